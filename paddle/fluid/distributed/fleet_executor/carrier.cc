@@ -144,6 +144,14 @@ Interceptor* Carrier::GetInterceptor(int64_t interceptor_id) {
   return iter->second.get();
 }
 
+Interceptor* Carrier::GetLocalInterceptor(int64_t interceptor_id) {
+  auto iter = interceptor_idx_to_interceptor_.find(interceptor_id);
+  if (iter == interceptor_idx_to_interceptor_.end()) {
+    return nullptr;
+  }
+  return iter->second.get();
+}
+
 void Carrier::Wait() {
   std::unique_lock<std::mutex> lock(running_mutex_);
   cond_var_.wait(lock);
@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/distributed/fleet_executor/interceptor.h"
 
+#include <algorithm>
+
 #include "paddle/fluid/distributed/fleet_executor/carrier.h"
 #include "paddle/fluid/distributed/fleet_executor/task_loop.h"
 #include "paddle/fluid/distributed/fleet_executor/task_node.h"
@@ -22,7 +24,9 @@ namespace paddle {
 namespace distributed {
 
 Interceptor::Interceptor(int64_t interceptor_id, TaskNode* node)
-    : interceptor_id_(interceptor_id), node_(node) {}
+    : interceptor_id_(interceptor_id), node_(node) {
+  local_mailboxes_.reserve(kMaxLocalMailboxes);
+}
 
 Interceptor::~Interceptor() {
   // FIXME(wangxi): throw in stop function
@@ -42,23 +46,72 @@ void Interceptor::Handle(const InterceptorMessage& msg) {
 }
 
 void Interceptor::LoopOnce() {
-  std::deque<InterceptorMessage> tmp_messages;
+  // Clear the flag before draining, so that a message enqueued after this
+  // point schedules another LoopOnce.
+  loop_scheduled_.store(false);
+
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    messages_.swap(tmp_messages);
+    for (auto& item : messages_) {
+      arrived_messages_.emplace_back(std::move(item));
+    }
+    messages_.clear();
+  }
+
+  size_t num_mailboxes = num_local_mailboxes_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < num_mailboxes; ++i) {
+    local_mailboxes_[i]->Drain([this](const LocalInterceptorMessage& msg) {
+      arrived_local_messages_.push_back(msg);
+    });
+  }
+  // The messages of every mailbox are in the order of arrival, so only the
+  // messages from different mailboxes need to be merged.
+  if (num_mailboxes > 1) {
+    std::sort(arrived_local_messages_.begin(),
+              arrived_local_messages_.end(),
+              [](const LocalInterceptorMessage& a,
+                 const LocalInterceptorMessage& b) {
+                return a.arrival < b.arrival;
+              });
   }
-  PADDLE_ENFORCE_EQ(tmp_messages.empty(),
-                    false,
-                    platform::errors::PreconditionNotMet(
-                        "tmp_messages must not empty in task loop"));
-
-  for (auto& msg : tmp_messages) {
-    const MessageType message_type = msg.message_type();
-    VLOG(3) << "Interceptor " << interceptor_id_ << " has received a message"
-            << " from interceptor " << msg.src_id()
-            << " with message: " << message_type << ".";
-
-    Handle(msg);
+
+  // Handle the messages in the order of arrival, and stop at the first
+  // missing one. Its sender schedules another LoopOnce after pushing it.
+  size_t num_local_handled = 0;
+  while (true) {
+    if (num_local_handled < arrived_local_messages_.size() &&
+        arrived_local_messages_[num_local_handled].arrival ==
+            next_to_handle_) {
+      const auto& msg = arrived_local_messages_[num_local_handled++];
+      VLOG(3) << "Interceptor " << interceptor_id_
+              << " has received a local message from interceptor "
+              << msg.src_id << " with message: " << msg.message_type << ".";
+      msg.ToProto(&local_message_);
+      ++next_to_handle_;
+      Handle(local_message_);
+    } else if (!arrived_messages_.empty() &&
+               arrived_messages_.front().first == next_to_handle_) {
+      InterceptorMessage msg = std::move(arrived_messages_.front().second);
+      arrived_messages_.pop_front();
+      VLOG(3) << "Interceptor " << interceptor_id_ << " has received a message"
+              << " from interceptor " << msg.src_id()
+              << " with message: " << msg.message_type() << ".";
+      ++next_to_handle_;
+      Handle(msg);
+    } else {
+      break;
+    }
+  }
+  arrived_local_messages_.erase(
+      arrived_local_messages_.begin(),
+      arrived_local_messages_.begin() + num_local_handled);
+}
+
+void Interceptor::ScheduleLoopOnce() {
+  // Only one LoopOnce is queued no matter how many messages arrive, so the
+  // lock of the task loop is not taken per message.
+  if (!loop_scheduled_.exchange(true)) {
+    loop_->QueueInLoop([this]() { LoopOnce(); });
   }
 }
 
@@ -75,15 +128,56 @@ void Interceptor::EnqueueRemoteInterceptorMessage(
   VLOG(3) << "Enqueue message: " << message.message_type() << " into "
           << interceptor_id_ << "'s remote mailbox.";
 
-  bool empty = false;
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    empty = messages_.empty();
-    messages_.emplace_back(message);
+    messages_.emplace_back(NextArrival(), message);
   }
-  if (empty) {
-    loop_->QueueInLoop([this]() { LoopOnce(); });
+  ScheduleLoopOnce();
+}
+
+LocalMailbox* Interceptor::AcquireLocalMailbox(int64_t src_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t num_mailboxes = num_local_mailboxes_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < num_mailboxes; ++i) {
+    if (local_mailboxes_[i]->src_id() == src_id) {
+      return local_mailboxes_[i].get();
+    }
+  }
+  if (num_mailboxes == kMaxLocalMailboxes) {
+    VLOG(3) << "Interceptor " << interceptor_id_
+            << " has no more local mailbox for interceptor " << src_id << ".";
+    return nullptr;
+  }
+  local_mailboxes_.emplace_back(std::make_unique<LocalMailbox>(src_id));
+  num_local_mailboxes_.store(num_mailboxes + 1, std::memory_order_release);
+  return local_mailboxes_.back().get();
+}
+
+bool Interceptor::SendLocal(int64_t dst_id, const InterceptorMessage& msg) {
+  // The mailboxes are single producer, so only the loop thread of this
+  // interceptor can use them.
+  if (msg.ctrl_message() || loop_ == nullptr || !loop_->IsInLoopThread()) {
+    return false;
+  }
+  auto iter = outboxes_.find(dst_id);
+  if (iter == outboxes_.end()) {
+    LocalMailbox* mailbox = nullptr;
+    Interceptor* dst = carrier_->GetLocalInterceptor(dst_id);
+    if (dst != nullptr) {
+      mailbox = dst->AcquireLocalMailbox(interceptor_id_);
+    }
+    iter = outboxes_.emplace(dst_id, std::make_pair(dst, mailbox)).first;
   }
+  Interceptor* dst = iter->second.first;
+  LocalMailbox* mailbox = iter->second.second;
+  if (mailbox == nullptr) {
+    return false;
+  }
+  VLOG(3) << "Send a local message from interceptor " << interceptor_id_
+          << " to interceptor " << dst_id << ".";
+  mailbox->Push(LocalInterceptorMessage::FromProto(msg, dst->NextArrival()));
+  dst->NotifyLocalMessage();
+  return true;
 }
 
 bool Interceptor::Send(int64_t dst_id, InterceptorMessage& msg) {
@@ -92,6 +186,9 @@ bool Interceptor::Send(int64_t dst_id, InterceptorMessage& msg) {
       platform::errors::PreconditionNotMet("Carrier is not registered."));
   msg.set_src_id(interceptor_id_);
   msg.set_dst_id(dst_id);
+  if (SendLocal(dst_id, msg)) {
+    return true;
+  }
   return carrier_->Send(msg);
 }
 
@@ -14,14 +14,19 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <deque>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "paddle/fluid/distributed/fleet_executor/interceptor_mailbox.h"
 #include "paddle/fluid/distributed/fleet_executor/interceptor_message.pb.h"
 #include "paddle/fluid/framework/blocking_queue.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -66,6 +71,21 @@ class Interceptor {
   void EnqueueRemoteInterceptorMessage(
       const InterceptorMessage& interceptor_message);
 
+  // Called by the sender in its loop thread, return the mailbox for the
+  // messages from `src_id`, or nullptr if no more mailbox can be created.
+  LocalMailbox* AcquireLocalMailbox(int64_t src_id);
+
+  // Called by the sender right before a message is pushed into one of the
+  // local mailboxes. The messages from the local mailboxes and the remote
+  // mailbox are handled in the order of arrival, so the messages from one
+  // sender are handled in order no matter which path they go through.
+  uint64_t NextArrival() {
+    return next_arrival_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Called by the sender after a message is pushed into one of the mailboxes.
+  void NotifyLocalMessage() { ScheduleLoopOnce(); }
+
   bool Send(int64_t dst_id, InterceptorMessage& msg);  // NOLINT
 
   void SetPlace(const platform::Place& place) { place_ = place; }
@@ -108,12 +128,47 @@ class Interceptor {
 
  private:
   void LoopOnce();
+  void ScheduleLoopOnce();
+
+  // Send to an interceptor of the same carrier through its local mailbox,
+  // return false if the fast path can not be used.
+  bool SendLocal(int64_t dst_id, const InterceptorMessage& msg);
 
   // interceptor handle which process message
   MsgHandle handle_{nullptr};
 
   std::mutex mutex_;
-  std::deque<InterceptorMessage> messages_;
+  // The remote mailbox, with the order of arrival of each message.
+  std::deque<std::pair<uint64_t, InterceptorMessage>> messages_;
+
+  // Every message takes the next order of arrival right before it is pushed
+  // into a mailbox, and never fails to be pushed.
+  std::atomic<uint64_t> next_arrival_{0};
+
+  // Whether LoopOnce has been queued in the task loop and not started yet.
+  std::atomic<bool> loop_scheduled_{false};
+
+  // Mailboxes for the messages from local interceptors, one per sender. The
+  // vector is reserved and never reallocates, so the receiver can iterate
+  // over the first `num_local_mailboxes_` mailboxes without a lock.
+  static constexpr size_t kMaxLocalMailboxes = 64;
+  std::vector<std::unique_ptr<LocalMailbox>> local_mailboxes_;
+  std::atomic<size_t> num_local_mailboxes_{0};
+  // Reused to pass local messages to the handle.
+  InterceptorMessage local_message_;
+
+  // The messages taken from the mailboxes but not handled yet, since some
+  // message arriving before them is still being pushed by its sender. Only
+  // accessed by the loop thread of this interceptor.
+  std::vector<LocalInterceptorMessage> arrived_local_messages_;
+  std::deque<std::pair<uint64_t, InterceptorMessage>> arrived_messages_;
+  uint64_t next_to_handle_{0};
+
+  // The receivers and their mailboxes for this interceptor, only accessed by
+  // the loop thread of this interceptor. A nullptr mailbox means the fast
+  // path can not be used, e.g. the receiver is in another rank.
+  std::unordered_map<int64_t, std::pair<Interceptor*, LocalMailbox*>>
+      outboxes_;
 
   int64_t already_run_times_{0};
   int64_t used_slot_nums_{0};
@@ -0,0 +1,162 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+#include "paddle/fluid/distributed/fleet_executor/interceptor_message.pb.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace distributed {
+
+// The plain counterpart of InterceptorMessage, which is used to deliver
+// messages between interceptors of the same carrier without any allocation.
+// Control messages are only sent inter rank, so they are not included.
+struct LocalInterceptorMessage {
+  int64_t src_id;
+  int64_t dst_id;
+  MessageType message_type;
+  int64_t scope_idx;
+  // The order of arrival at the receiver, see Interceptor::NextArrival.
+  uint64_t arrival;
+
+  static LocalInterceptorMessage FromProto(const InterceptorMessage& msg,
+                                           uint64_t arrival) {
+    return LocalInterceptorMessage{msg.src_id(),
+                                   msg.dst_id(),
+                                   msg.message_type(),
+                                   msg.scope_idx(),
+                                   arrival};
+  }
+
+  void ToProto(InterceptorMessage* msg) const {
+    msg->set_src_id(src_id);
+    msg->set_dst_id(dst_id);
+    msg->set_message_type(message_type);
+    msg->set_scope_idx(scope_idx);
+  }
+};
+
+// A bounded lock-free queue with exactly one producer thread and one consumer
+// thread. `kCapacity` must be a power of two.
+template <typename T, size_t kCapacity>
+class SpscRingQueue {
+  static_assert((kCapacity & (kCapacity - 1)) == 0,
+                "The capacity of SpscRingQueue must be a power of two.");
+
+ public:
+  SpscRingQueue() = default;
+
+  // Called by the producer, return false if the queue is full.
+  bool TryPush(const T& item) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == kCapacity) {
+      return false;
+    }
+    buffer_[tail & (kCapacity - 1)] = item;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Called by the consumer, return false if the queue is empty.
+  bool TryPop(T* item) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    *item = buffer_[head & (kCapacity - 1)];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(SpscRingQueue);
+
+  // Keep the indices written by different threads in different cache lines.
+  static constexpr size_t kCacheLineSize = 64;
+  std::atomic<size_t> head_{0};
+  char head_padding_[kCacheLineSize - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> tail_{0};
+  char tail_padding_[kCacheLineSize - sizeof(std::atomic<size_t>)];
+  std::array<T, kCapacity> buffer_;
+};
+
+// The mailbox of an interceptor for the messages from one local interceptor.
+// The producer is the loop thread of the sender and the consumer is the loop
+// thread of the receiver.
+//
+// Messages go through the ring queue in the common case. When the ring queue
+// is full, e.g. the sender and the receiver run in the same loop thread, the
+// messages go to the overflow queue, and the ring queue is not used again
+// until the overflowed messages are handled, so that the order is kept.
+class LocalMailbox {
+ public:
+  static constexpr size_t kRingCapacity = 256;
+
+  explicit LocalMailbox(int64_t src_id) : src_id_(src_id) {}
+
+  int64_t src_id() const { return src_id_; }
+
+  // Called by the sender.
+  void Push(const LocalInterceptorMessage& msg) {
+    if (overflow_pending_.load(std::memory_order_acquire) == 0 &&
+        ring_.TryPush(msg)) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(overflow_mutex_);
+    overflow_.emplace_back(msg);
+    overflow_pending_.fetch_add(1, std::memory_order_release);
+  }
+
+  // Called by the receiver, handle all the messages in order.
+  template <typename Handler>
+  void Drain(Handler&& handler) {
+    // All the messages in the ring queue are older than the overflowed ones
+    // taken here, since the sender does not use the ring queue again before
+    // the overflowed messages are handled.
+    std::deque<LocalInterceptorMessage> overflow;
+    if (overflow_pending_.load(std::memory_order_acquire) > 0) {
+      std::lock_guard<std::mutex> lock(overflow_mutex_);
+      overflow.swap(overflow_);
+    }
+    LocalInterceptorMessage msg;
+    while (ring_.TryPop(&msg)) {
+      handler(msg);
+    }
+    for (auto& item : overflow) {
+      handler(item);
+    }
+    if (!overflow.empty()) {
+      overflow_pending_.fetch_sub(overflow.size(), std::memory_order_release);
+    }
+  }
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(LocalMailbox);
+
+  int64_t src_id_;
+  SpscRingQueue<LocalInterceptorMessage, kRingCapacity> ring_;
+
+  std::atomic<size_t> overflow_pending_{0};
+  std::mutex overflow_mutex_;
+  std::deque<LocalInterceptorMessage> overflow_;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,117 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/fleet_executor/carrier.h"
+#include "paddle/fluid/distributed/fleet_executor/global.h"
+#include "paddle/fluid/distributed/fleet_executor/interceptor.h"
+#include "paddle/fluid/distributed/fleet_executor/interceptor_mailbox.h"
+#include "paddle/fluid/distributed/fleet_executor/message_bus.h"
+#include "paddle/fluid/distributed/fleet_executor/task_node.h"
+
+namespace paddle {
+namespace distributed {
+
+TEST(LocalMailbox, KeepOrderWithOverflow) {
+  constexpr int64_t kNumMessages = 100000;
+  LocalMailbox mailbox(0);
+
+  std::thread producer([&mailbox]() {
+    for (int64_t i = 0; i < kNumMessages; ++i) {
+      mailbox.Push(LocalInterceptorMessage{
+          0, 1, DATA_IS_READY, i, static_cast<uint64_t>(i)});
+    }
+  });
+
+  int64_t expected = 0;
+  while (expected < kNumMessages) {
+    mailbox.Drain([&expected](const LocalInterceptorMessage& msg) {
+      EXPECT_EQ(msg.scope_idx, expected);
+      EXPECT_EQ(msg.arrival, static_cast<uint64_t>(expected));
+      ++expected;
+    });
+  }
+  producer.join();
+  EXPECT_EQ(expected, kNumMessages);
+}
+
+// source->compute_0->...->compute_n->sink with many micro batches and no ops,
+// so the time is spent on the messages between the interceptors.
+TEST(InterceptorPipeline, MicroBatchBenchmark) {
+  constexpr int64_t kNumStages = 4;
+  constexpr int64_t kMicroSteps = 2000;
+
+  std::string carrier_id = "0";
+  Carrier* carrier =
+      GlobalMap<std::string, Carrier>::Create(carrier_id, carrier_id);
+  std::unordered_map<int64_t, int64_t> interceptor_id_to_rank = {
+      {SOURCE_ID, 0}, {SINK_ID, 0}};
+  for (int64_t i = 0; i < kNumStages; ++i) {
+    interceptor_id_to_rank.emplace(i, 0);
+  }
+  carrier->Init(0, interceptor_id_to_rank);
+  MessageBus* msg_bus = GlobalVal<MessageBus>::Create();
+  msg_bus->Init(0, {{0, ""}}, "");
+
+  // NOTE: don't delete, otherwise interceptor will use undefined node
+  std::vector<TaskNode*> nodes;
+  nodes.emplace_back(new TaskNode(0, SOURCE_ID, kMicroSteps));
+  for (int64_t i = 0; i < kNumStages; ++i) {
+    nodes.emplace_back(new TaskNode(0, 0, i, kMicroSteps, 0));
+  }
+  nodes.emplace_back(new TaskNode(0, SINK_ID, kMicroSteps));
+  for (size_t i = 0; i + 1 < nodes.size(); ++i) {
+    nodes[i]->AddDownstreamTask(nodes[i + 1]->task_id(), 2);
+    nodes[i + 1]->AddUpstreamTask(nodes[i]->task_id(), 2);
+  }
+
+  carrier->SetInterceptor(
+      SOURCE_ID, InterceptorFactory::Create("Source", SOURCE_ID, nodes[0]));
+  for (int64_t i = 0; i < kNumStages; ++i) {
+    carrier->SetInterceptor(
+        i, InterceptorFactory::Create("Compute", i, nodes[i + 1]));
+  }
+  carrier->SetInterceptor(
+      SINK_ID, InterceptorFactory::Create("Sink", SINK_ID, nodes.back()));
+
+  auto start = std::chrono::steady_clock::now();
+  InterceptorMessage msg;
+  msg.set_message_type(START);
+  msg.set_dst_id(SOURCE_ID);
+  carrier->EnqueueInterceptorMessage(msg);
+  carrier->Wait();
+  auto end = std::chrono::steady_clock::now();
+
+  // Every micro batch sends one DATA_IS_READY and one DATA_IS_USELESS on
+  // every edge.
+  int64_t num_messages = 2 * (kNumStages + 1) * kMicroSteps;
+  double us =
+      std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+          .count();
+  std::cout << "Pipeline of " << kNumStages << " stages with " << kMicroSteps
+            << " micro batches: " << num_messages << " messages in " << us
+            << " us, " << num_messages / std::max(us, 1.0)
+            << " messages per us." << std::endl;
+  carrier->Release();
+}
+
+}  // namespace distributed
+}  // namespace paddle
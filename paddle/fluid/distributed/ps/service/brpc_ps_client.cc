@@ -1069,6 +1069,87 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
   return fut;
 }
 
+std::future<int32_t> BrpcPsClient::PushSparseRawGradientMultiTable(
+    const std::vector<SparsePushRegion> &regions, void *done) {
+  DownpourBrpcClosure *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
+  auto promise = std::make_shared<std::promise<int32_t>>();
+  closure->add_promise(promise);
+  std::future<int> fut = promise->get_future();
+
+  size_t request_call_num = _server_channels.size();
+  size_t table_num = regions.size();
+  // ids[table][shard]
+  std::vector<std::vector<std::vector<uint64_t>>> ids(table_num);
+  std::vector<std::vector<std::vector<const float *>>> value_ptrs(table_num);
+  std::vector<uint32_t> value_sizes(table_num);
+
+  const auto &server_param = _config.server_param().downpour_server_param();
+  for (size_t t = 0; t < table_num; ++t) {
+    const auto &region = regions[t];
+    value_sizes[t] =
+        GetTableAccessor(region.table_id)->GetAccessorInfo().update_size;
+    uint64_t shard_num = FLAGS_pserver_sparse_table_shard_num;
+    for (int i = 0; i < server_param.downpour_table_param_size(); ++i) {
+      const auto &table_param = server_param.downpour_table_param(i);
+      if (table_param.table_id() == region.table_id) {
+        shard_num = table_param.shard_num();
+        break;
+      }
+    }
+    ids[t].resize(request_call_num);
+    value_ptrs[t].resize(request_call_num);
+    for (size_t i = 0; i < region.num; ++i) {
+      size_t pserver_idx =
+          get_sparse_shard(shard_num, request_call_num, region.keys[i]);
+      ids[t][pserver_idx].push_back(region.keys[i]);
+      value_ptrs[t][pserver_idx].push_back(region.update_values[i]);
+    }
+  }
+
+  for (size_t shard_idx = 0; shard_idx < request_call_num; ++shard_idx) {
+    /*
+    Push Content:
+    params: one {table_id, kv_size, value_size} for each table
+    data: |---keysData of table 0---|---valuesData of table 0---|...
+    */
+    auto *push_request = closure->request(shard_idx);
+    push_request->set_cmd_id(PS_PUSH_SPARSE_MULTI_TABLE);
+    push_request->set_table_id(regions[0].table_id);
+    push_request->set_client_id(_client_id);
+    size_t data_size = 0;
+    for (size_t t = 0; t < table_num; ++t) {
+      uint32_t header[3] = {static_cast<uint32_t>(regions[t].table_id),
+                            static_cast<uint32_t>(ids[t][shard_idx].size()),
+                            value_sizes[t]};
+      push_request->add_params(reinterpret_cast<char *>(header),
+                               sizeof(header));
+      data_size += ids[t][shard_idx].size() *
+                   (sizeof(uint64_t) + static_cast<size_t>(value_sizes[t]));
+    }
+    auto *push_data = push_request->mutable_data();
+    push_data->resize(data_size);
+    char *push_data_ptr = const_cast<char *>(push_data->data());
+    for (size_t t = 0; t < table_num; ++t) {
+      const auto &kvs = ids[t][shard_idx];
+      const auto &value_ptr = value_ptrs[t][shard_idx];
+      memcpy(push_data_ptr, kvs.data(), kvs.size() * sizeof(uint64_t));
+      push_data_ptr += kvs.size() * sizeof(uint64_t);
+      for (size_t i = 0; i < kvs.size(); ++i) {
+        memcpy(push_data_ptr, value_ptr[i], value_sizes[t]);
+        push_data_ptr += value_sizes[t];
+      }
+    }
+    PsService_Stub rpc_stub(GetSparseChannel(shard_idx));
+    closure->cntl(shard_idx)->set_request_compress_type(
+        (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
+    rpc_stub.service(closure->cntl(shard_idx),
+                     closure->request(shard_idx),
+                     closure->response(shard_idx),
+                     closure);
+  }
+  return fut;
+}
+
 std::future<int32_t> BrpcPsClient::PushDenseRawGradient(
     int table_id,
     float *total_send_data,
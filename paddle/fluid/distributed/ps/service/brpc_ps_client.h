@@ -397,6 +397,10 @@ class BrpcPsClient : public PSClient {
                                              size_t num,
                                              void *done) override;
 
+  bool SupportPushSparseMultiTable() const override { return true; }
+  std::future<int32_t> PushSparseRawGradientMultiTable(
+      const std::vector<SparsePushRegion> &regions, void *done) override;
+
   std::future<int32_t> PushSparseRawGradientPartial(size_t table_id,
                                                     const uint64_t *keys,
                                                     const float **update_values,
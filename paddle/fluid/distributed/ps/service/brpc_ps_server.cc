@@ -193,6 +193,8 @@ int32_t BrpcPsService::Initialize() {
   _service_handler_map[PS_PUSH_DENSE_TABLE] = &BrpcPsService::PushDense;
   _service_handler_map[PS_PULL_SPARSE_TABLE] = &BrpcPsService::PullSparse;
   _service_handler_map[PS_PUSH_SPARSE_TABLE] = &BrpcPsService::PushSparse;
+  _service_handler_map[PS_PUSH_SPARSE_MULTI_TABLE] =
+      &BrpcPsService::PushSparseMultiTable;
   _service_handler_map[PS_SAVE_ONE_TABLE] = &BrpcPsService::SaveOneTable;
   _service_handler_map[PS_SAVE_ALL_TABLE] = &BrpcPsService::SaveAllTable;
   _service_handler_map[PS_SHRINK_TABLE] = &BrpcPsService::ShrinkTable;
@@ -592,6 +594,87 @@ int32_t BrpcPsService::PushSparse(Table *table,
   return 0;
 }
 
+int32_t BrpcPsService::PushSparseMultiTable(Table *table,
+                                            const PsRequestMessage &request,
+                                            PsResponseMessage &response,
+                                            brpc::Controller *cntl) {
+  platform::RecordEvent record_event("PsService->PushSparseMultiTable",
+                                     platform::TracerEventType::Communication,
+                                     1);
+  CostTimer timer("pserver_server_push_sparse_multi_table");
+  /*
+  Push Content:
+  params: one {table_id, kv_size, value_size} for each table
+  data: |---keysData of table 0---|---valuesData of table 0---|...
+  */
+  auto &push_data = request.data();
+  // Validate the whole request before pushing any table, so that a bad
+  // request updates nothing and can be retried without pushing twice.
+  std::vector<std::pair<Table *, TableContext>> pushes;
+  size_t offset = 0;
+  for (int i = 0; i < request.params_size(); ++i) {
+    if (request.params(i).size() != 3 * sizeof(uint32_t)) {
+      set_response_code(
+          response, -1, "PsRequestMessage.params of multi table is invalid");
+      return 0;
+    }
+    const uint32_t *header =
+        reinterpret_cast<const uint32_t *>(request.params(i).c_str());
+    uint32_t table_id = header[0];
+    uint32_t num = header[1];
+    if (num == 0) {
+      continue;
+    }
+    auto *sub_table = _server->GetTable(table_id);
+    if (sub_table == NULL) {
+      std::string err_msg("table not found with table_id:");
+      err_msg.append(std::to_string(table_id));
+      set_response_code(response, -1, err_msg.c_str());
+      return 0;
+    }
+    // The values are read by the accessor of the table with its own
+    // update_size, so a different value_size would read out of the data.
+    auto accessor = sub_table->ValueAccesor();
+    if (accessor == nullptr ||
+        header[2] != accessor->GetAccessorInfo().update_size) {
+      std::string err_msg("value_size of multi table does not match table_id:");
+      err_msg.append(std::to_string(table_id));
+      set_response_code(response, -1, err_msg.c_str());
+      return 0;
+    }
+    size_t size = num * (sizeof(uint64_t) + static_cast<size_t>(header[2]));
+    if (size > push_data.size() - offset) {
+      set_response_code(
+          response, -1, "PsRequestMessage.data of multi table is too short");
+      return 0;
+    }
+    TableContext table_context;
+    table_context.value_type = Sparse;
+    table_context.push_context.keys =
+        reinterpret_cast<const uint64_t *>(push_data.data() + offset);
+    table_context.push_context.values = reinterpret_cast<const float *>(
+        push_data.data() + offset + sizeof(uint64_t) * num);
+    table_context.num = num;
+    pushes.emplace_back(sub_table, table_context);
+    offset += size;
+  }
+  if (offset != push_data.size()) {
+    set_response_code(response,
+                      -1,
+                      "PsRequestMessage.data of multi table does not match "
+                      "the size in params");
+    return 0;
+  }
+
+  for (auto &push : pushes) {
+    if (push.first->Push(push.second) != 0) {
+      set_response_code(response, -1, "PushSparseMultiTable error");
+      return 0;
+    }
+  }
+  return 0;
+}
+
 int32_t BrpcPsService::PrintTableStat(Table *table,
                                       const PsRequestMessage &request,
                                       PsResponseMessage &response,
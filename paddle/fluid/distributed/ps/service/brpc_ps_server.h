@@ -121,6 +121,10 @@ class BrpcPsService : public PsBaseService {
                      const PsRequestMessage &request,
                      PsResponseMessage &response,  // NOLINT
                      brpc::Controller *cntl);
+  int32_t PushSparseMultiTable(Table *table,
+                               const PsRequestMessage &request,
+                               PsResponseMessage &response,  // NOLINT
+                               brpc::Controller *cntl);
   int32_t LoadOneTable(Table *table,
                        const PsRequestMessage &request,
                        PsResponseMessage &response,  // NOLINT
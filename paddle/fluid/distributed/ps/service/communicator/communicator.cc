@@ -25,6 +25,9 @@ limitations under the License. */
 #define LEARNING_RATE_DECAY_COUNTER "@LR_DECAY_COUNTER@"
 #define STEP_COUNTER "@PS_STEP_COUNTER@"
 
+DECLARE_bool(communicator_coalesce_sparse_send);
+DECLARE_bool(communicator_adaptive_merge);
+
 namespace paddle {
 namespace distributed {
 
@@ -214,6 +217,7 @@ void Communicator::RpcSendDense(const CommContext &ctx,
   }
 
   ++_async_call_num;
+  send_rpc_num_ += request_call_num;
   DownpourBrpcClosure *closure = new DownpourBrpcClosure(
       request_call_num, [this, request_call_num](void *done) {
         int ret = 0;
@@ -310,6 +314,7 @@ void Communicator::RpcSendSparse(const std::string &var_name,
   */
 
   ++_async_call_num;
+  send_rpc_num_ += request_call_num;
   DownpourBrpcClosure *closure = new DownpourBrpcClosure(
       request_call_num, [this, request_call_num](void *done) {
         int ret = 0;
@@ -333,6 +338,57 @@ void Communicator::RpcSendSparse(const std::string &var_name,
   return;
 }
 
+void Communicator::RpcSendSparseMultiTable(
+    const std::vector<std::pair<std::string, int>> &var_tables,
+    const Scope &scope) {
+  platform::RecordEvent record_event("Communicator->RpcSendSparseMultiTable",
+                                     platform::TracerEventType::Communication,
+                                     1);
+  size_t request_call_num = _worker_ptr->GetServerNums();
+  size_t table_num = var_tables.size();
+  std::vector<std::vector<uint64_t>> sparse_push_keys(table_num);
+  std::vector<std::vector<float *>> push_g_vec(table_num);
+  std::vector<SparsePushRegion> regions(table_num);
+
+  for (size_t t = 0; t < table_num; ++t) {
+    auto *send_var = scope.FindVar(var_tables[t].first);
+    auto *tensor = send_var->GetMutable<phi::SelectedRows>();
+    auto dim = tensor->value().dims()[1];
+    auto &keys = sparse_push_keys[t];
+    std::transform(tensor->rows().begin(),
+                   tensor->rows().end(),
+                   std::back_inserter(keys),
+                   [&](int64_t id) { return static_cast<uint64_t>(id); });
+    for (size_t i = 0; i < keys.size(); ++i) {
+      push_g_vec[t].push_back(tensor->mutable_value()->data<float>() +
+                              i * dim);
+    }
+    regions[t].table_id = var_tables[t].second;
+    regions[t].keys = keys.data();
+    regions[t].update_values = (const float **)push_g_vec[t].data();
+    regions[t].num = keys.size();
+  }
+
+  ++_async_call_num;
+  send_rpc_num_ += request_call_num;
+  DownpourBrpcClosure *closure = new DownpourBrpcClosure(
+      request_call_num, [this, request_call_num](void *done) {
+        int ret = 0;
+        auto *closure = (DownpourBrpcClosure *)done;  // NOLINT
+        for (size_t i = 0; i < request_call_num; ++i) {
+          if (closure->check_response(i, PS_PUSH_SPARSE_MULTI_TABLE) != 0) {
+            ret = -1;
+            break;
+          }
+        }
+        closure->set_promise_value(ret);
+        --_async_call_num;
+      });
+  auto status = _worker_ptr->PushSparseRawGradientMultiTable(regions, closure);
+  status.wait();
+  return;
+}
+
 void Communicator::RpcRecvSparse(const std::string &varname,
                                  int table_id,
                                  Scope *scope) {
@@ -492,22 +548,52 @@ void AsyncCommunicator::SendByCommunicator() {
   std::vector<std::future<void>> tasks;
   tasks.reserve(send_varname_to_ctx_.size());
 
+  // If there are several sparse tables, their merged grads are sent together
+  // after all the tasks are done, with one request per server.
+  size_t sparse_table_num = 0;
   for (auto &iter : send_varname_to_ctx_) {
-    auto &ctx = iter.second;
+    if (iter.second.is_sparse && !iter.second.is_tensor_table) {
+      ++sparse_table_num;
+    }
+  }
+  bool coalesce_sparse = FLAGS_communicator_coalesce_sparse_send &&
+                         sparse_table_num > 1 &&
+                         _worker_ptr->SupportPushSparseMultiTable();
+  std::mutex coalesced_mutex;
+  std::vector<const CommContext *> coalesced_ctxs;
+  std::vector<AdaptiveMergeWindow *> coalesced_windows;
+  std::vector<int> coalesced_merged_nums;
 
-    auto send_recv_task = [this, &ctx] {
+  for (auto &iter : send_varname_to_ctx_) {
+    auto &ctx = iter.second;
+    auto &window = merge_windows_.at(iter.first);
+
+    auto send_recv_task = [this,
+                           &ctx,
+                           &window,
+                           coalesce_sparse,
+                           &coalesced_mutex,
+                           &coalesced_ctxs,
+                           &coalesced_windows,
+                           &coalesced_merged_nums] {
       auto &varnames = ctx.origin_varnames;
       auto &table_id = ctx.table_id;
       size_t var_nums = varnames.size();
       auto &check_queue = send_varname_to_queue_[varnames[0]];
+      int max_merge_num = max_merge_var_num_;
+      int max_wait_times = send_wait_times_;
+      if (FLAGS_communicator_adaptive_merge) {
+        max_merge_num = window.MergeNum();
+        max_wait_times = window.WaitTimes();
+      }
       std::vector<std::vector<std::shared_ptr<Variable>>> vars;
       vars.resize(var_nums);
       int merged_var_num = 0;
       int wait_times = 0;
-      while (merged_var_num < max_merge_var_num_) {
+      while (merged_var_num < max_merge_num) {
         if (check_queue->Size() == 0) {
           VLOG(4) << "wait_times -> " << wait_times;
-          if (wait_times >= send_wait_times_) {
+          if (wait_times >= max_wait_times) {
             break;
           }
           std::this_thread::sleep_for(std::chrono::milliseconds(10));
@@ -534,6 +620,7 @@ void AsyncCommunicator::SendByCommunicator() {
         }
       }
 
+      double send_begin = GetCurrentUS();
       if (ctx.is_tensor_table) {
         SendGlobalStep(ctx, merged_var_num, send_scope_.get());
       } else if (ctx.is_sparse) {
@@ -542,6 +629,13 @@ void AsyncCommunicator::SendByCommunicator() {
             1,
             platform::errors::InvalidArgument(
                 "sparse variables can only be merged by one variables"));
+        if (coalesce_sparse) {
+          std::lock_guard<std::mutex> lock(coalesced_mutex);
+          coalesced_ctxs.push_back(&ctx);
+          coalesced_windows.push_back(&window);
+          coalesced_merged_nums.push_back(merged_var_num);
+          return;
+        }
         RpcSendSparse(varnames[0], table_id, *send_scope_);
       } else {
         RpcSendDense(ctx, *send_scope_);
@@ -551,6 +645,8 @@ void AsyncCommunicator::SendByCommunicator() {
           RpcRecvDense(recv_varnames, table_id, recv_scope_);
         }
       }
+      window.Update(
+          merged_var_num, check_queue->Size(), GetCurrentUS() - send_begin);
       if (independent_recv_) {
         grad_num_.fetch_add(1, std::memory_order_relaxed);
       }
@@ -560,6 +656,31 @@ void AsyncCommunicator::SendByCommunicator() {
   for (auto &task : tasks) {
     task.wait();
   }
+
+  if (coalesced_ctxs.empty()) {
+    return;
+  }
+  std::vector<std::pair<std::string, int>> var_tables;
+  var_tables.reserve(coalesced_ctxs.size());
+  for (auto *ctx : coalesced_ctxs) {
+    var_tables.emplace_back(ctx->origin_varnames[0], ctx->table_id);
+  }
+  double send_begin = GetCurrentUS();
+  if (var_tables.size() == 1) {
+    RpcSendSparse(var_tables[0].first, var_tables[0].second, *send_scope_);
+  } else {
+    RpcSendSparseMultiTable(var_tables, *send_scope_);
+  }
+  double send_us = GetCurrentUS() - send_begin;
+  for (size_t i = 0; i < coalesced_ctxs.size(); ++i) {
+    auto &var_queue =
+        send_varname_to_queue_[coalesced_ctxs[i]->origin_varnames[0]];
+    coalesced_windows[i]->Update(
+        coalesced_merged_nums[i], var_queue->Size(), send_us);
+    if (independent_recv_) {
+      grad_num_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
   return;
 }
 
@@ -808,6 +929,10 @@ void AsyncCommunicator::InitImpl(const RpcCtxMap &send_varname_to_ctx,
               send_queue_size_);
     }
   }
+  for (auto &iter : send_varname_to_ctx_) {
+    merge_windows_[iter.first] =
+        AdaptiveMergeWindow(max_merge_var_num_, send_wait_times_);
+  }
   send_threadpool_.reset(new ::ThreadPool(thread_pool_size_));
 }
 
@@ -1291,7 +1416,7 @@ std::vector<int64_t> GeoCommunicator::MergeSparseIds(
                                      platform::TracerEventType::Communication,
                                      1);
   size_t merge_num = 0, wait_times = 0;
-  std::unordered_set<int64_t> sparse_ids;
+  FlatIdSet sparse_ids;
   while (merge_num <
          static_cast<size_t>(max_merge_var_num_)) {  // -> geo_step: 100
     VLOG(3) << "Merge Number of " << send_varname << " = " << merge_num;
@@ -1299,9 +1424,7 @@ std::vector<int64_t> GeoCommunicator::MergeSparseIds(
       wait_times = 0;
       std::shared_ptr<std::vector<int64_t>> pop_ids = nullptr;
       sparse_id_queues_.at(send_varname)->Get(pop_ids);
-      for (size_t j = 0; j < pop_ids->size(); j++) {
-        sparse_ids.insert(pop_ids->at(j));
-      }
+      sparse_ids.Insert(pop_ids->begin(), pop_ids->end());
       merge_num += 1;
       VLOG(3) << "sparse_id_queues_(" << send_varname << ") pushed";
     } else if (sparse_id_queues_.at(send_varname)->Size() == 0) {
@@ -1314,9 +1437,7 @@ std::vector<int64_t> GeoCommunicator::MergeSparseIds(
       continue;
     }
   }
-  std::vector<int64_t> res;
-  res.assign(sparse_ids.begin(), sparse_ids.end());
-  return res;
+  return sparse_ids.ToVector();
 }
 
 void GeoCommunicator::SendSparse(const std::string &varname,
@@ -31,6 +31,7 @@ limitations under the License. */
 
 #include "gflags/gflags.h"
 #include "paddle/fluid/distributed/ps/service/communicator/communicator_common.h"
+#include "paddle/fluid/distributed/ps/service/communicator/communicator_util.h"
 #include "paddle/fluid/distributed/ps/service/coordinator_client.h"
 #include "paddle/fluid/distributed/ps/service/ps_client.h"
 #include "paddle/fluid/framework/channel.h"
@@ -269,6 +270,10 @@ class Communicator {
   virtual void RpcSendSparse(const std::string &var_name,
                              int table_id,
                              const Scope &scope);
+  // 4.1 send sparse grads of several tables with one request per server
+  virtual void RpcSendSparseMultiTable(
+      const std::vector<std::pair<std::string, int>> &var_tables,
+      const Scope &scope);
   // 5. send sparse param
   virtual void RpcSendSparseParam(const std::string &varname,
                                   int table_id,
@@ -388,6 +393,9 @@ class Communicator {
 
   PSClient *GetPsClient() { return _worker_ptr.get(); }
 
+  // The number of requests sent to servers to push gradients.
+  uint64_t SendRpcNum() const { return send_rpc_num_.load(); }
+
   RecvCtxMap &GetRecvCtxMap() { return recv_varname_to_ctx_; }
 
   std::shared_ptr<PSClient> _worker_ptr;  // pointer to worker
@@ -421,6 +429,7 @@ class Communicator {
   Scope *recv_scope_;  // should be global scope
   std::unique_ptr<Scope> xpu_temp_scope_;
   std::atomic<uint32_t> _async_call_num{0};
+  std::atomic<uint64_t> send_rpc_num_{0};
 };
 
 class AsyncCommunicator : public Communicator {
@@ -501,6 +510,8 @@ class AsyncCommunicator : public Communicator {
                      std::shared_ptr<BlockingQueue<std::shared_ptr<Variable>>>>
       send_varname_to_queue_;
   std::unique_ptr<::ThreadPool> send_threadpool_{nullptr};
+  // Merge windows of the send contexts, indexed by the name of the context.
+  std::unordered_map<std::string, AdaptiveMergeWindow> merge_windows_;
 
   int min_send_grad_num_before_recv_;
   int thread_pool_size_;
@@ -0,0 +1,190 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace paddle {
+namespace distributed {
+
+// An open addressing hash set of int64 ids with linear probing, which keeps
+// all the ids in one flat array. It is used to deduplicate the sparse ids
+// before sending, where std::unordered_set spends most of the time on the
+// allocation of nodes.
+class FlatIdSet {
+ public:
+  explicit FlatIdSet(size_t expected_size = 0) { Reserve(expected_size); }
+
+  // Return true if the id is newly inserted.
+  bool Insert(int64_t id) {
+    if (id == kEmpty) {
+      bool inserted = !has_empty_id_;
+      has_empty_id_ = true;
+      return inserted;
+    }
+    if ((size_ + 1) * 2 > slots_.size()) {
+      Rehash(std::max<size_t>(slots_.size() * 2, kMinCapacity));
+    }
+    size_t mask = slots_.size() - 1;
+    for (size_t pos = Hash(id) & mask;; pos = (pos + 1) & mask) {
+      if (slots_[pos] == id) {
+        return false;
+      }
+      if (slots_[pos] == kEmpty) {
+        slots_[pos] = id;
+        ++size_;
+        return true;
+      }
+    }
+  }
+
+  template <typename Iter>
+  void Insert(Iter begin, Iter end) {
+    for (; begin != end; ++begin) {
+      Insert(*begin);
+    }
+  }
+
+  size_t Size() const { return size_ + (has_empty_id_ ? 1 : 0); }
+
+  void Reserve(size_t size) {
+    size_t capacity = kMinCapacity;
+    while (capacity < size * 2) {
+      capacity *= 2;
+    }
+    if (capacity > slots_.size()) {
+      Rehash(capacity);
+    }
+  }
+
+  // The ids in the set, in no particular order.
+  std::vector<int64_t> ToVector() const {
+    std::vector<int64_t> ids;
+    ids.reserve(Size());
+    for (int64_t slot : slots_) {
+      if (slot != kEmpty) {
+        ids.push_back(slot);
+      }
+    }
+    if (has_empty_id_) {
+      ids.push_back(kEmpty);
+    }
+    return ids;
+  }
+
+ private:
+  // Enumerators rather than static members, which need out-of-class
+  // definitions when they are bound to references.
+  enum : int64_t { kEmpty = -1 };
+  enum : size_t { kMinCapacity = 16 };
+
+  static size_t Hash(int64_t id) {
+    // The finalizer of MurmurHash3, since the ids are often sequential.
+    uint64_t h = static_cast<uint64_t>(id);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<size_t>(h);
+  }
+
+  void Rehash(size_t capacity) {
+    std::vector<int64_t> old_slots(capacity, kEmpty);
+    old_slots.swap(slots_);
+    size_t mask = slots_.size() - 1;
+    for (int64_t id : old_slots) {
+      if (id == kEmpty) {
+        continue;
+      }
+      size_t pos = Hash(id) & mask;
+      while (slots_[pos] != kEmpty) {
+        pos = (pos + 1) & mask;
+      }
+      slots_[pos] = id;
+    }
+  }
+
+  std::vector<int64_t> slots_;
+  size_t size_{0};
+  bool has_empty_id_{false};
+};
+
+// Decide how long the communicator waits for more gradients of a table and
+// how many gradients it merges before one send, with the depth of the send
+// queue and the latency of the RPCs.
+//
+// * If gradients are still queued after a send, the trainer is faster than
+//   the communicator. The merge window grows, so that the same data is sent
+//   with fewer RPCs, and the communicator waits at most one poll interval
+//   for more gradients. It still waits once, since the queue may be drained
+//   by the time of the next send, which then returns without sending and
+//   without updating the window.
+// * Otherwise the window shrinks back to the configured merge num, and the
+//   communicator waits for new gradients for about the time of one RPC,
+//   since sending a nearly empty merge costs one RPC anyway.
+class AdaptiveMergeWindow {
+ public:
+  // Poll interval of the send queue in the communicator.
+  static constexpr int kPollIntervalMs = 10;
+  static constexpr int kMaxMergeScale = 4;
+
+  AdaptiveMergeWindow() = default;
+  AdaptiveMergeWindow(int max_merge_num, int max_wait_times)
+      : min_merge_num_(std::max(max_merge_num, 1)),
+        max_merge_num_(min_merge_num_ * kMaxMergeScale),
+        max_wait_times_(max_wait_times),
+        merge_num_(min_merge_num_),
+        wait_times_(max_wait_times) {}
+
+  int MergeNum() const { return merge_num_; }
+  int WaitTimes() const { return wait_times_; }
+  double RpcLatencyUs() const { return rpc_us_; }
+
+  // Called after each send with the number of merged gradients, the number
+  // of gradients left in the queue and the latency of the send in us.
+  void Update(int merged_num, size_t queue_depth, double rpc_us) {
+    constexpr double kDecay = 0.8;
+    rpc_us_ = rpc_us_ == 0 ? rpc_us : kDecay * rpc_us_ + (1 - kDecay) * rpc_us;
+
+    if (queue_depth > 0) {
+      if (merged_num >= merge_num_) {
+        merge_num_ = std::min(merge_num_ * 2, max_merge_num_);
+      }
+      wait_times_ = std::min(1, max_wait_times_);
+      return;
+    }
+    merge_num_ = std::max(merge_num_ / 2, min_merge_num_);
+    int rpc_wait_times =
+        static_cast<int>(std::ceil(rpc_us_ / (kPollIntervalMs * 1000.0)));
+    wait_times_ = std::min(std::max(rpc_wait_times, 1), max_wait_times_);
+  }
+
+ private:
+  int min_merge_num_{1};
+  int max_merge_num_{1};
+  int max_wait_times_{0};
+  int merge_num_{1};
+  int wait_times_{0};
+  // Exponential moving average of the send latency.
+  double rpc_us_{0};
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -35,6 +35,14 @@ namespace distributed {
 using paddle::distributed::PsRequestMessage;
 using paddle::distributed::PsResponseMessage;
 
+// The raw sparse gradients of one table, see PushSparseRawGradientMultiTable.
+struct SparsePushRegion {
+  size_t table_id;
+  const uint64_t *keys;
+  const float **update_values;
+  size_t num;
+};
+
 typedef std::function<void(void *)> PSClientCallBack;
 class PSClientClosure : public google::protobuf::Closure {
  public:
@@ -240,6 +248,18 @@ class PSClient {
       size_t num,
       void *done) = 0;
 
+  // Push the raw sparse gradients of several tables, which are coalesced into
+  // one request per server instead of one request per table and server.
+  virtual bool SupportPushSparseMultiTable() const { return false; }
+  virtual std::future<int32_t> PushSparseRawGradientMultiTable(
+      const std::vector<SparsePushRegion> &regions, void *done) {
+    VLOG(0) << "Did not implement";
+    std::promise<int32_t> promise;
+    std::future<int> fut = promise.get_future();
+    promise.set_value(-1);
+    return fut;
+  }
+
   virtual std::future<int32_t> PushSparseRawGradientPartial(
       size_t table_id,
       const uint64_t *keys,
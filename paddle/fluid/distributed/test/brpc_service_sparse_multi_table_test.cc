@@ -0,0 +1,368 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/service/brpc_ps_client.h"
+#include "paddle/fluid/distributed/ps/service/brpc_ps_server.h"
+#include "paddle/fluid/distributed/ps/service/env.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/platform/place.h"
+#include "paddle/phi/kernels/funcs/math_function.h"
+
+namespace paddle {
+namespace distributed {
+class DownpourBrpcClosure;
+class PSClient;
+class PSServer;
+}  // namespace distributed
+namespace framework {
+class Variable;
+}  // namespace framework
+}  // namespace paddle
+
+namespace phi {
+class DenseTensor;
+}  // namespace phi
+
+namespace framework = paddle::framework;
+namespace platform = paddle::platform;
+namespace operators = paddle::operators;
+namespace memory = paddle::memory;
+namespace distributed = paddle::distributed;
+
+void CreateVarsOnScope(framework::Scope* scope, platform::CPUPlace* place) {
+  auto x_var = scope->Var("x");
+  x_var->GetMutable<phi::DenseTensor>();
+  auto x_g_var = scope->Var("x@GRAD");
+  x_g_var->GetMutable<phi::DenseTensor>();
+}
+
+void InitTensorsOnClient(framework::Scope* scope,
+                         platform::CPUPlace* place,
+                         int64_t rows_numel) {
+  CreateVarsOnScope(scope, place);
+
+  auto x_var = scope->Var("x")->GetMutable<phi::DenseTensor>();
+  float* x_ptr =
+      x_var->mutable_data<float>(framework::DDim({1, rows_numel}), *place);
+  for (int64_t i = 0; i < rows_numel; ++i) x_ptr[i] = 1.0;
+
+  auto g_size = rows_numel +
+                30;  // hard code here: key_num * (fea_dim + 3), show/clk/slot
+  auto x_g_var = scope->Var("x@GRAD")->GetMutable<phi::DenseTensor>();
+  float* x_g_ptr =
+      x_g_var->mutable_data<float>(framework::DDim({1, g_size}), *place);
+  for (int64_t i = 0; i < g_size; ++i) x_g_ptr[i] = 1.0;
+}
+
+const uint32_t kTableNum = 2;
+
+void GetDownpourSparseTableProto(
+    ::paddle::distributed::TableParameter* sparse_table_proto,
+    uint32_t table_id) {
+  sparse_table_proto->set_table_id(table_id);
+  sparse_table_proto->set_table_class("MemorySparseTable");
+  sparse_table_proto->set_shard_num(10);
+  ::paddle::distributed::TableAccessorParameter* accessor_config =
+      sparse_table_proto->mutable_accessor();
+
+  accessor_config->set_accessor_class("SparseAccessor");
+  accessor_config->set_fea_dim(10);
+  accessor_config->set_embedx_dim(9);
+  accessor_config->set_embedx_threshold(0);
+  accessor_config->mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_click_coeff(1);
+  accessor_config->mutable_ctr_accessor_param()->set_base_threshold(0.5);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_threshold(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_keep_days(16);
+  accessor_config->mutable_ctr_accessor_param()->set_show_click_decay_rate(
+      0.99);
+
+  accessor_config->mutable_embed_sgd_param()->set_name("SparseNaiveSGDRule");
+  auto* naive_param =
+      accessor_config->mutable_embed_sgd_param()->mutable_naive();
+  naive_param->set_learning_rate(1.0);
+  naive_param->set_initial_range(0.3);
+  naive_param->add_weight_bounds(-10.0);
+  naive_param->add_weight_bounds(10.0);
+
+  accessor_config->mutable_embedx_sgd_param()->set_name("SparseNaiveSGDRule");
+  naive_param = accessor_config->mutable_embedx_sgd_param()->mutable_naive();
+  naive_param->set_learning_rate(1.0);
+  naive_param->set_initial_range(0.3);
+  naive_param->add_weight_bounds(-10.0);
+  naive_param->add_weight_bounds(10.0);
+}
+
+::paddle::distributed::PSParameter GetServerProto() {
+  // Generate server proto desc
+  ::paddle::distributed::PSParameter server_fleet_desc;
+  ::paddle::distributed::ServerParameter* server_proto =
+      server_fleet_desc.mutable_server_param();
+  ::paddle::distributed::DownpourServerParameter* downpour_server_proto =
+      server_proto->mutable_downpour_server_param();
+  ::paddle::distributed::ServerServiceParameter* server_service_proto =
+      downpour_server_proto->mutable_service_param();
+  server_service_proto->set_service_class("BrpcPsService");
+  server_service_proto->set_server_class("BrpcPsServer");
+  server_service_proto->set_client_class("BrpcPsClient");
+  server_service_proto->set_start_server_port(0);
+  server_service_proto->set_server_thread_num(12);
+
+  for (uint32_t table_id = 0; table_id < kTableNum; ++table_id) {
+    GetDownpourSparseTableProto(
+        downpour_server_proto->add_downpour_table_param(), table_id);
+  }
+  return server_fleet_desc;
+}
+
+::paddle::distributed::PSParameter GetWorkerProto() {
+  ::paddle::distributed::PSParameter worker_fleet_desc;
+  ::paddle::distributed::WorkerParameter* worker_proto =
+      worker_fleet_desc.mutable_worker_param();
+
+  ::paddle::distributed::DownpourWorkerParameter* downpour_worker_proto =
+      worker_proto->mutable_downpour_worker_param();
+
+  for (uint32_t table_id = 0; table_id < kTableNum; ++table_id) {
+    GetDownpourSparseTableProto(
+        downpour_worker_proto->add_downpour_table_param(), table_id);
+  }
+
+  ::paddle::distributed::ServerParameter* server_proto =
+      worker_fleet_desc.mutable_server_param();
+  ::paddle::distributed::DownpourServerParameter* downpour_server_proto =
+      server_proto->mutable_downpour_server_param();
+  ::paddle::distributed::ServerServiceParameter* server_service_proto =
+      downpour_server_proto->mutable_service_param();
+  server_service_proto->set_service_class("BrpcPsService");
+  server_service_proto->set_server_class("BrpcPsServer");
+  server_service_proto->set_client_class("BrpcPsClient");
+  server_service_proto->set_start_server_port(0);
+  server_service_proto->set_server_thread_num(12);
+
+  for (uint32_t table_id = 0; table_id < kTableNum; ++table_id) {
+    GetDownpourSparseTableProto(
+        downpour_server_proto->add_downpour_table_param(), table_id);
+  }
+
+  return worker_fleet_desc;
+}
+
+/*-------------------------------------------------------------------------*/
+
+std::string ip_ = "127.0.0.1";  // NOLINT
+uint32_t port_ = 4213;
+
+std::vector<std::string> host_sign_list_;
+
+std::shared_ptr<paddle::distributed::PSServer> pserver_ptr_;
+
+std::shared_ptr<paddle::distributed::PSClient> worker_ptr_;
+
+void RunServer() {
+  ::paddle::distributed::PSParameter server_proto = GetServerProto();
+
+  auto _ps_env = paddle::distributed::PaddlePSEnvironment();
+  _ps_env.SetPsServers(&host_sign_list_, 1);
+  pserver_ptr_ = std::shared_ptr<paddle::distributed::PSServer>(
+      paddle::distributed::PSServerFactory::Create(server_proto));
+  std::vector<framework::ProgramDesc> empty_vec;
+  framework::ProgramDesc empty_prog;
+  empty_vec.push_back(empty_prog);
+  pserver_ptr_->Configure(server_proto, _ps_env, 0, empty_vec);
+  pserver_ptr_->Start(ip_, port_);
+}
+
+void RunClient(std::map<uint64_t, std::vector<paddle::distributed::Region>>&
+                   dense_regions) {
+  ::paddle::distributed::PSParameter worker_proto = GetWorkerProto();
+  paddle::distributed::PaddlePSEnvironment _ps_env;
+  auto servers_ = host_sign_list_.size();
+  _ps_env = paddle::distributed::PaddlePSEnvironment();
+  _ps_env.SetPsServers(&host_sign_list_, servers_);
+  worker_ptr_ = std::shared_ptr<paddle::distributed::PSClient>(
+      paddle::distributed::PSClientFactory::Create(worker_proto));
+  worker_ptr_->Configure(worker_proto, dense_regions, _ps_env, 0);
+}
+
+void RunBrpcPushSparseMultiTable() {
+  setenv("http_proxy", "", 1);
+  setenv("https_proxy", "", 1);
+  auto ph_host = paddle::distributed::PSHost(ip_, port_, 0);
+  host_sign_list_.push_back(ph_host.SerializeToString());
+
+  // Srart Server
+  std::thread server_thread(RunServer);
+  sleep(1);
+
+  // Start Client
+  framework::Scope client_scope;
+  platform::CPUPlace place;
+  InitTensorsOnClient(&client_scope, &place, 100);
+  std::map<uint64_t, std::vector<paddle::distributed::Region>> dense_regions;
+  dense_regions.insert(
+      std::pair<uint64_t, std::vector<paddle::distributed::Region>>(0, {}));
+  auto regions = dense_regions[0];
+  framework::Variable* var = client_scope.FindVar("x");
+  phi::DenseTensor* tensor = var->GetMutable<phi::DenseTensor>();
+
+  RunClient(dense_regions);
+  std::vector<uint64_t> fea_keys(10);
+  for (size_t idx = 0; idx < fea_keys.size(); ++idx) {
+    fea_keys[idx] = (uint64_t)idx;
+  }
+  std::vector<std::vector<float>> fea_values(kTableNum,
+                                             std::vector<float>(100));
+  std::vector<std::vector<float>> fea_temp_values(kTableNum,
+                                                  std::vector<float>(100));
+  std::vector<std::vector<float*>> fea_value_ptr(kTableNum,
+                                                 std::vector<float*>(10));
+  std::vector<std::vector<float*>> fea_temp_value_ptr(kTableNum,
+                                                      std::vector<float*>(10));
+  for (uint32_t t = 0; t < kTableNum; ++t) {
+    for (size_t idx = 0; idx < fea_keys.size(); ++idx) {
+      fea_value_ptr[t][idx] = fea_values[t].data() + idx * 10;
+      fea_temp_value_ptr[t][idx] = fea_temp_values[t].data() + idx * 10;
+    }
+  }
+
+  framework::Variable* g_var = client_scope.FindVar("x@GRAD");
+  phi::DenseTensor* g_tensor = g_var->GetMutable<phi::DenseTensor>();
+  std::vector<float*> push_g_vec;
+  for (auto i = 0; i < static_cast<int>(fea_keys.size()); ++i) {
+    push_g_vec.push_back(g_tensor->data<float>() + i * 13);
+  }
+  std::vector<paddle::distributed::SparsePushRegion> push_regions(kTableNum);
+  for (uint32_t t = 0; t < kTableNum; ++t) {
+    push_regions[t].table_id = t;
+    push_regions[t].keys = fea_keys.data();
+    push_regions[t].update_values = (const float**)push_g_vec.data();
+    push_regions[t].num = fea_keys.size();
+  }
+
+  auto push_multi_table = [&]() {
+    // One request for all the tables, since there is only one server.
+    paddle::distributed::DownpourBrpcClosure* closure =
+        new paddle::distributed::DownpourBrpcClosure(1, [](void* done) {
+          auto* closure = (paddle::distributed::DownpourBrpcClosure*)done;
+          int ret = closure->check_response(
+              0, paddle::distributed::PS_PUSH_SPARSE_MULTI_TABLE);
+          closure->set_promise_value(ret);
+        });
+    auto status =
+        worker_ptr_->PushSparseRawGradientMultiTable(push_regions, closure);
+    status.wait();
+    return status.get();
+  };
+  auto pull = [&](std::vector<std::vector<float*>>* value_ptr) {
+    for (uint32_t t = 0; t < kTableNum; ++t) {
+      auto status = worker_ptr_->PullSparse(
+          value_ptr->at(t).data(), t, fea_keys.data(), fea_keys.size(), true);
+      status.wait();
+    }
+  };
+
+  EXPECT_TRUE(worker_ptr_->SupportPushSparseMultiTable());
+  /*-----------------------Test Server Init----------------------------------*/
+  LOG(INFO) << "Run pull_sparse_param";
+  pull(&fea_value_ptr);
+
+  /*-----------------------Test Push Grad----------------------------------*/
+  // first to expand embedx, init
+  LOG(INFO) << "Run push_sparse_grad of multi table";
+  EXPECT_EQ(push_multi_table(), 0);
+  pull(&fea_value_ptr);
+
+  // push again, embedx update this time
+  EXPECT_EQ(push_multi_table(), 0);
+  pull(&fea_temp_value_ptr);
+
+  for (uint32_t t = 0; t < kTableNum; ++t) {
+    for (int64_t idx = 0; idx < tensor->numel(); ++idx) {
+      EXPECT_FLOAT_EQ(fea_temp_values[t][idx], fea_values[t][idx] - 1.0);
+    }
+  }
+
+  /*-----------------------Test Invalid Request-----------------------------*/
+  brpc::Channel channel;
+  brpc::ChannelOptions options;
+  options.protocol = "baidu_std";
+  std::string endpoint = ip_ + ":" + std::to_string(port_);
+  ASSERT_EQ(channel.Init(endpoint.c_str(), &options), 0);
+  uint32_t num = fea_keys.size();
+  uint32_t update_size =
+      worker_ptr_->GetTableAccessor(0)->GetAccessorInfo().update_size;
+  // Send {table_id, value_size} of each table with the gradients in
+  // push_g_vec, and return the err_code of the response.
+  auto push_raw =
+      [&](const std::vector<std::pair<uint32_t, uint32_t>>& tables) {
+        paddle::distributed::PsRequestMessage request;
+        paddle::distributed::PsResponseMessage response;
+        request.set_cmd_id(paddle::distributed::PS_PUSH_SPARSE_MULTI_TABLE);
+        request.set_table_id(0);
+        request.set_client_id(0);
+        std::string data;
+        for (auto& table : tables) {
+          uint32_t header[3] = {table.first, num, table.second};
+          request.add_params(reinterpret_cast<const char*>(header),
+                             sizeof(header));
+          std::string table_data(num * (sizeof(uint64_t) + table.second),
+                                 '\0');
+          memcpy(&table_data[0], fea_keys.data(), num * sizeof(uint64_t));
+          char* values = &table_data[num * sizeof(uint64_t)];
+          for (uint32_t k = 0; k < num; ++k) {
+            memcpy(values + k * table.second,
+                   push_g_vec[k],
+                   std::min(table.second, update_size));
+          }
+          data.append(table_data);
+        }
+        request.set_data(data);
+
+        brpc::Controller cntl;
+        paddle::distributed::PsService_Stub rpc_stub(&channel);
+        rpc_stub.service(&cntl, &request, &response, nullptr);
+        EXPECT_FALSE(cntl.Failed());
+        return response.err_code();
+      };
+
+  // The value_size in the header must be the update_size of the table.
+  EXPECT_NE(push_raw({{0, update_size + sizeof(float)}}), 0);
+
+  // A bad table after a valid one fails the whole request before any table
+  // is pushed, so the valid table is not updated.
+  pull(&fea_value_ptr);
+  EXPECT_NE(push_raw({{0, update_size}, {kTableNum + 100, update_size}}), 0);
+  pull(&fea_temp_value_ptr);
+  for (int64_t idx = 0; idx < tensor->numel(); ++idx) {
+    EXPECT_FLOAT_EQ(fea_temp_values[0][idx], fea_values[0][idx]);
+  }
+
+  LOG(INFO) << "Run stop_server";
+  worker_ptr_->StopServer();
+  LOG(INFO) << "Run finalize_worker";
+  worker_ptr_->FinalizeWorker();
+  server_thread.join();
+}
+
+TEST(RunBrpcPushSparseMultiTable, Run) { RunBrpcPushSparseMultiTable(); }
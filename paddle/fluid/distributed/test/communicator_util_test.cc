@@ -0,0 +1,78 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/service/communicator/communicator_util.h"
+
+#include <algorithm>
+#include <random>
+#include <unordered_set>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace distributed {
+
+TEST(FlatIdSet, SameAsUnorderedSet) {
+  std::mt19937_64 rng(0);
+  FlatIdSet flat_set;
+  std::unordered_set<int64_t> expected;
+  for (int i = 0; i < 100000; ++i) {
+    // Include -1, which is the empty slot of FlatIdSet.
+    int64_t id = static_cast<int64_t>(rng() % 20000) - 2;
+    EXPECT_EQ(flat_set.Insert(id), expected.insert(id).second);
+  }
+  EXPECT_EQ(flat_set.Size(), expected.size());
+
+  auto ids = flat_set.ToVector();
+  std::sort(ids.begin(), ids.end());
+  std::vector<int64_t> expected_ids(expected.begin(), expected.end());
+  std::sort(expected_ids.begin(), expected_ids.end());
+  EXPECT_EQ(ids, expected_ids);
+}
+
+TEST(AdaptiveMergeWindow, GrowWithBacklogAndShrinkWhenIdle) {
+  AdaptiveMergeWindow window(/*max_merge_num=*/20, /*max_wait_times=*/5);
+  EXPECT_EQ(window.MergeNum(), 20);
+  EXPECT_EQ(window.WaitTimes(), 5);
+
+  // The queue is not drained by a full window, merge more and wait at most
+  // one poll interval.
+  window.Update(20, 10, 1000);
+  EXPECT_EQ(window.MergeNum(), 40);
+  EXPECT_EQ(window.WaitTimes(), 1);
+  window.Update(40, 10, 1000);
+  window.Update(80, 10, 1000);
+  EXPECT_EQ(window.MergeNum(), 80);
+
+  // The queue is drained, wait for about the time of one RPC.
+  window.Update(30, 0, 1000);
+  EXPECT_EQ(window.MergeNum(), 40);
+  EXPECT_EQ(window.WaitTimes(), 1);
+  for (int i = 0; i < 20; ++i) {
+    window.Update(10, 0, 1000000);
+  }
+  EXPECT_EQ(window.MergeNum(), 20);
+  EXPECT_EQ(window.WaitTimes(), 5);
+
+  // Never wait if it is configured so.
+  AdaptiveMergeWindow no_wait_window(/*max_merge_num=*/20,
+                                     /*max_wait_times=*/0);
+  no_wait_window.Update(20, 10, 1000);
+  EXPECT_EQ(no_wait_window.WaitTimes(), 0);
+  no_wait_window.Update(20, 0, 1000000);
+  EXPECT_EQ(no_wait_window.WaitTimes(), 0);
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -21,6 +21,7 @@
 #include "paddle/phi/api/include/tensor.h"
 #include "paddle/phi/api/lib/utils/tensor_utils.h"
 #include "paddle/phi/core/compat/convert_utils.h"
+#include "paddle/phi/core/tensor_utils.h"
 
 namespace egr {
 
@@ -209,6 +210,13 @@ class EagerVariable final {
     if (tensor.defined()) {
       if (tensor.is_dense_tensor()) {
         ConstructVariableFromTensor<phi::DenseTensor>(tensor);
+        // The fluid kernels read and write the memory of the variables as
+        // contiguous tensors, so a strided view is passed as its contiguous
+        // copy, and the inplace ops on it write the copy.
+        auto* framework_tensor = var_.GetMutable<phi::DenseTensor>();
+        if (!framework_tensor->meta().is_contiguous()) {
+          phi::ContiguousCopy(*framework_tensor, framework_tensor);
+        }
         src_tensor_ = tensor.impl();
       } else if (tensor.is_selected_rows()) {
         ConstructVariableFromTensor<phi::SelectedRows>(tensor);
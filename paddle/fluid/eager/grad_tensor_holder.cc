@@ -19,6 +19,7 @@
 #include "paddle/fluid/framework/var_type.h"
 #include "paddle/fluid/imperative/gradient_accumulator.h"
 #include "paddle/phi/core/sparse_coo_tensor.h"
+#include "paddle/phi/core/tensor_utils.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
 
 namespace egr {
@@ -104,6 +105,19 @@ void GradTensorHolder::add(size_t slot_id,
     return;
   }  // TODO(jiabin): Remove this when we fix all kernel.
 
+  // The accumulation reads and writes the memory of the dense tensors
+  // directly, so a strided view is copied to a contiguous tensor first.
+  if (t.is_dense_tensor() &&
+      !static_cast<phi::DenseTensor*>(t.impl().get())->meta().is_contiguous()) {
+    auto contiguous_tensor = std::make_shared<phi::DenseTensor>();
+    phi::ContiguousCopy(*static_cast<phi::DenseTensor*>(t.impl().get()),
+                        contiguous_tensor.get());
+    paddle::experimental::Tensor contiguous_t(t);
+    contiguous_t.set_impl(contiguous_tensor);
+    add(slot_id, rank, contiguous_t, create_graph);
+    return;
+  }
+
   PADDLE_ENFORCE(slot_id < buffer_.size(),
                  paddle::platform::errors::Fatal(
                      "Invalid slot_id for GradTensorHolder::add() "
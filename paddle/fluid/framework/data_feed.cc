@@ -26,6 +26,7 @@ limitations under the License. */
 #include <sys/stat.h>
 #endif
 #include "io/fs.h"
+#include "paddle/fluid/platform/metrics_exporter.h"
 #include "paddle/fluid/platform/monitor.h"
 #include "paddle/fluid/platform/timer.h"
 
@@ -34,6 +35,21 @@ DECLARE_bool(enable_ins_parser_file);
 namespace paddle {
 namespace framework {
 
+// Export the number of instances (or batches for SlotRecordInMemoryDataFeed)
+// waiting to be consumed by the reader thread `thread_id`.
+static void UpdateQueueDepthMetric(const std::string& feed,
+                                   int thread_id,
+                                   size_t depth) {
+  if (!platform::IsMetricsEnabled()) {
+    return;
+  }
+  platform::MetricsRegistry::Instance()
+      .GetGauge("paddle_data_feed_queue_depth",
+                "Number of items waiting in the data feed queue.",
+                {{"feed", feed}, {"thread_id", std::to_string(thread_id)}})
+      ->Set(static_cast<double>(depth));
+}
+
 DLManager& global_dlmanager_pool() {
   static DLManager manager;
   return manager;
@@ -394,6 +410,8 @@ int InMemoryDataFeed<T>::Next() {
     VLOG(3) << "output_channel_ size=" << output_channel_->Size()
             << ", consume_channel_ size=" << consume_channel_->Size()
             << ", thread_id=" << thread_id_;
+    UpdateQueueDepthMetric(
+        "InMemoryDataFeed", thread_id_, output_channel_->Size());
     int index = 0;
     T instance;
     std::vector<T> ins_vec;
@@ -2661,6 +2679,11 @@ int SlotRecordInMemoryDataFeed::Next() {
   if (!gpu_graph_mode_) {
     VLOG(3) << "enable heter next: " << offset_index_
             << " batch_offsets: " << batch_offsets_.size();
+    UpdateQueueDepthMetric(
+        "SlotRecordInMemoryDataFeed",
+        thread_id_,
+        batch_offsets_.size() -
+            std::min<size_t>(offset_index_, batch_offsets_.size()));
     if (offset_index_ >= batch_offsets_.size()) {
       VLOG(3) << "offset_index: " << offset_index_
               << " batch_offsets: " << batch_offsets_.size();
@@ -0,0 +1,485 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/indexed_combine_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <sstream>
+#include <utility>
+
+#include "paddle/fluid/framework/convert_utils.h"
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/framework/version.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+constexpr uint32_t kTensorKind = 0;
+constexpr uint32_t kBlobKind = 1;
+// The data are written and read in chunks, by at most kMaxIOTasks tasks of
+// the IO thread pool.
+constexpr uint64_t kChunkSize = 64UL << 20;
+constexpr size_t kMaxIOTasks = 16;
+
+struct IOChunk {
+  char *data;
+  uint64_t offset;
+  uint64_t size;
+};
+
+uint64_t AlignUp(uint64_t offset) {
+  return (offset + kIndexedCombineFileAlignment - 1) /
+         kIndexedCombineFileAlignment * kIndexedCombineFileAlignment;
+}
+
+void AppendChunks(char *data,
+                  uint64_t offset,
+                  uint64_t size,
+                  std::vector<IOChunk> *chunks) {
+  for (uint64_t begin = 0; begin < size; begin += kChunkSize) {
+    chunks->push_back(
+        {data + begin, offset + begin, std::min(kChunkSize, size - begin)});
+  }
+}
+
+// Runs `fn` on the chunks in the tasks of the IO thread pool, each of which
+// gets the chunks at the same stride.
+void RunChunks(const std::vector<IOChunk> &chunks,
+               const std::function<void(const std::vector<IOChunk> &)> &fn) {
+  size_t num_tasks = std::min(chunks.size(), kMaxIOTasks);
+  if (num_tasks <= 1) {
+    fn(chunks);
+    return;
+  }
+  std::vector<std::future<void>> futures;
+  for (size_t i = 0; i < num_tasks; ++i) {
+    std::vector<IOChunk> task_chunks;
+    for (size_t j = i; j < chunks.size(); j += num_tasks) {
+      task_chunks.push_back(chunks[j]);
+    }
+    futures.push_back(
+        phi::AsyncIO([&fn, task_chunks]() { fn(task_chunks); }));
+  }
+  // Wait for all the tasks before any error is thrown, since they refer to
+  // the data of the caller.
+  for (auto &future : futures) {
+    future.wait();
+  }
+  for (auto &future : futures) {
+    future.get();
+  }
+}
+
+template <typename T>
+void WritePOD(std::ostream &os, const T &value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void WriteString(std::ostream &os, const std::string &value) {
+  WritePOD<uint64_t>(os, value.size());
+  os.write(value.data(), value.size());
+}
+
+// Checks a size read from the stream against the bytes left in it, before
+// anything of that size is allocated.
+void CheckReadSize(std::istream &is, uint64_t size) {
+  auto pos = is.tellg();
+  is.seekg(0, std::ios::end);
+  auto end = is.tellg();
+  is.seekg(pos);
+  PADDLE_ENFORCE_EQ(
+      is.good() && size <= static_cast<uint64_t>(end - pos),
+      true,
+      platform::errors::Unavailable(
+          "The size %d read from the combined file exceeds the file, please "
+          "check whether the file is complete or damaged.",
+          size));
+}
+
+template <typename T>
+T ReadPOD(std::istream &is) {
+  T value;
+  is.read(reinterpret_cast<char *>(&value), sizeof(T));
+  PADDLE_ENFORCE_EQ(is.good(),
+                    true,
+                    platform::errors::Unavailable(
+                        "Cannot read the index of the combined file, please "
+                        "check whether the file is complete or damaged."));
+  return value;
+}
+
+std::string ReadString(std::istream &is) {
+  uint64_t size = ReadPOD<uint64_t>(is);
+  CheckReadSize(is, size);
+  std::string value(size, '\0');
+  is.read(&value[0], value.size());
+  PADDLE_ENFORCE_EQ(is.good(),
+                    true,
+                    platform::errors::Unavailable(
+                        "Cannot read the index of the combined file, please "
+                        "check whether the file is complete or damaged."));
+  return value;
+}
+
+// The bytes written by SerializeToStream before the data of the tensor.
+std::string SerializeTensorMeta(const phi::DenseTensor &tensor) {
+  std::ostringstream os;
+  WritePOD(os, kCurTensorVersion);
+  const auto &lod = tensor.lod();
+  WritePOD<uint64_t>(os, lod.size());
+  for (const auto &level : lod) {
+    WritePOD<uint64_t>(os, level.size() * sizeof(size_t));
+    os.write(reinterpret_cast<const char *>(level.data()),
+             level.size() * sizeof(size_t));
+  }
+  // The version of TensorToStream.
+  WritePOD<uint32_t>(os, 0);
+  proto::VarType::TensorDesc desc;
+  desc.set_data_type(TransToProtoVarType(tensor.dtype()));
+  auto dims = phi::vectorize(tensor.dims());
+  auto *pb_dims = desc.mutable_dims();
+  pb_dims->Resize(static_cast<int>(dims.size()), 0);
+  std::copy(dims.begin(), dims.end(), pb_dims->begin());
+  std::string desc_data = desc.SerializeAsString();
+  WritePOD<int32_t>(os, desc_data.size());
+  os << desc_data;
+  return os.str();
+}
+
+// Resizes the tensor by the meta, and allocates it on CPU.
+void DeserializeTensorMeta(const std::string &meta, phi::DenseTensor *tensor) {
+  std::istringstream is(meta);
+  uint32_t version = ReadPOD<uint32_t>(is);
+  PADDLE_ENFORCE_EQ(
+      IsTensorVersionSupported(version),
+      true,
+      platform::errors::InvalidArgument("Tensor version %u is not supported.",
+                                        version));
+  auto &lod = *tensor->mutable_lod();
+  uint64_t lod_level = ReadPOD<uint64_t>(is);
+  // Each level takes at least the bytes of its size, so there are no more
+  // levels than the bytes left.
+  CheckReadSize(is, lod_level);
+  lod.resize(lod_level);
+  for (auto &level : lod) {
+    uint64_t level_size = ReadPOD<uint64_t>(is);
+    CheckReadSize(is, level_size);
+    level.resize(level_size / sizeof(size_t));
+    is.read(reinterpret_cast<char *>(level.data()),
+            level.size() * sizeof(size_t));
+  }
+  PADDLE_ENFORCE_EQ(ReadPOD<uint32_t>(is),
+                    0U,
+                    platform::errors::InvalidArgument(
+                        "Only version 0 of the tensor is supported."));
+  int32_t desc_size = ReadPOD<int32_t>(is);
+  PADDLE_ENFORCE_GE(desc_size,
+                    0,
+                    platform::errors::Unavailable(
+                        "The size of the tensor desc is negative, please "
+                        "check whether the file is complete or damaged."));
+  CheckReadSize(is, desc_size);
+  std::string desc_data(desc_size, '\0');
+  is.read(&desc_data[0], desc_data.size());
+  proto::VarType::TensorDesc desc;
+  PADDLE_ENFORCE_EQ(
+      is.good() && desc.ParseFromString(desc_data),
+      true,
+      platform::errors::InvalidArgument("Cannot parse tensor desc"));
+  std::vector<int64_t> dims(desc.dims().begin(), desc.dims().end());
+  tensor->Resize(phi::make_ddim(dims));
+  tensor->mutable_data(platform::CPUPlace(),
+                       TransToPhiDataType(desc.data_type()));
+}
+
+}  // namespace
+
+bool IsIndexedCombineFile(const std::string &file_path) {
+  std::ifstream fin(file_path, std::ios::binary);
+  char head[kIndexedCombineFileMagicSize];
+  fin.read(head, sizeof(head));
+  return fin.good() && IsIndexedCombineFile(head, sizeof(head));
+}
+
+bool IsIndexedCombineFile(const char *head, size_t size) {
+  return size >= kIndexedCombineFileMagicSize &&
+         std::memcmp(
+             head, kIndexedCombineFileMagic, kIndexedCombineFileMagicSize) ==
+             0;
+}
+
+void IndexedCombineFileWriter::AddTensor(const std::string &name,
+                                         const phi::DenseTensor &tensor) {
+  PADDLE_ENFORCE_EQ(
+      platform::is_cpu_place(tensor.place()),
+      true,
+      platform::errors::InvalidArgument(
+          "The tensor %s written to the indexed combined file should be on "
+          "CPU.",
+          name));
+  uint64_t size = tensor.numel() * phi::SizeOf(tensor.dtype());
+  entries_.push_back({kTensorKind,
+                      name,
+                      SerializeTensorMeta(tensor),
+                      size > 0 ? tensor.data() : nullptr,
+                      size});
+}
+
+void IndexedCombineFileWriter::AddBlob(const std::string &name,
+                                       std::string blob) {
+  blobs_.emplace_back(new std::string(std::move(blob)));
+  entries_.push_back(
+      {kBlobKind, name, "", blobs_.back()->data(), blobs_.back()->size()});
+}
+
+void IndexedCombineFileWriter::Write(const std::string &file_path) const {
+  uint64_t index_size = sizeof(uint64_t);
+  for (const auto &entry : entries_) {
+    index_size += sizeof(uint32_t) + 4 * sizeof(uint64_t) +
+                  entry.name.size() + entry.meta.size();
+  }
+  uint64_t file_size = AlignUp(kIndexedCombineFileMagicSize +
+                               sizeof(uint64_t) + index_size);
+  std::ostringstream header;
+  header.write(kIndexedCombineFileMagic, kIndexedCombineFileMagicSize);
+  WritePOD(header, index_size);
+  WritePOD<uint64_t>(header, entries_.size());
+  std::vector<IOChunk> chunks;
+  for (const auto &entry : entries_) {
+    uint64_t offset = AlignUp(file_size);
+    WritePOD(header, entry.kind);
+    WriteString(header, entry.name);
+    WriteString(header, entry.meta);
+    WritePOD(header, offset);
+    WritePOD(header, entry.size);
+    AppendChunks(const_cast<char *>(static_cast<const char *>(entry.data)),
+                 offset,
+                 entry.size,
+                 &chunks);
+    file_size = offset + entry.size;
+  }
+
+  {
+    std::ofstream fout(file_path, std::ios::binary | std::ios::trunc);
+    PADDLE_ENFORCE_EQ(static_cast<bool>(fout),
+                      true,
+                      platform::errors::Unavailable(
+                          "Cannot open %s to save variables.", file_path));
+    fout << header.str();
+    // Extend the file, so that the tasks write the data in place.
+    if (file_size > header.str().size()) {
+      fout.seekp(file_size - 1);
+      fout.put('\0');
+    }
+    PADDLE_ENFORCE_EQ(fout.good(),
+                      true,
+                      platform::errors::Unavailable(
+                          "Cannot write the variables to %s.", file_path));
+  }
+
+  RunChunks(chunks, [&file_path](const std::vector<IOChunk> &task_chunks) {
+    std::fstream fout(file_path,
+                      std::ios::in | std::ios::out | std::ios::binary);
+    for (const auto &chunk : task_chunks) {
+      fout.seekp(chunk.offset);
+      fout.write(chunk.data, chunk.size);
+    }
+    fout.flush();
+    PADDLE_ENFORCE_EQ(fout.good(),
+                      true,
+                      platform::errors::Unavailable(
+                          "Cannot write the variables to %s.", file_path));
+  });
+}
+
+IndexedCombineFileReader::IndexedCombineFileReader(
+    const std::string &file_path, const std::string *buffer)
+    : file_path_(file_path), buffer_(buffer) {
+  std::string index;
+  if (buffer_ != nullptr) {
+    PADDLE_ENFORCE_EQ(
+        IsIndexedCombineFile(buffer_->data(), buffer_->size()) &&
+            buffer_->size() >= kIndexedCombineFileMagicSize + sizeof(uint64_t),
+        true,
+        platform::errors::InvalidArgument(
+            "The buffer is not an indexed combined file."));
+    uint64_t index_size;
+    std::memcpy(&index_size,
+                buffer_->data() + kIndexedCombineFileMagicSize,
+                sizeof(index_size));
+    PADDLE_ENFORCE_LE(
+        index_size,
+        buffer_->size() - kIndexedCombineFileMagicSize - sizeof(uint64_t),
+        platform::errors::Unavailable(
+            "The combined file in the buffer is incomplete or damaged."));
+    index = buffer_->substr(kIndexedCombineFileMagicSize + sizeof(uint64_t),
+                            index_size);
+  } else {
+    std::ifstream fin(file_path_, std::ios::binary);
+    char head[kIndexedCombineFileMagicSize];
+    fin.read(head, sizeof(head));
+    PADDLE_ENFORCE_EQ(fin.good() && IsIndexedCombineFile(head, sizeof(head)),
+                      true,
+                      platform::errors::InvalidArgument(
+                          "%s is not an indexed combined file.", file_path_));
+    uint64_t index_size = ReadPOD<uint64_t>(fin);
+    CheckReadSize(fin, index_size);
+    index.resize(index_size);
+    fin.read(&index[0], index.size());
+    PADDLE_ENFORCE_EQ(
+        fin.good(),
+        true,
+        platform::errors::Unavailable(
+            "Cannot read the index of %s, please check whether the file is "
+            "complete or damaged.",
+            file_path_));
+  }
+
+  std::istringstream is(index);
+  uint64_t num_entries = ReadPOD<uint64_t>(is);
+  for (uint64_t i = 0; i < num_entries; ++i) {
+    Entry entry;
+    entry.kind = ReadPOD<uint32_t>(is);
+    std::string name = ReadString(is);
+    entry.meta = ReadString(is);
+    entry.offset = ReadPOD<uint64_t>(is);
+    entry.size = ReadPOD<uint64_t>(is);
+    if (buffer_ != nullptr) {
+      PADDLE_ENFORCE_EQ(
+          entry.size <= buffer_->size() &&
+              entry.offset <= buffer_->size() - entry.size,
+          true,
+          platform::errors::Unavailable(
+              "The combined file in the buffer is incomplete or damaged."));
+    }
+    PADDLE_ENFORCE_EQ(
+        entries_.count(name),
+        0UL,
+        platform::errors::Unavailable(
+            "The variable %s appears more than once in the combined file, "
+            "please check whether the file is damaged.",
+            name));
+    names_.push_back(name);
+    entries_[name] = std::move(entry);
+  }
+}
+
+bool IndexedCombineFileReader::Has(const std::string &name) const {
+  return entries_.count(name) > 0;
+}
+
+bool IndexedCombineFileReader::IsTensor(const std::string &name) const {
+  return GetEntry(name).kind == kTensorKind;
+}
+
+const IndexedCombineFileReader::Entry &IndexedCombineFileReader::GetEntry(
+    const std::string &name) const {
+  auto it = entries_.find(name);
+  PADDLE_ENFORCE_NE(it,
+                    entries_.end(),
+                    platform::errors::NotFound(
+                        "The variable %s is not in the combined file.", name));
+  return it->second;
+}
+
+void IndexedCombineFileReader::ReadTensors(
+    const std::vector<std::string> &names,
+    const std::vector<phi::DenseTensor *> &tensors) const {
+  PADDLE_ENFORCE_EQ(names.size(),
+                    tensors.size(),
+                    platform::errors::InvalidArgument(
+                        "The number of the names (%d) and the tensors (%d) "
+                        "to read should be the same.",
+                        names.size(),
+                        tensors.size()));
+  std::vector<IOChunk> chunks;
+  for (size_t i = 0; i < names.size(); ++i) {
+    const auto &entry = GetEntry(names[i]);
+    PADDLE_ENFORCE_EQ(entry.kind,
+                      kTensorKind,
+                      platform::errors::InvalidArgument(
+                          "The variable %s is not a tensor.", names[i]));
+    DeserializeTensorMeta(entry.meta, tensors[i]);
+    PADDLE_ENFORCE_EQ(
+        tensors[i]->numel() * phi::SizeOf(tensors[i]->dtype()),
+        entry.size,
+        platform::errors::Unavailable(
+            "The size of the tensor %s does not match its data, please check "
+            "whether the file is complete or damaged.",
+            names[i]));
+    if (entry.size > 0) {
+      AppendChunks(static_cast<char *>(tensors[i]->data()),
+                   entry.offset,
+                   entry.size,
+                   &chunks);
+    }
+  }
+
+  RunChunks(chunks, [this](const std::vector<IOChunk> &task_chunks) {
+    if (buffer_ != nullptr) {
+      for (const auto &chunk : task_chunks) {
+        std::memcpy(chunk.data, buffer_->data() + chunk.offset, chunk.size);
+      }
+      return;
+    }
+    std::ifstream fin(file_path_, std::ios::binary);
+    for (const auto &chunk : task_chunks) {
+      fin.seekg(chunk.offset);
+      fin.read(chunk.data, chunk.size);
+    }
+    PADDLE_ENFORCE_EQ(
+        fin.good(),
+        true,
+        platform::errors::Unavailable(
+            "Cannot read the variables from %s, please check whether the file "
+            "is complete or damaged.",
+            file_path_));
+  });
+}
+
+std::string IndexedCombineFileReader::ReadBlob(const std::string &name) const {
+  const auto &entry = GetEntry(name);
+  PADDLE_ENFORCE_EQ(entry.kind,
+                    kBlobKind,
+                    platform::errors::InvalidArgument(
+                        "The variable %s is a tensor.", name));
+  if (buffer_ != nullptr) {
+    return buffer_->substr(entry.offset, entry.size);
+  }
+  std::string blob(entry.size, '\0');
+  std::ifstream fin(file_path_, std::ios::binary);
+  fin.seekg(entry.offset);
+  fin.read(&blob[0], blob.size());
+  PADDLE_ENFORCE_EQ(
+      fin.good(),
+      true,
+      platform::errors::Unavailable(
+          "Cannot read the variable %s from %s, please check whether the file "
+          "is complete or damaged.",
+          name,
+          file_path_));
+  return blob;
+}
+
+}  // namespace framework
+}  // namespace paddle
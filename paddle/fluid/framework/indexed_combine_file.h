@@ -0,0 +1,121 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * The file of save_combine with an index of the variables, whose data are
+ * written and read in parallel, and can be read without reading the others.
+ *
+ *   char[8]   magic, kIndexedCombineFileMagic
+ *   uint64_t  the size of the index
+ *   index:
+ *     uint64_t  the number of the variables, and for each of them
+ *     uint32_t  kind, 0 for DenseTensor and 1 for blob
+ *     uint64_t  the size of the name, and the name
+ *     uint64_t  the size of the meta, and the meta, which is the LoD and
+ *               the TensorDesc written by SerializeToStream for DenseTensor,
+ *               and is empty for blob
+ *     uint64_t  the offset and the size of the data
+ *   the data of the variables, at the offsets aligned to
+ *   kIndexedCombineFileAlignment.
+ *
+ * The file in the stream format of SerializeToStream starts with the version
+ * 0 of DenseTensor or the size of a string map, so it is not mistaken for
+ * the indexed file.
+ */
+constexpr char kIndexedCombineFileMagic[] = "PDCOMBIX";
+constexpr size_t kIndexedCombineFileMagicSize = 8;
+constexpr size_t kIndexedCombineFileAlignment = 4096;
+
+// Whether the file, or its first bytes in memory, is an indexed file.
+bool IsIndexedCombineFile(const std::string &file_path);
+bool IsIndexedCombineFile(const char *head, size_t size);
+
+class IndexedCombineFileWriter {
+ public:
+  // Adds a CPU tensor, which is not copied and must outlive Write.
+  void AddTensor(const std::string &name, const phi::DenseTensor &tensor);
+
+  // Adds the bytes of a variable of other type, such as a Vocab written by
+  // StringMapToStream.
+  void AddBlob(const std::string &name, std::string blob);
+
+  // Writes the variables in the order they are added. The data are written
+  // in parallel in chunks.
+  void Write(const std::string &file_path) const;
+
+ private:
+  struct Entry {
+    uint32_t kind;
+    std::string name;
+    std::string meta;
+    const void *data;
+    uint64_t size;
+  };
+
+  std::vector<Entry> entries_;
+  std::vector<std::unique_ptr<std::string>> blobs_;
+};
+
+class IndexedCombineFileReader {
+ public:
+  // Reads the index of the file, or of the file in `buffer` if it is not
+  // nullptr, which must outlive the reader.
+  explicit IndexedCombineFileReader(const std::string &file_path,
+                                    const std::string *buffer = nullptr);
+
+  // The names of the variables in the order they are written.
+  const std::vector<std::string> &Names() const { return names_; }
+
+  bool Has(const std::string &name) const;
+
+  bool IsTensor(const std::string &name) const;
+
+  // Reads the tensors of `names` to CPU in parallel in chunks, without
+  // reading the other variables.
+  void ReadTensors(const std::vector<std::string> &names,
+                   const std::vector<phi::DenseTensor *> &tensors) const;
+
+  std::string ReadBlob(const std::string &name) const;
+
+ private:
+  struct Entry {
+    uint32_t kind;
+    std::string meta;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  const Entry &GetEntry(const std::string &name) const;
+
+  std::string file_path_;
+  const std::string *buffer_;
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, Entry> entries_;
+};
+
+}  // namespace framework
+}  // namespace paddle
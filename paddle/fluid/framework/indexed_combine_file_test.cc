@@ -0,0 +1,181 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/indexed_combine_file.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(IndexedCombineFile, write_and_read) {
+  const std::string file_path = "indexed_combine_file_test.pdparams";
+  phi::DenseTensor x, y, empty;
+  x.Resize({3, 4});
+  float* x_data = x.mutable_data<float>(platform::CPUPlace());
+  for (int i = 0; i < 12; ++i) {
+    x_data[i] = i * 0.5f;
+  }
+  x.set_lod({{0, 1, 3}});
+  // Larger than a chunk, so that it is written by several tasks.
+  y.Resize({(64 << 20) / 8 + 3});
+  int64_t* y_data = y.mutable_data<int64_t>(platform::CPUPlace());
+  for (int64_t i = 0; i < y.numel(); ++i) {
+    y_data[i] = i;
+  }
+  empty.Resize({0, 2});
+  empty.mutable_data<int>(platform::CPUPlace());
+
+  IndexedCombineFileWriter writer;
+  writer.AddTensor("x", x);
+  writer.AddBlob("vocab", "some bytes");
+  writer.AddTensor("y", y);
+  writer.AddTensor("empty", empty);
+  writer.Write(file_path);
+  ASSERT_TRUE(IsIndexedCombineFile(file_path));
+
+  std::ifstream fin(file_path, std::ios::binary);
+  std::ostringstream ss;
+  ss << fin.rdbuf();
+  const std::string buffer = ss.str();
+  IndexedCombineFileReader file_reader(file_path);
+  IndexedCombineFileReader buffer_reader("", &buffer);
+  for (const auto* reader : {&file_reader, &buffer_reader}) {
+    EXPECT_EQ(reader->Names(),
+              std::vector<std::string>({"x", "vocab", "y", "empty"}));
+    EXPECT_TRUE(reader->IsTensor("x"));
+    EXPECT_FALSE(reader->IsTensor("vocab"));
+    EXPECT_FALSE(reader->Has("z"));
+    EXPECT_EQ(reader->ReadBlob("vocab"), "some bytes");
+
+    // Read a part of the variables in another order.
+    phi::DenseTensor out_x, out_empty;
+    reader->ReadTensors({"empty", "x"}, {&out_empty, &out_x});
+    EXPECT_EQ(out_x.dims(), x.dims());
+    EXPECT_EQ(out_x.lod(), x.lod());
+    for (int i = 0; i < 12; ++i) {
+      EXPECT_EQ(out_x.data<float>()[i], x_data[i]);
+    }
+    EXPECT_EQ(out_empty.dims(), empty.dims());
+    EXPECT_EQ(out_empty.dtype(), phi::DataType::INT32);
+
+    phi::DenseTensor out_y;
+    reader->ReadTensors({"y"}, {&out_y});
+    ASSERT_EQ(out_y.numel(), y.numel());
+    for (int64_t i = 0; i < y.numel(); ++i) {
+      ASSERT_EQ(out_y.data<int64_t>()[i], i);
+    }
+  }
+  std::remove(file_path.c_str());
+}
+
+TEST(IndexedCombineFile, damaged) {
+  phi::DenseTensor x;
+  x.Resize({2, 3});
+  x.mutable_data<float>(platform::CPUPlace());
+  auto write = [&x](int num) {
+    const std::string file_path = "indexed_combine_file_damaged.pdparams";
+    IndexedCombineFileWriter writer;
+    for (int i = 0; i < num; ++i) {
+      writer.AddTensor("x", x);
+    }
+    writer.Write(file_path);
+    std::ifstream fin(file_path, std::ios::binary);
+    std::ostringstream ss;
+    ss << fin.rdbuf();
+    std::remove(file_path.c_str());
+    return ss.str();
+  };
+  auto read_file = [](const std::string& buffer) {
+    const std::string file_path = "indexed_combine_file_damaged.pdparams";
+    {
+      std::ofstream fout(file_path, std::ios::binary);
+      fout << buffer;
+    }
+    phi::DenseTensor out;
+    try {
+      IndexedCombineFileReader reader(file_path);
+      reader.ReadTensors({"x"}, {&out});
+    } catch (...) {
+      std::remove(file_path.c_str());
+      throw;
+    }
+    std::remove(file_path.c_str());
+  };
+  auto read_buffer = [](const std::string& buffer) {
+    phi::DenseTensor out;
+    IndexedCombineFileReader reader("", &buffer);
+    reader.ReadTensors({"x"}, {&out});
+  };
+  auto set = [](std::string* buffer, size_t pos, auto value) {
+    std::memcpy(&(*buffer)[pos], &value, sizeof(value));
+  };
+
+  const std::string origin = write(1);
+  read_file(origin);
+  read_buffer(origin);
+  // The index is: the index size, the number of entries, and the kind, the
+  // name, the meta, the offset and the size of each entry.
+  const size_t index_size_pos = kIndexedCombineFileMagicSize;
+  const size_t meta_pos = index_size_pos + 3 * sizeof(uint64_t) +
+                          sizeof(uint32_t) + 1 + sizeof(uint64_t);
+  uint64_t meta_size;
+  std::memcpy(
+      &meta_size, &origin[meta_pos - sizeof(uint64_t)], sizeof(meta_size));
+  const size_t offset_pos = meta_pos + meta_size;
+  // The tensor desc follows the version, the lod level of 0 and the version
+  // of the tensor.
+  const size_t desc_size_pos =
+      meta_pos + 2 * sizeof(uint32_t) + sizeof(uint64_t);
+
+  std::string damaged = origin;
+  set(&damaged, index_size_pos, uint64_t(1) << 60);
+  EXPECT_THROW(read_file(damaged), platform::EnforceNotMet);
+  EXPECT_THROW(read_buffer(damaged), platform::EnforceNotMet);
+
+  damaged = origin;
+  set(&damaged, desc_size_pos, int32_t(-1));
+  EXPECT_THROW(read_file(damaged), platform::EnforceNotMet);
+  EXPECT_THROW(read_buffer(damaged), platform::EnforceNotMet);
+
+  // The offset overflows with the size added.
+  damaged = origin;
+  set(&damaged, offset_pos, ~uint64_t(0));
+  EXPECT_THROW(read_buffer(damaged), platform::EnforceNotMet);
+
+  // The same name is written twice.
+  const std::string duplicated = write(2);
+  EXPECT_THROW(read_file(duplicated), platform::EnforceNotMet);
+  EXPECT_THROW(read_buffer(duplicated), platform::EnforceNotMet);
+}
+
+TEST(IndexedCombineFile, stream_format_is_not_indexed) {
+  phi::DenseTensor x;
+  x.Resize({2});
+  x.mutable_data<float>(platform::CPUPlace());
+  std::ostringstream ss;
+  SerializeToStream(ss, x);
+  const std::string data = ss.str();
+  EXPECT_FALSE(IsIndexedCombineFile(data.data(), data.size()));
+}
+
+}  // namespace framework
+}  // namespace paddle
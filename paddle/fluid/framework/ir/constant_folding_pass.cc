@@ -13,7 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/ir/constant_folding_pass.h"
+#include <cstring>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "glog/logging.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
@@ -22,6 +25,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/op_version_registry.h"
 #include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/string/pretty_log.h"
 
 #include "paddle/fluid/framework/convert_utils.h"
 
@@ -35,8 +39,11 @@ class Node;
 
 /*
  * When a op's inputs and outputs is determined before feeding data to the
- * model, we can remove this op from the model. This ConstantFolding pass can
- * remove all these like ops.
+ * model, we can remove this op from the model. This ConstantFolding pass
+ * runs all these like ops on CPU once, in the topological order, so that the
+ * chains of them are folded as a whole. Only the outputs used by the rest of
+ * the graph are kept as new persistable vars, the identical ones of which are
+ * merged, and the persistable inputs used only by the folded ops are removed.
  *
  */
 
@@ -51,6 +58,50 @@ struct ConstantFolding : public PatternBase {
 };
 }  // namespace patterns
 
+namespace {
+
+// The ops which have side effects, or whose outputs are not determined by
+// their inputs.
+const std::unordered_set<std::string> &UnfoldableOps() {
+  static const std::unordered_set<std::string> ops{"feed",
+                                                   "fetch",
+                                                   "save",
+                                                   "save_combine",
+                                                   "load",
+                                                   "load_combine",
+                                                   "print",
+                                                   "uniform_random",
+                                                   "gaussian_random",
+                                                   "truncated_gaussian_random",
+                                                   "randint",
+                                                   "randperm",
+                                                   "bernoulli",
+                                                   "multinomial",
+                                                   "sampling_id",
+                                                   "dropout",
+                                                   "share_data"};
+  return ops;
+}
+
+bool IsDenseTensorVar(const Node *node) {
+  return node->IsVar() && node->Var() != nullptr &&
+         node->Var()->GetType() == proto::VarType::LOD_TENSOR;
+}
+
+size_t NumBytes(const phi::DenseTensor &tensor) {
+  return tensor.numel() * phi::SizeOf(tensor.dtype());
+}
+
+bool SameTensor(const phi::DenseTensor &a, const phi::DenseTensor &b) {
+  if (a.dtype() != b.dtype() || a.dims() != b.dims() || a.lod() != b.lod()) {
+    return false;
+  }
+  size_t size = NumBytes(a);
+  return size == 0 || std::memcmp(a.data(), b.data(), size) == 0;
+}
+
+}  // namespace
+
 ConstantFoldingPass::ConstantFoldingPass() {}
 
 void ConstantFoldingPass::ApplyImpl(ir::Graph *graph) const {
@@ -64,92 +115,159 @@ void ConstantFoldingPass::ApplyImpl(ir::Graph *graph) const {
       platform::errors::Fatal(
           "scope must not be null when applying constant floding."));
 
-  std::vector<std::string> blacklist{"feed"};
+  // The var names occurring more than once in the graph are written by some
+  // ops in place, so they are not folded.
+  std::unordered_map<std::string, int> name_count;
+  for (auto *node : graph->Nodes()) {
+    if (node->IsVar()) {
+      name_count[node->Name()]++;
+    }
+  }
+  auto is_unique = [&name_count](const Node *node) {
+    return name_count[node->Name()] == 1;
+  };
+  // The persistable vars written by no op are constants.
+  auto is_weight = [&](const Node *node) {
+    return IsDenseTensorVar(node) && node->Var()->Persistable() &&
+           node->inputs.empty() && is_unique(node) &&
+           scope->FindVar(node->Name()) != nullptr;
+  };
 
+  // Run the foldable ops in the topological order in a local scope, so that
+  // the vars produced and consumed by them never reach the param scope.
+  Scope local_scope;
+  std::unordered_set<const Node *> folded_ops;
+  std::unordered_set<const Node *> folded_vars;
   auto op_node_sorted = framework::ir::TopologyVarientSort(
       *graph, static_cast<framework::ir::SortKind>(0));
   for (auto *op_node : op_node_sorted) {
-    if (!op_node->IsOp()) continue;
-    if (std::find(blacklist.begin(), blacklist.end(), op_node->Name()) !=
-        blacklist.end())
+    if (!op_node->IsOp() || op_node->Op() == nullptr) continue;
+    auto *op_desc = op_node->Op();
+    if (UnfoldableOps().count(op_desc->Type()) ||
+        op_desc->HasAttr("sub_block") || op_desc->HasAttr("sub_blocks") ||
+        op_node->outputs.empty()) {
       continue;
+    }
+    bool foldable = true;
+    for (auto *in_node : op_node->inputs) {
+      foldable = foldable && (folded_vars.count(in_node) || is_weight(in_node));
+    }
+    for (auto *out_node : op_node->outputs) {
+      foldable = foldable && IsDenseTensorVar(out_node) &&
+                 is_unique(out_node) && !out_node->Var()->Persistable();
+    }
+    if (!foldable) continue;
 
-    bool input_persis = true;
-    // map is used to record how many time a name string occures in the whole
-    // graph's nodes
-    std::unordered_map<std::string, int> map;
-    for (auto in_node : op_node->inputs) {
-      map[in_node->Name()] = 0;
-      if (!in_node->Var()->Persistable()) {
-        input_persis = false;
+    for (auto *in_node : op_node->inputs) {
+      if (local_scope.FindLocalVar(in_node->Name()) == nullptr) {
+        *local_scope.Var(in_node->Name())->GetMutable<phi::DenseTensor>() =
+            scope->FindVar(in_node->Name())->Get<phi::DenseTensor>();
       }
     }
-    for (auto out_node : op_node->outputs) {
-      map[out_node->Name()] = 0;
+    for (auto *out_node : op_node->outputs) {
+      local_scope.Var(out_node->Name())->GetMutable<phi::DenseTensor>();
     }
-    // Forbid other node in graph having the same name with nodes in map
-    for (auto iter : map) {
-      for (auto node : graph->Nodes()) {
-        if (node->IsVar() && node->Name() == iter.first) {
-          map[node->Name()]++;
-          if (map[node->Name()] > 1) {
-            input_persis = false;
-          }
-        }
-      }
+    try {
+      auto op = paddle::framework::OpRegistry::CreateOp(*op_desc);
+      op->Run(local_scope, platform::CPUPlace());
+    } catch (const std::exception &e) {
+      VLOG(3) << "Failed to fold the op " << op_desc->Type() << ": "
+              << e.what();
+      continue;
+    }
+    folded_ops.insert(op_node);
+    for (auto *out_node : op_node->outputs) {
+      folded_vars.insert(out_node);
     }
+  }
 
-    framework::Scope *local_scope = new framework::Scope();
-    std::unordered_set<const paddle::framework::ir::Node *> remove_nodes;
-    std::unique_ptr<OperatorBase> op;
-
-    if (input_persis) {
-      for (auto in_node : op_node->inputs) {
-        local_scope->Var(in_node->Var()->Name());
-        local_scope->FindVar(in_node->Var()->Name())
-            ->GetMutable<phi::DenseTensor>();
-        // This persistable input node is exclusive, and can be removed
-        if (in_node->outputs.size() == 1L) remove_nodes.emplace(in_node);
-
-        auto in_shape = in_node->Var()->GetShape();
-        auto *global_persis_x_tensor =
-            scope->FindVar(in_node->Name())->GetMutable<phi::DenseTensor>();
-        auto *local_x_tensor = local_scope->FindVar(in_node->Name())
-                                   ->GetMutable<phi::DenseTensor>();
-        local_x_tensor->Resize(global_persis_x_tensor->dims());
-        *local_x_tensor = *global_persis_x_tensor;
+  // The folded vars used by the rest of the graph become persistable, and
+  // the identical ones are merged into the first of them.
+  std::unordered_set<const paddle::framework::ir::Node *> remove_nodes;
+  std::unordered_map<size_t, std::vector<Node *>> constants;
+  int num_constants = 0;
+  int num_merged = 0;
+  size_t folded_bytes = 0;
+  size_t removed_bytes = 0;
+  for (auto *op_node : op_node_sorted) {
+    if (!folded_ops.count(op_node)) continue;
+    remove_nodes.emplace(op_node);
+    for (auto *out_node : op_node->outputs) {
+      bool used = false;
+      for (auto *next_op : out_node->outputs) {
+        used = used || !folded_ops.count(next_op);
       }
-
-      op = paddle::framework::OpRegistry::CreateOp(*op_node->Op());
-      remove_nodes.emplace(op_node);
-      for (auto out_node : op_node->outputs) {
-        local_scope->Var(out_node->Var()->Name());
-        local_scope->FindVar(out_node->Var()->Name())
-            ->GetMutable<phi::DenseTensor>();
-        // useless out_node can be removed, not need set it persistable !
-        if (out_node->outputs.size() == 0L) remove_nodes.emplace(out_node);
+      if (!used) {
+        remove_nodes.emplace(out_node);
+        continue;
+      }
+      const auto &tensor = local_scope.FindVar(out_node->Name())
+                               ->Get<phi::DenseTensor>();
+      size_t size = NumBytes(tensor);
+      // Hash the size and the leading bytes, and compare the whole tensors
+      // of the same hash.
+      size_t hash = size;
+      if (size > 0) {
+        hash ^= std::hash<std::string>()(std::string(
+            static_cast<const char *>(tensor.data()), size > 64 ? 64 : size));
       }
-      op->Run(*local_scope, platform::CPUPlace());
-      for (auto out_node : op_node->outputs) {
-        // this out_node is useless, do not set it persistable
-        if (out_node->outputs.size() == 0L) continue;
-        auto out_desc = out_node->Var();
-        auto out_name = out_desc->Name();
-        auto *local_out_tensor =
-            local_scope->FindVar(out_name)->GetMutable<phi::DenseTensor>();
-        std::vector<int64_t> out_shape;
-        for (int64_t i = 0; i < local_out_tensor->dims().size(); i++) {
-          out_shape.push_back(local_out_tensor->dims()[i]);
+      Node *same = nullptr;
+      for (auto *node : constants[hash]) {
+        if (SameTensor(
+                tensor,
+                scope->FindVar(node->Name())->Get<phi::DenseTensor>())) {
+          same = node;
+          break;
         }
-        out_desc->SetShape(out_shape);
-        out_desc->SetPersistable(true);
-        auto *global_out_tensor =
-            scope->Var(out_name)->GetMutable<phi::DenseTensor>();
-        *global_out_tensor = *local_out_tensor;
       }
-      GraphSafeRemoveNodes(graph, remove_nodes);
+      if (same != nullptr) {
+        for (auto *next_op : out_node->outputs) {
+          if (folded_ops.count(next_op)) continue;
+          next_op->Op()->RenameInput(out_node->Name(), same->Name());
+          IR_NODE_LINK_TO(same, next_op);
+        }
+        remove_nodes.emplace(out_node);
+        num_merged++;
+        removed_bytes += size;
+        continue;
+      }
+      std::vector<int64_t> out_shape = phi::vectorize<int64_t>(tensor.dims());
+      out_node->Var()->SetShape(out_shape);
+      out_node->Var()->SetPersistable(true);
+      *scope->Var(out_node->Name())->GetMutable<phi::DenseTensor>() = tensor;
+      constants[hash].push_back(out_node);
+      num_constants++;
+      folded_bytes += size;
     }
-    delete local_scope;
+    // The weights used only by the folded ops are removed. They are kept in
+    // the param scope if the program has other blocks, which may use them.
+    for (auto *in_node : op_node->inputs) {
+      if (folded_vars.count(in_node) || remove_nodes.count(in_node)) continue;
+      bool used = false;
+      for (auto *next_op : in_node->outputs) {
+        used = used || !folded_ops.count(next_op);
+      }
+      if (used) continue;
+      remove_nodes.emplace(in_node);
+      if (graph->OriginProgram().Size() == 1) {
+        removed_bytes += NumBytes(
+            scope->FindVar(in_node->Name())->Get<phi::DenseTensor>());
+        scope->EraseVars({in_node->Name()});
+      }
+    }
+  }
+  GraphSafeRemoveNodes(graph, remove_nodes);
+
+  AddStatis(static_cast<int>(folded_ops.size()));
+  if (!Has("disable_logs") || !Get<bool>("disable_logs")) {
+    string::PrettyLogDetail(
+        "---    folded %d ops into %d constants of %d bytes, merged %d "
+        "constants and removed %d bytes",
+        folded_ops.size(),
+        num_constants,
+        folded_bytes,
+        num_merged,
+        removed_bytes);
   }
 }
 
@@ -0,0 +1,109 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+
+#include <gtest/gtest.h>
+
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/phi/core/kernel_registry.h"
+
+USE_OP_ITSELF(scale);
+PD_DECLARE_KERNEL(scale, CPU, ALL_LAYOUT);
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+TEST(ConstantFoldingPass, fold_chains) {
+  Layers layers;
+  // (w) -> scale -> scale -> (a)
+  // (w) -> scale -> scale -> (b), which is the same as a
+  // (w) -> scale -> (c)
+  // (x, a) -> mul, (x, b) -> mul, (x, c) -> mul
+  auto* x = layers.data("x", {2, 3});
+  auto* w = layers.data("w", {3, 4}, true);
+  auto* a = layers.scale(layers.scale(w, 2.f, 0.f, true), 1.f, 1.f, true);
+  auto* b = layers.scale(layers.scale(w, 2.f, 0.f, true), 1.f, 1.f, true);
+  auto* c = layers.scale(w, 3.f, 0.f, true);
+  layers.mul(x, a);
+  layers.mul(x, b);
+  layers.mul(x, c);
+
+  std::unique_ptr<Graph> graph(new Graph(layers.main_program()));
+  auto* scope = new Scope();
+  auto* w_tensor = scope->Var("w")->GetMutable<phi::DenseTensor>();
+  w_tensor->Resize({3, 4});
+  float* w_data = w_tensor->mutable_data<float>(platform::CPUPlace());
+  for (int i = 0; i < 12; ++i) {
+    w_data[i] = i;
+  }
+  graph->Set("__param_scope__", scope);
+
+  auto pass = PassRegistry::Instance().Get("constant_folding_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+  EXPECT_EQ(GetNumOpNodes(graph, "scale"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "mul"), 3);
+  // w is used only by the folded ops.
+  EXPECT_EQ(scope->FindVar("w"), nullptr);
+  std::unordered_set<std::string> weights;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == "mul") {
+      weights.insert(node->Op()->Input("Y")[0]);
+    }
+  }
+  // a and b are merged.
+  ASSERT_EQ(weights.size(), 2UL);
+  EXPECT_EQ(weights.count(c->Name()), 1UL);
+  for (const auto& name : weights) {
+    const auto& tensor = scope->FindVar(name)->Get<phi::DenseTensor>();
+    ASSERT_EQ(tensor.numel(), 12);
+    float scale = name == c->Name() ? 3.f : 2.f;
+    float bias = name == c->Name() ? 0.f : 1.f;
+    for (int i = 0; i < 12; ++i) {
+      EXPECT_EQ(tensor.data<float>()[i], i * scale + bias);
+    }
+  }
+  EXPECT_EQ(weights.count(a->Name()) + weights.count(b->Name()), 1UL);
+}
+
+TEST(ConstantFoldingPass, keep_ops_on_inputs) {
+  Layers layers;
+  auto* x = layers.data("x", {2, 3});
+  auto* w = layers.data("w", {2, 3}, true);
+  layers.scale(x, 2.f, 0.f, true);
+  layers.elementwise_add(x, w);
+
+  std::unique_ptr<Graph> graph(new Graph(layers.main_program()));
+  auto* scope = new Scope();
+  scope->Var("w")
+      ->GetMutable<phi::DenseTensor>()
+      ->mutable_data<float>(phi::make_ddim({2, 3}), platform::CPUPlace());
+  graph->Set("__param_scope__", scope);
+
+  auto pass = PassRegistry::Instance().Get("constant_folding_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+  EXPECT_EQ(GetNumOpNodes(graph, "scale"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "elementwise_add"), 1);
+  EXPECT_NE(scope->FindVar("w"), nullptr);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(constant_folding_pass);
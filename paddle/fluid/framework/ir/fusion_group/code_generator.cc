@@ -15,6 +15,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/ir/fusion_group/code_generator.h"
 
 #include "paddle/fluid/framework/ir/fusion_group/code_generator_helper.h"
+#include "paddle/fluid/framework/ir/fusion_group/cpu_resources.h"
 #include "paddle/fluid/framework/ir/fusion_group/cuda_resources.h"
 
 namespace paddle {
@@ -43,11 +44,12 @@ std::string ExtractDataType(const std::vector<Node*>& nodes) {
   return dtype_str;
 }
 
-CodeGenerator::CodeGenerator() {
+CodeGenerator::CodeGenerator(bool use_gpu) : use_gpu_(use_gpu) {
   // Only support elementwise operations now.
   code_templates_.resize(1);
 
-  CodeTemplate elementwise_t(cuda_kernel_template_1d);
+  CodeTemplate elementwise_t(use_gpu ? cuda_kernel_template_1d
+                                     : cpu_kernel_template_1d);
   code_templates_[0] = elementwise_t;
 }
 
@@ -193,6 +195,22 @@ std::string CodeGenerator::Generate(
   for (const auto& type : dtypes) {
     all_dtype.insert(type.second);
   }
+  if (!use_gpu_) {
+    PADDLE_ENFORCE_EQ(all_dtype.count("__half"),
+                      0UL,
+                      platform::errors::Unimplemented(
+                          "The CPU code of fusion_group does not support "
+                          "float16."));
+    std::string predefined_cpu_functions = predefined_cpu_headers;
+    if (all_dtype.count("float")) {
+      predefined_cpu_functions += predefined_cpu_functions_fp32;
+    }
+    if (all_dtype.count("double")) {
+      predefined_cpu_functions += predefined_cpu_functions_fp64;
+    }
+    return predefined_cpu_functions + code_templates_[0].Format(template_var);
+  }
+
   std::string predefined_cuda_functions = "";
   if (all_dtype.find("float") != all_dtype.end() &&
       all_dtype.find("__half") == all_dtype.end()) {
@@ -284,6 +302,25 @@ std::string CodeGenerator::EmitParameters(
     const std::set<int>& intermediate_ids,
     const std::unordered_map<int, std::string>& dtypes) const {
   std::stringstream ret;
+  if (!use_gpu_) {
+    // The CPU kernel gets the pointers from args in the same order.
+    int index = 0;
+    for (auto id : input_ids) {
+      if (output_ids.find(id) == output_ids.end()) {
+        ret << "const " << dtypes.at(id) << "* __restrict__ " << ArgName(id)
+            << " = static_cast<const " << dtypes.at(id) << "*>(args["
+            << index++ << "]);";
+      }
+    }
+    for (auto id : output_ids) {
+      if (intermediate_ids.find(id) == intermediate_ids.end()) {
+        ret << dtypes.at(id) << "* __restrict__ " << ArgName(id)
+            << " = static_cast<" << dtypes.at(id) << "*>(args[" << index++
+            << "]);";
+      }
+    }
+    return ret.str();
+  }
   ret << "int N, ";
 
   // If a id is in the input and output list at the same time, then remove it
@@ -331,9 +368,14 @@ std::string CodeGenerator::EmitComputeBody(
   for (auto id : input_ids) {
     if (output_ids.find(id) == output_ids.end() &&
         used.find(id) != used.end()) {
-      load << dtypes.at(id) << " " << TmpName(id) << " = "
-           << "__ldg(&" << VarName(id) << ")"
-           << ";";
+      if (use_gpu_) {
+        load << dtypes.at(id) << " " << TmpName(id) << " = "
+             << "__ldg(&" << VarName(id) << ")"
+             << ";";
+      } else {
+        load << dtypes.at(id) << " " << TmpName(id) << " = " << VarName(id)
+             << ";";
+      }
     }
   }
   // Store temporal variables to memory.
@@ -32,7 +32,9 @@ class SubGraph;
 
 class CodeGenerator {
  public:
-  CodeGenerator();
+  // Generates the CUDA code for platform::CUDADeviceCode if use_gpu is true,
+  // otherwise the C++ code for platform::CPUDeviceCode.
+  explicit CodeGenerator(bool use_gpu = true);
 
   std::string Generate(std::string func_name,
                        const std::vector<OperationExpression>& expressions);
@@ -69,6 +71,7 @@ class CodeGenerator {
   std::unordered_map<Node*, int> EncodeVarNodes(SubGraph* subgraph);
 
  private:
+  bool use_gpu_;
   std::vector<CodeTemplate> code_templates_;
 };
 
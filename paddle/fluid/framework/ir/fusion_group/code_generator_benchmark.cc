@@ -0,0 +1,104 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/ir/fusion_group/code_generator.h"
+#include "paddle/fluid/framework/ir/fusion_group/operation.h"
+#include "paddle/fluid/platform/device_code.h"
+#include "paddle/fluid/platform/timer.h"
+
+namespace fusion_group = paddle::framework::ir::fusion_group;
+
+// Compare the fused CPU code with the unfused operations, which pass over the
+// memory once for every operation, on the elementwise chain after the first
+// fc of the feed-forward layer of BERT base.
+TEST(code_generator, cpu_benchmark) {
+  if (!paddle::platform::CPUDeviceCode::IsAvailable()) {
+    return;
+  }
+  // t1 = scale(t0), t3 = t1 + t2, t4 = relu(t3), t6 = t4 * t5
+  std::string dtype = "float";
+  fusion_group::OperationExpression scale(
+      "scale", {0}, {1}, dtype, dtype, {1});
+  scale.SetAttr(
+      {{"scale", 0.125f}, {"bias", 0.5f}, {"bias_after_scale", true}});
+  fusion_group::OperationExpression add(
+      "elementwise_add", {1, 2}, {3}, dtype, dtype, {3});
+  fusion_group::OperationExpression relu("relu", {3}, {4}, dtype, dtype, {4});
+  fusion_group::OperationExpression mul(
+      "elementwise_mul", {4, 5}, {6}, dtype, dtype);
+  fusion_group::OperationMap::Init();
+  fusion_group::CodeGenerator code_generator(false);
+  std::string code_str = code_generator.Generate(
+      "elementwise_cpu_benchmark", {scale, add, relu, mul});
+  VLOG(3) << code_str;
+  paddle::platform::CPUDeviceCode device_code(
+      paddle::platform::CPUPlace(), "elementwise_cpu_benchmark", code_str);
+  ASSERT_TRUE(device_code.Compile());
+
+  // The tokens of a batch of 128 x the intermediate size of 3072.
+  size_t n = 128 * 3072;
+  std::mt19937 rng(2022);
+  std::uniform_real_distribution<float> uniform_dist(-1, 1);
+  std::vector<float> x(n), y(n), z(n), fused(n), unfused(n);
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = uniform_dist(rng);
+    y[i] = uniform_dist(rng);
+    z[i] = uniform_dist(rng);
+  }
+  std::vector<float> tmp_1(n), tmp_3(n), tmp_4(n);
+  auto run_unfused = [&]() {
+    for (size_t i = 0; i < n; ++i) {
+      tmp_1[i] = 0.125f * x[i] + 0.5f;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      tmp_3[i] = tmp_1[i] + y[i];
+    }
+    for (size_t i = 0; i < n; ++i) {
+      tmp_4[i] = tmp_3[i] > 0 ? tmp_3[i] : 0;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      unfused[i] = tmp_4[i] * z[i];
+    }
+  };
+  std::vector<float*> ptrs = {x.data(), y.data(), z.data(), fused.data()};
+  std::vector<void*> args = {&n, &ptrs[0], &ptrs[1], &ptrs[2], &ptrs[3]};
+  auto run_fused = [&]() { device_code.Launch(n, &args); };
+
+  auto ms = [](std::function<void()> func) {
+    const int kRepeats = 20;
+    func();
+    paddle::platform::Timer timer;
+    timer.Start();
+    for (int i = 0; i < kRepeats; ++i) {
+      func();
+    }
+    timer.Pause();
+    return timer.ElapsedMS() / kRepeats;
+  };
+  double unfused_ms = ms(run_unfused);
+  double fused_ms = ms(run_fused);
+  for (size_t i = 0; i < n; ++i) {
+    ASSERT_NEAR(fused[i], unfused[i], 1e-5);
+  }
+  LOG(INFO) << "scale -> elementwise_add -> relu -> elementwise_mul of " << n
+            << " elements: unfused " << unfused_ms << " ms, fused " << fused_ms
+            << " ms.";
+}
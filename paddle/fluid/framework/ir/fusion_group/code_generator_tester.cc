@@ -15,6 +15,7 @@ limitations under the License. */
 #include <gtest/gtest.h>
 
 #include <cmath>
+#include <random>
 #include <string>
 
 #include "paddle/fluid/framework/ir/fusion_group/code_generator.h"
@@ -27,8 +28,6 @@ namespace phi {
 class DenseTensor;
 }  // namespace phi
 
-#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
-
 namespace paddle {
 namespace framework {
 namespace ir {
@@ -171,6 +170,7 @@ void SetupRandomCPUTensor(phi::DenseTensor* tensor) {
 
 namespace fusion_group = paddle::framework::ir::fusion_group;
 
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 template <typename T>
 void TestMainImpl(std::string func_name,
                   std::string code_str,
@@ -253,6 +253,35 @@ void TestMainImpl(std::string func_name,
     }
   }
 }
+#endif
+
+// Runs the CPU code on cpu_tensors in place, which only supports float.
+void TestMainImplCPU(std::string func_name,
+                     std::string code_str,
+                     std::vector<phi::DenseTensor> cpu_tensors,
+                     size_t n,
+                     std::vector<int> input_ids,
+                     std::vector<int> output_ids) {
+  paddle::platform::CPUDeviceCode device_code(
+      paddle::platform::CPUPlace(), func_name, code_str);
+  ASSERT_TRUE(device_code.Compile());
+
+  std::vector<float*> ptrs(cpu_tensors.size());
+  std::vector<void*> args;
+  args.push_back(&n);
+  for (auto id : input_ids) {
+    if (id >= 0) {
+      fusion_group::SetupRandomCPUTensor<float>(&cpu_tensors[id]);
+      ptrs[id] = cpu_tensors[id].data<float>();
+      args.push_back(&ptrs[id]);
+    }
+  }
+  for (auto id : output_ids) {
+    ptrs[id] = cpu_tensors[id].data<float>();
+    args.push_back(&ptrs[id]);
+  }
+  device_code.Launch(n, &args);
+}
 
 void TestElementwiseMain(
     std::string func_name,
@@ -260,7 +289,8 @@ void TestElementwiseMain(
     std::vector<fusion_group::OperationExpression> expressions,
     std::vector<int> input_ids,
     std::vector<int> output_ids,
-    std::string dtype) {
+    std::string dtype,
+    bool use_gpu) {
   std::unordered_set<int> ids;
   for (auto id : input_ids) {
     ids.insert(id);
@@ -278,12 +308,18 @@ void TestElementwiseMain(
   }
 
   int n = cpu_tensors[0].numel();
-  if (dtype == "__half") {
-    TestMainImpl<paddle::platform::float16>(
-        func_name, code_str, cpu_tensors, n, input_ids, output_ids);
+  if (!use_gpu) {
+    TestMainImplCPU(func_name, code_str, cpu_tensors, n, input_ids, output_ids);
   } else {
-    TestMainImpl<float>(
-        func_name, code_str, cpu_tensors, n, input_ids, output_ids);
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    if (dtype == "__half") {
+      TestMainImpl<paddle::platform::float16>(
+          func_name, code_str, cpu_tensors, n, input_ids, output_ids);
+    } else {
+      TestMainImpl<float>(
+          func_name, code_str, cpu_tensors, n, input_ids, output_ids);
+    }
+#endif
   }
 
   // Check the results
@@ -298,23 +334,25 @@ void TestMain(std::string func_name,
               std::vector<fusion_group::OperationExpression> expressions,
               std::vector<int> input_ids,
               std::vector<int> output_ids,
-              std::string dtype) {
+              std::string dtype,
+              bool use_gpu = true) {
   fusion_group::OperationMap::Init();
-  fusion_group::CodeGenerator code_generator;
+  fusion_group::CodeGenerator code_generator(use_gpu);
   std::string code_str = code_generator.Generate(func_name, expressions);
   VLOG(3) << code_str;
 
   LOG(INFO) << "dtype: " << dtype;
   TestElementwiseMain(
-      func_name, code_str, expressions, input_ids, output_ids, dtype);
+      func_name, code_str, expressions, input_ids, output_ids, dtype, use_gpu);
 }
 
 void TestMain(fusion_group::SubGraph* subgraph,
               std::vector<int> input_ids,
               std::vector<int> output_ids,
-              std::string dtype) {
+              std::string dtype,
+              bool use_gpu = true) {
   fusion_group::OperationMap::Init();
-  fusion_group::CodeGenerator code_generator;
+  fusion_group::CodeGenerator code_generator(use_gpu);
   std::string code_str = code_generator.Generate(subgraph);
   VLOG(3) << code_str;
 
@@ -327,9 +365,11 @@ void TestMain(fusion_group::SubGraph* subgraph,
                       expressions,
                       input_ids,
                       output_ids,
-                      dtype);
+                      dtype,
+                      use_gpu);
 }
 
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 TEST(code_generator, elementwise) {
   for (std::string dtype : {"float", "__half"}) {
     // t2 = t0 * t1
@@ -382,6 +422,7 @@ TEST(code_generator, elementwise_grad) {
         "elementwise_grad_kernel_0", expressions, input_ids, output_ids, dtype);
   }
 }
+#endif
 
 std::unique_ptr<paddle::framework::ir::Graph> BuildGraph(bool backward,
                                                          std::string dtype) {
@@ -477,6 +518,7 @@ std::unordered_set<paddle::framework::ir::Node*> DistilGradNodes(
   return grad_nodes;
 }
 
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 TEST(code_generator, subgraph) {
   for (std::string dtype : {"float", "__half"}) {
     std::unique_ptr<paddle::framework::ir::Graph> graph =
@@ -515,3 +557,68 @@ TEST(code_generator, subgraph_grad) {
   }
 }
 #endif
+
+TEST(code_generator, elementwise_cpu) {
+  if (!paddle::platform::CPUDeviceCode::IsAvailable()) {
+    return;
+  }
+  std::string dtype = "float";
+  // t2 = t0 * t1
+  // t4 = t2 + t3
+  // t6 = t4 - t5
+  // t7 = relu(t6)
+  // t8 = sigmoid(t7)
+  fusion_group::OperationExpression exp1(
+      "elementwise_mul", {0, 1}, {2}, dtype, dtype);
+  fusion_group::OperationExpression exp2(
+      "elementwise_add", {2, 3}, {4}, dtype, dtype);
+  fusion_group::OperationExpression exp3(
+      "elementwise_sub", {4, 5}, {6}, dtype, dtype);
+  fusion_group::OperationExpression exp4("relu", {6}, {7}, dtype, dtype);
+  fusion_group::OperationExpression exp5("sigmoid", {7}, {8}, dtype, dtype);
+  std::vector<fusion_group::OperationExpression> expressions = {
+      exp1, exp2, exp3, exp4, exp5};
+  std::vector<int> input_ids = {0, 1, 3, 5};
+  std::vector<int> output_ids = {2, 4, 6, 7, 8};
+  TestMain("elementwise_cpu_kernel_0",
+           expressions,
+           input_ids,
+           output_ids,
+           dtype,
+           false);
+
+  // t2' = relu_grad(t2, t3, t3')
+  // t0', t1' = elementwise_mul_grad(t0, t1, t2, t2')
+  fusion_group::OperationExpression exp6(
+      "relu_grad", {-1, 3, 7}, {6}, dtype, dtype);
+  fusion_group::OperationExpression exp7(
+      "elementwise_mul_grad", {0, 1, 2, 6}, {4, 5}, dtype, dtype);
+  TestMain("elementwise_grad_cpu_kernel_0",
+           {exp6, exp7},
+           {0, 1, 2, 3, 7},
+           {4, 5, 6},
+           dtype,
+           false);
+}
+
+TEST(code_generator, subgraph_cpu) {
+  if (!paddle::platform::CPUDeviceCode::IsAvailable()) {
+    return;
+  }
+  std::string dtype = "float";
+  std::unique_ptr<paddle::framework::ir::Graph> graph =
+      BuildGraph(false, dtype);
+  fusion_group::SubGraph subgraph(
+      0, "elementwise_cpu_kernel_1", true, graph->Nodes());
+  TestMain(&subgraph, {0, 1, 2, 3}, {4, 5, 6, 7, 8}, dtype, false);
+
+  std::unique_ptr<paddle::framework::ir::Graph> grad_graph =
+      BuildGraph(true, dtype);
+  fusion_group::SubGraph grad_subgraph(
+      0, "elementwise_grad_cpu_kernel_1", true, DistilGradNodes(grad_graph));
+  TestMain(&grad_subgraph,
+           {0, 1, 2, 3, 4, 5, 6, 7, 8, 9},
+           {10, 11, 12, 13, 14, 15, 16, 17},
+           dtype,
+           false);
+}
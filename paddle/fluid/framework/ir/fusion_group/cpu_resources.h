@@ -0,0 +1,60 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+namespace paddle {
+namespace framework {
+namespace ir {
+namespace fusion_group {
+
+static constexpr char predefined_cpu_headers[] = R"(
+#include <cmath>
+#include <cstdint>
+
+)";
+
+static constexpr char predefined_cpu_functions_fp32[] = R"(
+static inline float Max(float x, float y) { return std::fmax(x, y); }
+static inline float Exp(float x) { return std::exp(x); }
+static inline float Log(float x) { return std::log(x); }
+static inline float Sqrt(float x) { return std::sqrt(x); }
+
+)";
+
+static constexpr char predefined_cpu_functions_fp64[] = R"(
+static inline double Max(double x, double y) { return std::fmax(x, y); }
+static inline double Exp(double x) { return std::exp(x); }
+static inline double Log(double x) { return std::log(x); }
+static inline double Sqrt(double x) { return std::sqrt(x); }
+
+)";
+
+// The kernel loaded by platform::CPUDeviceCode, which computes the elements
+// in [begin, end). The loop has no dependency between the elements, so it is
+// vectorized by the compiler.
+static constexpr char cpu_kernel_template_1d[] = R"(
+extern "C" void $func_name(int64_t begin, int64_t end, void** args) {
+  $parameters
+#pragma omp simd
+  for (int64_t idx = begin; idx < end; ++idx) {
+    $compute_body
+  }
+}
+)";
+
+}  // namespace fusion_group
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
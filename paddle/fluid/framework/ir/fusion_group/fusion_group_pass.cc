@@ -20,6 +20,9 @@ limitations under the License. */
 #include "paddle/fluid/framework/ir/pass_tester_helper.h"
 #include "paddle/fluid/framework/op_proto_maker.h"
 #include "paddle/fluid/platform/device_code.h"
+
+DECLARE_bool(use_cpu_fusion_group);
+
 namespace paddle {
 namespace platform {
 class DeviceCodePool;
@@ -48,12 +51,41 @@ void FusionGroupPass::ApplyImpl(ir::Graph* graph) const {
     AddStatis(num_elementwise_groups);
     LOG(INFO) << "Detect " << num_elementwise_groups
               << " elementwise fusion groups.";
+  } else if (FLAGS_use_cpu_fusion_group) {
+    if (!platform::CPUDeviceCode::IsAvailable()) {
+      LOG(WARNING) << "Disable fusion_group on CPU because the compiler is "
+                      "not available.";
+      return;
+    }
+    fusion_group::OperationMap::Init();
+    int num_elementwise_groups = DetectFusionGroup(graph, 0);
+    AddStatis(num_elementwise_groups);
+    LOG(INFO) << "Detect " << num_elementwise_groups
+              << " elementwise fusion groups on CPU.";
   }
 }
 
-int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
+static platform::Place GetCodePlace(bool use_gpu) {
   // TODO(liuyiqun): supported different places
-  platform::CUDAPlace place = platform::CUDAPlace(0);
+  if (use_gpu) {
+    return platform::CUDAPlace(0);
+  }
+  return platform::CPUPlace();
+}
+
+static bool HasFP16Var(fusion_group::SubGraph* subgraph) {
+  for (auto* n : subgraph->Nodes()) {
+    if (n && n->IsVar() && n->Var() &&
+        n->Var()->GetDataType() == proto::VarType::FP16) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
+  bool use_gpu = Get<bool>("use_gpu");
+  platform::Place place = GetCodePlace(use_gpu);
   int index = platform::DeviceCodePool::Init({place}).size(place);
 
   std::vector<std::vector<Node*>> subgraphs =
@@ -70,7 +102,9 @@ int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
         std::unordered_set<Node*>(vec.begin(), vec.end()));
     VLOG(3) << "subgraph: {\n" << DebugString(subgraph.SortedNodes()) << "}\n";
 
-    if (subgraph.IsValid(min_subgraph_size)) {
+    // The CPU code does not support float16.
+    if (subgraph.IsValid(min_subgraph_size) &&
+        (use_gpu || !HasFP16Var(&subgraph))) {
       subgraph.SetFuncName("fused_elementwise_" + std::to_string(index++));
       if (GenerateCode(&subgraph)) {
         InsertFusionGroupOp(graph, &subgraph);
@@ -82,14 +116,24 @@ int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
 }
 
 bool FusionGroupPass::GenerateCode(fusion_group::SubGraph* subgraph) const {
-  fusion_group::CodeGenerator code_generator;
+  bool use_gpu = Get<bool>("use_gpu");
+  fusion_group::CodeGenerator code_generator(use_gpu);
   std::string code_str = code_generator.Generate(subgraph);
   VLOG(4) << code_str;
 
-  // TODO(liuyiqun): supported different places
-  platform::CUDAPlace place = platform::CUDAPlace(0);
-  std::unique_ptr<platform::CUDADeviceCode> device_code(
-      new platform::CUDADeviceCode(place, subgraph->GetFuncName(), code_str));
+  platform::Place place = GetCodePlace(use_gpu);
+  std::unique_ptr<platform::DeviceCode> device_code;
+  if (use_gpu) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    device_code.reset(new platform::CUDADeviceCode(
+        place, subgraph->GetFuncName(), code_str));
+#else
+    return false;
+#endif
+  } else {
+    device_code.reset(new platform::CPUDeviceCode(
+        place, subgraph->GetFuncName(), code_str));
+  }
   bool is_compiled = device_code->Compile();
   if (is_compiled) {
     platform::DeviceCodePool& pool = platform::DeviceCodePool::Init({place});
@@ -16,6 +16,9 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/ir/fusion_group/fusion_group_pass.h"
 #include "paddle/fluid/framework/ir/pass_tester_helper.h"
+#include "paddle/fluid/platform/device_code.h"
+
+DECLARE_bool(use_cpu_fusion_group);
 
 namespace paddle {
 namespace framework {
@@ -127,7 +130,12 @@ std::unique_ptr<Graph> BuildElementwiseTreeGraph(bool backward = false) {
 int TestMain(std::unique_ptr<Graph> graph, std::string prefix) {
   // VisualizeGraph(&graph, prefix + ".dot");
   auto pass = PassRegistry::Instance().Get("fusion_group_pass");
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   pass->Set("use_gpu", new bool(true));
+#else
+  FLAGS_use_cpu_fusion_group = true;
+  pass->Set("use_gpu", new bool(false));
+#endif
   VLOG(3) << DebugString(graph);
 
   graph.reset(pass->Apply(graph.release()));
@@ -138,13 +146,28 @@ int TestMain(std::unique_ptr<Graph> graph, std::string prefix) {
   return num_fusion_group_ops;
 }
 
+// The pass is skipped on CPU without the compiler.
+static bool IsAvailable() {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  return true;
+#else
+  return platform::CPUDeviceCode::IsAvailable();
+#endif
+}
+
 TEST(FusionGroupPass, elementwise_list) {
+  if (!IsAvailable()) {
+    return;
+  }
   std::unique_ptr<Graph> graph = BuildElementwiseListGraph(true);
   int num_fusion_group_ops = TestMain(std::move(graph), "elementwise_list");
   EXPECT_EQ(num_fusion_group_ops, 2);
 }
 
 TEST(FusionGroupPass, elementwise_tree) {
+  if (!IsAvailable()) {
+    return;
+  }
   std::unique_ptr<Graph> graph = BuildElementwiseTreeGraph(true);
   int num_fusion_group_ops = TestMain(std::move(graph), "elementwise_tree");
   EXPECT_EQ(num_fusion_group_ops, 4);
@@ -65,6 +65,10 @@ void NaiveExecutor::Run() {
     platform::CudaNvtxRangePush(op->Type(), platform::NvtxRangeColor::Green);
 #endif
 
+    for (auto &func : input_hookfunc_) {
+      func(op.get());
+    }
+
     // According to reuse table, we share the out tensor's holder.
     if (reuse_cache_.count(op.get())) {
       for (auto &it : reuse_cache_[op.get()]) {
@@ -171,6 +175,10 @@ void NaiveExecutor::RegisterOutputHook(const HookFunc &hookfunc) {
   hookfunc_.push_back(hookfunc);
 }
 
+void NaiveExecutor::RegisterInputHook(const HookFunc &hookfunc) {
+  input_hookfunc_.push_back(hookfunc);
+}
+
 void NaiveExecutor::MakeReusePlan(
     const std::unordered_map<std::string, std::string> &reuse_table) {
   std::unordered_map<std::string, std::unordered_set<std::string>> clusters;
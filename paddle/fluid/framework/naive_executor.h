@@ -75,6 +75,10 @@ class NaiveExecutor {
 
   void RegisterOutputHook(const HookFunc& hookfunc);
 
+  // Registers a hook called before each op runs, such as to prepare its
+  // inputs.
+  void RegisterInputHook(const HookFunc& hookfunc);
+
  private:
   void CreateOps(const ProgramDesc& desc,
                  int block_id,
@@ -87,6 +91,7 @@ class NaiveExecutor {
   Scope* scope_{nullptr};
 
   std::vector<HookFunc> hookfunc_;
+  std::vector<HookFunc> input_hookfunc_;
 
   // Record information that tensor_a should ShareBufferWith tensor_b.
   std::unordered_map<OperatorBase*, std::unordered_map<phi::DenseTensor*, int>>
@@ -0,0 +1,281 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/interpreter/step_arena.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
+#include <utility>
+
+#include "paddle/fluid/memory/malloc.h"
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+namespace {
+
+constexpr size_t kStepArenaAlignment = 64;
+
+size_t AlignSize(size_t size) {
+  return (size + kStepArenaAlignment - 1) / kStepArenaAlignment *
+         kStepArenaAlignment;
+}
+
+// A non-owning view of the arena, which keeps the arena alive.
+class StepArenaView : public phi::Allocation {
+ public:
+  StepArenaView(const std::shared_ptr<phi::Allocation>& arena,
+                size_t offset,
+                size_t size)
+      : phi::Allocation(static_cast<uint8_t*>(arena->ptr()) + offset,
+                        size,
+                        arena->place()),
+        arena_(arena) {}
+
+ private:
+  std::shared_ptr<phi::Allocation> arena_;
+};
+
+// Whether the lifetime of `prior` ends before `posterior` is written.
+bool BlockEndsBefore(const StepArenaBlock& prior,
+                     const StepArenaBlock& posterior,
+                     const std::function<bool(size_t, size_t)>& happens_before) {
+  for (size_t last_op : prior.last_live_ops) {
+    for (size_t writer : posterior.writers) {
+      if (last_op == writer || !happens_before(last_op, writer)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+size_t PlanStepArena(
+    std::vector<StepArenaBlock>* blocks,
+    const std::function<bool(size_t, size_t)>& happens_before) {
+  std::vector<size_t> order(blocks->size());
+  std::iota(order.begin(), order.end(), 0);
+  // Place the larger blocks first, which usually leads to less fragmentation.
+  std::stable_sort(order.begin(), order.end(), [blocks](size_t a, size_t b) {
+    return blocks->at(a).size > blocks->at(b).size;
+  });
+
+  size_t total_size = 0;
+  std::vector<size_t> placed;
+  for (size_t idx : order) {
+    auto& block = blocks->at(idx);
+    size_t size = AlignSize(block.size);
+
+    // The address ranges occupied by the placed blocks whose lifetimes
+    // overlap with the current one.
+    std::vector<std::pair<size_t, size_t>> occupied;
+    for (size_t other_idx : placed) {
+      auto& other = blocks->at(other_idx);
+      if (!BlockEndsBefore(other, block, happens_before) &&
+          !BlockEndsBefore(block, other, happens_before)) {
+        occupied.emplace_back(other.offset,
+                              other.offset + AlignSize(other.size));
+      }
+    }
+    std::sort(occupied.begin(), occupied.end());
+
+    // First fit.
+    size_t offset = 0;
+    for (auto& range : occupied) {
+      if (offset + size <= range.first) {
+        break;
+      }
+      offset = std::max(offset, range.second);
+    }
+    block.offset = offset;
+    total_size = std::max(total_size, offset + size);
+    placed.push_back(idx);
+  }
+  return total_size;
+}
+
+StepArena::StepArena(const platform::Place& place, size_t var_num)
+    : place_(place),
+      recorded_size_(var_num, 0),
+      excluded_(var_num, 0),
+      views_(var_num) {}
+
+void StepArena::OnRelease(size_t var_id, Variable* var) {
+  if (var_id >= excluded_.size() || excluded_[var_id] || var == nullptr ||
+      !var->IsType<phi::DenseTensor>()) {
+    return;
+  }
+  const auto& holder = var->Get<phi::DenseTensor>().Holder();
+  if (!holder) {
+    return;
+  }
+
+  auto& view = views_[var_id];
+  bool is_view = view && holder == view;
+
+  // Only this var (and views_ for a view) holds the memory, otherwise the
+  // memory is shared with other vars (e.g. inplace or feed), which may
+  // outlive this var, so it can not be placed in the arena.
+  if (holder.use_count() != (is_view ? 2 : 1) || holder->place() != place_) {
+    VLOG(6) << "Exclude var " << var_id << " from the step arena.";
+    excluded_[var_id] = 1;
+    if (view) {
+      need_replan_ = true;
+    }
+    return;
+  }
+
+  if (is_view) {
+    ++hit_count_;
+    return;
+  }
+
+  if (view) {
+    // The planned memory is not enough, e.g. the shape is changed.
+    VLOG(4) << "Var " << var_id << " requires " << holder->size()
+            << " bytes, but " << view->size() << " bytes are planned.";
+    need_replan_ = true;
+  }
+  recorded_size_[var_id] = std::max(recorded_size_[var_id], holder->size());
+}
+
+void StepArena::BeforeRun(size_t instr_id, const VariableScope& var_scope) {
+  if (!arena_ || instr_id >= install_vars_.size()) {
+    return;
+  }
+  for (size_t var_id : install_vars_[instr_id]) {
+    auto* tensor = var_scope.VarRef(var_id)->GetMutable<phi::DenseTensor>();
+    if (!tensor->Holder()) {
+      tensor->ResetHolder(views_[var_id]);
+    }
+  }
+}
+
+void StepArena::Reset() {
+  arena_.reset();
+  for (auto& view : views_) {
+    view.reset();
+  }
+  install_vars_.clear();
+}
+
+void StepArena::EndStep(
+    const std::vector<Instruction>& instructions,
+    const std::map<size_t, std::set<size_t>>& last_live_ops,
+    const DependencyBuilder& dependency_builder,
+    const VariableScope& var_scope) {
+  last_hit_count_ = hit_count_.exchange(0);
+  if (arena_ && !need_replan_) {
+    VLOG(4) << last_hit_count_ << " vars are allocated from the step arena.";
+    return;
+  }
+  need_replan_ = false;
+  Reset();
+
+  // Whether an inplace pair shares the buffer is decided when the op runs
+  // (by the dims), so it may happen only in the steps after the plan, and the
+  // out var would keep using the memory of the in var after the in var dies.
+  std::unordered_set<const Variable*> inplace_vars;
+  for (auto& instr : instructions) {
+    for (auto& pair : instr.InplaceInfo()) {
+      inplace_vars.insert(pair.first);
+      inplace_vars.insert(pair.second);
+    }
+  }
+  if (!inplace_vars.empty()) {
+    for (size_t var_id = 0; var_id < excluded_.size(); ++var_id) {
+      if (inplace_vars.count(var_scope.VarRef(var_id))) {
+        excluded_[var_id] = 1;
+      }
+    }
+  }
+
+  std::vector<std::set<size_t>> writers(recorded_size_.size());
+  for (size_t instr_id = 0; instr_id < instructions.size(); ++instr_id) {
+    for (auto& item : instructions[instr_id].Outputs()) {
+      for (int var_id : item.second) {
+        if (var_id >= 0 && static_cast<size_t>(var_id) < writers.size()) {
+          writers[var_id].insert(instr_id);
+        }
+      }
+    }
+  }
+
+  auto happens_before = [&dependency_builder](size_t prior, size_t posterior) {
+    return dependency_builder.OpHappensBefore(prior, posterior);
+  };
+
+  std::vector<StepArenaBlock> blocks;
+  std::vector<size_t> first_writers;
+  for (size_t var_id = 0; var_id < recorded_size_.size(); ++var_id) {
+    if (recorded_size_[var_id] == 0 || excluded_[var_id] ||
+        writers[var_id].empty()) {
+      continue;
+    }
+    auto live_iter = last_live_ops.find(var_id);
+    if (live_iter == last_live_ops.end() || live_iter->second.empty()) {
+      continue;
+    }
+    // The memory is given to the var before its first writer runs, which
+    // must happen before all the other writers.
+    size_t first_writer = *writers[var_id].begin();
+    for (size_t writer : writers[var_id]) {
+      if (writer != first_writer && happens_before(writer, first_writer)) {
+        first_writer = writer;
+      }
+    }
+    bool has_unique_first_writer = std::all_of(
+        writers[var_id].begin(), writers[var_id].end(), [&](size_t writer) {
+          return writer == first_writer || happens_before(first_writer, writer);
+        });
+    if (!has_unique_first_writer) {
+      continue;
+    }
+
+    StepArenaBlock block;
+    block.var_id = var_id;
+    block.size = recorded_size_[var_id];
+    block.writers = writers[var_id];
+    block.last_live_ops = live_iter->second;
+    blocks.emplace_back(std::move(block));
+    first_writers.push_back(first_writer);
+  }
+
+  if (blocks.empty()) {
+    VLOG(4) << "No var can be allocated from the step arena.";
+    return;
+  }
+
+  size_t arena_size = PlanStepArena(&blocks, happens_before);
+  arena_ = memory::AllocShared(place_, arena_size);
+  install_vars_.resize(instructions.size());
+  size_t total_size = 0;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    auto& block = blocks[i];
+    views_[block.var_id] =
+        std::make_shared<StepArenaView>(arena_, block.offset, block.size);
+    install_vars_[first_writers[i]].push_back(block.var_id);
+    total_size += block.size;
+  }
+  VLOG(1) << "Plan step arena of " << arena_size << " bytes for "
+          << blocks.size() << " vars of " << total_size << " bytes.";
+}
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,116 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "paddle/fluid/framework/new_executor/interpreter/dependency_builder.h"
+#include "paddle/fluid/framework/new_executor/new_executor_defs.h"
+#include "paddle/fluid/platform/place.h"
+#include "paddle/phi/core/allocator.h"
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+struct StepArenaBlock {
+  size_t var_id;
+  size_t size;
+  // The ops that write the var, and the ops that access it last.
+  std::set<size_t> writers;
+  std::set<size_t> last_live_ops;
+  // Assigned by PlanStepArena.
+  size_t offset{0};
+};
+
+// Assign offsets to the blocks such that two blocks overlap only if the
+// lifetime of one ends before the other one is written, according to
+// `happens_before`. Return the total size of the arena.
+size_t PlanStepArena(std::vector<StepArenaBlock>* blocks,
+                     const std::function<bool(size_t, size_t)>& happens_before);
+
+// StepArena carves the intermediate tensors of an InterpreterCore out of one
+// persistent allocation, so that they are not allocated and freed every step.
+//
+// In the first step after the InterpreterCore is built, the size of every
+// DenseTensor released by the garbage collector is recorded. Then the offsets
+// in the arena are planned with the lifetimes of the vars, and in the
+// following steps a view of the arena is given to the var before its first
+// writer runs. The kernel finds the holder large enough and does not
+// allocate, and the release of the view by the garbage collector is a no-op.
+//
+// If a var requires more memory than planned (e.g. the shape changes), the
+// kernel simply allocates from the allocator as before, and the arena is
+// planned again in the next step. The in and out vars of inplace ops, and
+// the vars that turn out to share memory with other vars when released, are
+// excluded from the arena.
+//
+// Only CPUPlace is supported, since the reuse of memory is decided by the
+// dependencies of ops and does not respect device streams.
+class StepArena {
+ public:
+  StepArena(const platform::Place& place, size_t var_num);
+
+  // Called by the garbage collection check of `var_id`, before the memory of
+  // `var` is released. Thread-safe for different vars.
+  void OnRelease(size_t var_id, Variable* var);
+
+  // Called before the instruction `instr_id` runs, to give the planned vars
+  // written by it the memory in the arena.
+  void BeforeRun(size_t instr_id, const VariableScope& var_scope);
+
+  // Called after each step, to plan the arena with the recorded sizes or to
+  // check whether the plan is still valid.
+  void EndStep(const std::vector<Instruction>& instructions,
+               const std::map<size_t, std::set<size_t>>& last_live_ops,
+               const DependencyBuilder& dependency_builder,
+               const VariableScope& var_scope);
+
+  bool IsPlanned() const { return arena_ != nullptr; }
+  size_t ArenaSize() const { return arena_ ? arena_->size() : 0; }
+  // Number of planned vars that got their memory from the arena in the last
+  // step.
+  size_t HitCount() const { return last_hit_count_; }
+
+ private:
+  void Reset();
+
+  platform::Place place_;
+
+  // Sizes recorded in the recording step, 0 means not recorded.
+  std::vector<size_t> recorded_size_;
+  // Vars which should never be placed in the arena. Not vector<bool> since it
+  // is written by different threads.
+  std::vector<uint8_t> excluded_;
+
+  std::shared_ptr<phi::Allocation> arena_;
+  // The views of the arena given to each var, indexed by var id.
+  std::vector<std::shared_ptr<phi::Allocation>> views_;
+  // The vars to give views to before running each instruction.
+  std::vector<std::vector<size_t>> install_vars_;
+
+  std::atomic<size_t> hit_count_{0};
+  size_t last_hit_count_{0};
+  std::atomic<bool> need_replan_{false};
+};
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
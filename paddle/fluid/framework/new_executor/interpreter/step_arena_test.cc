@@ -0,0 +1,58 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/interpreter/step_arena.h"
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+static StepArenaBlock MakeBlock(size_t var_id,
+                                size_t size,
+                                std::set<size_t> writers,
+                                std::set<size_t> last_live_ops) {
+  StepArenaBlock block;
+  block.var_id = var_id;
+  block.size = size;
+  block.writers = writers;
+  block.last_live_ops = last_live_ops;
+  return block;
+}
+
+TEST(StepArena, ReuseAlongChain) {
+  // op0 writes a, op1 reads a and writes b, op2 reads b and writes c, op3
+  // reads c. a and c can share memory, while b overlaps with both.
+  std::vector<StepArenaBlock> blocks = {MakeBlock(0, 100, {0}, {1}),
+                                        MakeBlock(1, 100, {1}, {2}),
+                                        MakeBlock(2, 100, {2}, {3})};
+  size_t size = PlanStepArena(
+      &blocks, [](size_t prior, size_t posterior) { return prior < posterior; });
+  EXPECT_EQ(size, 256UL);
+  EXPECT_EQ(blocks[0].offset, blocks[2].offset);
+  EXPECT_NE(blocks[0].offset, blocks[1].offset);
+}
+
+TEST(StepArena, NoReuseWithoutDependency) {
+  std::vector<StepArenaBlock> blocks = {MakeBlock(0, 64, {0}, {1}),
+                                        MakeBlock(1, 100, {2}, {3}),
+                                        MakeBlock(2, 10, {4}, {5})};
+  size_t size = PlanStepArena(&blocks, [](size_t, size_t) { return false; });
+  EXPECT_EQ(size, 64UL + 128UL + 64UL);
+}
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
@@ -23,6 +23,7 @@
 #include "paddle/fluid/framework/new_executor/interpreter/interpreter_util.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/platform/device/gpu/gpu_info.h"
+#include "paddle/fluid/platform/metrics_exporter.h"
 #include "paddle/fluid/platform/os_info.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 #include "paddle/fluid/platform/profiler/supplement_tracing.h"
@@ -52,6 +53,11 @@ PADDLE_DEFINE_EXPORTED_bool(new_executor_use_local_scope,
 PADDLE_DEFINE_EXPORTED_bool(control_flow_use_new_executor,
                             false,
                             "Use new executor in control flow op");
+PADDLE_DEFINE_EXPORTED_bool(new_executor_use_step_arena,
+                            false,
+                            "Allocate the intermediate tensors from a "
+                            "persistent arena planned by the first step in "
+                            "new executor, only applied to CPU.");
 
 DECLARE_bool(check_nan_inf);
 DECLARE_bool(benchmark);
@@ -62,6 +68,23 @@ constexpr const char* kTaskCompletion = "TaskCompletion";
 namespace paddle {
 namespace framework {
 
+// Histograms are never released by the MetricsRegistry, so they are cached
+// per thread to avoid locking the registry for every instruction.
+static platform::MetricHistogram* GetOpLatencyHistogram(
+    const std::string& op_type) {
+  thread_local std::unordered_map<std::string, platform::MetricHistogram*>
+      cache;
+  auto it = cache.find(op_type);
+  if (it == cache.end()) {
+    auto* histogram = platform::MetricsRegistry::Instance().GetHistogram(
+        "paddle_executor_op_latency_seconds",
+        "Latency of running an op in the standalone executor.",
+        {{"op_type", op_type}});
+    it = cache.emplace(op_type, histogram).first;
+  }
+  return it->second;
+}
+
 inline void SetDeviceId(const platform::Place& place) {
   // TODO(zhiqiu): reduce the cost
   if (platform::is_gpu_place(place)) {
@@ -206,22 +229,7 @@ paddle::framework::FetchList InterpreterCore::Run(
       gc_ = CreateInterpreterCoreGarbageCollector(place_, vec_instruction_);
     }
 
-    if (execution_config_.used_for_jit && (sync_op_num_ == 0)) {
-      VLOG(4) << "Tracing Instruction List";
-      TraceInstructionList(vec_instruction_);
-    } else {
-      ExecuteInstructionList(vec_instruction_);
-    }
-#ifdef PADDLE_WITH_ASCEND_CL
-    if (platform::is_npu_place(place_)) {
-      platform::DeviceContextPool::Instance().Get(place_)->Wait();
-    }
-#endif
-#ifdef PADDLE_WITH_CUSTOM_DEVICE
-    if (platform::is_custom_place(place_)) {
-      platform::DeviceContextPool::Instance().Get(place_)->Wait();
-    }
-#endif
+    ExecuteStep();
   }
   if (HasLocalScope()) {
     ClearLoDTensorArrayInLocalScope();
@@ -274,22 +282,7 @@ paddle::framework::FetchList InterpreterCore::Run(
       gc_ = CreateInterpreterCoreGarbageCollector(place_, vec_instruction_);
     }
 
-    if (execution_config_.used_for_jit && (sync_op_num_ == 0)) {
-      VLOG(4) << "Tracing Instruction List";
-      TraceInstructionList(vec_instruction_);
-    } else {
-      ExecuteInstructionList(vec_instruction_);
-    }
-#ifdef PADDLE_WITH_ASCEND_CL
-    if (platform::is_npu_place(place_)) {
-      platform::DeviceContextPool::Instance().Get(place_)->Wait();
-    }
-#endif
-#ifdef PADDLE_WITH_CUSTOM_DEVICE
-    if (platform::is_custom_place(place_)) {
-      platform::DeviceContextPool::Instance().Get(place_)->Wait();
-    }
-#endif
+    ExecuteStep();
   }
 
   if (HasLocalScope()) {
@@ -902,11 +895,17 @@ void InterpreterCore::RunInstruction(const Instruction& instr_node) {
   auto* op = instr_node.OpBase();
   platform::RecordEvent instruction_event(
       op->Type(), platform::TracerEventType::Operator, 1);
+  platform::ScopedLatencyRecorder latency_recorder(
+      UNLIKELY(platform::IsMetricsEnabled()) ? GetOpLatencyHistogram(op->Type())
+                                             : nullptr);
 
   try {
     instr_node.WaitEvent(place_);
 
     if (!instr_node.IsArtificial()) {
+      if (step_arena_) {
+        step_arena_->BeforeRun(instr_node.Id(), var_scope_);
+      }
       RunOperator(instr_node);
       CheckGC(instr_node);
       interpreter::LogDeviceMemoryStats(place_);
@@ -928,6 +927,36 @@ void InterpreterCore::RunInstruction(const Instruction& instr_node) {
   }
 }
 
+void InterpreterCore::ExecuteStep() {
+  if (FLAGS_new_executor_use_step_arena && platform::is_cpu_place(place_) &&
+      !step_arena_) {
+    step_arena_ =
+        std::make_unique<interpreter::StepArena>(place_, var_scope_.VarSize());
+  }
+
+  if (execution_config_.used_for_jit && (sync_op_num_ == 0)) {
+    VLOG(4) << "Tracing Instruction List";
+    TraceInstructionList(vec_instruction_);
+  } else {
+    ExecuteInstructionList(vec_instruction_);
+  }
+#ifdef PADDLE_WITH_ASCEND_CL
+  if (platform::is_npu_place(place_)) {
+    platform::DeviceContextPool::Instance().Get(place_)->Wait();
+  }
+#endif
+#ifdef PADDLE_WITH_CUSTOM_DEVICE
+  if (platform::is_custom_place(place_)) {
+    platform::DeviceContextPool::Instance().Get(place_)->Wait();
+  }
+#endif
+
+  if (step_arena_) {
+    step_arena_->EndStep(
+        vec_instruction_, last_live_ops_, dependency_builder_, var_scope_);
+  }
+}
+
 void InterpreterCore::ExecuteInstructionList(
     const std::vector<Instruction>& vec_instr) {
   interpreter::ResetAtomicGuard guard(&deps_, &refs_);
@@ -1147,6 +1176,9 @@ void InterpreterCore::CheckGC(const Instruction& instr) {
     if (is_ready) {
       VLOG(6) << "Async delete variable with name : "
               << var_scope.GetNameById(var_id);
+      if (step_arena_) {
+        step_arena_->OnRelease(var_id, refs_[var_id]->Var());
+      }
       gc_->Add(refs_[var_id]->Var(), instr);
     }
   }
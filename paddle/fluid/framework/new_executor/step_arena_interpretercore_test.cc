@@ -0,0 +1,101 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/new_executor/interpretercore.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/phi/core/kernel_registry.h"
+
+USE_OP_ITSELF(scale);
+USE_OP_ITSELF(elementwise_add);
+USE_OP_ITSELF(fetch_v2);
+
+PD_DECLARE_KERNEL(scale, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(add, CPU, ALL_LAYOUT);
+
+DECLARE_bool(new_executor_use_inplace);
+DECLARE_bool(new_executor_use_step_arena);
+
+namespace paddle {
+namespace framework {
+
+static void AppendScaleOp(BlockDesc* block,
+                          const std::string& x,
+                          const std::string& out,
+                          float scale) {
+  OpDesc* op = block->AppendOp();
+  op->SetType("scale");
+  op->SetInput("X", {x});
+  op->SetOutput("Out", {out});
+  op->SetAttr("scale", scale);
+}
+
+// a = 2x, b = 3a (inplace), c = 5b, d = c + b, so d = 36x. c is written after
+// the last use of a, so it would be planned at the memory of a, which b
+// shares by inplace.
+TEST(InterpreterCore, step_arena_with_inplace) {
+  bool use_inplace = FLAGS_new_executor_use_inplace;
+  bool use_step_arena = FLAGS_new_executor_use_step_arena;
+  FLAGS_new_executor_use_inplace = true;
+  FLAGS_new_executor_use_step_arena = true;
+
+  ProgramDesc program;
+  BlockDesc* block = program.MutableBlock(0);
+  for (auto name : {"x", "a", "b", "c", "d"}) {
+    block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  AppendScaleOp(block, "x", "a", 2.0f);
+  AppendScaleOp(block, "a", "b", 3.0f);
+  AppendScaleOp(block, "b", "c", 5.0f);
+  OpDesc* add = block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"c"});
+  add->SetInput("Y", {"b"});
+  add->SetOutput("Out", {"d"});
+
+  const platform::CPUPlace place;
+  phi::DenseTensor x;
+  float* x_data = x.mutable_data<float>(phi::make_ddim({64}), place);
+  for (int i = 0; i < 64; ++i) {
+    x_data[i] = static_cast<float>(i);
+  }
+
+  Scope scope;
+  std::shared_ptr<InterpreterCore> core =
+      CreateInterpreterCore(place, program, &scope, {"d"});
+  for (int step = 0; step < 5; ++step) {
+    // The sizes of the vars are recorded in the second step, in which the
+    // inplace ops do not share the buffer, while they do in the later steps
+    // with the planned arena.
+    FLAGS_new_executor_use_inplace = step != 1;
+    FetchList fetch_list = core->Run({"x"}, {x});
+    ASSERT_EQ(fetch_list.size(), 1UL);
+    const auto& d = PADDLE_GET_CONST(phi::DenseTensor, fetch_list[0]);
+    ASSERT_EQ(d.numel(), 64);
+    for (int i = 0; i < 64; ++i) {
+      ASSERT_FLOAT_EQ(d.data<float>()[i], 36.0f * i) << "step " << step;
+    }
+  }
+
+  FLAGS_new_executor_use_inplace = use_inplace;
+  FLAGS_new_executor_use_step_arena = use_step_arena;
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -43,6 +43,10 @@ void EraseLoadProcessPIDs(int64_t key) {
   if (it != load_process_pids.end()) {
     VLOG(3) << "Dygraph Data Loader: erase loader child process PID (" << key
             << ")";
+    // The shared memory files kept for the batches of the workers are not
+    // used again.
+    memory::allocation::MemoryMapAllocationPool::Instance().ReleaseFilesOf(
+        it->second);
     load_process_pids.erase(it);
   } else {
     VLOG(3) << "Dygraph Data Loader: The dygrph loader (id: " << key
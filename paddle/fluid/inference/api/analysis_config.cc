@@ -404,6 +404,17 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(trt_allow_build_at_runtime_);
   CP_MEMBER(collect_shape_range_info_);
   CP_MEMBER(shape_range_info_path_);
+  CP_MEMBER(use_shape_bucket_);
+  CP_MEMBER(shape_buckets_);
+  CP_MEMBER(shape_bucket_info_path_);
+  CP_MEMBER(shape_bucket_num_);
+  CP_MEMBER(shape_bucket_warmup_);
+  CP_MEMBER(use_pass_tuning_);
+  CP_MEMBER(pass_tuning_shapes_);
+  CP_MEMBER(pass_tuning_candidates_);
+  CP_MEMBER(pass_tuning_repeat_);
+  CP_MEMBER(lazy_load_params_);
+  CP_MEMBER(lazy_load_params_prefetch_);
   CP_MEMBER(trt_use_inspector_);
   CP_MEMBER(trt_engine_memory_sharing_);
   // Dlnne related
@@ -1307,6 +1318,9 @@ std::string AnalysisConfig::Summary() {
   os.InsertRow({"enable_log", with_glog_info_ ? "true" : "false"});
   os.InsertRow({"collect_shape_range_info",
                 collect_shape_range_info_ ? shape_range_info_path_ : "false"});
+  os.InsertRow({"use_shape_bucket", use_shape_bucket_ ? "true" : "false"});
+  os.InsertRow({"use_pass_tuning", use_pass_tuning_ ? "true" : "false"});
+  os.InsertRow({"lazy_load_params", lazy_load_params_ ? "true" : "false"});
 
   return os.PrintTable();
 }
@@ -1392,6 +1406,66 @@ bool AnalysisConfig::shape_range_info_collected() const {
   return collect_shape_range_info_;
 }
 
+void AnalysisConfig::EnableShapeBucket(
+    const std::vector<std::map<std::string, std::vector<int>>> &buckets,
+    bool warmup) {
+  PADDLE_ENFORCE_EQ(buckets.empty(),
+                    false,
+                    platform::errors::InvalidArgument(
+                        "The shape buckets should not be empty."));
+  use_shape_bucket_ = true;
+  shape_buckets_ = buckets;
+  shape_bucket_info_path_.clear();
+  shape_bucket_warmup_ = warmup;
+}
+
+void AnalysisConfig::EnableShapeBucket(const std::string &shape_range_info_path,
+                                       int num_buckets,
+                                       bool warmup) {
+  PADDLE_ENFORCE_EQ(shape_range_info_path.empty(),
+                    false,
+                    platform::errors::InvalidArgument(
+                        "The shape_range_info_path should not be empty, please "
+                        "re-check the argument."));
+  PADDLE_ENFORCE_GT(num_buckets,
+                    0,
+                    platform::errors::InvalidArgument(
+                        "The number of the shape buckets should be greater "
+                        "than 0, but got %d.",
+                        num_buckets));
+  use_shape_bucket_ = true;
+  shape_buckets_.clear();
+  shape_bucket_info_path_ = shape_range_info_path;
+  shape_bucket_num_ = num_buckets;
+  shape_bucket_warmup_ = warmup;
+}
+
+void AnalysisConfig::EnablePassTuning(
+    const std::map<std::string, std::vector<int>> &sample_shapes,
+    const std::vector<std::string> &candidate_passes,
+    int repeat) {
+  PADDLE_ENFORCE_EQ(sample_shapes.empty(),
+                    false,
+                    platform::errors::InvalidArgument(
+                        "The shapes of the sample inputs should not be "
+                        "empty."));
+  PADDLE_ENFORCE_GT(repeat,
+                    0,
+                    platform::errors::InvalidArgument(
+                        "The number of the runs to time the passes should be "
+                        "greater than 0, but got %d.",
+                        repeat));
+  use_pass_tuning_ = true;
+  pass_tuning_shapes_ = sample_shapes;
+  pass_tuning_candidates_ = candidate_passes;
+  pass_tuning_repeat_ = repeat;
+}
+
+void AnalysisConfig::EnableLazyLoadParams(bool prefetch) {
+  lazy_load_params_ = true;
+  lazy_load_params_prefetch_ = prefetch;
+}
+
 void AnalysisConfig::EnableTunedTensorRtDynamicShape(
     const std::string &shape_range_info_path, bool allow_build_at_runtime) {
   shape_range_info_path_ = shape_range_info_path;
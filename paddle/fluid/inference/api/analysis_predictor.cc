@@ -17,10 +17,15 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <cstring>
+#include <deque>
 #include <fstream>
 #include <memory>
+#include <numeric>
 #include <set>
 #include <string>
+#include <thread>  // NOLINT
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -34,6 +39,7 @@
 #include "paddle/fluid/framework/op_proto_maker.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/framework/transfer_scope_cache.h"
 #include "paddle/fluid/framework/var_type_traits.h"
 #include "paddle/fluid/framework/version.h"
@@ -47,13 +53,16 @@
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/api/paddle_inference_pass.h"
 #include "paddle/fluid/inference/api/resource_manager.h"
+#include "paddle/fluid/inference/api/shape_bucket.h"
 #include "paddle/fluid/inference/utils/io_utils.h"
 #include "paddle/fluid/inference/utils/model_utils.h"
 #include "paddle/fluid/inference/utils/singleton.h"
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/platform/cpu_helper.h"
+#include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/device/gpu/gpu_info.h"
 #include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/metrics_exporter.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/profiler.h"
 #include "paddle/phi/api/ext/op_meta_info.h"
@@ -61,6 +70,7 @@
 #include "paddle/phi/common/data_type.h"
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/packed_weight_cache.h"
 #include "paddle/utils/string/split.h"
 
 #if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_PSCORE)
@@ -103,6 +113,35 @@ using inference::tensorrt::TRTInt8Calibrator;
 int AnalysisPredictor::clone_num_ = 1;
 
 namespace {
+// Resolve the request counter and the latency histogram of `api`. It locks
+// the MetricsRegistry, so it is called once in Init rather than per request.
+// QPS is exported as the counter, of which the rate is taken by the scraper.
+void GetPredictorRequestMetrics(const std::string &api,
+                                platform::MetricCounter **requests,
+                                platform::MetricHistogram **latency) {
+  auto &registry = platform::MetricsRegistry::Instance();
+  *requests =
+      registry.GetCounter("paddle_inference_requests",
+                          "Number of requests run by AnalysisPredictor.",
+                          {{"api", api}});
+  *latency = registry.GetHistogram("paddle_inference_latency_seconds",
+                                   "Latency of AnalysisPredictor requests.",
+                                   {{"api", api}},
+                                   platform::DefaultLatencyBuckets(),
+                                   {0.5, 0.9, 0.99, 0.999});
+}
+
+// Count the request and return the histogram to record its latency into, or
+// nullptr if metrics are disabled.
+platform::MetricHistogram *RecordPredictorRequest(
+    platform::MetricCounter *requests, platform::MetricHistogram *latency) {
+  if (requests == nullptr || !platform::IsMetricsEnabled()) {
+    return nullptr;
+  }
+  requests->Increase();
+  return latency;
+}
+
 bool IsPersistable(const framework::VarDesc *var) {
   if (var->Persistable() &&
       var->GetType() != framework::proto::VarType::FEED_MINIBATCH &&
@@ -151,6 +190,96 @@ phi::Backend ConvertBackend(paddle_infer::PlaceType backend) {
       return phi::Backend::CPU;
   }
 }
+
+// Marks the CPU parameters which no op of the program writes as constant, so
+// that the CPU kernels may cache their packed forms.
+void MarkConstantParameters(const framework::ProgramDesc &program,
+                            const framework::Scope &scope) {
+  std::unordered_set<std::string> written;
+  for (size_t i = 0; i < program.Size(); ++i) {
+    for (auto *op : program.Block(i).AllOps()) {
+      for (auto &name : op->OutputArgumentNames()) {
+        written.insert(name);
+      }
+    }
+  }
+  auto &cache = phi::funcs::PackedWeightCache::Instance();
+  for (auto *var_desc : program.Block(0).AllVars()) {
+    if (!IsPersistable(var_desc) || written.count(var_desc->Name())) {
+      continue;
+    }
+    auto *var = scope.FindVar(var_desc->Name());
+    if (var == nullptr || !var->IsType<phi::DenseTensor>()) {
+      continue;
+    }
+    const auto &tensor = var->Get<phi::DenseTensor>();
+    if (tensor.initialized() && platform::is_cpu_place(tensor.place())) {
+      cache.MarkConstant(tensor);
+    }
+  }
+}
+
+// A pass is deleted by the pass tuning only if the sample inputs run faster
+// than this ratio of the time with it, which filters out the noise.
+constexpr double kPassTuningGain = 0.97;
+
+// Returns the median time in ms to run the sample inputs filled with ones by
+// the predictor of config, or -1 if it fails.
+double TimeSampleInputs(const AnalysisConfig &config,
+                        const std::map<std::string, std::vector<int>> &shapes,
+                        int repeat) {
+  try {
+    auto predictor =
+        CreatePaddlePredictor<AnalysisConfig, PaddleEngineKind::kAnalysis>(
+            config);
+    if (predictor == nullptr) {
+      return -1;
+    }
+    auto input_types = predictor->GetInputTypes();
+    for (const auto &it : shapes) {
+      auto tensor = predictor->GetInputTensor(it.first);
+      tensor->Reshape(it.second);
+      size_t numel = std::accumulate(it.second.begin(),
+                                     it.second.end(),
+                                     static_cast<int64_t>(1),
+                                     std::multiplies<int64_t>());
+      switch (input_types[it.first]) {
+        case paddle_infer::DataType::FLOAT32:
+          tensor->CopyFromCpu(std::vector<float>(numel, 1).data());
+          break;
+        case paddle_infer::DataType::INT64:
+          tensor->CopyFromCpu(std::vector<int64_t>(numel, 1).data());
+          break;
+        case paddle_infer::DataType::INT32:
+          tensor->CopyFromCpu(std::vector<int32_t>(numel, 1).data());
+          break;
+        default:
+          LOG(WARNING) << "The input " << it.first
+                       << " is not float32, int64 or int32, which is not "
+                          "supported by the pass tuning.";
+          return -1;
+      }
+    }
+    std::vector<double> times;
+    inference::Timer timer;
+    // The first run warms up the kernels.
+    for (int i = 0; i <= repeat; ++i) {
+      timer.tic();
+      if (!predictor->ZeroCopyRun()) {
+        return -1;
+      }
+      if (i > 0) {
+        times.push_back(timer.toc());
+      }
+    }
+    std::nth_element(
+        times.begin(), times.begin() + times.size() / 2, times.end());
+    return times[times.size() / 2];
+  } catch (const std::exception &e) {
+    LOG(WARNING) << "Failed to run the sample inputs: " << e.what();
+    return -1;
+  }
+}
 }  // namespace
 
 bool PaddleTensorToLoDTensor(const PaddleTensor &pt,
@@ -267,6 +396,12 @@ bool AnalysisPredictor::Init(
     root_predictor_id_ = predictor_id_;
   }
 
+  if (platform::IsMetricsEnabled()) {
+    GetPredictorRequestMetrics("Run", &run_requests_, &run_latency_);
+    GetPredictorRequestMetrics(
+        "ZeroCopyRun", &zero_copy_run_requests_, &zero_copy_run_latency_);
+  }
+
   // no matter with or without MKLDNN
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
 
@@ -313,6 +448,9 @@ bool AnalysisPredictor::Init(
     }
   }
 #endif
+  if (config_.shape_bucket_enabled()) {
+    PrepareShapeBuckets();
+  }
   inference::DisplayMemoryInfo(place_, "Init predictor");
   return true;
 }
@@ -547,6 +685,12 @@ bool AnalysisPredictor::PrepareProgram(
     // not be executed.
     model_precision_ =
         paddle::inference::GetModelPrecision(*inference_program_);
+    if (config_.pass_tuning_enabled() && config_.ir_optim()) {
+      TunePasses();
+    }
+    if (config_.lazy_load_params_enabled()) {
+      PrepareLazyParams();
+    }
     OptimizeInferenceProgram();
   } else {
     // If the program is passed from external, no need to optimize it, this
@@ -632,6 +776,24 @@ bool AnalysisPredictor::PrepareExecutor() {
   PADDLE_ENFORCE_NOT_NULL(sub_scope_,
                           platform::errors::PreconditionNotMet(
                               "The sub_scope should not be nullptr."));
+  if (!lazy_params_) {
+    MarkConstantParameters(*inference_program_, *sub_scope_);
+    return true;
+  }
+
+  // The parameters are marked constant by the loader when they are loaded.
+  executor_->RegisterInputHook([this](framework::OperatorBase *op) {
+    lazy_params_->LoadFor(*op, *sub_scope_);
+  });
+  if (!status_is_cloned_ && config_.lazy_load_params_prefetch_) {
+    std::vector<std::string> order;
+    for (auto *op : inference_program_->Block(0).AllOps()) {
+      for (const auto &name : op->InputArgumentNames()) {
+        order.push_back(name);
+      }
+    }
+    lazy_params_->StartPrefetch(order);
+  }
 
   return true;
 }
@@ -929,9 +1091,17 @@ void AnalysisPredictor::MkldnnPostReset() {
 bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
                             std::vector<PaddleTensor> *output_data,
                             int batch_size) {
+  platform::ScopedLatencyRecorder latency_recorder(
+      RecordPredictorRequest(run_requests_, run_latency_));
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  std::vector<PaddleTensor> bucket_inputs;
+  if (!shape_buckets_.empty()) {
+    bucket_inputs = inputs;
+    PadToShapeBucket(&bucket_inputs);
+  }
+  const auto &feed_inputs = shape_buckets_.empty() ? inputs : bucket_inputs;
 #ifdef PADDLE_WITH_MKLDNN
-  if (config_.use_mkldnn_) MkldnnPreSet(inputs);
+  if (config_.use_mkldnn_) MkldnnPreSet(feed_inputs);
 #endif
   VLOG(3) << "Predictor::predict";
   inference::Timer timer;
@@ -941,7 +1111,7 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
   PADDLE_ENFORCE_NOT_NULL(
       scope,
       platform::errors::PreconditionNotMet("The scope should not be nullptr."));
-  if (!SetFeed(inputs, scope)) {
+  if (!SetFeed(feed_inputs, scope)) {
     LOG(ERROR) << "fail to set feed";
     return false;
   }
@@ -1107,7 +1277,8 @@ void AnalysisPredictor::PrepareArgument() {
     argument_.SetModelParamsPath(config_.params_file());
   }
   // For JITLayer
-  argument_.SetSkipLoadParams(config_.skip_load_params_);
+  argument_.SetSkipLoadParams(config_.skip_load_params_ ||
+                              lazy_params_ != nullptr);
 
   argument_.SetTensorRtPrecisionMode(config_.tensorrt_precision_mode_);
   argument_.SetTensorRtUseOSS(config_.trt_use_varseqlen_);
@@ -1670,6 +1841,8 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetOutputTensor(
 }
 
 bool AnalysisPredictor::ZeroCopyRun() {
+  platform::ScopedLatencyRecorder latency_recorder(
+      RecordPredictorRequest(zero_copy_run_requests_, zero_copy_run_latency_));
   inference::DisplayMemoryInfo(place_, "before run");
 #if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_PSCORE)
   if (config_.dist_config().use_dist_model()) {
@@ -1686,6 +1859,9 @@ bool AnalysisPredictor::ZeroCopyRun() {
     paddle::platform::DeviceContextPool::SetDeviceContexts(&device_contexts_);
   }
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  if (!shape_buckets_.empty()) {
+    PadToShapeBucket(executor_->GetScope());
+  }
 #ifdef PADDLE_WITH_MKLDNN
   if (config_.use_mkldnn_) {
     std::vector<std::vector<int>> shape_vector;
@@ -1886,6 +2062,272 @@ void AnalysisPredictor::StatisticShapeRangeInfo() {
                                      opt_values);
 }
 
+void AnalysisPredictor::PrepareShapeBuckets() {
+  PADDLE_ENFORCE_EQ(platform::is_cpu_place(place_),
+                    true,
+                    platform::errors::Unimplemented(
+                        "The shape buckets are only supported on CPU."));
+  if (config_.shape_bucket_info_path_.empty()) {
+    shape_buckets_ = config_.shape_buckets_;
+  } else {
+    std::map<std::string, std::vector<int32_t>> min_shape;
+    std::map<std::string, std::vector<int32_t>> max_shape;
+    std::map<std::string, std::vector<int32_t>> opt_shape;
+    std::map<std::string, std::vector<int32_t>> min_value;
+    std::map<std::string, std::vector<int32_t>> max_value;
+    std::map<std::string, std::vector<int32_t>> opt_value;
+    inference::DeserializeShapeRangeInfo(config_.shape_bucket_info_path_,
+                                         &min_shape,
+                                         &max_shape,
+                                         &opt_shape,
+                                         &min_value,
+                                         &max_value,
+                                         &opt_value);
+    shape_buckets_ = inference::LearnShapeBuckets(
+        min_shape, max_shape, GetInputNames(), config_.shape_bucket_num_);
+  }
+  for (const auto &bucket : shape_buckets_) {
+    for (const auto &it : bucket) {
+      PADDLE_ENFORCE_NE(feed_names_.find(it.first),
+                        feed_names_.end(),
+                        platform::errors::InvalidArgument(
+                            "The input %s of the shape bucket is not an input "
+                            "of the model.",
+                            it.first));
+    }
+  }
+  inference::SortShapeBuckets(&shape_buckets_);
+  VLOG(3) << "Use " << shape_buckets_.size() << " shape buckets.";
+#ifdef PADDLE_WITH_MKLDNN
+  // Keep the oneDNN primitives of all the buckets in cache clearing mode.
+  int num_buckets = shape_buckets_.size();
+  if (config_.use_mkldnn_ && config_.mkldnn_cache_capacity_ > 0 &&
+      config_.mkldnn_cache_capacity_ < num_buckets) {
+    config_.mkldnn_cache_capacity_ = num_buckets;
+  }
+#endif
+  if (config_.shape_bucket_warmup_) {
+    WarmUpShapeBuckets();
+  }
+}
+
+void AnalysisPredictor::WarmUpShapeBuckets() {
+  framework::Scope *scope = sub_scope_ ? sub_scope_ : scope_.get();
+  feed_tensors_.resize(feeds_.size());
+  for (const auto &bucket : shape_buckets_) {
+    std::vector<std::vector<int>> inputs_shape;
+    for (size_t i = 0; i < feeds_.size(); ++i) {
+      const auto &name = idx2feeds_[i];
+      auto it = bucket.find(name);
+      if (it == bucket.end()) {
+        LOG(WARNING) << "The shape buckets are not warmed up, since the input "
+                     << name << " is not in the buckets.";
+        return;
+      }
+      auto dtype = framework::TransToPhiDataType(
+          inference_program_->Block(0).FindVar(name)->GetDataType());
+      phi::DenseTensor *tensor =
+          config_.use_feed_fetch_ops_
+              ? &feed_tensors_[i]
+              : scope->Var(name)->GetMutable<phi::DenseTensor>();
+      tensor->Resize(phi::make_ddim(it->second));
+      void *data = tensor->mutable_data(place_, dtype);
+      std::memset(data, 0, tensor->numel() * phi::SizeOf(dtype));
+      if (config_.use_feed_fetch_ops_) {
+        framework::SetFeedVariable(scope, *tensor, "feed", i);
+      }
+      inputs_shape.push_back(it->second);
+    }
+#ifdef PADDLE_WITH_MKLDNN
+    if (config_.use_mkldnn_) MkldnnPreSet(inputs_shape);
+#endif
+    executor_->Run();
+#ifdef PADDLE_WITH_MKLDNN
+    if (config_.use_mkldnn_) MkldnnPostReset();
+#endif
+  }
+  VLOG(3) << "Warmed up " << shape_buckets_.size() << " shape buckets.";
+}
+
+void AnalysisPredictor::PadToShapeBucket(framework::Scope *scope) {
+  inference::ShapeBucket shapes;
+  for (const auto &it : feed_names_) {
+    auto *var = scope->FindVar(it.first);
+    if (var != nullptr && var->IsType<phi::DenseTensor>()) {
+      const auto &dims = var->Get<phi::DenseTensor>().dims();
+      shapes[it.first] = phi::vectorize<int>(dims);
+    }
+  }
+  int index = inference::FindShapeBucket(shape_buckets_, shapes);
+  PADDLE_ENFORCE_GE(index,
+                    0,
+                    platform::errors::InvalidArgument(
+                        "The shapes of the inputs do not fit in any of the "
+                        "shape buckets."));
+  for (const auto &it : shape_buckets_[index]) {
+    if (shapes[it.first] == it.second) {
+      continue;
+    }
+    auto *tensor = scope->FindVar(it.first)->GetMutable<phi::DenseTensor>();
+    PADDLE_ENFORCE_EQ(
+        tensor->lod().empty() && platform::is_cpu_place(tensor->place()),
+        true,
+        platform::errors::InvalidArgument(
+            "The input %s padded to the shape bucket should be a CPU tensor "
+            "without LoD.",
+            it.first));
+    phi::DenseTensor padded;
+    padded.Resize(phi::make_ddim(it.second));
+    void *data = padded.mutable_data(place_, tensor->dtype());
+    size_t elem_size = phi::SizeOf(tensor->dtype());
+    std::memset(data, 0, padded.numel() * elem_size);
+    inference::PadToShape(
+        tensor->data(), shapes[it.first], data, it.second, elem_size);
+    tensor->ShareDataWith(padded);
+  }
+}
+
+void AnalysisPredictor::PadToShapeBucket(std::vector<PaddleTensor> *inputs) {
+  inference::ShapeBucket shapes;
+  std::vector<std::string> names;
+  for (size_t i = 0; i < inputs->size(); ++i) {
+    names.push_back(config_.specify_input_name_ ? inputs->at(i).name
+                                                : idx2feeds_[i]);
+    shapes[names.back()] = inputs->at(i).shape;
+  }
+  int index = inference::FindShapeBucket(shape_buckets_, shapes);
+  PADDLE_ENFORCE_GE(index,
+                    0,
+                    platform::errors::InvalidArgument(
+                        "The shapes of the inputs do not fit in any of the "
+                        "shape buckets."));
+  const auto &bucket = shape_buckets_[index];
+  for (size_t i = 0; i < inputs->size(); ++i) {
+    auto it = bucket.find(names[i]);
+    auto &input = inputs->at(i);
+    if (it == bucket.end() || input.shape == it->second) {
+      continue;
+    }
+    PADDLE_ENFORCE_EQ(input.lod.empty(),
+                      true,
+                      platform::errors::InvalidArgument(
+                          "The input %s padded to the shape bucket should not "
+                          "have LoD.",
+                          names[i]));
+    PaddleTensor padded;
+    padded.name = input.name;
+    padded.dtype = input.dtype;
+    padded.shape = it->second;
+    size_t elem_size = PaddleDtypeSize(input.dtype);
+    padded.data.Resize(inference::VecReduceToInt(it->second) * elem_size);
+    std::memset(padded.data.data(), 0, padded.data.length());
+    inference::PadToShape(input.data.data(),
+                          input.shape,
+                          padded.data.data(),
+                          it->second,
+                          elem_size);
+    input = std::move(padded);
+  }
+}
+
+void AnalysisPredictor::TunePasses() {
+  if (config_.tensorrt_engine_enabled()) {
+    LOG(WARNING) << "The passes are not tuned with TensorRT.";
+    return;
+  }
+  auto *pass_builder = config_.pass_builder();
+  const auto &all_passes = pass_builder->AllPasses();
+  std::vector<std::string> candidates;
+  for (const auto &pass : all_passes) {
+    if (config_.pass_tuning_candidates_.empty()
+            ? pass.find("fuse") != std::string::npos
+            : std::count(config_.pass_tuning_candidates_.begin(),
+                         config_.pass_tuning_candidates_.end(),
+                         pass) > 0) {
+      candidates.push_back(pass);
+    }
+  }
+  if (candidates.empty()) {
+    return;
+  }
+
+  // The choice is saved with the candidates, the sample shapes and the host
+  // CPU, and is tuned again if any of them changes, e.g. the model dir is
+  // shared by hosts of different CPUs.
+  std::string key = "passes:";
+  for (const auto &pass : candidates) {
+    key += " " + pass;
+  }
+  key += " shapes:";
+  for (const auto &it : config_.pass_tuning_shapes_) {
+    key += " " + it.first;
+    for (int dim : it.second) {
+      key += "," + std::to_string(dim);
+    }
+  }
+  key += " cpu: " + platform::CpuIdentity();
+  std::string cache_path;
+  if (!config_.model_from_memory()) {
+    std::string cache_dir = config_.opt_cache_dir_;
+    if (cache_dir.empty()) {
+      cache_dir = inference::analysis::GetOrCreateModelOptCacheDir(
+          config_.model_dir().empty()
+              ? inference::analysis::GetDirRoot(config_.prog_file())
+              : config_.model_dir());
+    } else {
+      inference::analysis::MakeDirIfNotExists(cache_dir);
+    }
+    cache_path = cache_dir + "/pass_tuning.txt";
+  }
+  if (!cache_path.empty() && inference::analysis::FileExists(cache_path)) {
+    std::ifstream fin(cache_path);
+    std::string line;
+    if (std::getline(fin, line) && line == key) {
+      while (std::getline(fin, line)) {
+        if (!line.empty()) {
+          LOG(INFO) << "Delete the tuned pass " << line;
+          pass_builder->DeletePass(line);
+        }
+      }
+      return;
+    }
+  }
+
+  LOG(INFO) << "Tune " << candidates.size() << " passes on the sample inputs";
+  AnalysisConfig config(config_);
+  config.use_pass_tuning_ = false;
+  double best_time = TimeSampleInputs(
+      config, config_.pass_tuning_shapes_, config_.pass_tuning_repeat_);
+  if (best_time < 0) {
+    LOG(WARNING) << "The passes are not tuned.";
+    return;
+  }
+  std::vector<std::string> deleted;
+  for (const auto &pass : candidates) {
+    AnalysisConfig trial(config);
+    trial.pass_builder()->DeletePass(pass);
+    double time = TimeSampleInputs(
+        trial, config_.pass_tuning_shapes_, config_.pass_tuning_repeat_);
+    VLOG(3) << "The sample inputs run in " << time << " ms without " << pass
+            << ", and in " << best_time << " ms with it.";
+    if (time >= 0 && time < best_time * kPassTuningGain) {
+      LOG(INFO) << "Delete the pass " << pass << ", which takes the time from "
+                << best_time << " ms to " << time << " ms";
+      config.pass_builder()->DeletePass(pass);
+      pass_builder->DeletePass(pass);
+      deleted.push_back(pass);
+      best_time = time;
+    }
+  }
+  if (!cache_path.empty()) {
+    std::ofstream fout(cache_path);
+    fout << key << "\n";
+    for (const auto &pass : deleted) {
+      fout << pass << "\n";
+    }
+  }
+}
+
 bool AnalysisPredictor::LoadProgramDesc() {
   // Initialize the inference program
   std::string filename;
@@ -1935,6 +2377,36 @@ bool AnalysisPredictor::LoadProgramDesc() {
   return true;
 }
 
+void AnalysisPredictor::PrepareLazyParams() {
+  // The fuse passes rewrite the parameters and ir_params_sync_among_devices
+  // copies them to the device at load time, so both need them loaded.
+  if (config_.ir_optim() || !platform::is_cpu_place(place_) ||
+      config_.model_from_memory() || !config_.model_dir().empty() ||
+      config_.params_file().empty() ||
+      config_.dist_config().use_dist_model()) {
+    LOG(WARNING) << "The parameters can be loaded lazily only from the "
+                    "combined params file on CPU with ir_optim off, so they "
+                    "are loaded at load time.";
+    return;
+  }
+  // The warm-up of the shape buckets runs the whole program in Init.
+  if (config_.shape_bucket_enabled() && config_.shape_bucket_warmup_) {
+    LOG(WARNING) << "The shape buckets are warmed up with all the parameters, "
+                    "so they are loaded at load time instead of lazily.";
+    return;
+  }
+  lazy_params_ = inference::LazyParamLoader::Create(
+      *inference_program_, config_.params_file(), scope_);
+  if (!lazy_params_) {
+    LOG(WARNING) << "The parameters in " << config_.params_file()
+                 << " can not be loaded lazily, so they are loaded at load "
+                    "time.";
+    return;
+  }
+  LOG(INFO) << "Load " << lazy_params_->Size() << " parameters lazily from "
+            << config_.params_file();
+}
+
 bool AnalysisPredictor::LoadParameters() {
   PADDLE_ENFORCE_NOT_NULL(inference_program_.get(),
                           platform::errors::PreconditionNotMet(
@@ -2140,6 +2612,7 @@ std::unique_ptr<PaddlePredictor> AnalysisPredictor::Clone(void *stream) {
         "function has received a stream parameter."));
   }
   x->predictor_stream_ = stream;
+  x->lazy_params_ = lazy_params_;
   x->Init(scope_, inference_program_);
 #ifdef PADDLE_WITH_TENSORRT
   x->executor_->ResetTrtOps(++AnalysisPredictor::clone_num_);
@@ -2153,6 +2626,9 @@ std::string AnalysisPredictor::GetSerializedProgram() const {
 
 // Add SaveOptimModel
 void AnalysisPredictor::SaveOptimModel(const std::string &dir) {
+  if (lazy_params_) {
+    lazy_params_->LoadAll();
+  }
   // save model
   std::string model_name = dir + "/model";
   std::ofstream outfile;
@@ -2355,6 +2831,150 @@ USE_TRT_CONVERTER(sparse_multihead_matmul)
 
 namespace paddle_infer {
 
+namespace {
+// The worker threads shared by the async runs of all the predictors. It is
+// never destroyed, so that the runs queued at exit do not outlive it.
+paddle::framework::ThreadPool *AsyncRunThreadPool() {
+  static auto *pool = new paddle::framework::ThreadPool(
+      std::max(1U, std::thread::hardware_concurrency()));
+  return pool;
+}
+
+// The queue whose request is being run by the thread.
+thread_local AsyncRunQueue *running_async_queue = nullptr;
+}  // namespace
+
+// The queue of the requests of RunAsync, which are run by at most
+// max_runners runners on AsyncRunThreadPool. A runner keeps running the
+// queued requests with the same predictor until the queue is empty, so that
+// the consecutive requests are pipelined without returning to the callers.
+class AsyncRunQueue {
+ public:
+  // The runner should call Drain with its predictor until Exit returns true,
+  // and must not touch the queue after that.
+  using Runner = std::function<void(AsyncRunQueue *)>;
+
+  AsyncRunQueue(size_t max_runners, Runner runner)
+      : max_runners_(max_runners), runner_(std::move(runner)) {}
+
+  // Waits for the queued requests. It must not be called by the callbacks of
+  // the requests, see DestroyOnExit.
+  ~AsyncRunQueue() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return num_runners_ == 0; });
+  }
+
+  void Push(Predictor::AsyncFeedFunc feed, Predictor::AsyncDoneFunc done) {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      requests_.emplace_back(std::move(feed), std::move(done));
+      if (num_runners_ >= max_runners_) {
+        return;
+      }
+      num_runners_++;
+    }
+    Runner runner = runner_;
+    AsyncRunThreadPool()->Run([this, runner] { runner(this); });
+  }
+
+  // Run the queued requests with `pred`. If it is nullptr, the requests fail
+  // without running, and `done` is called with false and nullptr.
+  void Drain(Predictor *pred) {
+    while (true) {
+      Request request;
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (destroy_on_exit_ || requests_.empty()) {
+          return;
+        }
+        request = std::move(requests_.front());
+        requests_.pop_front();
+      }
+      AsyncRunQueue *running = running_async_queue;
+      running_async_queue = this;
+      RunRequest(pred, request);
+      running_async_queue = running;
+    }
+  }
+
+  // Returns false if some requests are queued after Drain returned.
+  bool Exit() {
+    bool destroy = false;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (!destroy_on_exit_ && !requests_.empty()) {
+        return false;
+      }
+      if (!requests_.empty()) {
+        LOG(WARNING) << "Drop " << requests_.size()
+                     << " async runs queued after the predictor is destroyed.";
+      }
+      num_runners_--;
+      idle_.notify_all();
+      destroy = destroy_on_exit_ && num_runners_ == 0;
+    }
+    if (destroy) {
+      delete this;
+    }
+    return true;
+  }
+
+  // Whether the thread is running a request of the queue, such as when the
+  // owner of the queue is destroyed by the done callback.
+  bool InCallback() const { return running_async_queue == this; }
+
+  // Called by the owner with a single runner in its destructor instead of
+  // destroying the queue when InCallback, which would wait for the runner
+  // calling it. The runner stops running the queued requests, which are
+  // dropped, and destroys the queue when it exits.
+  void DestroyOnExit() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    destroy_on_exit_ = true;
+  }
+
+ private:
+  using Request = std::pair<Predictor::AsyncFeedFunc, Predictor::AsyncDoneFunc>;
+
+  static void RunRequest(Predictor *pred, const Request &request) {
+    bool success = false;
+    try {
+      if (pred != nullptr) {
+        if (request.first) {
+          request.first(pred);
+        }
+        success = pred->Run();
+      }
+    } catch (const std::exception &e) {
+      LOG(ERROR) << "Failed to run the predictor asynchronously: " << e.what();
+    }
+    try {
+      if (request.second) {
+        request.second(success, pred);
+      }
+    } catch (const std::exception &e) {
+      LOG(ERROR) << "The callback of the async run throws: " << e.what();
+    }
+  }
+
+  const size_t max_runners_;
+  const Runner runner_;
+  std::mutex mutex_;
+  std::condition_variable idle_;
+  std::deque<Request> requests_;
+  size_t num_runners_{0};
+  bool destroy_on_exit_{false};
+};
+
+Predictor::Predictor(std::unique_ptr<paddle::PaddlePredictor> &&pred)
+    : predictor_(std::move(pred)) {}
+
+Predictor::~Predictor() {
+  if (async_queue_ != nullptr && async_queue_->InCallback()) {
+    async_queue_.release()->DestroyOnExit();
+  }
+  async_queue_.reset();
+}
+
 Predictor::Predictor(const Config &config) {
   const_cast<Config *>(&config)->SwitchUseFeedFetchOps(false);
   // The second parameter indicates that the discard log is not printed
@@ -2409,6 +3029,25 @@ std::unique_ptr<Tensor> Predictor::GetOutputHandle(const std::string &name) {
 
 bool Predictor::Run() { return predictor_->ZeroCopyRun(); }
 
+void Predictor::RunAsync(AsyncFeedFunc feed, AsyncDoneFunc done) {
+  std::call_once(async_once_, [this] {
+    async_queue_.reset(new AsyncRunQueue(1, [this](AsyncRunQueue *queue) {
+      do {
+        queue->Drain(this);
+      } while (!queue->Exit());
+    }));
+  });
+  async_queue_->Push(std::move(feed), std::move(done));
+}
+
+std::future<bool> Predictor::RunAsync() {
+  auto promise = std::make_shared<std::promise<bool>>();
+  RunAsync(nullptr, [promise](bool success, Predictor *) {
+    promise->set_value(success);
+  });
+  return promise->get_future();
+}
+
 std::unique_ptr<Predictor> Predictor::Clone(void *stream) {
   auto analysis_pred = predictor_->Clone(stream);
   std::unique_ptr<Predictor> pred(new Predictor(std::move(analysis_pred)));
@@ -2494,25 +3133,77 @@ std::shared_ptr<Predictor> CreatePredictor(const Config &config) {  // NOLINT
 }
 
 namespace services {
-PredictorPool::PredictorPool(const Config &config, size_t size) {
+namespace {
+// The states of the slots of PredictorPool.
+constexpr int kSlotEmpty = 0;
+constexpr int kSlotIdle = 1;
+constexpr int kSlotLeased = 2;
+// After every kPoolResizeWindow leases are returned, the pool shrinks to the
+// peak number of the concurrent leases in the window.
+constexpr size_t kPoolResizeWindow = 1024;
+}  // namespace
+
+struct PredictorPool::Slot {
+  std::atomic<int> state{kSlotEmpty};
+  Predictor *pred{nullptr};
+  // The predictors grown by Acquire are owned by their slots.
+  std::unique_ptr<Predictor> owned;
+};
+
+PredictorPool::PredictorPool(const Config &config, size_t size)
+    : PredictorPool(config, size, size) {}
+
+PredictorPool::PredictorPool(const Config &config,
+                             size_t size,
+                             size_t max_size,
+                             bool release_idle_memory)
+    : config_(config),
+      min_size_(size),
+      release_idle_memory_(release_idle_memory) {
   PADDLE_ENFORCE_GE(
       size,
       1UL,
       paddle::platform::errors::InvalidArgument(
           "The predictor pool size should be greater than 1, but it's (%d)",
           size));
-  Config copy_config(config);
+  PADDLE_ENFORCE_GE(
+      max_size,
+      size,
+      paddle::platform::errors::InvalidArgument(
+          "The max size (%d) of the predictor pool should not be less than "
+          "its size (%d)",
+          max_size,
+          size));
   main_pred_.reset(new Predictor(config));
   for (size_t i = 0; i < size - 1; i++) {
-    if (config.tensorrt_engine_enabled()) {
-      Config config_tmp(copy_config);
-      preds_.emplace_back(new Predictor(config_tmp));
-    } else {
-      preds_.emplace_back(main_pred_->Clone());
+    preds_.emplace_back(NewPredictor());
+  }
+  for (size_t i = 0; i < max_size; i++) {
+    slots_.emplace_back(new Slot);
+    if (i < size) {
+      slots_[i]->pred = i == 0 ? main_pred_.get() : preds_[i - 1].get();
+      slots_[i]->state.store(kSlotIdle);
     }
   }
 }
 
+PredictorPool::~PredictorPool() {
+  if (async_queue_ != nullptr && async_queue_->InCallback()) {
+    // The other runners still use the leased predictors of the pool.
+    LOG(FATAL) << "The predictor pool can not be destroyed in the callbacks "
+                  "of its RunAsync.";
+  }
+  async_queue_.reset();
+}
+
+std::unique_ptr<Predictor> PredictorPool::NewPredictor() {
+  if (config_.tensorrt_engine_enabled()) {
+    Config config_tmp(config_);
+    return std::unique_ptr<Predictor>(new Predictor(config_tmp));
+  }
+  return main_pred_->Clone();
+}
+
 Predictor *PredictorPool::Retrive(size_t idx) {
   PADDLE_ENFORCE_LT(
       idx,
@@ -2526,6 +3217,139 @@ Predictor *PredictorPool::Retrive(size_t idx) {
   }
   return preds_[idx - 1].get();
 }
+
+PredictorPool::Lease::Lease(PredictorPool *pool, size_t idx, Predictor *pred)
+    : pool_(pool), idx_(idx), pred_(pred) {}
+
+PredictorPool::Lease::Lease(Lease &&other)
+    : pool_(other.pool_), idx_(other.idx_), pred_(other.pred_) {
+  other.pool_ = nullptr;
+  other.pred_ = nullptr;
+}
+
+PredictorPool::Lease::~Lease() {
+  if (pool_ != nullptr) {
+    pool_->Release(idx_);
+  }
+}
+
+PredictorPool::Lease PredictorPool::Acquire() {
+  size_t leased = num_leased_.fetch_add(1) + 1;
+  size_t peak = peak_leased_.load();
+  while (peak < leased && !peak_leased_.compare_exchange_weak(peak, leased)) {
+  }
+  while (true) {
+    // The idle predictors are leased without locking.
+    for (size_t i = 0; i < slots_.size(); i++) {
+      int state = kSlotIdle;
+      if (slots_[i]->state.compare_exchange_strong(state, kSlotLeased)) {
+        return Lease(this, i, slots_[i]->pred);
+      }
+    }
+    {
+      std::lock_guard<std::mutex> guard(resize_mutex_);
+      for (size_t i = min_size_; i < slots_.size(); i++) {
+        auto &slot = *slots_[i];
+        if (slot.state.load() == kSlotEmpty) {
+          try {
+            slot.owned = NewPredictor();
+          } catch (...) {
+            num_leased_.fetch_sub(1);
+            throw;
+          }
+          slot.pred = slot.owned.get();
+          slot.state.store(kSlotLeased);
+          VLOG(3) << "The predictor pool grows to " << Size() << " predictors.";
+          return Lease(this, i, slot.pred);
+        }
+      }
+    }
+    std::unique_lock<std::mutex> lock(idle_mutex_);
+    idle_cv_.wait(lock, [this] { return HasFreeSlot(); });
+  }
+}
+
+bool PredictorPool::HasFreeSlot() const {
+  for (const auto &slot : slots_) {
+    if (slot->state.load() != kSlotLeased) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void PredictorPool::Release(size_t idx) {
+  auto &slot = *slots_[idx];
+  if (release_idle_memory_) {
+    slot.pred->ClearIntermediateTensor();
+  }
+  slot.state.store(kSlotIdle);
+  num_leased_.fetch_sub(1);
+  {
+    // Locked, so that the waiting Acquire does not miss the idle slot
+    // between checking the slots and waiting.
+    std::lock_guard<std::mutex> guard(idle_mutex_);
+  }
+  idle_cv_.notify_one();
+  if ((num_released_.fetch_add(1) + 1) % kPoolResizeWindow == 0) {
+    Shrink();
+  }
+}
+
+void PredictorPool::Shrink() {
+  std::lock_guard<std::mutex> guard(resize_mutex_);
+  size_t target = std::max(min_size_, peak_leased_.exchange(num_leased_));
+  size_t size = Size();
+  for (size_t i = slots_.size(); i > min_size_ && size > target; i--) {
+    auto &slot = *slots_[i - 1];
+    int state = kSlotIdle;
+    // Lease the idle predictor, so that it is not leased while destroyed.
+    if (slot.state.compare_exchange_strong(state, kSlotLeased)) {
+      slot.pred = nullptr;
+      slot.owned.reset();
+      slot.state.store(kSlotEmpty);
+      size--;
+    }
+  }
+  // Acquire may wait while the shrunk slots are leased above, and grows the
+  // predictors in them once they are empty.
+  {
+    std::lock_guard<std::mutex> guard(idle_mutex_);
+  }
+  idle_cv_.notify_all();
+  VLOG(3) << "The predictor pool shrinks to " << size << " predictors.";
+}
+
+void PredictorPool::RunAsync(Predictor::AsyncFeedFunc feed,
+                             Predictor::AsyncDoneFunc done) {
+  std::call_once(async_once_, [this] {
+    async_queue_.reset(
+        new AsyncRunQueue(slots_.size(), [this](AsyncRunQueue *queue) {
+          do {
+            // Acquire throws if the pool fails to grow, and then the queued
+            // requests fail rather than leaving the runner without exiting.
+            try {
+              auto lease = Acquire();
+              queue->Drain(lease.get());
+            } catch (const std::exception &e) {
+              LOG(ERROR) << "Failed to acquire a predictor: " << e.what();
+              queue->Drain(nullptr);
+            }
+          } while (!queue->Exit());
+        }));
+  });
+  async_queue_->Push(std::move(feed), std::move(done));
+}
+
+size_t PredictorPool::Size() const {
+  size_t size = 0;
+  for (const auto &slot : slots_) {
+    if (slot->state.load() != kSlotEmpty) {
+      size++;
+    }
+  }
+  return size;
+}
 }  // namespace services
 
 namespace experimental {
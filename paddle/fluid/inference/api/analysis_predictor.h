@@ -28,10 +28,13 @@
 #include "paddle/fluid/inference/api/api_impl.h"
 #include "paddle/fluid/inference/api/details/reset_tensor_array.h"
 #include "paddle/fluid/inference/api/helper.h"
+#include "paddle/fluid/inference/api/lazy_param_loader.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/api/resource_manager.h"
+#include "paddle/fluid/inference/api/shape_bucket.h"
 #include "paddle/fluid/platform/device/gpu/gpu_types.h"
 #include "paddle/fluid/platform/float16.h"
+#include "paddle/fluid/platform/metrics_exporter.h"
 #include "paddle/fluid/string/printf.h"
 #ifdef PADDLE_WITH_TESTING
 #include <gtest/gtest.h>
@@ -420,6 +423,7 @@ class AnalysisPredictor : public PaddlePredictor {
   FRIEND_TEST(AnalysisPredictor, analysis_off);
   FRIEND_TEST(AnalysisPredictor, analysis_on);
   FRIEND_TEST(AnalysisPredictor, with_gpu);
+  FRIEND_TEST(AnalysisPredictor, LazyLoadParams);
 #endif
 
  protected:
@@ -429,6 +433,43 @@ class AnalysisPredictor : public PaddlePredictor {
   void StatisticShapeRangeInfo();
   void CollectShapeRangeInfo();
 
+  ///
+  /// \brief Prepare the shape buckets of the inputs, and warm them up if
+  /// needed.
+  ///
+  /// Used in AnalysisPredictor::Init().
+  ///
+  void PrepareShapeBuckets();
+  ///
+  /// \brief Delete the candidate passes which slow down the sample inputs
+  /// from the pass builder, or the ones saved by the earlier tuning of the
+  /// model.
+  ///
+  /// Used in AnalysisPredictor::PrepareProgram().
+  ///
+  void TunePasses();
+  ///
+  /// \brief Index the parameters in the params file to load them on first
+  /// use, if the config enables it and the model supports it.
+  ///
+  /// Used in AnalysisPredictor::PrepareProgram().
+  ///
+  void PrepareLazyParams();
+  ///
+  /// \brief Run the program with zeros of the shapes of every bucket, which
+  /// creates the kernels and oneDNN primitives of the shapes.
+  ///
+  void WarmUpShapeBuckets();
+  ///
+  /// \brief Pad the inputs in the scope to the nearest shape bucket, used in
+  /// ZeroCopyRun().
+  ///
+  void PadToShapeBucket(framework::Scope *scope);
+  ///
+  /// \brief Pad the inputs to the nearest shape bucket, used in Run().
+  ///
+  void PadToShapeBucket(std::vector<PaddleTensor> *inputs);
+
   void InitPlace();
   void InitDeviceContexts();
   void InitResourceManager(void *stream);
@@ -489,6 +530,9 @@ class AnalysisPredictor : public PaddlePredictor {
   platform::Place place_;
   std::shared_ptr<framework::Scope> scope_;
   framework::Scope *sub_scope_{nullptr};
+  // Not nullptr if the parameters are loaded on first use, and shared by the
+  // clones.
+  std::shared_ptr<inference::LazyParamLoader> lazy_params_;
   std::shared_ptr<framework::ProgramDesc> inference_program_;
   framework::OpCompatibleMap op_compatible_map_;
   std::vector<framework::OpDesc *> feeds_;
@@ -523,6 +567,12 @@ class AnalysisPredictor : public PaddlePredictor {
   std::vector<std::map<std::string, std::vector<int>>> batch_var_shapes_;
   int predictor_id_;
   int root_predictor_id_{-1};
+  // The request metrics of Run and ZeroCopyRun, resolved in Init if
+  // FLAGS_enable_metrics is set, so that a request only touches atomics.
+  platform::MetricCounter *run_requests_{nullptr};
+  platform::MetricHistogram *run_latency_{nullptr};
+  platform::MetricCounter *zero_copy_run_requests_{nullptr};
+  platform::MetricHistogram *zero_copy_run_latency_{nullptr};
 
  private:
   std::vector<Exp_OutputHookFunc> hookfuncs_;
@@ -532,6 +582,8 @@ class AnalysisPredictor : public PaddlePredictor {
 
   std::map<std::string, std::vector<std::vector<int32_t>>> shape_info_;
   std::map<std::string, std::vector<std::vector<int32_t>>> shape_tensor_value_;
+  // Sorted from the smallest, empty if the shape buckets are not used.
+  std::vector<inference::ShapeBucket> shape_buckets_;
   static int clone_num_;
 
   bool private_context_{false};
@@ -20,6 +20,7 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include <numeric>
 #include <thread>  // NOLINT
 
 #include "paddle/fluid/framework/ir/pass.h"
@@ -27,6 +28,7 @@
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_api.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/inference/api/shape_bucket.h"
 #include "paddle/fluid/inference/tests/api/tester_helper.h"
 #include "paddle/fluid/inference/utils/io_utils.h"
 #include "paddle/fluid/platform/cpu_info.h"
@@ -166,6 +168,170 @@ TEST(AnalysisPredictor, ZeroCopy) {
   predictor->TryShrinkMemory();
 }
 
+TEST(AnalysisPredictor, ShapeBucket) {
+  std::vector<int64_t> input_data{0, 1, 2};
+  std::vector<std::string> input_names{"firstw", "secondw", "thirdw", "forthw"};
+  auto run = [&](AnalysisConfig* config, std::vector<int>* out_shape) {
+    config->SetModel(FLAGS_dirname);
+    config->SwitchUseFeedFetchOps(false);
+    auto predictor = CreatePaddlePredictor<AnalysisConfig>(*config);
+    for (const auto& name : input_names) {
+      auto input = predictor->GetInputTensor(name);
+      input->Reshape({3, 1});
+      input->copy_from_cpu(input_data.data());
+    }
+    EXPECT_TRUE(predictor->ZeroCopyRun());
+    auto out = predictor->GetOutputTensor("fc_1.tmp_2");
+    *out_shape = out->shape();
+    std::vector<float> out_data(std::accumulate(out_shape->begin(),
+                                                out_shape->end(),
+                                                1,
+                                                std::multiplies<int>()));
+    out->copy_to_cpu(out_data.data());
+    return out_data;
+  };
+
+  AnalysisConfig config;
+  std::vector<int> shape;
+  auto expect = run(&config, &shape);
+  ASSERT_EQ(shape[0], 3);
+
+  std::vector<std::map<std::string, std::vector<int>>> buckets(2);
+  for (const auto& name : input_names) {
+    buckets[0][name] = {8, 1};
+    buckets[1][name] = {4, 1};
+  }
+  AnalysisConfig bucket_config;
+  bucket_config.EnableShapeBucket(buckets);
+  ASSERT_TRUE(bucket_config.shape_bucket_enabled());
+  std::vector<int> bucket_shape;
+  auto actual = run(&bucket_config, &bucket_shape);
+  // The inputs are padded to the smaller bucket, and the outputs of the
+  // rows of the inputs are not changed.
+  ASSERT_EQ(bucket_shape[0], 4);
+  for (size_t i = 0; i < expect.size(); ++i) {
+    EXPECT_NEAR(expect[i], actual[i], 1e-6);
+  }
+}
+
+TEST(AnalysisPredictor, PassTuning) {
+  std::map<std::string, std::vector<int>> sample_shapes;
+  for (const auto& name : {"firstw", "secondw", "thirdw", "forthw"}) {
+    sample_shapes[name] = {4, 1};
+  }
+  const std::string cache_dir = "./pass_tuning_cache";
+  inference::analysis::MakeDirIfNotExists(cache_dir);
+  const std::string cache_path = cache_dir + "/pass_tuning.txt";
+  std::remove(cache_path.c_str());
+
+  for (int i = 0; i < 2; ++i) {
+    AnalysisConfig config;
+    config.SetModel(FLAGS_dirname);
+    config.SwitchUseFeedFetchOps(false);
+    config.SetOptimCacheDir(cache_dir);
+    config.EnablePassTuning(sample_shapes, {"fc_fuse_pass"}, 2);
+    ASSERT_TRUE(config.pass_tuning_enabled());
+    auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+    ASSERT_NE(predictor, nullptr);
+
+    // The choice is saved by the first predictor and read by the second.
+    std::ifstream fin(cache_path);
+    std::string key;
+    ASSERT_TRUE(static_cast<bool>(std::getline(fin, key)));
+    EXPECT_EQ(key.find("passes: fc_fuse_pass shapes:"), 0UL);
+    EXPECT_NE(key.find(" cpu: " + platform::CpuIdentity()), std::string::npos);
+  }
+}
+
+TEST(AnalysisPredictor, LazyLoadParams) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchIrOptim(false);
+  config.DisableGpu();
+  auto eager_predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  // Save the model with the combined params file.
+  const std::string model_dir = "./lazy_load_params_model";
+  inference::analysis::MakeDirIfNotExists(model_dir);
+  static_cast<AnalysisPredictor*>(eager_predictor.get())
+      ->SaveOptimModel(model_dir);
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+  std::vector<PaddleTensor> expects;
+  ASSERT_TRUE(eager_predictor->Run(inputs, &expects));
+
+  for (bool prefetch : {false, true}) {
+    AnalysisConfig lazy_config;
+    lazy_config.SetModel(model_dir + "/model", model_dir + "/params");
+    lazy_config.SwitchIrOptim(false);
+    lazy_config.DisableGpu();
+    lazy_config.EnableLazyLoadParams(prefetch);
+    ASSERT_TRUE(lazy_config.lazy_load_params_enabled());
+    auto _predictor = CreatePaddlePredictor<AnalysisConfig>(lazy_config);
+    auto* predictor = static_cast<AnalysisPredictor*>(_predictor.get());
+    ASSERT_TRUE(predictor->lazy_params_);
+    if (!prefetch) {
+      EXPECT_EQ(predictor->lazy_params_->NumLoaded(), 0UL);
+    }
+
+    std::vector<PaddleTensor> outputs;
+    ASSERT_TRUE(predictor->Run(inputs, &outputs));
+    EXPECT_EQ(predictor->lazy_params_->NumLoaded(),
+              predictor->lazy_params_->Size());
+    inference::CompareTensor(outputs.front(), expects.front());
+
+    // The clone shares the loaded parameters.
+    auto clone = predictor->Clone();
+    std::vector<PaddleTensor> clone_outputs;
+    ASSERT_TRUE(clone->Run(inputs, &clone_outputs));
+    inference::CompareTensor(clone_outputs.front(), expects.front());
+  }
+
+  // The warm-up of the shape buckets needs all the parameters at load time.
+  AnalysisConfig bucket_config;
+  bucket_config.SetModel(model_dir + "/model", model_dir + "/params");
+  bucket_config.SwitchIrOptim(false);
+  bucket_config.DisableGpu();
+  bucket_config.EnableLazyLoadParams(false);
+  std::vector<std::map<std::string, std::vector<int>>> buckets(1);
+  for (const auto& name : {"firstw", "secondw", "thirdw", "forthw"}) {
+    buckets[0][name] = {4, 1};
+  }
+  bucket_config.EnableShapeBucket(buckets);
+  auto _predictor = CreatePaddlePredictor<AnalysisConfig>(bucket_config);
+  auto* predictor = static_cast<AnalysisPredictor*>(_predictor.get());
+  EXPECT_FALSE(predictor->lazy_params_);
+  std::vector<PaddleTensor> outputs;
+  ASSERT_TRUE(predictor->Run(inputs, &outputs));
+  inference::CompareTensor(outputs.front(), expects.front());
+}
+
+TEST(ShapeBucket, find_and_pad) {
+  std::vector<inference::ShapeBucket> buckets{{{"x", {2, 16}}, {"y", {2}}},
+                                              {{"x", {2, 4}}, {"y", {2}}}};
+  inference::SortShapeBuckets(&buckets);
+  EXPECT_EQ(buckets[0].at("x")[1], 4);
+  EXPECT_EQ(inference::FindShapeBucket(buckets, {{"x", {1, 3}}}), 0);
+  EXPECT_EQ(inference::FindShapeBucket(buckets, {{"x", {2, 5}}}), 1);
+  EXPECT_EQ(inference::FindShapeBucket(buckets, {{"x", {3, 5}}}), -1);
+  EXPECT_EQ(inference::FindShapeBucket(buckets, {{"x", {2}}}), -1);
+
+  std::vector<int> src{1, 2, 3, 4, 5, 6};
+  std::vector<int> dst(8, 0);
+  inference::PadToShape(src.data(), {2, 3}, dst.data(), {2, 4}, sizeof(int));
+  EXPECT_EQ(dst, std::vector<int>({1, 2, 3, 0, 4, 5, 6, 0}));
+
+  auto learned = inference::LearnShapeBuckets(
+      {{"x", {1, 8}}}, {{"x", {1, 128}}}, {"x"}, 4);
+  ASSERT_EQ(learned.size(), 4UL);
+  EXPECT_EQ(learned[0].at("x"), std::vector<int>({1, 38}));
+  EXPECT_EQ(learned[3].at("x"), std::vector<int>({1, 128}));
+}
+
 TEST(AnalysisPredictor, CollectShapeRangeInfo) {
   AnalysisConfig config;
   config.SetModel(FLAGS_dirname);
@@ -463,6 +629,162 @@ TEST(Predictor, Run) {
   predictor->TryShrinkMemory();
 }
 
+TEST(PredictorPool, Acquire) {
+  Config config;
+  config.SetModel(FLAGS_dirname);
+  services::PredictorPool pool(config, 1, 4, true);
+  ASSERT_EQ(pool.Size(), 1UL);
+
+  auto run = [&pool]() {
+    auto predictor = pool.Acquire();
+    std::vector<int64_t> input_data{0, 1, 2, 3};
+    for (const auto& name : predictor->GetInputNames()) {
+      auto input = predictor->GetInputHandle(name);
+      input->Reshape({4, 1});
+      input->CopyFromCpu(input_data.data());
+    }
+    EXPECT_TRUE(predictor->Run());
+    auto out = predictor->GetOutputHandle(predictor->GetOutputNames()[0]);
+    std::vector<float> out_data(out->shape()[0] * out->shape()[1]);
+    out->CopyToCpu(out_data.data());
+    return out_data;
+  };
+  auto expect = run();
+
+  std::vector<std::thread> threads;
+  std::vector<std::vector<float>> outputs(8);
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    threads.emplace_back([&, i]() { outputs[i] = run(); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& output : outputs) {
+    EXPECT_EQ(output, expect);
+  }
+  EXPECT_GE(pool.Size(), 1UL);
+  EXPECT_LE(pool.Size(), 4UL);
+
+  {
+    // The leased predictors are not leased again until they are returned.
+    auto first = pool.Acquire();
+    auto second = pool.Acquire();
+    EXPECT_NE(first.get(), second.get());
+  }
+
+  {
+    // Acquire waits until the only predictor of the full pool is returned.
+    services::PredictorPool full(config, 1, 1);
+    auto lease = full.Acquire();
+    Predictor* pred = lease.get();
+    auto waiting = std::async(std::launch::async,
+                              [&full]() { return full.Acquire().get(); });
+    EXPECT_EQ(waiting.wait_for(std::chrono::milliseconds(100)),
+              std::future_status::timeout);
+    { auto returned = std::move(lease); }
+    EXPECT_EQ(waiting.get(), pred);
+  }
+}
+
+TEST(Predictor, RunAsync) {
+  Config config;
+  config.SetModel(FLAGS_dirname);
+  auto predictor = CreatePredictor(config);
+
+  auto feed = [](int64_t value) {
+    return [value](Predictor* pred) {
+      std::vector<int64_t> input_data(4, value);
+      for (const auto& name : pred->GetInputNames()) {
+        auto input = pred->GetInputHandle(name);
+        input->Reshape({4, 1});
+        input->CopyFromCpu(input_data.data());
+      }
+    };
+  };
+  auto fetch = [](Predictor* pred) {
+    auto out = pred->GetOutputHandle(pred->GetOutputNames()[0]);
+    std::vector<float> out_data(out->shape()[0] * out->shape()[1]);
+    out->CopyToCpu(out_data.data());
+    return out_data;
+  };
+  std::vector<std::vector<float>> expects;
+  for (int64_t i = 0; i < 4; ++i) {
+    feed(i)(predictor.get());
+    ASSERT_TRUE(predictor->Run());
+    expects.push_back(fetch(predictor.get()));
+  }
+
+  // The requests are queued without waiting, and run in order.
+  std::mutex mutex;
+  std::vector<std::vector<float>> outputs;
+  std::vector<std::future<void>> done;
+  for (int64_t i = 0; i < 4; ++i) {
+    auto promise = std::make_shared<std::promise<void>>();
+    done.push_back(promise->get_future());
+    predictor->RunAsync(feed(i), [&, promise](bool success, Predictor* pred) {
+      EXPECT_TRUE(success);
+      std::lock_guard<std::mutex> guard(mutex);
+      outputs.push_back(fetch(pred));
+      promise->set_value();
+    });
+  }
+  for (auto& future : done) {
+    future.wait();
+  }
+  EXPECT_EQ(outputs, expects);
+
+  feed(3)(predictor.get());
+  ASSERT_TRUE(predictor->RunAsync().get());
+  EXPECT_EQ(fetch(predictor.get()), expects[3]);
+
+  {
+    // The predictor is destroyed by the done callback of its async run
+    // without waiting for the runner calling it.
+    std::shared_ptr<Predictor> async_pred = CreatePredictor(config);
+    std::promise<bool> destroyed;
+    async_pred->RunAsync(feed(0), [&](bool success, Predictor*) {
+      async_pred.reset();
+      destroyed.set_value(success);
+    });
+    EXPECT_TRUE(destroyed.get_future().get());
+    EXPECT_EQ(async_pred, nullptr);
+  }
+
+  // The pool runs the requests concurrently, so they are checked by value.
+  services::PredictorPool pool(config, 1, 2);
+  std::vector<std::vector<float>> pool_outputs(4);
+  std::atomic<int> num_done{0};
+  for (int64_t i = 0; i < 4; ++i) {
+    pool.RunAsync(feed(i), [&, i](bool success, Predictor* pred) {
+      EXPECT_TRUE(success);
+      pool_outputs[i] = fetch(pred);
+      num_done++;
+    });
+  }
+  while (num_done < 4) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(pool_outputs, expects);
+
+  {
+    // The clones of a predictor with an external stream require a stream,
+    // so the pool fails to grow. The request fails instead of hanging the
+    // runner, and the pool can be destroyed.
+    Config stream_config;
+    stream_config.SetModel(FLAGS_dirname);
+    int stream = 0;
+    stream_config.SetExecStream(&stream);
+    services::PredictorPool failing(stream_config, 1, 2);
+    auto lease = failing.Acquire();
+    std::promise<bool> failed;
+    failing.RunAsync(feed(0), [&](bool success, Predictor* pred) {
+      EXPECT_EQ(pred, nullptr);
+      failed.set_value(success);
+    });
+    EXPECT_FALSE(failed.get_future().get());
+  }
+}
+
 TEST(Predictor, EnableONNXRuntime) {
   Config config;
   config.SetModel(FLAGS_dirname);
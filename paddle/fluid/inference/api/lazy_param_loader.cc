@@ -0,0 +1,279 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/lazy_param_loader.h"
+
+#include <algorithm>
+#include <fstream>
+#include <unordered_set>
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/indexed_combine_file.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/phi/kernels/funcs/packed_weight_cache.h"
+
+namespace paddle {
+namespace inference {
+
+namespace {
+
+bool IsPersistable(const framework::VarDesc *var) {
+  return var->Persistable() &&
+         var->GetType() != framework::proto::VarType::FEED_MINIBATCH &&
+         var->GetType() != framework::proto::VarType::FETCH_LIST &&
+         var->GetType() != framework::proto::VarType::RAW;
+}
+
+template <typename T>
+bool ReadPod(std::istream *is, T *value) {
+  is->read(reinterpret_cast<char *>(value), sizeof(T));
+  return static_cast<bool>(*is);
+}
+
+// Finds the offsets of the tensors written in the stream format by
+// save_combine, by reading their headers and skipping their data. Returns
+// false if the file does not hold exactly `num` tensors.
+bool IndexStreamFile(const std::string &path,
+                     size_t num,
+                     std::vector<uint64_t> *offsets) {
+  std::ifstream fin(path, std::ios::binary);
+  if (!fin.is_open()) {
+    return false;
+  }
+  fin.seekg(0, std::ios::end);
+  const uint64_t file_size = fin.tellg();
+  fin.seekg(0, std::ios::beg);
+  offsets->clear();
+  for (size_t i = 0; i < num; ++i) {
+    offsets->push_back(fin.tellg());
+    uint32_t version;
+    uint64_t lod_level;
+    if (!ReadPod(&fin, &version) || version != 0 ||
+        !ReadPod(&fin, &lod_level)) {
+      return false;
+    }
+    for (uint64_t l = 0; l < lod_level; ++l) {
+      uint64_t size;
+      if (!ReadPod(&fin, &size)) {
+        return false;
+      }
+      fin.seekg(size, std::ios::cur);
+    }
+    int32_t desc_size;
+    if (!ReadPod(&fin, &version) || version != 0 ||
+        !ReadPod(&fin, &desc_size) || desc_size < 0) {
+      return false;
+    }
+    std::string buf(desc_size, '\0');
+    fin.read(&buf[0], desc_size);
+    framework::proto::VarType::TensorDesc desc;
+    if (!fin || !desc.ParseFromString(buf)) {
+      return false;
+    }
+    uint64_t numel = 1;
+    for (auto dim : desc.dims()) {
+      numel *= dim;
+    }
+    fin.seekg(numel * framework::SizeOfType(desc.data_type()), std::ios::cur);
+    if (!fin || static_cast<uint64_t>(fin.tellg()) > file_size) {
+      return false;
+    }
+  }
+  return static_cast<uint64_t>(fin.tellg()) == file_size;
+}
+
+bool IsFalseCondition(const framework::OperatorBase &op,
+                      const framework::Scope &scope) {
+  if ((op.Type() != "conditional_block" &&
+       op.Type() != "conditional_block_infer") ||
+      !op.Attr<bool>("is_scalar_condition")) {
+    return false;
+  }
+  auto *var = scope.FindVar(op.Input("Cond"));
+  if (var == nullptr || !var->IsType<phi::DenseTensor>()) {
+    return false;
+  }
+  const auto &cond = var->Get<phi::DenseTensor>();
+  return cond.IsInitialized() && cond.numel() == 1 &&
+         cond.dtype() == phi::DataType::BOOL &&
+         platform::is_cpu_place(cond.place()) && !*cond.data<bool>();
+}
+
+}  // namespace
+
+std::shared_ptr<LazyParamLoader> LazyParamLoader::Create(
+    const framework::ProgramDesc &program,
+    const std::string &params_file,
+    const std::shared_ptr<framework::Scope> &scope) {
+  std::vector<std::string> params;
+  for (auto *var : program.Block(0).AllVars()) {
+    if (!IsPersistable(var)) {
+      continue;
+    }
+    if (var->GetType() != framework::proto::VarType::LOD_TENSOR) {
+      VLOG(3) << "The parameter " << var->Name()
+              << " is not a DenseTensor, so it can not be loaded lazily.";
+      return nullptr;
+    }
+    params.push_back(var->Name());
+  }
+  // The same order as the load_combine op used to load them all.
+  std::sort(params.begin(), params.end());
+
+  std::shared_ptr<LazyParamLoader> loader(
+      new LazyParamLoader(params_file, scope));
+  std::vector<uint64_t> offsets(params.size(), 0);
+  if (framework::IsIndexedCombineFile(params_file)) {
+    loader->reader_.reset(new framework::IndexedCombineFileReader(params_file));
+    for (const auto &name : params) {
+      if (!loader->reader_->Has(name) || !loader->reader_->IsTensor(name)) {
+        VLOG(3) << "The parameter " << name << " is not in " << params_file;
+        return nullptr;
+      }
+    }
+  } else if (!IndexStreamFile(params_file, params.size(), &offsets)) {
+    VLOG(3) << "The parameters in " << params_file
+            << " do not match the program.";
+    return nullptr;
+  }
+
+  std::unordered_set<std::string> written;
+  for (size_t i = 0; i < program.Size(); ++i) {
+    for (auto *op : program.Block(i).AllOps()) {
+      for (const auto &name : op->OutputArgumentNames()) {
+        written.insert(name);
+      }
+    }
+  }
+  for (size_t i = 0; i < params.size(); ++i) {
+    auto *entry = new Entry;
+    entry->name = params[i];
+    entry->offset = offsets[i];
+    entry->constant = !written.count(params[i]);
+    loader->entries_.emplace_back(entry);
+    loader->index_[params[i]] = entry;
+  }
+  return loader;
+}
+
+LazyParamLoader::LazyParamLoader(const std::string &params_file,
+                                 const std::shared_ptr<framework::Scope> &scope)
+    : params_file_(params_file), scope_(scope) {}
+
+LazyParamLoader::~LazyParamLoader() {
+  stop_prefetch_ = true;
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
+}
+
+void LazyParamLoader::LoadFor(const framework::OperatorBase &op,
+                              const framework::Scope &scope) {
+  if (AllLoaded()) {
+    return;
+  }
+  for (const auto &it : op.Inputs()) {
+    for (const auto &name : it.second) {
+      Load(name);
+    }
+  }
+  if (op.HasAttr("sub_block") && !IsFalseCondition(op, scope)) {
+    LoadForBlock(*op.Attr<framework::BlockDesc *>("sub_block"));
+  }
+}
+
+void LazyParamLoader::LoadForBlock(const framework::BlockDesc &block) {
+  for (auto *op : block.AllOps()) {
+    for (const auto &name : op->InputArgumentNames()) {
+      Load(name);
+    }
+    if (op->HasAttr("sub_block")) {
+      LoadForBlock(block.Program()->Block(op->GetBlockAttrId("sub_block")));
+    }
+  }
+}
+
+void LazyParamLoader::LoadAll() {
+  for (auto &entry : entries_) {
+    Load(entry.get());
+  }
+}
+
+void LazyParamLoader::StartPrefetch(const std::vector<std::string> &order) {
+  PADDLE_ENFORCE_EQ(prefetch_thread_.joinable(),
+                    false,
+                    platform::errors::PreconditionNotMet(
+                        "The parameters are being prefetched."));
+  prefetch_thread_ = std::thread([this, order] {
+    try {
+      for (const auto &name : order) {
+        if (stop_prefetch_) return;
+        Load(name);
+      }
+      for (auto &entry : entries_) {
+        if (stop_prefetch_) return;
+        Load(entry.get());
+      }
+      VLOG(3) << "Prefetched " << entries_.size() << " parameters from "
+              << params_file_;
+    } catch (const std::exception &e) {
+      // The failed parameter is loaded again by the op using it, which
+      // reports the error to the caller of Run.
+      LOG(WARNING) << "Failed to prefetch the parameters from " << params_file_
+                   << ": " << e.what();
+    }
+  });
+}
+
+void LazyParamLoader::Load(const std::string &name) {
+  auto it = index_.find(name);
+  if (it != index_.end()) {
+    Load(it->second);
+  }
+}
+
+void LazyParamLoader::Load(Entry *entry) {
+  std::call_once(entry->once, [this, entry] {
+    auto *tensor = scope_->Var(entry->name)->GetMutable<phi::DenseTensor>();
+    if (reader_) {
+      reader_->ReadTensors({entry->name}, {tensor});
+    } else {
+      std::ifstream fin(params_file_, std::ios::binary);
+      PADDLE_ENFORCE_EQ(fin.is_open(),
+                        true,
+                        platform::errors::Unavailable(
+                            "Failed to open file %s.", params_file_));
+      fin.seekg(entry->offset);
+      auto *dev_ctx =
+          platform::DeviceContextPool::Instance().Get(platform::CPUPlace());
+      framework::DeserializeFromStream(fin, tensor, *dev_ctx);
+    }
+    if (entry->constant) {
+      phi::funcs::PackedWeightCache::Instance().MarkConstant(*tensor);
+    }
+    VLOG(4) << "Loaded the parameter " << entry->name;
+    num_loaded_.fetch_add(1, std::memory_order_release);
+  });
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,103 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+class BlockDesc;
+class IndexedCombineFileReader;
+class OperatorBase;
+class ProgramDesc;
+class Scope;
+}  // namespace framework
+
+namespace inference {
+
+// Loads the parameters of a program from its combined params file on first
+// use instead of all at once. The offsets of the parameters in the file are
+// indexed when the loader is created, and each parameter is read to the CPU
+// when an op using it is about to run, or by the prefetch thread. The
+// parameters are loaded at most once, and the loader is shared by the clones
+// of the predictor.
+class LazyParamLoader {
+ public:
+  // Returns nullptr if the parameters can not be loaded lazily, such as when
+  // some of them are not DenseTensor or the file does not match the program.
+  static std::shared_ptr<LazyParamLoader> Create(
+      const framework::ProgramDesc &program,
+      const std::string &params_file,
+      const std::shared_ptr<framework::Scope> &scope);
+
+  ~LazyParamLoader();
+
+  // Loads the parameters used by op, including the ones used in its
+  // sub_block. The sub_block of a conditional_block is skipped when its
+  // scalar condition in `scope` is false.
+  void LoadFor(const framework::OperatorBase &op,
+               const framework::Scope &scope);
+
+  void LoadAll();
+
+  // Loads the parameters in a background thread, first the ones in `order`
+  // and then the others, until all of them are loaded or the loader is
+  // destroyed. It is called at most once.
+  void StartPrefetch(const std::vector<std::string> &order);
+
+  size_t NumLoaded() const { return num_loaded_.load(); }
+  size_t Size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    std::string name;
+    // The offset in the file in the stream format.
+    uint64_t offset{0};
+    // Whether no op writes to it, so its packed weights can be cached.
+    bool constant{true};
+    std::once_flag once;
+  };
+
+  LazyParamLoader(const std::string &params_file,
+                  const std::shared_ptr<framework::Scope> &scope);
+
+  bool AllLoaded() const {
+    return num_loaded_.load(std::memory_order_acquire) == entries_.size();
+  }
+
+  void Load(const std::string &name);
+  void Load(Entry *entry);
+  void LoadForBlock(const framework::BlockDesc &block);
+
+  std::string params_file_;
+  std::shared_ptr<framework::Scope> scope_;
+  // Not nullptr if the file is an indexed combine file.
+  std::unique_ptr<framework::IndexedCombineFileReader> reader_;
+  std::vector<std::unique_ptr<Entry>> entries_;
+  std::unordered_map<std::string, Entry *> index_;
+  std::atomic<size_t> num_loaded_{0};
+
+  std::atomic<bool> stop_prefetch_{false};
+  std::thread prefetch_thread_;
+};
+
+}  // namespace inference
+}  // namespace paddle
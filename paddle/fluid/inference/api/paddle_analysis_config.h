@@ -686,6 +686,81 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   bool shape_range_info_collected() const;
 
+  ///
+  /// \brief Pad the inputs to the nearest of the shape buckets, so that the
+  /// predictor only runs with the shapes of the buckets. The buckets are
+  /// warmed up at load time to create the kernels and oneDNN primitives of
+  /// their shapes. The outputs have the shapes of the padded inputs. Only
+  /// supported on CPU.
+  ///
+  /// \param buckets each bucket maps the names of the inputs to their shapes,
+  /// and the inputs are padded with zeros at the end of every dim.
+  /// \param warmup whether to run the buckets at load time.
+  ///
+  void EnableShapeBucket(
+      const std::vector<std::map<std::string, std::vector<int>>>& buckets,
+      bool warmup = true);
+
+  ///
+  /// \brief Pad the inputs to the nearest of the shape buckets learned from
+  /// the shape_info file got in CollectShapeInfo mode.
+  ///
+  /// \param shape_range_info_path the path to the shape_info file.
+  /// \param num_buckets the number of the buckets between the min and max
+  /// shapes of the inputs.
+  /// \param warmup whether to run the buckets at load time.
+  ///
+  void EnableShapeBucket(const std::string& shape_range_info_path,
+                         int num_buckets = 4,
+                         bool warmup = true);
+
+  ///
+  /// \brief A boolean state telling whether the shape buckets are used.
+  ///
+  bool shape_bucket_enabled() const { return use_shape_bucket_; }
+
+  ///
+  /// \brief Tune the IR passes on the sample inputs at load time. The
+  /// predictor is built without each of the candidate passes in turn, and a
+  /// pass is deleted if the sample inputs run faster without it. The deleted
+  /// passes are saved in the _opt_cache dir of the model, and reused by the
+  /// later predictors of the model with the same candidates, sample shapes
+  /// and host CPU.
+  ///
+  /// \param sample_shapes the shapes of the inputs, which are filled with
+  /// ones.
+  /// \param candidate_passes the passes to tune, which are all the fuse
+  /// passes of the pass builder if empty.
+  /// \param repeat the number of runs to time each pass list.
+  ///
+  void EnablePassTuning(
+      const std::map<std::string, std::vector<int>>& sample_shapes,
+      const std::vector<std::string>& candidate_passes = {},
+      int repeat = 10);
+
+  ///
+  /// \brief A boolean state telling whether the passes are tuned.
+  ///
+  bool pass_tuning_enabled() const { return use_pass_tuning_; }
+
+  ///
+  /// \brief Load the parameters on first use instead of all at load time.
+  /// Each parameter is read from the params file when an op using it is
+  /// about to run, so the parameters of the branches not taken are not
+  /// loaded. It is supported only for the combined params file on CPU with
+  /// ir_optim off and without the warm-up of the shape buckets, and the
+  /// parameters are loaded at load time otherwise.
+  ///
+  /// \param prefetch whether to load the parameters in a background thread
+  /// in the order they are used.
+  ///
+  void EnableLazyLoadParams(bool prefetch = true);
+
+  ///
+  /// \brief A boolean state telling whether the parameters are loaded lazily.
+  ///
+  bool lazy_load_params_enabled() const { return lazy_load_params_; }
+
   ///
   /// \brief Prevent ops running in Paddle-TRT
   /// NOTE: just experimental, not an official stable API, easy to be broken.
@@ -1093,6 +1168,23 @@ struct PD_INFER_DECL AnalysisConfig {
   bool collect_shape_range_info_{false};
   std::string shape_range_info_path_;
 
+  // Shape bucket related. The buckets are learned from
+  // shape_bucket_info_path_ if they are not given.
+  bool use_shape_bucket_{false};
+  std::vector<std::map<std::string, std::vector<int>>> shape_buckets_;
+  std::string shape_bucket_info_path_;
+  int shape_bucket_num_{4};
+  bool shape_bucket_warmup_{true};
+
+  // Pass tuning related.
+  bool use_pass_tuning_{false};
+  std::map<std::string, std::vector<int>> pass_tuning_shapes_;
+  std::vector<std::string> pass_tuning_candidates_;
+  int pass_tuning_repeat_{10};
+
+  bool lazy_load_params_{false};
+  bool lazy_load_params_prefetch_{true};
+
   // dlnne related.
   bool use_dlnne_{false};
   int dlnne_min_subgraph_size_{3};
@@ -21,9 +21,14 @@ limitations under the License. */
 
 #pragma once
 
+#include <atomic>
 #include <cassert>
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <future>  // NOLINT
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -48,6 +53,8 @@ using PrecisionType = paddle::AnalysisConfig::Precision;
 using Config = paddle::AnalysisConfig;
 using DistConfig = paddle::DistConfig;
 
+class AsyncRunQueue;
+
 ///
 /// \class Predictor
 ///
@@ -80,10 +87,9 @@ using DistConfig = paddle::DistConfig;
 class PD_INFER_DECL Predictor {
  public:
   Predictor() = delete;
-  ~Predictor() {}
+  ~Predictor();
   // Use for clone
-  explicit Predictor(std::unique_ptr<paddle::PaddlePredictor>&& pred)
-      : predictor_(std::move(pred)) {}
+  explicit Predictor(std::unique_ptr<paddle::PaddlePredictor>&& pred);
 
   ///
   /// \brief Construct a new Predictor object
@@ -121,6 +127,35 @@ class PD_INFER_DECL Predictor {
   ///
   bool Run();
 
+  /// \brief The function to set the inputs of an async run.
+  using AsyncFeedFunc = std::function<void(Predictor*)>;
+  /// \brief The function called with whether an async run succeeded, which
+  /// reads the outputs.
+  using AsyncDoneFunc = std::function<void(bool, Predictor*)>;
+
+  ///
+  /// \brief Run the prediction engine asynchronously on the internal worker
+  /// threads, and return without waiting for it.
+  ///
+  /// The runs are queued and executed in order. Before each run, \param feed
+  /// is called on the worker thread to set the inputs, and after it \param
+  /// done is called to read the outputs, so that the next requests can be
+  /// submitted while the current one is running. The predictor should not
+  /// be used by other threads until the queued runs are done, and its
+  /// destructor waits for them. The predictor can also be destroyed in \param
+  /// done, and then the runs queued after it are dropped.
+  ///
+  void RunAsync(AsyncFeedFunc feed, AsyncDoneFunc done);
+
+  ///
+  /// \brief Run the prediction engine asynchronously with the inputs which
+  /// are already set.
+  ///
+  /// \return The future of whether the run succeeded. The outputs can be
+  /// read once it is ready.
+  ///
+  std::future<bool> RunAsync();
+
   ///
   /// \brief Get the output names
   ///
@@ -177,6 +212,8 @@ class PD_INFER_DECL Predictor {
 
  private:
   std::unique_ptr<paddle::PaddlePredictor> predictor_;
+  std::once_flag async_once_;
+  std::unique_ptr<AsyncRunQueue> async_queue_;
   friend class paddle_infer::experimental::InternalUtils;
 };
 
@@ -218,7 +255,11 @@ namespace services {
 /// \brief PredictorPool is a simple encapsulation of Predictor, suitable for
 /// use in multi-threaded situations. According to the thread id, the
 /// corresponding Predictor is taken out from PredictorPool to complete the
-/// prediction.
+/// prediction. Or a predictor is leased to the request by Acquire, and the
+/// pool grows and shrinks by the number of the concurrent leases.
+///
+/// The predictors are cloned from the first one, sharing its parameters, so
+/// that each of them only holds its own executor and intermediate tensors.
 ///
 class PD_INFER_DECL PredictorPool {
  public:
@@ -229,12 +270,94 @@ class PD_INFER_DECL PredictorPool {
   /// \brief Construct the predictor pool with \param size predictor instances.
   explicit PredictorPool(const Config& config, size_t size = 1);
 
+  /// \brief Construct the predictor pool with \param size predictor
+  /// instances, which grows to at most \param max_size instances when all of
+  /// them are leased, and shrinks back when they are idle.
+  /// \param release_idle_memory whether to release the intermediate tensors
+  /// of the returned predictors to the allocator, which are then reused by
+  /// the running predictors.
+  PredictorPool(const Config& config,
+                size_t size,
+                size_t max_size,
+                bool release_idle_memory = false);
+
+  ~PredictorPool();
+
   /// \brief Get \param id-th predictor.
   Predictor* Retrive(size_t idx);
 
+  ///
+  /// \class Lease
+  ///
+  /// \brief A predictor leased from the pool, which is returned to the pool
+  /// when the lease is destroyed.
+  ///
+  class PD_INFER_DECL Lease {
+   public:
+    Lease(Lease&& other);
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    ~Lease();
+
+    Predictor* get() const { return pred_; }
+    Predictor* operator->() const { return pred_; }
+
+   private:
+    friend class PredictorPool;
+    Lease(PredictorPool* pool, size_t idx, Predictor* pred);
+
+    PredictorPool* pool_;
+    size_t idx_;
+    Predictor* pred_;
+  };
+
+  /// \brief Lease an idle predictor. A new predictor is cloned if all of them
+  /// are leased and the pool is not full, or waits for one to be returned.
+  /// The leased predictor is not used by other threads until it is returned,
+  /// so its outputs should be copied before that.
+  Lease Acquire();
+
+  /// \brief The number of the predictor instances.
+  size_t Size() const;
+
+  ///
+  /// \brief Run a request asynchronously with a leased predictor, which is
+  /// the same as Predictor::RunAsync except that the requests are run by up
+  /// to max_size predictors concurrently, and may run out of order. If the
+  /// pool fails to grow, the queued requests fail, and \param done is called
+  /// with false and nullptr. The destructor of the pool waits for the queued
+  /// requests, so the pool must not be destroyed in \param feed or \param
+  /// done.
+  ///
+  void RunAsync(Predictor::AsyncFeedFunc feed, Predictor::AsyncDoneFunc done);
+
  private:
+  struct Slot;
+
+  std::unique_ptr<Predictor> NewPredictor();
+  void Release(size_t idx);
+  void Shrink();
+  bool HasFreeSlot() const;
+
+  Config config_;
   std::shared_ptr<Predictor> main_pred_;
   std::vector<std::unique_ptr<Predictor>> preds_;
+  // The slots of the predictors leased by Acquire, whose first size slots
+  // hold main_pred_ and preds_, and are never shrunk.
+  std::vector<std::unique_ptr<Slot>> slots_;
+  size_t min_size_{1};
+  bool release_idle_memory_{false};
+  // Guards the growing and shrinking of the slots.
+  std::mutex resize_mutex_;
+  std::atomic<size_t> num_leased_{0};
+  std::atomic<size_t> peak_leased_{0};
+  std::atomic<size_t> num_released_{0};
+  // Acquire waits on it when all the slots are leased, and is notified when
+  // a slot is returned or shrunk.
+  std::mutex idle_mutex_;
+  std::condition_variable idle_cv_;
+  std::once_flag async_once_;
+  std::unique_ptr<AsyncRunQueue> async_queue_;
 };
 }  // namespace services
 
@@ -0,0 +1,166 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/shape_bucket.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace inference {
+
+namespace {
+
+int64_t NumElements(const ShapeBucket &bucket) {
+  int64_t numel = 0;
+  for (const auto &it : bucket) {
+    int64_t size = 1;
+    for (int dim : it.second) {
+      size *= dim;
+    }
+    numel += size;
+  }
+  return numel;
+}
+
+}  // namespace
+
+std::vector<ShapeBucket> LearnShapeBuckets(
+    const std::map<std::string, std::vector<int32_t>> &min_shape,
+    const std::map<std::string, std::vector<int32_t>> &max_shape,
+    const std::vector<std::string> &input_names,
+    int num_buckets) {
+  PADDLE_ENFORCE_GT(num_buckets,
+                    0,
+                    platform::errors::InvalidArgument(
+                        "The number of the shape buckets should be greater "
+                        "than 0, but got %d.",
+                        num_buckets));
+  std::vector<ShapeBucket> buckets;
+  for (int k = 1; k <= num_buckets; ++k) {
+    ShapeBucket bucket;
+    for (const auto &name : input_names) {
+      auto min_it = min_shape.find(name);
+      auto max_it = max_shape.find(name);
+      PADDLE_ENFORCE_EQ(
+          min_it != min_shape.end() && max_it != max_shape.end(),
+          true,
+          platform::errors::NotFound(
+              "The shape range of the input %s is not collected.", name));
+      const auto &min_dims = min_it->second;
+      const auto &max_dims = max_it->second;
+      PADDLE_ENFORCE_EQ(min_dims.size(),
+                        max_dims.size(),
+                        platform::errors::InvalidArgument(
+                            "The min and max shapes of the input %s should "
+                            "have the same rank.",
+                            name));
+      std::vector<int> dims(min_dims.size());
+      for (size_t d = 0; d < dims.size(); ++d) {
+        int range = max_dims[d] - min_dims[d];
+        dims[d] = min_dims[d] + (range * k + num_buckets - 1) / num_buckets;
+      }
+      bucket[name] = dims;
+    }
+    if (buckets.empty() || buckets.back() != bucket) {
+      buckets.push_back(bucket);
+    }
+  }
+  return buckets;
+}
+
+void SortShapeBuckets(std::vector<ShapeBucket> *buckets) {
+  std::stable_sort(buckets->begin(),
+                   buckets->end(),
+                   [](const ShapeBucket &a, const ShapeBucket &b) {
+                     return NumElements(a) < NumElements(b);
+                   });
+}
+
+int FindShapeBucket(const std::vector<ShapeBucket> &buckets,
+                    const ShapeBucket &shapes) {
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    bool fit = true;
+    for (const auto &it : buckets[i]) {
+      auto shape_it = shapes.find(it.first);
+      if (shape_it == shapes.end()) {
+        continue;
+      }
+      const auto &shape = shape_it->second;
+      const auto &bucket_shape = it.second;
+      fit = shape.size() == bucket_shape.size();
+      for (size_t d = 0; fit && d < shape.size(); ++d) {
+        fit = shape[d] <= bucket_shape[d];
+      }
+      if (!fit) {
+        break;
+      }
+    }
+    if (fit) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+void PadToShape(const void *src,
+                const std::vector<int> &src_dims,
+                void *dst,
+                const std::vector<int> &dst_dims,
+                size_t elem_size) {
+  PADDLE_ENFORCE_EQ(src_dims.size(),
+                    dst_dims.size(),
+                    platform::errors::InvalidArgument(
+                        "The shape to pad to should have the same rank as the "
+                        "tensor, but got %d and %d.",
+                        dst_dims.size(),
+                        src_dims.size()));
+  size_t rank = src_dims.size();
+  if (rank == 0) {
+    std::memcpy(dst, src, elem_size);
+    return;
+  }
+  // Copy the innermost rows of src to their offsets in dst.
+  std::vector<int64_t> dst_strides(rank, 1);
+  for (int i = static_cast<int>(rank) - 2; i >= 0; --i) {
+    dst_strides[i] = dst_strides[i + 1] * dst_dims[i + 1];
+  }
+  int64_t num_rows = 1;
+  for (size_t i = 0; i + 1 < rank; ++i) {
+    num_rows *= src_dims[i];
+  }
+  size_t row_size = src_dims.back() * elem_size;
+  const char *src_data = static_cast<const char *>(src);
+  char *dst_data = static_cast<char *>(dst);
+  std::vector<int> index(rank, 0);
+  for (int64_t row = 0; row < num_rows; ++row) {
+    int64_t offset = 0;
+    for (size_t i = 0; i + 1 < rank; ++i) {
+      offset += index[i] * dst_strides[i];
+    }
+    std::memcpy(
+        dst_data + offset * elem_size, src_data + row * row_size, row_size);
+    for (int i = static_cast<int>(rank) - 2; i >= 0; --i) {
+      if (++index[i] < src_dims[i]) {
+        break;
+      }
+      index[i] = 0;
+    }
+  }
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,56 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace inference {
+
+// The shapes of the inputs in a bucket, keyed by the names of the inputs.
+using ShapeBucket = std::map<std::string, std::vector<int>>;
+
+// Learns num_buckets buckets of the inputs from the min and max shapes
+// collected in CollectShapeRangeInfo mode. The dims whose min and max
+// differ are split evenly between them, and the others are fixed.
+std::vector<ShapeBucket> LearnShapeBuckets(
+    const std::map<std::string, std::vector<int32_t>> &min_shape,
+    const std::map<std::string, std::vector<int32_t>> &max_shape,
+    const std::vector<std::string> &input_names,
+    int num_buckets);
+
+// Sorts the buckets by their number of elements, so that the first bucket
+// found by FindShapeBucket is the smallest one.
+void SortShapeBuckets(std::vector<ShapeBucket> *buckets);
+
+// Returns the index of the first bucket which all the shapes fit in, or -1.
+// A shape fits in the bucket if it has the same rank and no larger dims, and
+// the inputs not in the bucket are not limited.
+int FindShapeBucket(const std::vector<ShapeBucket> &buckets,
+                    const ShapeBucket &shapes);
+
+// Copies src of src_dims to the front of dst of dst_dims, which is no
+// smaller in every dim. The padded elements of dst are not written.
+void PadToShape(const void *src,
+                const std::vector<int> &src_dims,
+                void *dst,
+                const std::vector<int> &dst_dims,
+                size_t elem_size);
+
+}  // namespace inference
+}  // namespace paddle
@@ -94,6 +94,27 @@ PD_Bool PD_PredictorRun(__pd_keep PD_Predictor* pd_predictor) {
   return predictor->Run();
 }
 
+void PD_PredictorRunAsync(__pd_keep PD_Predictor* pd_predictor,
+                          PD_PredictorFeedFunc feed,
+                          PD_PredictorDoneFunc done,
+                          void* user_data) {
+  CHECK_AND_CONVERT_PD_PREDICTOR;
+  paddle_infer::Predictor::AsyncFeedFunc feed_func;
+  if (feed != nullptr) {
+    feed_func = [pd_predictor, feed, user_data](paddle_infer::Predictor*) {
+      feed(pd_predictor, user_data);
+    };
+  }
+  paddle_infer::Predictor::AsyncDoneFunc done_func;
+  if (done != nullptr) {
+    done_func = [pd_predictor, done, user_data](bool success,
+                                                paddle_infer::Predictor*) {
+      done(success, pd_predictor, user_data);
+    };
+  }
+  predictor->RunAsync(std::move(feed_func), std::move(done_func));
+}
+
 void PD_PredictorClearIntermediateTensor(__pd_keep PD_Predictor* pd_predictor) {
   CHECK_AND_CONVERT_PD_PREDICTOR;
   predictor->ClearIntermediateTensor();
@@ -115,6 +115,39 @@ PADDLE_CAPI_EXPORT extern __pd_give PD_Tensor* PD_PredictorGetOutputHandle(
 PADDLE_CAPI_EXPORT extern PD_Bool PD_PredictorRun(
     __pd_keep PD_Predictor* pd_predictor);
 
+///
+/// \brief The function to set the inputs of an async run
+///
+typedef void (*PD_PredictorFeedFunc)(PD_Predictor* pd_predictor,
+                                     void* user_data);
+///
+/// \brief The function called with whether an async run succeeded, which
+/// reads the outputs
+///
+typedef void (*PD_PredictorDoneFunc)(PD_Bool success,
+                                     PD_Predictor* pd_predictor,
+                                     void* user_data);
+
+///
+/// \brief Run the prediction engine asynchronously on the internal worker
+/// threads. The runs are queued and executed in order, and feed and done are
+/// called on the worker thread before and after the run. The predictor
+/// should not be used by other threads until the queued runs are done.
+/// PD_PredictorDestroy waits for the queued runs, except when it is called in
+/// done, and then the runs queued after it are dropped.
+///
+/// \param[in] pd_predictor predictor
+/// \param[in] feed the function to set the inputs, which can be NULL if the
+/// inputs are already set
+/// \param[in] done the function to read the outputs, which can be NULL
+/// \param[in] user_data the data passed to feed and done
+///
+PADDLE_CAPI_EXPORT extern void PD_PredictorRunAsync(
+    __pd_keep PD_Predictor* pd_predictor,
+    PD_PredictorFeedFunc feed,
+    PD_PredictorDoneFunc done,
+    void* user_data);
+
 /// \brief Clear the intermediate tensors of the predictor
 ///
 /// \param[in] pd_predictor predictor
@@ -15,6 +15,7 @@ limitations under the License. */
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <future>
 #include <string>
 #include <vector>
 
@@ -61,6 +62,42 @@ void predictor_run() {
 
 TEST(PD_PredictorRun, predictor_run) { predictor_run(); }
 
+struct AsyncRunData {
+  std::vector<float> input;
+  std::promise<PD_Bool> success;
+};
+
+void feed_input(PD_Predictor *predictor, void *user_data) {
+  auto *data = static_cast<AsyncRunData *>(user_data);
+  PD_Tensor *tensor = PD_PredictorGetInputHandle(predictor, "data");
+  int32_t shape[4] = {1, 3, 318, 318};
+  PD_TensorReshape(tensor, 4, shape);
+  PD_TensorCopyFromCpuFloat(tensor, data->input.data());
+  PD_TensorDestroy(tensor);
+}
+
+void set_success(PD_Bool success, PD_Predictor *predictor, void *user_data) {
+  static_cast<AsyncRunData *>(user_data)->success.set_value(success);
+}
+
+TEST(PD_PredictorRunAsync, predictor_run_async) {
+  std::string model_dir = FLAGS_infer_model;
+  PD_Config *config = PD_ConfigCreate();
+  PD_ConfigDisableGpu(config);
+  PD_ConfigSetModel(config,
+                    (model_dir + "/model").c_str(),
+                    (model_dir + "/params").c_str());
+  PD_Predictor *predictor = PD_PredictorCreate(config);
+
+  AsyncRunData data;
+  data.input.resize(3 * 318 * 318);
+  auto success = data.success.get_future();
+  PD_PredictorRunAsync(predictor, feed_input, set_success, &data);
+  EXPECT_TRUE(success.get());
+
+  PD_PredictorDestroy(predictor);
+}
+
 #ifdef PADDLE_WITH_MKLDNN
 TEST(PD_Config, profile_mkldnn) {
   std::string model_dir = FLAGS_infer_model;
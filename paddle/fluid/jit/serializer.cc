@@ -16,6 +16,8 @@
 
 #include <set>
 
+#include "paddle/fluid/framework/indexed_combine_file.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/framework/var_desc.h"
 #include "paddle/fluid/framework/variable.h"
 #include "paddle/fluid/platform/device_context.h"
@@ -93,6 +95,10 @@ void Deserializer::ReadTensorData(const std::string& file_name,
                                   const phi::Place& place,
                                   VariableMap* params_dict) const {
   VLOG(3) << "ReadTensorData from: " << file_name;
+  if (framework::IsIndexedCombineFile(file_name)) {
+    ReadIndexedTensorData(file_name, var_name, place, params_dict);
+    return;
+  }
   std::ifstream fin(file_name, std::ios::binary);
   platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
   auto& dev_ctx = *pool.Get(place);
@@ -106,6 +112,46 @@ void Deserializer::ReadTensorData(const std::string& file_name,
   }
 }
 
+void Deserializer::ReadIndexedTensorData(const std::string& file_name,
+                                         const std::set<std::string>& var_name,
+                                         const phi::Place& place,
+                                         VariableMap* params_dict) const {
+  framework::IndexedCombineFileReader reader(file_name);
+  // The variables are saved in the order of their names, so they are read
+  // by the order if the names are not in the file.
+  std::vector<std::string> names(var_name.begin(), var_name.end());
+  bool has_names = true;
+  for (const auto& name : names) {
+    has_names = has_names && reader.Has(name);
+  }
+  if (!has_names) {
+    PADDLE_ENFORCE_EQ(reader.Names().size(),
+                      names.size(),
+                      platform::errors::InvalidArgument(
+                          "The number of the parameters in %s is %d, but %d "
+                          "parameters are expected.",
+                          file_name,
+                          reader.Names().size(),
+                          names.size()));
+    names = reader.Names();
+  }
+  std::vector<Variable> vars(names.size());
+  std::vector<DenseTensor*> tensors;
+  for (auto& v : vars) {
+    tensors.push_back(v.GetMutable<DenseTensor>());
+  }
+  reader.ReadTensors(names, tensors);
+  size_t i = 0;
+  for (auto it = var_name.begin(); it != var_name.end(); ++it, ++i) {
+    VLOG(3) << "load Tensor: " << *it;
+    if (!platform::is_cpu_place(place)) {
+      DenseTensor cpu_tensor = *tensors[i];
+      framework::TensorCopySync(cpu_tensor, place, tensors[i]);
+    }
+    (*params_dict)[*it] = std::make_shared<Variable>(vars[i]);
+  }
+}
+
 void Deserializer::ReadAttributeData(const std::string& file_path,
                                      VariableMap* attrs_dict) const {
   VLOG(3) << "ReadPropertyData from: " << file_path;
@@ -57,6 +57,12 @@ class Deserializer {
                       const phi::Place& place,
                       VariableMap* params_dict) const;
 
+  // Reads the parameters saved by save_combine with an index.
+  void ReadIndexedTensorData(const std::string& file_name,
+                             const std::set<std::string>& var_name,
+                             const phi::Place& place,
+                             VariableMap* params_dict) const;
+
   // property pb
   void ReadAttributeData(const std::string& file_path,
                          VariableMap* attrs_dict) const;
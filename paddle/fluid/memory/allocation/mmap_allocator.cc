@@ -17,15 +17,22 @@
 #include "paddle/fluid/memory/allocation/mmap_allocator.h"
 
 #include <fcntl.h>
+#include <signal.h>
 #include <stdlib.h>
 #include <sys/mman.h>
 
+#include <algorithm>
 #include <random>
 #include <string>
 
+#include "gflags/gflags.h"
 #include "glog/logging.h"
 #include "paddle/fluid/platform/enforce.h"
 
+DECLARE_bool(use_shm_cache);
+DECLARE_int32(shm_cache_size);
+DECLARE_uint64(shm_cache_max_mb);
+
 namespace paddle {
 namespace memory {
 namespace allocation {
@@ -45,6 +52,11 @@ std::string GetIPCName() {
 
 struct CountInfo {
   std::atomic<int> refcount;
+  // Whether the file is kept by MemoryMapAllocationPool of the process which
+  // creates it, so that it is not unlinked when refcount reaches 0.
+  bool pooled;
+  // The pid of the process which creates the pooled file.
+  pid_t creator_pid;
 };
 
 void AllocateMemoryMap(
@@ -108,13 +120,51 @@ void AllocateMemoryMap(
   }
 }
 
+// The pooled files are allocated in pages, so that the tensors of similar
+// sizes reuse them.
+static size_t PooledDataSize(size_t size) {
+  constexpr size_t kPageSize = 4096;
+  size_t file_size =
+      (size + mmap_alignment + kPageSize - 1) / kPageSize * kPageSize;
+  return file_size - mmap_alignment;
+}
+
 std::shared_ptr<RefcountedMemoryMapAllocation>
 AllocateRefcountedMemoryMapAllocation(std::string filename,
                                       int flags,
                                       size_t size) {
+  bool created = flags & MAPPED_EXCLUSIVE;
+  auto &pool = MemoryMapAllocationPool::Instance();
+  if (FLAGS_use_shm_cache) {
+    auto info = created ? pool.Acquire(size) : pool.Find(filename);
+    if (info != nullptr && info->data_size() >= size) {
+      return std::make_shared<RefcountedMemoryMapAllocation>(info, flags);
+    }
+    if (created) {
+      size = PooledDataSize(size);
+    }
+  }
   int fd = -1;
   void *base_ptr = nullptr;
   AllocateMemoryMap(filename, flags, size + mmap_alignment, &base_ptr, &fd);
+  if (FLAGS_use_shm_cache) {
+    auto *count_info = static_cast<CountInfo *>(base_ptr);
+    if (created) {
+      count_info->pooled = true;
+      count_info->creator_pid = getpid();
+    }
+    // The file not kept by its creator is unlinked once it is released, so
+    // it is not kept by the receivers either.
+    if (count_info->pooled) {
+      auto info = pool.Insert(filename, base_ptr, size, created);
+      if (info != nullptr) {
+        return std::make_shared<RefcountedMemoryMapAllocation>(info, flags);
+      }
+      if (created) {
+        count_info->pooled = false;
+      }
+    }
+  }
   void *aliged_base_ptr =
       static_cast<void *>(static_cast<char *>(base_ptr) + mmap_alignment);
   return std::make_shared<RefcountedMemoryMapAllocation>(
@@ -129,6 +179,19 @@ RefcountedMemoryMapAllocation::RefcountedMemoryMapAllocation(
   initializeRefercount();
 }
 
+RefcountedMemoryMapAllocation::RefcountedMemoryMapAllocation(
+    std::shared_ptr<MemoryMapInfo> info, int flags)
+    : MemoryMapAllocation(
+          static_cast<char *>(info->map_ptr()) + mmap_alignment,
+          info->data_size(),
+          info->file_name(),
+          flags,
+          -1),
+      info_(std::move(info)) {
+  resetBaseptr();
+  initializeRefercount();
+}
+
 void MemoryMapAllocation::close() {
   if (closed_) {
     return;
@@ -171,10 +234,15 @@ void RefcountedMemoryMapAllocation::close() {
   closed_ = true;
   void *data = map_ptr_;
   CountInfo *info = reinterpret_cast<CountInfo *>(data);
-  if (--info->refcount == 0) {
+  // The pooled file is reused by its creator.
+  if (--info->refcount == 0 && !info->pooled) {
     shm_unlink(ipc_name_.c_str());
     VLOG(6) << "shm_unlink file: " << ipc_name_;
   }
+  if (info_ != nullptr) {
+    info_.reset();
+    return;
+  }
 
   PADDLE_ENFORCE_NE(
       munmap(map_ptr_, map_size_),
@@ -265,6 +333,156 @@ std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
   return std::make_shared<MemoryMapReaderAllocation>(ptr, size, ipc_name);
 }
 
+MemoryMapInfo::MemoryMapInfo(std::string file_name,
+                             void *map_ptr,
+                             size_t data_size,
+                             bool created)
+    : file_name_(std::move(file_name)),
+      map_ptr_(map_ptr),
+      data_size_(data_size),
+      owner_pid_(created ? getpid() : -1) {}
+
+MemoryMapInfo::~MemoryMapInfo() {
+  if (owned()) {
+    shm_unlink(file_name_.c_str());
+    MemoryMapFdSet::Instance().Remove(file_name_);
+    VLOG(6) << "shm_unlink pooled file: " << file_name_;
+  }
+  if (munmap(map_ptr_, data_size_ + mmap_alignment) == -1) {
+    LOG(WARNING) << "Could not unmap the shared memory file " << file_name_
+                 << ": " << strerror(errno);
+  }
+}
+
+bool MemoryMapInfo::owned() const { return owner_pid_ == getpid(); }
+
+int MemoryMapInfo::refcount() const {
+  return static_cast<CountInfo *>(map_ptr_)->refcount;
+}
+
+pid_t MemoryMapInfo::creator_pid() const {
+  return static_cast<CountInfo *>(map_ptr_)->creator_pid;
+}
+
+MemoryMapAllocationPool &MemoryMapAllocationPool::Instance() {  // NOLINT
+  // MemoryMapFdSet is constructed first, so that it is destructed after the
+  // pool, which removes the unlinked files from it.
+  MemoryMapFdSet::Instance();
+  static MemoryMapAllocationPool pool;
+  return pool;
+}
+
+std::shared_ptr<MemoryMapInfo> MemoryMapAllocationPool::Acquire(
+    size_t data_size) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  std::shared_ptr<MemoryMapInfo> best;
+  for (auto &info : infos_) {
+    // The refcount of a free file is only increased by the process itself,
+    // which allocates in the file and then passes it to the others.
+    if (info->owned() && info->refcount() == 0 &&
+        info->data_size() >= data_size &&
+        info->data_size() < 2 * PooledDataSize(data_size) &&
+        (best == nullptr || info->data_size() < best->data_size())) {
+      best = info;
+    }
+  }
+  if (best != nullptr) {
+    static_cast<CountInfo *>(best->map_ptr())->refcount = 1;
+  }
+  return best;
+}
+
+std::shared_ptr<MemoryMapInfo> MemoryMapAllocationPool::Find(
+    const std::string &file_name) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  for (auto &info : infos_) {
+    if (info->file_name() == file_name) {
+      return info;
+    }
+  }
+  return nullptr;
+}
+
+template <typename Pred>
+void MemoryMapAllocationPool::EraseIf(Pred pred) {
+  auto it = std::remove_if(infos_.begin(), infos_.end(), pred);
+  for (auto erased = it; erased != infos_.end(); ++erased) {
+    mapped_size_ -= (*erased)->mapped_size();
+  }
+  infos_.erase(it, infos_.end());
+}
+
+static bool IsExited(pid_t pid) {
+  return kill(pid, 0) == -1 && errno == ESRCH;
+}
+
+std::shared_ptr<MemoryMapInfo> MemoryMapAllocationPool::Insert(
+    const std::string &file_name,
+    void *map_ptr,
+    size_t data_size,
+    bool created) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  const size_t max_files =
+      static_cast<size_t>(std::max(FLAGS_shm_cache_size, 0));
+  const size_t max_size = FLAGS_shm_cache_max_mb << 20;
+  const size_t size = data_size + mmap_alignment;
+  auto is_full = [&] {
+    return infos_.size() >= max_files || mapped_size_ + size > max_size;
+  };
+  if (size > max_size) {
+    return nullptr;
+  }
+  if (is_full()) {
+    // The files of the exited processes are not passed again.
+    EraseIf([](const std::shared_ptr<MemoryMapInfo> &info) {
+      return !info->owned() && IsExited(info->creator_pid());
+    });
+  }
+  while (is_full()) {
+    // The file not created by the process is kept mapped by its allocations
+    // after it is removed from the pool.
+    auto it = std::find_if(
+        infos_.begin(),
+        infos_.end(),
+        [](const std::shared_ptr<MemoryMapInfo> &info) {
+          return !info->owned() || info->refcount() == 0;
+        });
+    if (it == infos_.end()) {
+      return nullptr;
+    }
+    mapped_size_ -= (*it)->mapped_size();
+    infos_.erase(it);
+  }
+  auto info =
+      std::make_shared<MemoryMapInfo>(file_name, map_ptr, data_size, created);
+  infos_.push_back(info);
+  mapped_size_ += size;
+  return info;
+}
+
+void MemoryMapAllocationPool::ReleaseFilesOf(const std::set<pid_t> &pids) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  EraseIf([&pids](const std::shared_ptr<MemoryMapInfo> &info) {
+    return !info->owned() && pids.count(info->creator_pid());
+  });
+}
+
+size_t MemoryMapAllocationPool::Size() {
+  std::lock_guard<std::mutex> guard(mtx_);
+  return infos_.size();
+}
+
+size_t MemoryMapAllocationPool::MappedSize() {
+  std::lock_guard<std::mutex> guard(mtx_);
+  return mapped_size_;
+}
+
+void MemoryMapAllocationPool::Clear() {
+  std::lock_guard<std::mutex> guard(mtx_);
+  infos_.clear();
+  mapped_size_ = 0;
+}
+
 MemoryMapFdSet &MemoryMapFdSet::Instance() {  // NOLINT
   static MemoryMapFdSet set;
   return set;
@@ -16,12 +16,16 @@
 
 #ifndef _WIN32
 
+#include <sys/types.h>
+
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "paddle/fluid/memory/allocation/allocator.h"
 
@@ -73,10 +77,55 @@ class MemoryMapAllocation : public Allocation {
   bool closed_ = false;
 };
 
+// A shared memory file of RefcountedMemoryMapAllocation kept mapped by
+// MemoryMapAllocationPool, which is a reference count header of
+// mmap_alignment bytes followed by data_size bytes of data. The file created
+// by the process is reused once no allocation in any process refers to it,
+// and is unlinked when it is released.
+class MemoryMapInfo {
+ public:
+  MemoryMapInfo(std::string file_name,
+                void *map_ptr,
+                size_t data_size,
+                bool created);
+
+  MemoryMapInfo(const MemoryMapInfo &) = delete;
+  MemoryMapInfo &operator=(const MemoryMapInfo &) = delete;
+
+  ~MemoryMapInfo();
+
+  const std::string &file_name() const { return file_name_; }
+  void *map_ptr() const { return map_ptr_; }
+  size_t data_size() const { return data_size_; }
+
+  // Whether the file is created by the process, but not by its parent
+  // before forking.
+  bool owned() const;
+
+  // The number of the allocations in the file in all processes.
+  int refcount() const;
+
+  // The pid of the process which creates the file.
+  pid_t creator_pid() const;
+
+  // The bytes mapped for the file, including the header.
+  size_t mapped_size() const { return data_size_ + mmap_alignment; }
+
+ private:
+  std::string file_name_;
+  void *map_ptr_;
+  size_t data_size_;
+  // The pid of the process which creates the file, or -1.
+  int owner_pid_;
+};
+
 class RefcountedMemoryMapAllocation : public MemoryMapAllocation {
  public:
   RefcountedMemoryMapAllocation(
       void *ptr, size_t size, std::string ipc_name, int flags, int fd);
+  // The allocation of the whole data in the file kept by the pool.
+  RefcountedMemoryMapAllocation(std::shared_ptr<MemoryMapInfo> info,
+                                int flags);
 
   void incref();
   int decref();
@@ -86,16 +135,74 @@ class RefcountedMemoryMapAllocation : public MemoryMapAllocation {
  protected:
   void initializeRefercount();
   void resetBaseptr();
+
+  // Not null if the file is kept by MemoryMapAllocationPool, which unmaps it.
+  std::shared_ptr<MemoryMapInfo> info_;
 };
 
 void AllocateMemoryMap(
     std::string filename, int flags, size_t size, void **base_ptr_, int *fd_);
 
+// Allocates the shared memory of `size` bytes in a new file of `filename` if
+// flags has MAPPED_EXCLUSIVE, or maps the existing file of `filename`
+// otherwise. With FLAGS_use_shm_cache, a free file kept by
+// MemoryMapAllocationPool of at least `size` bytes is reused instead of the
+// new file, and the kept file of `filename` is not mapped again.
 std::shared_ptr<RefcountedMemoryMapAllocation>
 AllocateRefcountedMemoryMapAllocation(std::string filename,
                                       int flags,
                                       size_t size);
 
+// The shared memory files mapped by the process for
+// RefcountedMemoryMapAllocation with FLAGS_use_shm_cache. A process passing
+// the tensors, such as a DataLoader worker, reuses the files it creates once
+// the receivers release the tensors, and the receivers keep the files mapped,
+// so that neither of them opens, maps and unmaps a file for every tensor.
+class MemoryMapAllocationPool {
+ public:
+  static MemoryMapAllocationPool &Instance();  // NOLINT
+
+  // Returns the smallest free file created by the process whose data is at
+  // least `data_size` bytes and less than twice of the pages it takes, or
+  // nullptr. The refcount of the file is set to 1 for the allocation in it.
+  std::shared_ptr<MemoryMapInfo> Acquire(size_t data_size);
+
+  // Returns the file of `file_name` mapped by the process, or nullptr.
+  std::shared_ptr<MemoryMapInfo> Find(const std::string &file_name);
+
+  // Keeps the file mapped at `map_ptr`. The files created by the exited
+  // processes are released first, and then the files not in use are replaced
+  // until the pool has less than FLAGS_shm_cache_size files and maps at most
+  // FLAGS_shm_cache_max_mb MB with the file. Returns nullptr if it can not,
+  // and then the caller unmaps the file.
+  std::shared_ptr<MemoryMapInfo> Insert(const std::string &file_name,
+                                        void *map_ptr,
+                                        size_t data_size,
+                                        bool created);
+
+  // Releases the files created by the processes of `pids`, such as the
+  // DataLoader workers which exit. The files still in use are unmapped once
+  // their allocations are released.
+  void ReleaseFilesOf(const std::set<pid_t> &pids);
+
+  size_t Size();
+
+  // The bytes mapped for the files in the pool.
+  size_t MappedSize();
+
+  void Clear();
+
+ private:
+  MemoryMapAllocationPool() = default;
+
+  template <typename Pred>
+  void EraseIf(Pred pred);
+
+  std::vector<std::shared_ptr<MemoryMapInfo>> infos_;
+  size_t mapped_size_{0};
+  std::mutex mtx_;
+};
+
 class MemoryMapWriterAllocation : public Allocation {
  public:
   explicit MemoryMapWriterAllocation(void *ptr,
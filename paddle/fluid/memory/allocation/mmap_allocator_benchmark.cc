@@ -0,0 +1,125 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _WIN32
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/memory/allocation/mmap_allocator.h"
+
+DECLARE_bool(use_shm_cache);
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// Pass the batches of kNumTensors tensors from a child process to the parent
+// like the DataLoader, which keeps at most kPrefetch batches in flight.
+static double PassBatches(bool use_shm_cache) {
+  const int kNumBatches = 200;
+  const int kNumTensors = 4;
+  const int kPrefetch = 2;
+  const size_t kTensorSize = 32 * 3 * 64 * 64 * sizeof(float);
+  FLAGS_use_shm_cache = use_shm_cache;
+  struct Message {
+    char ipc_name[64];
+    size_t size;
+  };
+  int batches[2], acks[2];
+  EXPECT_EQ(pipe(batches), 0);
+  EXPECT_EQ(pipe(acks), 0);
+  pid_t pid = fork();
+  if (pid == 0) {
+    char ack;
+    for (int i = 0; i < kNumBatches; ++i) {
+      if (i >= kPrefetch && read(acks[0], &ack, 1) != 1) {
+        _exit(1);
+      }
+      for (int j = 0; j < kNumTensors; ++j) {
+        auto writer = AllocateRefcountedMemoryMapAllocation(
+            GetIPCName(), MAPPED_SHAREDMEM | MAPPED_EXCLUSIVE, kTensorSize);
+        memset(writer->ptr(), i, kTensorSize);
+        // The reference of the message, which is released by the parent.
+        writer->incref();
+        Message message;
+        snprintf(message.ipc_name,
+                 sizeof(message.ipc_name),
+                 "%s",
+                 writer->ipc_name().c_str());
+        message.size = writer->size();
+        if (write(batches[1], &message, sizeof(message)) !=
+            static_cast<ssize_t>(sizeof(message))) {
+          _exit(1);
+        }
+      }
+    }
+    for (int i = 0; i < kPrefetch; ++i) {
+      if (read(acks[0], &ack, 1) != 1) {
+        _exit(1);
+      }
+    }
+    MemoryMapAllocationPool::Instance().Clear();
+    MemoryMapFdSet::Instance().Clear();
+    _exit(0);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kNumBatches; ++i) {
+    for (int j = 0; j < kNumTensors; ++j) {
+      Message message;
+      EXPECT_EQ(read(batches[0], &message, sizeof(message)),
+                static_cast<ssize_t>(sizeof(message)));
+      auto reader = AllocateRefcountedMemoryMapAllocation(
+          message.ipc_name,
+          MAPPED_SHAREDMEM | MAPPED_NOCREATE,
+          message.size);
+      reader->decref();
+      auto* data = static_cast<const unsigned char*>(reader->ptr());
+      EXPECT_EQ(data[kTensorSize - 1], static_cast<unsigned char>(i));
+    }
+    EXPECT_EQ(write(acks[1], "a", 1), 1);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  int status = 0;
+  waitpid(pid, &status, 0);
+  EXPECT_EQ(status, 0);
+  for (int fd : {batches[0], batches[1], acks[0], acks[1]}) {
+    close(fd);
+  }
+  MemoryMapAllocationPool::Instance().Clear();
+  FLAGS_use_shm_cache = false;
+  return kNumBatches / std::chrono::duration<double>(elapsed).count();
+}
+
+TEST(MemoryMapAllocationPool, benchmark) {
+  double batches_per_second = PassBatches(false);
+  double pooled_batches_per_second = PassBatches(true);
+  LOG(INFO) << "Passing the batches in new shared memory files: "
+            << batches_per_second << " batches/s, in the pooled files: "
+            << pooled_batches_per_second << " batches/s.";
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
+
+#endif
@@ -16,8 +16,17 @@
 
 #include "paddle/fluid/memory/allocation/mmap_allocator.h"
 
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+#include "gflags/gflags.h"
 #include "gtest/gtest.h"
 
+DECLARE_bool(use_shm_cache);
+DECLARE_uint64(shm_cache_max_mb);
+
 namespace paddle {
 namespace memory {
 namespace allocation {
@@ -45,6 +54,150 @@ TEST(MemoryMapAllocation, test_allocation_base) {
   }
 }
 
+TEST(MemoryMapAllocationPool, test_reuse) {
+  FLAGS_use_shm_cache = true;
+  auto& pool = MemoryMapAllocationPool::Instance();
+  pool.Clear();
+  const int create_flags = MAPPED_SHAREDMEM | MAPPED_EXCLUSIVE;
+  const int open_flags = MAPPED_SHAREDMEM | MAPPED_NOCREATE;
+  const size_t data_size = 4000;
+  std::string ipc_name;
+  {
+    auto writer =
+        AllocateRefcountedMemoryMapAllocation(GetIPCName(), create_flags, 100);
+    ipc_name = writer->ipc_name();
+    EXPECT_GE(writer->size(), 100UL);
+    static_cast<int32_t*>(writer->ptr())[0] = 7;
+    // Pass the tensor to the reader, which maps the kept file.
+    writer->incref();
+    auto reader = AllocateRefcountedMemoryMapAllocation(
+        ipc_name, open_flags, writer->size());
+    reader->decref();
+    EXPECT_EQ(reader->ptr(), writer->ptr());
+    EXPECT_EQ(static_cast<int32_t*>(reader->ptr())[0], 7);
+    writer.reset();
+    // The file is in use by the reader.
+    auto other = AllocateRefcountedMemoryMapAllocation(
+        GetIPCName(), create_flags, data_size);
+    EXPECT_NE(other->ipc_name(), ipc_name);
+    EXPECT_EQ(pool.Size(), 2UL);
+  }
+  auto writer = AllocateRefcountedMemoryMapAllocation(
+      GetIPCName(), create_flags, data_size);
+  EXPECT_EQ(writer->ipc_name(), ipc_name);
+  std::string large_name;
+  {
+    auto large = AllocateRefcountedMemoryMapAllocation(
+        GetIPCName(), create_flags, 4 * data_size);
+    large_name = large->ipc_name();
+  }
+  // The free file is too large for a few bytes, which reuse the smaller one.
+  auto small =
+      AllocateRefcountedMemoryMapAllocation(GetIPCName(), create_flags, 8);
+  EXPECT_NE(small->ipc_name(), large_name);
+  auto large = AllocateRefcountedMemoryMapAllocation(
+      GetIPCName(), create_flags, 3 * data_size);
+  EXPECT_EQ(large->ipc_name(), large_name);
+  EXPECT_EQ(pool.Size(), 3UL);
+  FLAGS_use_shm_cache = false;
+  writer.reset();
+  large.reset();
+  small.reset();
+  pool.Clear();
+}
+
+TEST(MemoryMapAllocationPool, test_max_mb) {
+  FLAGS_use_shm_cache = true;
+  FLAGS_shm_cache_max_mb = 1;
+  auto& pool = MemoryMapAllocationPool::Instance();
+  pool.Clear();
+  const int create_flags = MAPPED_SHAREDMEM | MAPPED_EXCLUSIVE;
+  auto first =
+      AllocateRefcountedMemoryMapAllocation(GetIPCName(), create_flags, 100);
+  auto second = AllocateRefcountedMemoryMapAllocation(
+      GetIPCName(), create_flags, 900UL * 1024);
+  // The third one can not replace the files in use.
+  auto third = AllocateRefcountedMemoryMapAllocation(
+      GetIPCName(), create_flags, 600UL * 1024);
+  EXPECT_EQ(pool.Size(), 2UL);
+  EXPECT_LE(pool.MappedSize(), 1UL << 20);
+  // The file larger than the limit is not kept.
+  auto large = AllocateRefcountedMemoryMapAllocation(
+      GetIPCName(), create_flags, 2UL << 20);
+  EXPECT_EQ(pool.Size(), 2UL);
+  second.reset();
+  third.reset();
+  // The free file of the second one is too large to be reused, and is
+  // replaced.
+  auto fourth = AllocateRefcountedMemoryMapAllocation(
+      GetIPCName(), create_flags, 400UL * 1024);
+  EXPECT_EQ(pool.Size(), 2UL);
+  EXPECT_EQ(pool.MappedSize(),
+            first->size() + fourth->size() + 2 * mmap_alignment);
+  FLAGS_shm_cache_max_mb = 1024;
+  FLAGS_use_shm_cache = false;
+  first.reset();
+  large.reset();
+  fourth.reset();
+  pool.Clear();
+}
+
+TEST(MemoryMapAllocationPool, test_release_files_of) {
+  FLAGS_use_shm_cache = true;
+  auto& pool = MemoryMapAllocationPool::Instance();
+  pool.Clear();
+  const size_t data_size = 4000;
+  int names[2], acks[2];
+  ASSERT_EQ(pipe(names), 0);
+  ASSERT_EQ(pipe(acks), 0);
+  pid_t pid = fork();
+  if (pid == 0) {
+    auto writer = AllocateRefcountedMemoryMapAllocation(
+        GetIPCName(), MAPPED_SHAREDMEM | MAPPED_EXCLUSIVE, data_size);
+    writer->incref();
+    char name[64];
+    snprintf(name, sizeof(name), "%s", writer->ipc_name().c_str());
+    size_t size = writer->size();
+    char ack;
+    if (write(names[1], name, sizeof(name)) !=
+            static_cast<ssize_t>(sizeof(name)) ||
+        write(names[1], &size, sizeof(size)) !=
+            static_cast<ssize_t>(sizeof(size)) ||
+        read(acks[0], &ack, 1) != 1) {
+      _exit(1);
+    }
+    writer.reset();
+    MemoryMapAllocationPool::Instance().Clear();
+    MemoryMapFdSet::Instance().Clear();
+    _exit(0);
+  }
+  char name[64];
+  size_t size = 0;
+  ASSERT_EQ(read(names[0], name, sizeof(name)),
+            static_cast<ssize_t>(sizeof(name)));
+  ASSERT_EQ(read(names[0], &size, sizeof(size)),
+            static_cast<ssize_t>(sizeof(size)));
+  {
+    auto reader = AllocateRefcountedMemoryMapAllocation(
+        name, MAPPED_SHAREDMEM | MAPPED_NOCREATE, size);
+    reader->decref();
+    EXPECT_EQ(pool.Size(), 1UL);
+  }
+  EXPECT_EQ(write(acks[1], "a", 1), 1);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  EXPECT_EQ(status, 0);
+  pool.ReleaseFilesOf({getpid()});
+  EXPECT_EQ(pool.Size(), 1UL);
+  pool.ReleaseFilesOf({pid});
+  EXPECT_EQ(pool.Size(), 0UL);
+  EXPECT_EQ(pool.MappedSize(), 0UL);
+  for (int fd : {names[0], names[1], acks[0], acks[1]}) {
+    close(fd);
+  }
+  FLAGS_use_shm_cache = false;
+}
+
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
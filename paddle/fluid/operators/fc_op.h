@@ -95,7 +95,8 @@ class FCOpKernel : public framework::OpKernel<T> {
        output_data,
        bias ? bias->data<T>() : NULL,
        with_relu,
-       padding_weights);
+       padding_weights,
+       w);
   }
 };
 
@@ -79,7 +79,7 @@ class FusionGroupOp : public framework::OperatorWithKernel {
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
     return framework::OpKernelType(framework::proto::VarType::FP32,
-                                   platform::CUDAPlace(0));
+                                   ctx.GetPlace());
   };
 };
 
@@ -104,8 +104,9 @@ class FusionGroupOpMaker : public framework::OpProtoAndCheckerMaker {
     AddComment(R"DOC(
 fusion_group Operator.
 
-It is used to execute a generated CUDA kernel which fuse the computation of
-multiple operators into one. It supports several types:
+It is used to execute a generated CUDA kernel, or a generated C++ kernel on
+CPU, which fuse the computation of multiple operators into one. It supports
+several types:
 0, fused computation of elementwise operations in which all the dims of inputs
     and outputs should be exactly the same.
 )DOC");
@@ -117,3 +118,6 @@ multiple operators into one. It supports several types:
 
 namespace ops = paddle::operators;
 REGISTER_OPERATOR(fusion_group, ops::FusionGroupOp, ops::FusionGroupOpMaker);
+REGISTER_OP_CPU_KERNEL(fusion_group,
+                       ops::FusionGroupKernel<phi::CPUContext, float>,
+                       ops::FusionGroupKernel<phi::CPUContext, double>);
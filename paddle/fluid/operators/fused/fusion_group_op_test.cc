@@ -92,13 +92,21 @@ framework::OpDesc* CreateFusionGroupOp(
 
 void PrepareDeviceCode(platform::Place place,
                        std::string func_name,
-                       std::string cuda_kernel_str) {
+                       std::string kernel_str) {
   paddle::platform::DeviceCodePool& pool =
       paddle::platform::DeviceCodePool::Init({place});
 
-  std::unique_ptr<paddle::platform::DeviceCode> code(
-      new paddle::platform::CUDADeviceCode(place, func_name, cuda_kernel_str));
-  code->Compile();
+  std::unique_ptr<paddle::platform::DeviceCode> code;
+  if (platform::is_cpu_place(place)) {
+    code.reset(
+        new paddle::platform::CPUDeviceCode(place, func_name, kernel_str));
+  } else {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    code.reset(
+        new paddle::platform::CUDADeviceCode(place, func_name, kernel_str));
+#endif
+  }
+  ASSERT_TRUE(code->Compile());
   pool.Set(std::move(code));
 }
 
@@ -137,17 +145,17 @@ void CheckOutputs(framework::Scope* scope,
   }
 }
 
-void TestMain(const std::vector<std::string>& input_names,
+void TestMain(const platform::Place& place,
+              const std::vector<std::string>& input_names,
               const std::vector<std::vector<int64_t>>& input_shapes,
               const std::vector<std::string>& output_names,
               int type,
               std::string func_name,
-              std::string cuda_kernel_str,
+              std::string kernel_str,
               CPUKernelFunc cpu_kernel_func) {
   // Compile the device code
   paddle::framework::InitDevices({0});
-  platform::CUDAPlace place = platform::CUDAPlace(0);
-  PrepareDeviceCode(place, func_name, cuda_kernel_str);
+  PrepareDeviceCode(place, func_name, kernel_str);
 
   // Create a ProgramDesc that has a fusion_group_op.
   framework::ProgramDesc program;
@@ -182,6 +190,21 @@ void TestMain(const std::vector<std::string>& input_names,
       &scope, output_names, &cpu_tensors, input_names.size(), cpu_kernel_func);
 }
 
+// z = relu(x + y)
+static void ElementwiseCPUKernel(size_t n, std::vector<void*> args) {
+  float* x = static_cast<float*>(args[0]);
+  float* y = static_cast<float*>(args[1]);
+  float* z = static_cast<float*>(args[2]);
+  for (size_t i = 0; i < n; ++i) {
+    float tmp_0 = x[i];
+    float tmp_1 = y[i];
+    float tmp_2 = tmp_0 + tmp_1;
+    float tmp_3 = tmp_2 > 0 ? tmp_2 : 0;
+    z[i] = tmp_3;
+  }
+}
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 TEST(FusionGroupOp, elementwise) {
   if (!platform::dynload::HasNVRTC() || !platform::dynload::HasCUDADriver()) {
     return;
@@ -208,30 +231,62 @@ void elementwise_cuda_kernel_0(size_t n, float *x, float* y, float* z) {
   }
 })";
 
-  auto elementwise_cpu_kernel_0 = [](size_t n,
-                                     std::vector<void*> args) -> void {
-    float* x = static_cast<float*>(args[0]);
-    float* y = static_cast<float*>(args[1]);
-    float* z = static_cast<float*>(args[2]);
-    for (size_t i = 0; i < n; ++i) {
-      float tmp_0 = x[i];
-      float tmp_1 = y[i];
-      float tmp_2 = tmp_0 + tmp_1;
-      float tmp_3 = tmp_2 > 0 ? tmp_2 : 0;
-      z[i] = tmp_3;
-    }
-  };
-
-  TestMain(input_names,
+  TestMain(platform::CUDAPlace(0),
+           input_names,
            input_shapes,
            output_names,
            0,
            "elementwise_cuda_kernel_0",
            kernel,
-           elementwise_cpu_kernel_0);
+           ElementwiseCPUKernel);
+}
+#endif
+
+TEST(FusionGroupOp, elementwise_cpu) {
+  if (!platform::CPUDeviceCode::IsAvailable()) {
+    return;
+  }
+
+  // z = relu(x + y)
+  std::vector<std::string> input_names = {"x", "y"};
+  std::vector<std::string> output_names = {"z"};
+  std::vector<std::vector<int64_t>> input_shapes = {{256, 256}, {256, 256}};
+  constexpr auto kernel = R"(
+#include <cstdint>
+
+static inline float relu(float x) {
+  return x * (x > 0);
+}
+
+extern "C"
+void elementwise_cpu_kernel_0(int64_t begin, int64_t end, void** args) {
+  const float* x = static_cast<const float*>(args[0]);
+  const float* y = static_cast<const float*>(args[1]);
+  float* z = static_cast<float*>(args[2]);
+  for (int64_t i = begin; i < end; ++i) {
+    float tmp_0 = x[i];
+    float tmp_1 = y[i];
+    float tmp_2 = tmp_0 + tmp_1;
+    float tmp_3 = relu(tmp_2);
+    z[i] = tmp_3;
+  }
+})";
+
+  TestMain(platform::CPUPlace(),
+           input_names,
+           input_shapes,
+           output_names,
+           0,
+           "elementwise_cpu_kernel_0",
+           kernel,
+           ElementwiseCPUKernel);
 }
 
 }  // namespace operators
 }  // namespace paddle
 
-USE_CUDA_ONLY_OP(fusion_group);
+USE_OP_ITSELF(fusion_group);
+USE_OP_DEVICE_KERNEL(fusion_group, CPU);
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+USE_OP_DEVICE_KERNEL(fusion_group, CUDA);
+#endif
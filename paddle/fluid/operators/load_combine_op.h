@@ -15,12 +15,15 @@ limitations under the License. */
 #pragma once
 
 #include <fstream>
+#include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "paddle/fluid/framework/convert_utils.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/data_type_transform.h"
+#include "paddle/fluid/framework/indexed_combine_file.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/string_array.h"
 #include "paddle/fluid/framework/tensor_util.h"
@@ -44,7 +47,14 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
                           "The number of variables to be loaded is %d, expect "
                           "it to be greater than 0.",
                           out_var_names.size()));
-    if (!model_from_memory) {
+    if (!model_from_memory && framework::IsIndexedCombineFile(filename)) {
+      framework::IndexedCombineFileReader reader(filename);
+      LoadParamsFromIndex(ctx, place, reader, load_as_fp16, out_var_names);
+    } else if (model_from_memory && framework::IsIndexedCombineFile(
+                                        filename.data(), filename.size())) {
+      framework::IndexedCombineFileReader reader("", &filename);
+      LoadParamsFromIndex(ctx, place, reader, load_as_fp16, out_var_names);
+    } else if (!model_from_memory) {
       std::ifstream fin(filename, std::ios::binary);
       PADDLE_ENFORCE_EQ(
           static_cast<bool>(fin),
@@ -92,50 +102,13 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
               "An error occurred while loading model parameters. "
               "Please check whether the model file is complete or damaged."));
       if (out_vars[i]->IsType<framework::Vocab>()) {
-        auto *tensor = out_vars[i]->GetMutable<framework::Vocab>();
-        tensor->clear();
-        std::unordered_map<std::string, std::int32_t> data;
-        framework::StringMapFromStream(*buffer, &data);
-        for (auto it = data.begin(); it != data.end(); ++it) {
-          std::string tmp;
-          framework::NFD(it->first, &tmp);
-          if (tmp.empty()) {
-            VLOG(0) << "The string " << it->first
-                    << " was converted to unicode failedly! "
-                    << "Then dropped to load it.";
-            continue;
-          }
-          std::wstring token;
-          bool status = framework::ConvertStrToWstr(tmp, &token);
-          if (!status) continue;
-          tensor->emplace(token, it->second);
-        }
+        LoadVocab(*buffer, out_vars[i]->GetMutable<framework::Vocab>());
       } else {
         auto *tensor = out_vars[i]->GetMutable<phi::DenseTensor>();
 
         // Get data from fin to tensor
         paddle::framework::DeserializeFromStream(*buffer, tensor, dev_ctx);
-
-        auto in_dtype = framework::TransToProtoVarType(tensor->dtype());
-        auto out_dtype =
-            load_as_fp16 ? framework::proto::VarType::FP16 : in_dtype;
-
-        if (in_dtype != out_dtype) {
-          // convert to float16 tensor
-          auto in_kernel_type = framework::OpKernelType(in_dtype, place);
-          auto out_kernel_type = framework::OpKernelType(out_dtype, place);
-          phi::DenseTensor fp16_tensor;
-          // copy LoD info to the new tensor
-          fp16_tensor.set_lod(tensor->lod());
-          framework::TransDataType(
-              in_kernel_type, out_kernel_type, *tensor, &fp16_tensor);
-
-          // reset output tensor
-          out_vars[i]->Clear();
-          tensor = out_vars[i]->GetMutable<phi::DenseTensor>();
-          tensor->set_lod(fp16_tensor.lod());
-          tensor->ShareDataWith(fp16_tensor);
-        }
+        ConvertToFP16(place, load_as_fp16, out_vars[i]);
       }
     }
     buffer->peek();
@@ -145,6 +118,120 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
                           "Not allowed to load partial data via "
                           "load_combine_op, please use load_op instead."));
   }
+
+  // Loads the variables from the file with an index, whose tensors are read
+  // in parallel. The variables are found by their names, or by their order if
+  // the names are not in the file.
+  void LoadParamsFromIndex(
+      const framework::ExecutionContext &context,
+      const platform::Place &place,
+      const framework::IndexedCombineFileReader &reader,
+      bool load_as_fp16,
+      const std::vector<std::string> &out_var_names) const {
+    auto out_vars = context.MultiOutputVar("Out");
+    std::vector<std::string> names = out_var_names;
+    bool has_names = true;
+    for (const auto &name : names) {
+      has_names = has_names && reader.Has(name);
+    }
+    if (!has_names) {
+      PADDLE_ENFORCE_EQ(reader.Names().size(),
+                        names.size(),
+                        platform::errors::Unavailable(
+                            "Not allowed to load partial data via "
+                            "load_combine_op, please use load_op instead."));
+      names = reader.Names();
+    }
+
+    std::vector<std::string> tensor_names;
+    std::vector<phi::DenseTensor *> tensors;
+    // The tensors are read to CPU, and copied to place later.
+    std::vector<phi::DenseTensor> cpu_tensors(out_var_names.size());
+    bool is_cpu_place = platform::is_cpu_place(place);
+    for (size_t i = 0; i < out_var_names.size(); i++) {
+      VLOG(4) << "loading tensor: " << out_var_names[i];
+      PADDLE_ENFORCE_NOT_NULL(
+          out_vars[i],
+          platform::errors::InvalidArgument(
+              "The variable %s to be loaded cannot be found.",
+              out_var_names[i]));
+      bool is_vocab = out_vars[i]->IsType<framework::Vocab>();
+      PADDLE_ENFORCE_EQ(
+          reader.IsTensor(names[i]),
+          !is_vocab,
+          platform::errors::InvalidArgument(
+              "The type of the variable %s to be loaded does not match the "
+              "type saved in the file.",
+              out_var_names[i]));
+      if (is_vocab) {
+        std::istringstream blob(reader.ReadBlob(names[i]));
+        LoadVocab(blob, out_vars[i]->GetMutable<framework::Vocab>());
+      } else {
+        tensor_names.push_back(names[i]);
+        tensors.push_back(is_cpu_place
+                              ? out_vars[i]->GetMutable<phi::DenseTensor>()
+                              : &cpu_tensors[i]);
+      }
+    }
+    reader.ReadTensors(tensor_names, tensors);
+
+    for (size_t i = 0; i < out_var_names.size(); i++) {
+      if (out_vars[i]->IsType<framework::Vocab>()) {
+        continue;
+      }
+      if (!is_cpu_place) {
+        auto *tensor = out_vars[i]->GetMutable<phi::DenseTensor>();
+        framework::TensorCopySync(cpu_tensors[i], place, tensor);
+        tensor->set_lod(cpu_tensors[i].lod());
+      }
+      ConvertToFP16(place, load_as_fp16, out_vars[i]);
+    }
+  }
+
+  void LoadVocab(std::istream &is, framework::Vocab *tensor) const {
+    tensor->clear();
+    std::unordered_map<std::string, std::int32_t> data;
+    framework::StringMapFromStream(is, &data);
+    for (auto it = data.begin(); it != data.end(); ++it) {
+      std::string tmp;
+      framework::NFD(it->first, &tmp);
+      if (tmp.empty()) {
+        VLOG(0) << "The string " << it->first
+                << " was converted to unicode failedly! "
+                << "Then dropped to load it.";
+        continue;
+      }
+      std::wstring token;
+      bool status = framework::ConvertStrToWstr(tmp, &token);
+      if (!status) continue;
+      tensor->emplace(token, it->second);
+    }
+  }
+
+  void ConvertToFP16(const platform::Place &place,
+                     bool load_as_fp16,
+                     framework::Variable *var) const {
+    auto *tensor = var->GetMutable<phi::DenseTensor>();
+    auto in_dtype = framework::TransToProtoVarType(tensor->dtype());
+    auto out_dtype = load_as_fp16 ? framework::proto::VarType::FP16 : in_dtype;
+
+    if (in_dtype != out_dtype) {
+      // convert to float16 tensor
+      auto in_kernel_type = framework::OpKernelType(in_dtype, place);
+      auto out_kernel_type = framework::OpKernelType(out_dtype, place);
+      phi::DenseTensor fp16_tensor;
+      // copy LoD info to the new tensor
+      fp16_tensor.set_lod(tensor->lod());
+      framework::TransDataType(
+          in_kernel_type, out_kernel_type, *tensor, &fp16_tensor);
+
+      // reset output tensor
+      var->Clear();
+      tensor = var->GetMutable<phi::DenseTensor>();
+      tensor->set_lod(fp16_tensor.lod());
+      tensor->ShareDataWith(fp16_tensor);
+    }
+  }
 };
 
 }  // namespace operators
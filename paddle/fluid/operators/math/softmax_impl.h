@@ -18,12 +18,12 @@ limitations under the License. */
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/operators/jit/kernels.h"
-#include "paddle/fluid/operators/math/cpu_vec.h"
 #include "paddle/fluid/platform/bfloat16.h"
 #include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/float16.h"
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/kernels/funcs/softmax_cpu.h"
 
 namespace paddle {
 namespace operators {
@@ -247,28 +247,12 @@ class SoftmaxFunctor<DeviceContext, T, enable_if_CPU<DeviceContext>> {
     const int batch_size = in_dims[kBatchDim];
     const int num_remain = num_classes / axis_dim;
 
-    if (num_remain == 1 && platform::MayIUse(platform::avx)) {
-      const T* in_data = X->data<T>();
-      T* out_data = Y->data<T>();
-      for (int bs = 0; bs < batch_size; ++bs) {
-        T max_val = *std::max_element(in_data, in_data + num_classes);
-        max_val *= static_cast<T>(-1);
-        vec_add_bias<T, platform::avx>(num_classes, max_val, in_data, out_data);
-        vec_clip<T, platform::avx>(
-            num_classes, static_cast<T>(-64), out_data, out_data);
-        vec_exp<T>(num_classes, out_data, out_data);
-
-        T sum = 0;
-        vec_sum<T, platform::avx>(num_classes, out_data, &sum);
-        sum = static_cast<T>(1) / sum;
-        vec_scal<T, platform::avx>(num_classes, sum, out_data, out_data);
-
-        in_data += num_classes;
-        out_data += num_classes;
-      }
-    } else {
-      SoftmaxEigen<DeviceContext, T>()(context, axis_dim, X, Y);
-    }
+    phi::funcs::SoftmaxCPU<T>(X->data<T>(),
+                              batch_size,
+                              axis_dim,
+                              num_remain,
+                              /*log_softmax=*/false,
+                              Y->data<T>());
   }
 };
 
@@ -400,25 +384,13 @@ class SoftmaxGradFunctor<DeviceContext, T, enable_if_CPU<DeviceContext>> {
     const int batch_size = out_dims[kBatchDim];
     const int num_remain = num_classes / axis_dim;
 
-    if (num_remain == 1 && platform::MayIUse(platform::avx)) {
-      const T* out_data = y->data<T>();
-      const T* out_grad = y_grad->data<T>();
-      T* in_grad = x_grad->data<T>();
-      for (int bs = 0; bs < batch_size; ++bs) {
-        T scalar;
-        vec_mul_reduce<T, platform::avx>(
-            num_classes, out_grad, out_data, &scalar);
-        scalar *= static_cast<T>(-1);
-        vec_add_bias<T, platform::avx>(num_classes, scalar, out_grad, in_grad);
-        vec_mul<T, platform::avx>(num_classes, out_data, in_grad, in_grad);
-        out_data += num_classes;
-        out_grad += num_classes;
-        in_grad += num_classes;
-      }
-    } else {
-      SoftmaxGradEigen<DeviceContext, T>()(
-          context, axis_dim, y, y_grad, x_grad);
-    }
+    phi::funcs::SoftmaxGradCPU<T>(y->data<T>(),
+                                  y_grad->data<T>(),
+                                  batch_size,
+                                  axis_dim,
+                                  num_remain,
+                                  /*log_softmax=*/false,
+                                  x_grad->data<T>());
   }
 };
 
@@ -14,42 +14,56 @@
 
 #include "paddle/fluid/operators/reader/buffered_reader.h"
 
+#include <algorithm>
+#include <chrono>
+
 #include "paddle/fluid/framework/convert_utils.h"
 #include "paddle/fluid/platform/device/device_wrapper.h"
+#include "paddle/fluid/platform/flags.h"
+#include "paddle/fluid/platform/metrics_exporter.h"
 #include "paddle/fluid/platform/profiler.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 
 #include "paddle/phi/backends/device_guard.h"
 #include "paddle/phi/backends/device_manager.h"
 
+/**
+ * Reader related FLAG
+ * Name: FLAGS_reader_num_workers
+ * Since Version: 2.4.0
+ * Value Range: int32, default=1
+ * Example:
+ * Note: Number of threads of each BufferedReader to copy batches to device in
+ * parallel. The buffer size of the reader is num_workers + 1.
+ */
+PADDLE_DEFINE_EXPORTED_int32(reader_num_workers,
+                             1,
+                             "Number of worker threads of BufferedReader.");
+
 namespace paddle {
 namespace operators {
 namespace reader {
 BufferedReader::~BufferedReader() {
-  VLOG(1) << "~BufferedReader";
+  VLOG(1) << "~BufferedReader, consumer stalls: " << consumer_stall_count_
+          << ", producer stalls: " << producer_stall_count_;
   reader_->Shutdown();
-  while (!position_.empty()) {
-    auto &front = position_.front();
-    if (front.valid()) {
-      front.wait();
-    }
-    position_.pop();
-  }
+  WaitAllPending();
 }
 
 BufferedReader::BufferedReader(
     const std::shared_ptr<framework::ReaderBase> &reader,
     const platform::Place &place,
     size_t buffer_size,
-    bool pin_memory)
+    bool pin_memory,
+    size_t num_workers)
     : framework::DecoratedReader(reader),
-      thread_pool_(1),
+      thread_pool_(std::max<size_t>(1, std::min(num_workers, buffer_size))),
       place_(place),
       buffer_size_(buffer_size),
       pin_memory_(pin_memory) {
-  VLOG(1) << "BufferedReader";
+  VLOG(1) << "BufferedReader with " << num_workers << " workers";
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
-  if (platform::is_gpu_place(place_) && !pin_memory) {
+  if (platform::is_gpu_place(place_)) {
     int dev_idx = place_.device;
     compute_stream_ =
         ((phi::GPUContext *)(platform::DeviceContextPool::Instance().Get(
@@ -132,9 +146,53 @@ BufferedReader::BufferedReader(
   mlu_buffer_.resize(buffer_size);
   xpu_buffer_.resize(buffer_size);
   custom_device_buffer_.resize(buffer_size);
+  recycled_buffer_.resize(buffer_size);
+  pinned_staging_buffer_.resize(buffer_size);
   ReadTillBufferFullAsync();
 }
 
+void BufferedReader::WaitAllPending() {
+  while (!position_.empty()) {
+    auto &front = position_.front();
+    if (front.valid()) {
+      front.wait();
+    }
+    position_.pop();
+  }
+}
+
+bool BufferedReader::ReuseRecycledBuffer(size_t i, TensorVec *buffer) {
+  TensorVec &recycled = recycled_buffer_[i];
+  bool reused = false;
+  for (size_t j = 0; j < recycled.size() && j < buffer->size(); ++j) {
+    auto &holder = recycled[j].Holder();
+    // Only this reader holds the memory, so the consumer has released it.
+    if (holder && holder.use_count() == 1 &&
+        !(*buffer)[j].IsInitialized()) {
+      (*buffer)[j].ShareDataWith(recycled[j]);
+      reused = true;
+    }
+  }
+  recycled.clear();
+  return reused;
+}
+
+void BufferedReader::UpdateStallMetrics(bool consumer_stall) {
+  if (consumer_stall) {
+    ++consumer_stall_count_;
+  } else {
+    ++producer_stall_count_;
+  }
+  if (platform::IsMetricsEnabled()) {
+    platform::MetricsRegistry::Instance()
+        .GetCounter("paddle_buffered_reader_stalls",
+                    "Number of stalls of BufferedReader. A consumer stall "
+                    "means the data reading is the bottleneck.",
+                    {{"side", consumer_stall ? "consumer" : "producer"}})
+        ->Increase();
+  }
+}
+
 void BufferedReader::ReadTillBufferFullAsync() {
   for (size_t i = 0; i < buffer_size_; ++i) {
     ReadAsync(i);
@@ -142,9 +200,29 @@ void BufferedReader::ReadTillBufferFullAsync() {
 }
 
 void BufferedReader::ReadAsync(size_t i) {
-  position_.emplace(thread_pool_.enqueue([this, i]() -> size_t {
+  size_t ticket = next_ticket_++;
+  position_.emplace(thread_pool_.enqueue([this, i, ticket]() -> size_t {
     TensorVec &cpu = cpu_buffer_[i];
-    reader_->ReadNext(&cpu);
+    {
+      {
+        std::unique_lock<std::mutex> lock(read_mutex_);
+        read_cv_.wait(lock, [this, ticket] { return read_turn_ == ticket; });
+      }
+      // Only the worker holding the turn reads, so the mutex is not held
+      // while reading. Pass the turn to the next ticket even if ReadNext
+      // throws.
+      struct TurnGuard {
+        BufferedReader *reader;
+        ~TurnGuard() {
+          {
+            std::lock_guard<std::mutex> guard(reader->read_mutex_);
+            ++reader->read_turn_;
+          }
+          reader->read_cv_.notify_all();
+        }
+      } turn_guard{this};
+      reader_->ReadNext(&cpu);
+    }
 
     if (cpu.empty()) {
       return -1UL;
@@ -162,6 +240,7 @@ void BufferedReader::ReadAsync(size_t i) {
             platform::errors::InvalidArgument(
                 "Input tensor number on GPU and CPU devices are not matched."));
       }
+      bool reused = ReuseRecycledBuffer(i, &cuda);
       if (pin_memory_) {
         // NOTE: [Copy processing of different input devices]
         // We may accept input tensor in three different devices:
@@ -185,6 +264,20 @@ void BufferedReader::ReadAsync(size_t i) {
         // cuda lib into device, it will cost hundreds of MB of GPU memory.
         // If we don't set Device here, which will use CUDAPlace(0) default.
         platform::SetDeviceId(place_.device);
+        if (reused) {
+          // The consumer may have issued async copies from the recycled
+          // pinned memory on the compute stream before releasing it, so wait
+          // for them before overwriting the memory.
+#ifdef PADDLE_WITH_HIP
+          PADDLE_ENFORCE_GPU_SUCCESS(
+              hipEventRecord(events_[i].get(), compute_stream_));
+          PADDLE_ENFORCE_GPU_SUCCESS(hipEventSynchronize(events_[i].get()));
+#else
+          PADDLE_ENFORCE_GPU_SUCCESS(
+              cudaEventRecord(events_[i].get(), compute_stream_));
+          PADDLE_ENFORCE_GPU_SUCCESS(cudaEventSynchronize(events_[i].get()));
+#endif
+        }
         for (size_t i = 0; i < cpu.size(); ++i) {
           if (platform::is_cpu_place(cpu[i].place())) {
             cuda[i].Resize(cpu[i].dims());
@@ -236,6 +329,9 @@ void BufferedReader::ReadAsync(size_t i) {
             cudaStreamWaitEvent(stream_.get(), events_[i].get(), 0));
 #endif
 
+        TensorVec &staging = pinned_staging_buffer_[i];
+        staging.resize(cpu.size());
+
         platform::RecordEvent record_event(
             "BufferedReader:MemoryCopy",
             platform::TracerEventType::UserDefined,
@@ -252,8 +348,11 @@ void BufferedReader::ReadAsync(size_t i) {
             memory::Copy(
                 place_, gpu_ptr, cpu_place, cpu_ptr, size, stream_.get());
           } else {
+            // The staging tensors are kept by the slot and reused by the
+            // following batches, they are safe to be overwritten after the
+            // stream synchronization at the end of this batch.
             platform::CUDAPinnedPlace cuda_pinned_place;
-            phi::DenseTensor cuda_pinned_tensor;
+            phi::DenseTensor &cuda_pinned_tensor = staging[i];
             cuda_pinned_tensor.Resize(cpu[i].dims());
             auto cuda_pinned_ptr = cuda_pinned_tensor.mutable_data(
                 cuda_pinned_place, cpu[i].type());
@@ -265,8 +364,6 @@ void BufferedReader::ReadAsync(size_t i) {
                          cuda_pinned_ptr,
                          size,
                          stream_.get());
-
-            platform::GpuStreamSync(stream_.get());
           }
           cuda[i].set_lod(cpu[i].lod());
         }
@@ -290,6 +387,7 @@ void BufferedReader::ReadAsync(size_t i) {
                 npu.size(),
                 cpu.size()));
       }
+      ReuseRecycledBuffer(i, &npu);
 
       std::vector<void *> npu_ptrs;
       npu_ptrs.reserve(cpu.size());
@@ -340,6 +438,7 @@ void BufferedReader::ReadAsync(size_t i) {
                 mlu.size(),
                 cpu.size()));
       }
+      ReuseRecycledBuffer(i, &mlu);
 
       std::vector<void *> mlu_ptrs;
       mlu_ptrs.reserve(cpu.size());
@@ -391,6 +490,7 @@ void BufferedReader::ReadAsync(size_t i) {
                 xpu.size(),
                 cpu.size()));
       }
+      ReuseRecycledBuffer(i, &xpu);
 
       std::vector<void *> xpu_ptrs;
       xpu_ptrs.reserve(cpu.size());
@@ -443,6 +543,7 @@ void BufferedReader::ReadAsync(size_t i) {
                               custom_device.size(),
                               cpu.size()));
       }
+      ReuseRecycledBuffer(i, &custom_device);
 
       std::vector<void *> custom_device_ptrs;
       custom_device_ptrs.reserve(cpu.size());
@@ -485,9 +586,11 @@ void BufferedReader::ReadAsync(size_t i) {
 void BufferedReader::ShutdownImpl() {
   VLOG(1) << "ShutdownImpl";
   reader_->Shutdown();
-  while (!position_.empty()) {
-    position_.pop();
-  }
+  // The pending tasks must finish before the tickets are reset, otherwise
+  // they would wait for their turns forever.
+  WaitAllPending();
+  next_ticket_ = 0;
+  read_turn_ = 0;
   prev_pos_ = -1UL;
 }
 
@@ -501,7 +604,14 @@ void BufferedReader::ReadNextImpl(paddle::framework::LoDTensorArray *out) {
     out->clear();
     return;
   }
-  size_t i = position_.front().get();
+  auto &front = position_.front();
+  if (front.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    UpdateStallMetrics(/*consumer_stall=*/true);
+  } else if (position_.back().wait_for(std::chrono::seconds(0)) ==
+             std::future_status::ready) {
+    UpdateStallMetrics(/*consumer_stall=*/false);
+  }
+  size_t i = front.get();
   position_.pop();
 
   if (i == -1UL) {
@@ -509,19 +619,26 @@ void BufferedReader::ReadNextImpl(paddle::framework::LoDTensorArray *out) {
     return;
   }
 
+  TensorVec *buffer = nullptr;
   if (platform::is_gpu_place(place_)) {
-    *out = std::move(cuda_buffer_[i]);
+    buffer = &cuda_buffer_[i];
   } else if (platform::is_npu_place(place_)) {
-    *out = std::move(npu_buffer_[i]);
+    buffer = &npu_buffer_[i];
   } else if (platform::is_mlu_place(place_)) {
-    *out = std::move(mlu_buffer_[i]);
+    buffer = &mlu_buffer_[i];
   } else if (platform::is_xpu_place(place_)) {
-    *out = std::move(xpu_buffer_[i]);
+    buffer = &xpu_buffer_[i];
   } else if (platform::is_custom_place(place_)) {
-    *out = std::move(custom_device_buffer_[i]);
+    buffer = &custom_device_buffer_[i];
   } else {
-    *out = std::move(cpu_buffer_[i]);
+    buffer = &cpu_buffer_[i];
+  }
+  // The tensors of the CPU buffer are replaced by the underlying reader, so
+  // only the device buffers are recycled.
+  if (buffer != &cpu_buffer_[i]) {
+    recycled_buffer_[i] = *buffer;
   }
+  *out = std::move(*buffer);
 
   // Do not push current position into ReadAsync. Push the previous position
   // Since all computation in fluid are async, change the data of
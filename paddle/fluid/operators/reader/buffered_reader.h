@@ -14,8 +14,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <vector>
 
@@ -53,15 +56,33 @@ class BufferedReader : public framework::DecoratedReader {
   BufferedReader(const std::shared_ptr<framework::ReaderBase>& reader,
                  const platform::Place& place,
                  size_t buffer_size,
-                 bool pin_memory = false);
+                 bool pin_memory = false,
+                 size_t num_workers = 1);
 
   ~BufferedReader() override;
 
+  // Number of times ReadNext had to wait for the next batch, i.e. the
+  // producers are the bottleneck.
+  size_t ConsumerStallCount() const { return consumer_stall_count_; }
+  // Number of times all the in-flight batches had been ready before ReadNext
+  // was called, i.e. the producers were idle waiting for a free slot and the
+  // consumer is the bottleneck.
+  size_t ProducerStallCount() const { return producer_stall_count_; }
+
  private:
   void ReadTillBufferFullAsync();
 
   void ReadAsync(size_t i);
 
+  void WaitAllPending();
+
+  // Let `buffer` reuse the device memory of the batch previously delivered
+  // from slot `i`, if the consumer has released it. Returns whether any
+  // memory is reused.
+  bool ReuseRecycledBuffer(size_t i, TensorVec* buffer);
+
+  void UpdateStallMetrics(bool consumer_stall);
+
  protected:
   void ShutdownImpl() override;
   void StartImpl() override;
@@ -75,6 +96,17 @@ class BufferedReader : public framework::DecoratedReader {
 
   std::queue<std::future<size_t>> position_;
 
+  // With several workers, the batches are read from the underlying reader in
+  // the order of the tickets, and are delivered in the same order since
+  // position_ is FIFO, while the copies to device complete out of order.
+  size_t next_ticket_{0};
+  size_t read_turn_{0};
+  std::mutex read_mutex_;
+  std::condition_variable read_cv_;
+
+  std::atomic<size_t> consumer_stall_count_{0};
+  std::atomic<size_t> producer_stall_count_{0};
+
   // The buffer for reading data.
   // NOTE: the simplest way to implement buffered reader is do not use any
   // buffer, just read async and create futures as buffer size. However, to
@@ -86,6 +118,11 @@ class BufferedReader : public framework::DecoratedReader {
   std::vector<TensorVec> mlu_buffer_;
   std::vector<TensorVec> xpu_buffer_;
   std::vector<TensorVec> custom_device_buffer_;
+  // The batches delivered from each slot, whose memory is reused by the slot
+  // once the consumer releases them.
+  std::vector<TensorVec> recycled_buffer_;
+  // Pinned staging tensors of each slot to copy CPU tensors to GPU.
+  std::vector<TensorVec> pinned_staging_buffer_;
   size_t prev_pos_{-1UL};
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   gpuStream_t compute_stream_;
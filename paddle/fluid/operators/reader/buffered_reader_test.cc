@@ -0,0 +1,132 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/buffered_reader.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/device_context.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/platform/device/gpu/gpu_info.h"
+#endif
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+// Produce `total` batches, each of which holds one int64 tensor filled with
+// the index of the batch.
+class CountingReader : public framework::ReaderBase {
+ public:
+  explicit CountingReader(int64_t total)
+      : framework::ReaderBase({phi::make_ddim({4})},
+                              {framework::proto::VarType::INT64},
+                              {false}),
+        total_(total) {}
+
+  void ReadNextImpl(framework::LoDTensorArray *out) override {
+    out->clear();
+    if (next_ >= total_) {
+      return;
+    }
+    phi::DenseTensor tensor;
+    tensor.Resize(phi::make_ddim({4}));
+    auto *data = tensor.mutable_data<int64_t>(platform::CPUPlace());
+    for (int i = 0; i < 4; ++i) {
+      data[i] = next_;
+    }
+    ++next_;
+    out->emplace_back(std::move(tensor));
+  }
+
+  void StartImpl() override { next_ = 0; }
+
+ private:
+  int64_t total_;
+  int64_t next_{0};
+};
+
+void CheckReadInOrder(size_t num_workers) {
+  constexpr int64_t kTotal = 100;
+  auto underlying = std::make_shared<CountingReader>(kTotal);
+  auto reader = framework::MakeDecoratedReader<BufferedReader>(
+      underlying, platform::CPUPlace(), num_workers + 1, false, num_workers);
+
+  for (int epoch = 0; epoch < 2; ++epoch) {
+    framework::LoDTensorArray out;
+    for (int64_t i = 0; i < kTotal; ++i) {
+      reader->ReadNext(&out);
+      ASSERT_EQ(out.size(), 1UL);
+      EXPECT_EQ(out[0].data<int64_t>()[0], i);
+    }
+    reader->ReadNext(&out);
+    EXPECT_TRUE(out.empty());
+    reader->Shutdown();
+    reader->Start();
+  }
+  auto *buffered = static_cast<BufferedReader *>(reader.get());
+  EXPECT_GT(buffered->ConsumerStallCount() + buffered->ProducerStallCount(),
+            0UL);
+}
+
+TEST(BufferedReader, SingleWorker) { CheckReadInOrder(1); }
+
+TEST(BufferedReader, MultipleWorkersKeepOrder) { CheckReadInOrder(4); }
+
+#ifdef PADDLE_WITH_CUDA
+void CUDART_CB SleepOnStream(void *) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+}
+
+TEST(BufferedReader, PinnedMemoryReusedAfterPendingCopies) {
+  if (platform::GetGPUDeviceCount() == 0) {
+    return;
+  }
+  constexpr int64_t kTotal = 20;
+  platform::CUDAPlace place(0);
+  auto underlying = std::make_shared<CountingReader>(kTotal);
+  auto reader = framework::MakeDecoratedReader<BufferedReader>(
+      underlying, place, 2, true, 1);
+  auto *dev_ctx = static_cast<phi::GPUContext *>(
+      platform::DeviceContextPool::Instance().Get(place));
+
+  std::vector<phi::DenseTensor> copies(kTotal);
+  for (int64_t i = 0; i < kTotal; ++i) {
+    framework::LoDTensorArray out;
+    reader->ReadNext(&out);
+    ASSERT_EQ(out.size(), 1UL);
+    ASSERT_TRUE(platform::is_cuda_pinned_place(out[0].place()));
+    // Delay the copy from the pinned memory, which is released right after
+    // and reused by the reader while the copy is pending.
+    PADDLE_ENFORCE_GPU_SUCCESS(
+        cudaLaunchHostFunc(dev_ctx->stream(), SleepOnStream, nullptr));
+    framework::TensorCopy(out[0], place, *dev_ctx, &copies[i]);
+  }
+  dev_ctx->Wait();
+  for (int64_t i = 0; i < kTotal; ++i) {
+    phi::DenseTensor cpu;
+    framework::TensorCopySync(copies[i], platform::CPUPlace(), &cpu);
+    EXPECT_EQ(cpu.data<int64_t>()[0], i);
+  }
+}
+#endif
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
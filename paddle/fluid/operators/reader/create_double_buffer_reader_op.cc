@@ -15,6 +15,8 @@
 #include "paddle/fluid/operators/reader/buffered_reader.h"
 #include "paddle/fluid/operators/reader/reader_op_registry.h"
 
+DECLARE_int32(reader_num_workers);
+
 namespace paddle {
 namespace operators {
 namespace reader {
@@ -60,9 +62,10 @@ class CreateDoubleBufferReaderOp : public framework::OperatorBase {
 
     VLOG(10) << "Create new double buffer reader on " << place;
 
+    size_t num_workers = std::max(FLAGS_reader_num_workers, 1);
     out->Clear();
     out->Reset(framework::MakeDecoratedReader<BufferedReader>(
-        underlying_reader, place, 2));
+        underlying_reader, place, num_workers + 1, false, num_workers));
   }
 };
 
@@ -21,16 +21,21 @@ limitations under the License. */
 #include <sstream>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "paddle/fluid/framework/convert_utils.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/data_type_transform.h"
+#include "paddle/fluid/framework/indexed_combine_file.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/string_array.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/phi/backends/dynload/port.h"
 
+DECLARE_bool(save_combine_with_index);
+
 namespace paddle {
 namespace operators {
 template <typename DeviceContext, typename T>
@@ -67,6 +72,13 @@ class SaveCombineOpKernel : public framework::OpKernel<T> {
     platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
     auto &dev_ctx = *pool.Get(place);
 
+    // The indexed file is written from the CPU tensors, which are kept in
+    // cpu_tensors if they are converted or copied.
+    bool with_index = FLAGS_save_combine_with_index && !save_to_memory;
+    framework::IndexedCombineFileWriter writer;
+    std::vector<phi::DenseTensor> cpu_tensors;
+    cpu_tensors.reserve(inp_var_names.size());
+
     for (size_t i = 0; i < inp_var_names.size(); i++) {
       PADDLE_ENFORCE_NOT_NULL(
           inp_vars[i],
@@ -103,7 +115,25 @@ class SaveCombineOpKernel : public framework::OpKernel<T> {
           out.set_lod(tensor.lod());
           framework::TransDataType(
               in_kernel_type, out_kernel_type, tensor, &out);
-          framework::SerializeToStream(ss, out, dev_ctx);
+          if (with_index) {
+            cpu_tensors.emplace_back();
+            framework::TensorCopySync(
+                out, platform::CPUPlace(), &cpu_tensors.back());
+            cpu_tensors.back().set_lod(out.lod());
+            writer.AddTensor(inp_var_names[i], cpu_tensors.back());
+          } else {
+            framework::SerializeToStream(ss, out, dev_ctx);
+          }
+        } else if (with_index) {
+          if (platform::is_cpu_place(tensor.place())) {
+            writer.AddTensor(inp_var_names[i], tensor);
+          } else {
+            cpu_tensors.emplace_back();
+            framework::TensorCopySync(
+                tensor, platform::CPUPlace(), &cpu_tensors.back());
+            cpu_tensors.back().set_lod(tensor.lod());
+            writer.AddTensor(inp_var_names[i], cpu_tensors.back());
+          }
         } else {
           framework::SerializeToStream(ss, tensor, dev_ctx);
         }
@@ -115,7 +145,13 @@ class SaveCombineOpKernel : public framework::OpKernel<T> {
           framework::ConvertWstrToStr(it->first, &t);
           data.emplace(t, it->second);
         }
-        framework::StringMapToStream(ss, data);
+        if (with_index) {
+          std::ostringstream blob;
+          framework::StringMapToStream(blob, data);
+          writer.AddBlob(inp_var_names[i], blob.str());
+        } else {
+          framework::StringMapToStream(ss, data);
+        }
       }
     }
     if (save_to_memory) {
@@ -124,6 +160,9 @@ class SaveCombineOpKernel : public framework::OpKernel<T> {
                         platform::errors::InvalidArgument(
                             "Cannot find variable Y for save_combine_op"));
       *output = ss.str();
+    } else if (with_index) {
+      MkDirRecursively(DirName(filename).c_str());
+      writer.Write(filename);
     } else {
       MkDirRecursively(DirName(filename).c_str());
       std::ofstream fout(filename, std::ios::binary);
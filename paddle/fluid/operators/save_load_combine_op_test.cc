@@ -21,6 +21,8 @@ limitations under the License. */
 #include "paddle/fluid/platform/bfloat16.h"
 #include "paddle/fluid/platform/float16.h"
 
+DECLARE_bool(save_combine_with_index);
+
 USE_CPU_ONLY_OP(save_combine);
 USE_CPU_ONLY_OP(load_combine);
 
@@ -157,6 +159,44 @@ TEST(SaveLoadCombineBF16Op, CPU) {
   SaveLoadCombineOp<paddle::platform::bfloat16, paddle::platform::bfloat16>();
 }
 
+TEST(SaveLoadCombineOpWithIndex, CPU) {
+  FLAGS_save_combine_with_index = true;
+  SaveLoadCombineOp<int, int>();
+  FLAGS_save_combine_with_index = false;
+}
+
+// The variables in the file with an index are loaded by their names, so that
+// a part of them are loaded without reading the others.
+TEST(LoadCombineOpWithIndex, LoadByName) {
+  FLAGS_save_combine_with_index = true;
+  paddle::framework::Scope scope;
+  paddle::platform::CPUPlace place;
+
+  paddle::framework::LoD expect_lod1, expect_lod2;
+  CreateForSaveCombineOp<int, int>(
+      10, 10, {0, 1, 10}, "test_var1", place, &scope, &expect_lod1);
+  int* expect2 = CreateForSaveCombineOp<int, int>(
+      20, 30, {0, 2, 20}, "test_var2", place, &scope, &expect_lod2);
+
+  paddle::framework::AttributeMap attrs;
+  attrs.insert({"file_path", std::string("check_index.ls")});
+  auto save_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "save_combine", {{"X", {"test_var1", "test_var2"}}}, {}, attrs);
+  save_combine_op->Run(scope, place);
+
+  paddle::framework::Scope load_scope;
+  auto target2 = GeneratePlaceholderBeforeLoad("test_var2", &load_scope);
+  auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "load_combine", {}, {{"Out", {"test_var2"}}}, attrs);
+  load_combine_op->Run(load_scope, place);
+
+  paddle::framework::LoD actual_lod2;
+  int* actual2 =
+      GetValuesAfterLoadCombineOp<int>(target2, load_scope, &actual_lod2);
+  CheckValues<int, int>(expect2, actual2, expect_lod2, actual_lod2, 600);
+  FLAGS_save_combine_with_index = false;
+}
+
 // FP16 version of SaveLoadCombineOp Test, only altering the saving aspect
 // to save as FP16.
 TEST(SaveCombineFP16Op, CPU) {
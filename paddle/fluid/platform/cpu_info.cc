@@ -31,6 +31,8 @@ limitations under the License. */
 #endif  // _WIN32
 
 #include <algorithm>
+#include <fstream>
+#include <utility>
 
 #include "paddle/fluid/platform/flags.h"
 
@@ -211,5 +213,56 @@ bool MayIUse(const cpu_isa_t cpu_isa) {
 }
 #endif
 
+std::string CpuIdentity() {
+  static const std::string identity = [] {
+    std::string model;
+    std::string features;
+#ifdef __APPLE__
+    char brand[256];
+    size_t size = sizeof(brand);
+    if (sysctlbyname("machdep.cpu.brand_string", brand, &size, nullptr, 0) ==
+        0) {
+      model = brand;
+    }
+#elif !defined(_WIN32)
+    // The first processor, "flags" on x86 and "Features" on ARM.
+    std::ifstream fin("/proc/cpuinfo");
+    std::string line;
+    while ((model.empty() || features.empty()) && std::getline(fin, line)) {
+      size_t colon = line.find(':');
+      if (colon == std::string::npos) {
+        continue;
+      }
+      std::string key = line.substr(0, colon);
+      key.erase(key.find_last_not_of(" \t") + 1);
+      std::string value =
+          colon + 2 <= line.size() ? line.substr(colon + 2) : std::string();
+      if (model.empty() && (key == "model name" || key == "CPU part")) {
+        model = value;
+      } else if (features.empty() && (key == "flags" || key == "Features")) {
+        features = value;
+      }
+    }
+#endif
+    if (features.empty()) {
+      const std::pair<cpu_isa_t, const char*> isas[] = {
+          {sse42, "sse42"},
+          {avx, "avx"},
+          {avx2, "avx2"},
+          {avx512f, "avx512f"},
+          {avx512_core, "avx512_core"},
+          {avx512_core_vnni, "avx512_core_vnni"},
+          {avx512_bf16, "avx512_bf16"}};
+      for (const auto& isa : isas) {
+        if (MayIUse(isa.first)) {
+          features += std::string(features.empty() ? "" : " ") + isa.second;
+        }
+      }
+    }
+    return model + ";" + features;
+  }();
+  return identity;
+}
+
 }  // namespace platform
 }  // namespace paddle
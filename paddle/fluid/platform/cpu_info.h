@@ -16,6 +16,8 @@ limitations under the License. */
 
 #include <stddef.h>
 
+#include <string>
+
 #ifdef _WIN32
 #if defined(__AVX2__)
 #include <immintrin.h>  // avx2
@@ -89,5 +91,9 @@ using namespace phi::backends::cpu;  // NOLINT
 // May I use some instruction
 bool MayIUse(const cpu_isa_t cpu_isa);
 
+//! Get the model and the instruction sets of the host CPU, which identify the
+//! caches of things tuned or compiled for it, e.g. with -march=native.
+std::string CpuIdentity();
+
 }  // namespace platform
 }  // namespace paddle
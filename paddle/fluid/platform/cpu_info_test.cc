@@ -14,6 +14,7 @@
 #include "paddle/fluid/platform/cpu_info.h"
 
 #include <sstream>
+#include <string>
 
 #include "gflags/gflags.h"
 #include "gtest/gtest.h"
@@ -31,3 +32,9 @@ TEST(CpuMemoryUsage, Print) {
                                        memory_size)
             << std::endl;
 }
+
+TEST(CpuIdentity, Stable) {
+  std::string identity = paddle::platform::CpuIdentity();
+  EXPECT_NE(identity, ";");
+  EXPECT_EQ(paddle::platform::CpuIdentity(), identity);
+}
@@ -14,15 +14,25 @@ limitations under the License. */
 
 #include "paddle/fluid/platform/device_code.h"
 
+#include <dlfcn.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
 #include <set>
+#include <sstream>
 #include <utility>
 
+#include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/enforce.h"
 
 DECLARE_string(cuda_dir);
+DECLARE_string(fusion_group_cpu_compiler);
+DECLARE_string(fusion_group_cpu_cache_dir);
 
 namespace paddle {
 namespace platform {
@@ -69,13 +79,26 @@ DeviceCodePool::DeviceCodePool(const std::vector<platform::Place>& places) {
                     errors::InvalidArgument(
                         "Expected the number of places >= 1. But received %d.",
                         places.size()));
+  AddPlaces(places);
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  CUDADeviceCode::CheckAvailableStatus();
+#endif
+}
+
+void DeviceCodePool::AddPlaces(const std::vector<platform::Place>& places) {
   // Remove the duplicated places
   std::set<Place> set;
   for (auto& p : places) {
     set.insert(p);
   }
   for (auto& p : set) {
-    if (is_gpu_place(p)) {
+    if (device_codes_.count(p)) {
+      continue;
+    }
+    if (is_cpu_place(p)) {
+      device_codes_.emplace(p, DeviceCodeMap());
+    } else if (is_gpu_place(p)) {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
       device_codes_.emplace(p, DeviceCodeMap());
 #else
@@ -85,10 +108,150 @@ DeviceCodePool::DeviceCodePool(const std::vector<platform::Place>& places) {
 #endif
     }
   }
+}
 
-#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
-  CUDADeviceCode::CheckAvailableStatus();
+static constexpr char kCPUCompileOptions[] =
+    "-std=c++11 -O3 -march=native -fno-math-errno -fopenmp-simd -fPIC "
+    "-shared";
+// The elements of a block are computed by one call of the kernel, and the
+// blocks run in parallel.
+static constexpr int64_t kCPULaunchBlockSize = 1 << 14;
+
+// The directory of the compiled code. Without FLAGS_fusion_group_cpu_cache_dir
+// it is a temporary directory of the process, so that the libraries written
+// by the other users are never loaded.
+static std::string GetCPUCodeDir() {
+  if (!FLAGS_fusion_group_cpu_cache_dir.empty()) {
+    mkdir(FLAGS_fusion_group_cpu_cache_dir.c_str(), 0755);
+    return FLAGS_fusion_group_cpu_cache_dir;
+  }
+  static std::string dir = []() -> std::string {
+    const char* tmp = std::getenv("TMPDIR");
+    std::string pattern = std::string(tmp && *tmp ? tmp : "/tmp") +
+                          "/paddle_fusion_group_XXXXXX";
+    std::vector<char> buffer(pattern.begin(), pattern.end());
+    buffer.push_back('\0');
+    return mkdtemp(buffer.data()) ? std::string(buffer.data()) : "";
+  }();
+  return dir;
+}
+
+CPUDeviceCode::CPUDeviceCode(const Place& place,
+                             const std::string& name,
+                             const std::string& kernel) {
+  if (!is_cpu_place(place)) {
+    PADDLE_THROW(platform::errors::PermissionDenied(
+        "CPUDeviceCode can only launch on CPU place."));
+  }
+
+  place_ = place;
+  name_ = name;
+  kernel_ = kernel;
+}
+
+CPUDeviceCode::~CPUDeviceCode() {
+  if (handle_) {
+    dlclose(handle_);
+  }
+}
+
+bool CPUDeviceCode::IsAvailable() {
+  std::string command =
+      FLAGS_fusion_group_cpu_compiler + " --version > /dev/null 2>&1";
+  return std::system(command.c_str()) == 0;
+}
+
+bool CPUDeviceCode::Compile(bool include_path) {
+  is_compiled_ = false;
+  std::string dir = GetCPUCodeDir();
+  if (dir.empty()) {
+    LOG_FIRST_N(WARNING, 1)
+        << "Failed to create the directory to compile < " << name_ << " >.";
+    return false;
+  }
+
+  std::string compiler =
+      FLAGS_fusion_group_cpu_compiler + " " + kCPUCompileOptions;
+  // The library is compiled with -march=native, so the cache shared by the
+  // hosts of different CPUs must not load the ones compiled for the others.
+  std::stringstream hash;
+  hash << std::hex
+       << std::hash<std::string>()(compiler + "\n" + CpuIdentity() + "\n" +
+                                   kernel_);
+  std::string prefix = dir + "/" + name_ + "_" + hash.str();
+  std::string library = prefix + ".so";
+  struct stat library_stat;
+  if (stat(library.c_str(), &library_stat) != 0) {
+    std::string source = prefix + ".cc";
+    std::string log = prefix + ".log";
+    // Compile to a file of the process and rename it, so that the processes
+    // sharing the cache never load a partially written library.
+    std::string temp_library = prefix + "." + std::to_string(getpid()) + ".so";
+    {
+      std::ofstream ofs(source);
+      ofs << kernel_;
+      if (!ofs) {
+        LOG_FIRST_N(WARNING, 1) << "Failed to write " << source << ".";
+        return false;
+      }
+    }
+    std::string command = compiler + " -o \"" + temp_library + "\" \"" +
+                          source + "\" > \"" + log + "\" 2>&1";
+    VLOG(3) << "Compile < " << name_ << " >: " << command;
+    if (std::system(command.c_str()) != 0 ||
+        std::rename(temp_library.c_str(), library.c_str()) != 0) {
+      std::ifstream ifs(log);
+      std::stringstream message;
+      message << ifs.rdbuf();
+      LOG_FIRST_N(WARNING, 1) << "Failed to compile < " << name_
+                              << " > by: " << command << "\n"
+                              << message.str();
+      std::remove(temp_library.c_str());
+      return false;
+    }
+  }
+
+  handle_ = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!handle_) {
+    LOG_FIRST_N(WARNING, 1) << "Failed to load " << library << ": "
+                            << dlerror();
+    return false;
+  }
+  function_ = reinterpret_cast<KernelFunc>(dlsym(handle_, name_.c_str()));
+  if (!function_) {
+    LOG_FIRST_N(WARNING, 1) << "Failed to find < " << name_ << " > in "
+                            << library << ".";
+    return false;
+  }
+  is_compiled_ = true;
+  return true;
+}
+
+void CPUDeviceCode::Launch(const size_t n, std::vector<void*>* args) const {
+  PADDLE_ENFORCE_EQ(
+      is_compiled_,
+      true,
+      errors::PreconditionNotMet(
+          "Please compile the code before launching the kernel."));
+
+  // Skip the address of n.
+  std::vector<void*> ptrs(args->size() - 1);
+  for (size_t i = 0; i < ptrs.size(); ++i) {
+    ptrs[i] = *static_cast<void**>((*args)[i + 1]);
+  }
+  const int64_t numel = static_cast<int64_t>(n);
+  const int64_t num_blocks =
+      (numel + kCPULaunchBlockSize - 1) / kCPULaunchBlockSize;
+  bool parallel = num_blocks > 1;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (parallel)
 #endif
+  for (int64_t i = 0; i < num_blocks; ++i) {
+    function_(i * kCPULaunchBlockSize,
+              std::min(numel, (i + 1) * kCPULaunchBlockSize),
+              ptrs.data());
+  }
+  (void)parallel;
 }
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
@@ -48,6 +48,34 @@ class DeviceCode {
   std::string kernel_;
 };
 
+// The C++ code compiled by the host compiler into a shared library, and
+// loaded by dlopen. The kernel is expected to define
+//   extern "C" void name(int64_t begin, int64_t end, void** args)
+// which computes the elements in [begin, end), where args are the pointers of
+// the inputs and the outputs. The libraries are cached by the hash of the
+// code, in FLAGS_fusion_group_cpu_cache_dir if it is set.
+class CPUDeviceCode : public DeviceCode {
+ public:
+  explicit CPUDeviceCode(const Place& place,
+                         const std::string& name,
+                         const std::string& kernel);
+  ~CPUDeviceCode() override;
+  bool Compile(bool include_path = false) override;
+  // args are the same as CUDADeviceCode, that is the address of n followed
+  // by the addresses of the pointers of the inputs and the outputs.
+  void Launch(const size_t n, std::vector<void*>* args) const override;
+
+  // Whether FLAGS_fusion_group_cpu_compiler can be run.
+  static bool IsAvailable();
+
+ private:
+  using KernelFunc = void (*)(int64_t, int64_t, void**);
+
+  bool is_compiled_{false};
+  void* handle_{nullptr};
+  KernelFunc function_{nullptr};
+};
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 class CUDADeviceCode : public DeviceCode {
  public:
@@ -107,6 +135,8 @@ class DeviceCodePool {
   static DeviceCodePool& Init(const std::vector<platform::Place>& places) {
     if (pool == nullptr) {
       pool = new DeviceCodePool(places);
+    } else {
+      pool->AddPlaces(places);
     }
     return *pool;
   }
@@ -125,6 +155,8 @@ class DeviceCodePool {
   }
 
  private:
+  void AddPlaces(const std::vector<platform::Place>& places);
+
   static DeviceCodePool* pool;
   std::map<Place, DeviceCodeMap> device_codes_;
   DISABLE_COPY_AND_ASSIGN(DeviceCodePool);
@@ -232,6 +232,189 @@ PADDLE_DEFINE_EXPORTED_bool(
     true,
     "Whether enable api kernel fallback to CPU one when not found");
 
+/*
+ * Kernel related FLAG
+ * Name: FLAGS_use_strided_view
+ * Since Version: 2.5
+ * Value Range: bool, default=false
+ * Example: FLAGS_use_strided_view=true would make transpose, slice, split,
+ * unbind, diagonal and expand of dygraph return views of the CPU input
+ * instead of copies
+ * Note: The views share the memory with the input, so the other kernels
+ * copy them to contiguous tensors before using them.
+ */
+PADDLE_DEFINE_EXPORTED_bool(
+    use_strided_view,
+    false,
+    "Whether the dygraph api returns strided views instead of copies for "
+    "transpose, slice, split, unbind, diagonal and expand on CPU");
+
+/*
+ * Kernel related FLAG
+ * Name: FLAGS_use_direct_conv
+ * Since Version: 2.5
+ * Value Range: bool, default=false
+ * Example: FLAGS_use_direct_conv=true would make the CPU conv2d and
+ * depthwise_conv2d of NCHW run the direct convolution with packed filters
+ * instead of im2col and GEMM
+ * Note: The packed filters of the parameters of the predictors are cached,
+ * the other filters are packed on every call.
+ */
+PADDLE_DEFINE_EXPORTED_bool(
+    use_direct_conv,
+    false,
+    "Whether the CPU conv2d runs the direct convolution with packed filters "
+    "instead of im2col and GEMM");
+
+/*
+ * Kernel related FLAG
+ * Name: FLAGS_use_packed_gemm
+ * Since Version: 2.5
+ * Value Range: bool, default=false
+ * Example: FLAGS_use_packed_gemm=true would make the CPU fc and matmul_v2
+ * pack the constant weights for the MKL packed GEMM once, and reuse them
+ * on the later calls
+ * Note: Only the parameters of the predictors are constant weights, and
+ * the packed weights take as much memory as the weights.
+ */
+PADDLE_DEFINE_EXPORTED_bool(
+    use_packed_gemm,
+    false,
+    "Whether the CPU fc and matmul_v2 reuse the constant weights packed for "
+    "the MKL packed GEMM");
+
+/*
+ * Performance related FLAG
+ * Name: FLAGS_use_numpy_zero_copy
+ * Since Version: 2.5
+ * Value Range: bool, default=false
+ * Example: FLAGS_use_numpy_zero_copy=true would make the new CPU tensors
+ * created from the numpy arrays, such as the fed data and paddle.to_tensor,
+ * share the memory of the arrays, and Tensor.numpy() of the CPU tensors
+ * return the arrays sharing the memory of the tensors
+ * Note: The tensor and the array alias each other, so that writing one of
+ * them is seen by the other. The arrays which are not C-contiguous, aligned
+ * and writeable, or are fed to the initialized tensors, are still copied.
+ */
+PADDLE_DEFINE_EXPORTED_bool(
+    use_numpy_zero_copy,
+    false,
+    "Whether the CPU tensors and the numpy arrays converted from each other "
+    "share the memory");
+
+/*
+ * Memory related FLAG
+ * Name: FLAGS_use_shm_cache
+ * Since Version: 2.5
+ * Value Range: bool, default=false
+ * Example: FLAGS_use_shm_cache=true would make the tensors passed between
+ * processes in shared memory, such as the batches of the DataLoader workers,
+ * reuse the shared memory files kept mapped by MemoryMapAllocationPool
+ * instead of creating, mapping and unlinking a file for every tensor
+ * Note: The free files are kept until the process exits, at most
+ * FLAGS_shm_cache_size files of FLAGS_shm_cache_max_mb MB in each process. The
+ * files received from a DataLoader worker are released when it exits.
+ */
+PADDLE_DEFINE_EXPORTED_bool(
+    use_shm_cache,
+    false,
+    "Whether the tensors passed between processes reuse the shared memory "
+    "files kept mapped by the process");
+
+/*
+ * Memory related FLAG
+ * Name: FLAGS_shm_cache_size
+ * Since Version: 2.5
+ * Value Range: int32, default=128
+ * Example: FLAGS_shm_cache_size=256 would make each process keep at most 256
+ * shared memory files mapped when FLAGS_use_shm_cache is true
+ * Note: The tensors are passed in the files which are not kept if all the
+ * kept files are in use.
+ */
+PADDLE_DEFINE_EXPORTED_int32(
+    shm_cache_size,
+    128,
+    "The max number of the shared memory files kept mapped by each process "
+    "when FLAGS_use_shm_cache is true");
+
+/*
+ * Memory related FLAG
+ * Name: FLAGS_shm_cache_max_mb
+ * Since Version: 2.5
+ * Value Range: uint64, default=1024 (MB)
+ * Example: FLAGS_shm_cache_max_mb=4096 would make each process keep at most
+ * 4096 MB of shared memory files mapped when FLAGS_use_shm_cache is true
+ * Note: The tensors larger than it are passed in the files which are not kept.
+ */
+PADDLE_DEFINE_EXPORTED_uint64(
+    shm_cache_max_mb,
+    1024,
+    "The max size in MB of the shared memory files kept mapped by each "
+    "process when FLAGS_use_shm_cache is true");
+
+/*
+ * Performance related FLAG
+ * Name: FLAGS_save_combine_with_index
+ * Since Version: 2.5
+ * Value Range: bool, default=false
+ * Example: FLAGS_save_combine_with_index=true would make save_combine write
+ * the files with an index of the variables, whose data are written and read
+ * in parallel by load_combine, which can also load a part of the variables
+ * by their names without reading the others
+ * Note: The files are only read by load_combine and the jit loader of this
+ * version or later. The files saved to memory are not indexed.
+ */
+PADDLE_DEFINE_EXPORTED_bool(
+    save_combine_with_index,
+    false,
+    "Whether save_combine writes the files with an index of the variables");
+
+/*
+ * Kernel related FLAG
+ * Name: FLAGS_use_cpu_fusion_group
+ * Since Version: 2.5
+ * Value Range: bool, default=false
+ * Example: FLAGS_use_cpu_fusion_group=true would make fusion_group_pass fuse
+ * the elementwise subgraphs of the CPU programs into fusion_group ops, whose
+ * code is compiled at runtime by FLAGS_fusion_group_cpu_compiler
+ * Note: The pass is skipped on CPU if the compiler is not found.
+ */
+PADDLE_DEFINE_EXPORTED_bool(
+    use_cpu_fusion_group,
+    false,
+    "Whether fusion_group_pass fuses the elementwise subgraphs on CPU");
+
+/*
+ * Kernel related FLAG
+ * Name: FLAGS_fusion_group_cpu_compiler
+ * Since Version: 2.5
+ * Value Range: string, default=c++
+ * Example: FLAGS_fusion_group_cpu_compiler=g++-9 would compile the CPU code
+ * of fusion_group with g++-9
+ * Note: The compiler is run as a command, so it may be a path.
+ */
+PADDLE_DEFINE_EXPORTED_string(
+    fusion_group_cpu_compiler,
+    "c++",
+    "The C++ compiler used to compile the CPU code of fusion_group");
+
+/*
+ * Kernel related FLAG
+ * Name: FLAGS_fusion_group_cpu_cache_dir
+ * Since Version: 2.5
+ * Value Range: string, default=""
+ * Example: FLAGS_fusion_group_cpu_cache_dir=/path/to/cache would keep the
+ * compiled CPU code of fusion_group in the directory and reuse it in the
+ * later processes
+ * Note: If it is empty, the code is compiled in a temporary directory of
+ * the process, and only reused in the process. The code is compiled for the
+ * host CPU, so the directory can be shared by hosts of different CPUs.
+ */
+PADDLE_DEFINE_EXPORTED_string(
+    fusion_group_cpu_cache_dir,
+    "",
+    "The directory to cache the compiled CPU code of fusion_group");
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 /**
  * CUDNN related FLAG
@@ -376,6 +559,35 @@ PADDLE_DEFINE_EXPORTED_bool(
 PADDLE_DEFINE_EXPORTED_int32(communicator_send_queue_size,
                              20,
                              "queue size to recv gradient before send");
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_communicator_coalesce_sparse_send
+ * Since Version: 2.4.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If true, the async communicator sends the merged gradients of all
+ *       the sparse tables with one request per server, instead of one
+ *       request per table and server.
+ */
+PADDLE_DEFINE_EXPORTED_bool(
+    communicator_coalesce_sparse_send,
+    false,
+    "send the gradients of sparse tables in one request per server");
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_communicator_adaptive_merge
+ * Since Version: 2.4.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If true, the async communicator adjusts the number of gradients to
+ *       merge and the time to wait for them with the depth of the send
+ *       queue and the latency of the RPCs, within
+ *       [communicator_max_merge_var_num, 4 * communicator_max_merge_var_num]
+ *       and [0, communicator_send_wait_times] respectively.
+ */
+PADDLE_DEFINE_EXPORTED_bool(communicator_adaptive_merge,
+                            false,
+                            "adapt the merge window of the communicator");
 #endif
 
 /**
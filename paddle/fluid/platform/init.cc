@@ -28,6 +28,7 @@ limitations under the License. */
 #include "paddle/fluid/platform/device/device_wrapper.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/init.h"
+#include "paddle/fluid/platform/metrics_exporter.h"
 #include "paddle/fluid/platform/os_info.h"
 #include "paddle/fluid/platform/place.h"
 
@@ -111,6 +112,7 @@ bool InitGflags(std::vector<std::string> args) {
     successed = true;
 
     VLOG(1) << "After Parse: argc is " << argc;
+    platform::InitMetricsExport();
   });
   return successed;
 }
@@ -285,6 +287,7 @@ void InitDevices(const std::vector<int> devices) {
 #ifndef PADDLE_WITH_MKLDNN
   platform::SetNumThreads(FLAGS_paddle_num_threads);
 #endif
+  platform::InitMetricsExport();
 }
 
 #ifndef _WIN32
@@ -13,8 +13,14 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 #include "paddle/fluid/platform/init.h"
 
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
 #include "gtest/gtest.h"
 #include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/metrics_exporter.h"
 #ifdef PADDLE_WITH_MLU
 #include "paddle/fluid/platform/device/mlu/device_context.h"
 #endif
@@ -67,6 +73,24 @@ TEST(InitDevices, MLU) {
 #endif
 }
 
+TEST(InitGflags, MetricsExport) {
+  // Only the path is set, metrics export does not need FLAGS_enable_metrics.
+  std::string path = "init_test_metrics.prom";
+  std::remove(path.c_str());
+  ASSERT_TRUE(paddle::framework::InitGflags(
+      {"--metrics_export_path=" + path, "--metrics_export_interval_ms=10"}));
+  ASSERT_FALSE(paddle::platform::IsMetricsEnabled());
+
+  bool exported = false;
+  for (int i = 0; i < 500 && !exported; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    exported = std::ifstream(path).good();
+  }
+  EXPECT_TRUE(exported);
+  paddle::platform::MetricsRegistry::Instance().StopFileExport();
+  std::remove(path.c_str());
+}
+
 #ifndef _WIN32
 TEST(SignalHandle, SignalHandle) {
   std::string msg = "Signal raises";
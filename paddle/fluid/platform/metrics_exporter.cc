@@ -0,0 +1,502 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/metrics_exporter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#include "glog/logging.h"
+
+#include "paddle/fluid/memory/stats.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/flags.h"
+#include "paddle/fluid/platform/monitor.h"
+
+/**
+ * Metrics related FLAG
+ * Name: FLAGS_enable_metrics
+ * Since Version: 2.4.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: Collect executor op latency, predictor latency and data feed queue
+ * depth into the MetricsRegistry. Allocator stats and StatRegistry values
+ * are always exported since they are collected anyway.
+ */
+PADDLE_DEFINE_EXPORTED_bool(enable_metrics,
+                            false,
+                            "Collect runtime metrics for export.");
+
+/**
+ * Metrics related FLAG
+ * Name: FLAGS_metrics_export_path
+ * Since Version: 2.4.0
+ * Value Range: string, default=""
+ * Example: FLAGS_metrics_export_path=/var/lib/node_exporter/paddle.prom
+ * Note: If not empty, metrics are dumped to this file in the OpenMetrics
+ * text format every FLAGS_metrics_export_interval_ms milliseconds, from the
+ * initialization of Paddle on, whether FLAGS_enable_metrics is set or not.
+ */
+PADDLE_DEFINE_EXPORTED_string(metrics_export_path,
+                              "",
+                              "The file to dump metrics to periodically.");
+
+/**
+ * Metrics related FLAG
+ * Name: FLAGS_metrics_export_interval_ms
+ * Since Version: 2.4.0
+ * Value Range: int64, default=10000
+ * Example:
+ * Note: The interval of dumping metrics to FLAGS_metrics_export_path.
+ */
+PADDLE_DEFINE_EXPORTED_int64(metrics_export_interval_ms,
+                             10000,
+                             "The interval in ms of dumping metrics.");
+
+namespace paddle {
+namespace platform {
+
+namespace {
+
+template <typename T>
+void AtomicAdd(std::atomic<T>* target, T inc) {
+  T prev = target->load(std::memory_order_relaxed);
+  while (!target->compare_exchange_weak(
+      prev, prev + inc, std::memory_order_relaxed)) {
+  }
+}
+
+std::string EscapeLabelValue(const std::string& value) {
+  std::string out;
+  out.reserve(value.size());
+  for (char c : value) {
+    if (c == '\\' || c == '"') {
+      out.push_back('\\');
+      out.push_back(c);
+    } else if (c == '\n') {
+      out.append("\\n");
+    } else {
+      out.push_back(c);
+    }
+  }
+  return out;
+}
+
+// Serialize labels as `k1="v1",k2="v2"`, which is also used as the key of a
+// metric in its family.
+std::string FormatLabels(const MetricLabels& labels) {
+  std::string out;
+  for (auto& kv : labels) {
+    if (!out.empty()) {
+      out.push_back(',');
+    }
+    out.append(kv.first).append("=\"").append(EscapeLabelValue(kv.second));
+    out.push_back('"');
+  }
+  return out;
+}
+
+std::string JoinLabels(const std::string& labels, const std::string& extra) {
+  if (labels.empty()) return extra;
+  if (extra.empty()) return labels;
+  return labels + "," + extra;
+}
+
+std::string FormatDouble(double value) {
+  if (std::isinf(value)) {
+    return value > 0 ? "+Inf" : "-Inf";
+  }
+  if (std::isnan(value)) {
+    return "NaN";
+  }
+  std::ostringstream os;
+  os.precision(17);
+  os << value;
+  return os.str();
+}
+
+void WriteSample(std::ostringstream* os,
+                 const std::string& name,
+                 const std::string& labels,
+                 const std::string& value) {
+  *os << name;
+  if (!labels.empty()) {
+    *os << "{" << labels << "}";
+  }
+  *os << " " << value << "\n";
+}
+
+void WriteHeader(std::ostringstream* os,
+                 const std::string& name,
+                 const char* type,
+                 const std::string& help) {
+  *os << "# TYPE " << name << " " << type << "\n";
+  if (!help.empty()) {
+    *os << "# HELP " << name << " " << help << "\n";
+  }
+}
+
+template <typename T>
+void ExportStatRegistry(std::ostringstream* os) {
+  for (auto& stat : StatRegistry<T>::Instance().publish()) {
+    WriteSample(os,
+                "paddle_stat",
+                FormatLabels({{"name", stat.key}}),
+                FormatDouble(static_cast<double>(stat.value)));
+  }
+}
+
+void ExportMemoryStats(std::ostringstream* os) {
+  // Only the ids of devices which have ever reserved memory are exported.
+  constexpr int kMaxDeviceNum = 16;
+  const std::vector<std::pair<const char*, const char*>> stat_types = {
+      {"Allocated", "allocated"}, {"Reserved", "reserved"}};
+  for (auto& stat_type : stat_types) {
+    for (const char* kind : {"current", "peak"}) {
+      bool is_peak = std::string(kind) == "peak";
+      std::string name = std::string("paddle_memory_") + stat_type.second +
+                         (is_peak ? "_peak_bytes" : "_bytes");
+      WriteHeader(os,
+                  name,
+                  "gauge",
+                  std::string(is_peak ? "Peak " : "Current ") +
+                      stat_type.second + " memory of the allocator.");
+      int64_t host_value =
+          is_peak ? memory::HostMemoryStatPeakValue(stat_type.first, 0)
+                  : memory::HostMemoryStatCurrentValue(stat_type.first, 0);
+      WriteSample(os,
+                  name,
+                  FormatLabels({{"place", "host"}}),
+                  std::to_string(host_value));
+      for (int dev_id = 0; dev_id < kMaxDeviceNum; ++dev_id) {
+        if (memory::DeviceMemoryStatPeakValue("Reserved", dev_id) == 0) {
+          continue;
+        }
+        int64_t value =
+            is_peak
+                ? memory::DeviceMemoryStatPeakValue(stat_type.first, dev_id)
+                : memory::DeviceMemoryStatCurrentValue(stat_type.first,
+                                                       dev_id);
+        std::string place = "device:" + std::to_string(dev_id);
+        WriteSample(os,
+                    name,
+                    FormatLabels({{"place", place}}),
+                    std::to_string(value));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+void MetricGauge::Add(double inc) { AtomicAdd(&value_, inc); }
+
+MetricHistogram::MetricHistogram(const std::vector<double>& bounds)
+    : bounds_(bounds), buckets_(new std::atomic<int64_t>[bounds.size() + 1]) {
+  PADDLE_ENFORCE_EQ(
+      std::is_sorted(bounds_.begin(), bounds_.end()),
+      true,
+      errors::InvalidArgument("The bounds of histogram must be sorted."));
+  for (size_t i = 0; i <= bounds_.size(); ++i) {
+    buckets_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void MetricHistogram::Observe(double value) {
+  size_t idx = std::lower_bound(bounds_.begin(), bounds_.end(), value) -
+               bounds_.begin();
+  buckets_[idx].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  AtomicAdd(&sum_, value);
+}
+
+std::vector<int64_t> MetricHistogram::CumulativeCounts() const {
+  std::vector<int64_t> counts(bounds_.size() + 1);
+  int64_t acc = 0;
+  for (size_t i = 0; i <= bounds_.size(); ++i) {
+    acc += buckets_[i].load(std::memory_order_relaxed);
+    counts[i] = acc;
+  }
+  return counts;
+}
+
+double MetricHistogram::Quantile(double q) const {
+  auto counts = CumulativeCounts();
+  int64_t total = counts.back();
+  if (total == 0) {
+    return 0.0;
+  }
+  double rank = std::min(std::max(q, 0.0), 1.0) * total;
+  size_t idx = std::lower_bound(counts.begin(), counts.end(), rank) -
+               counts.begin();
+  if (idx >= bounds_.size()) {
+    // Falls into the +Inf bucket, return the largest finite bound.
+    return bounds_.empty() ? 0.0 : bounds_.back();
+  }
+  double lower = idx == 0 ? 0.0 : bounds_[idx - 1];
+  double upper = bounds_[idx];
+  int64_t below = idx == 0 ? 0 : counts[idx - 1];
+  int64_t in_bucket = counts[idx] - below;
+  if (in_bucket == 0) {
+    return upper;
+  }
+  return lower + (upper - lower) * (rank - below) / in_bucket;
+}
+
+const std::vector<double>& DefaultLatencyBuckets() {
+  static const std::vector<double> buckets = [] {
+    std::vector<double> b;
+    for (double v = 1e-6; v < 20.0; v *= 2) {
+      b.push_back(v);
+    }
+    return b;
+  }();
+  return buckets;
+}
+
+MetricsRegistry& MetricsRegistry::Instance() {
+  // Leaked, so that the last dump runs in the exit handler registered by
+  // StartFileExport rather than in a static destructor, when the registries
+  // it reads may have been destroyed.
+  static auto* registry = new MetricsRegistry();
+  return *registry;
+}
+
+MetricsRegistry::MetricsRegistry() = default;
+
+MetricsRegistry::~MetricsRegistry() { StopFileExport(); }
+
+MetricsRegistry::Family* MetricsRegistry::GetFamily(const std::string& name,
+                                                    MetricType type,
+                                                    const std::string& help) {
+  auto it = families_.find(name);
+  if (it == families_.end()) {
+    Family family;
+    family.type = type;
+    family.help = help;
+    it = families_.emplace(name, std::move(family)).first;
+  }
+  PADDLE_ENFORCE_EQ(
+      it->second.type == type,
+      true,
+      errors::AlreadyExists(
+          "Metric %s has been registered with another type.", name));
+  return &it->second;
+}
+
+MetricCounter* MetricsRegistry::GetCounter(const std::string& name,
+                                           const std::string& help,
+                                           const MetricLabels& labels) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto* family = GetFamily(name, MetricType::kCounter, help);
+  auto& counter = family->counters[FormatLabels(labels)];
+  if (!counter) {
+    counter.reset(new MetricCounter());
+  }
+  return counter.get();
+}
+
+MetricGauge* MetricsRegistry::GetGauge(const std::string& name,
+                                       const std::string& help,
+                                       const MetricLabels& labels) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto* family = GetFamily(name, MetricType::kGauge, help);
+  auto& gauge = family->gauges[FormatLabels(labels)];
+  if (!gauge) {
+    gauge.reset(new MetricGauge());
+  }
+  return gauge.get();
+}
+
+MetricHistogram* MetricsRegistry::GetHistogram(
+    const std::string& name,
+    const std::string& help,
+    const MetricLabels& labels,
+    const std::vector<double>& bounds,
+    const std::vector<double>& quantiles) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto* family = GetFamily(name, MetricType::kHistogram, help);
+  if (family->histograms.empty()) {
+    family->bounds = bounds;
+    family->quantiles = quantiles;
+  }
+  auto& histogram = family->histograms[FormatLabels(labels)];
+  if (!histogram) {
+    histogram.reset(new MetricHistogram(family->bounds));
+  }
+  return histogram.get();
+}
+
+std::string MetricsRegistry::ExportText() {
+  std::ostringstream os;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto& kv : families_) {
+      const std::string& name = kv.first;
+      const Family& family = kv.second;
+      switch (family.type) {
+        case MetricType::kCounter:
+          WriteHeader(&os, name, "counter", family.help);
+          for (auto& c : family.counters) {
+            WriteSample(&os,
+                        name + "_total",
+                        c.first,
+                        std::to_string(c.second->Value()));
+          }
+          break;
+        case MetricType::kGauge:
+          WriteHeader(&os, name, "gauge", family.help);
+          for (auto& g : family.gauges) {
+            WriteSample(&os, name, g.first, FormatDouble(g.second->Value()));
+          }
+          break;
+        case MetricType::kHistogram:
+          WriteHeader(&os, name, "histogram", family.help);
+          for (auto& h : family.histograms) {
+            auto counts = h.second->CumulativeCounts();
+            for (size_t i = 0; i < counts.size(); ++i) {
+              double le = i < family.bounds.size()
+                              ? family.bounds[i]
+                              : std::numeric_limits<double>::infinity();
+              WriteSample(
+                  &os,
+                  name + "_bucket",
+                  JoinLabels(h.first, "le=\"" + FormatDouble(le) + "\""),
+                  std::to_string(counts[i]));
+            }
+            WriteSample(&os,
+                        name + "_count",
+                        h.first,
+                        std::to_string(counts.back()));
+            WriteSample(
+                &os, name + "_sum", h.first, FormatDouble(h.second->Sum()));
+          }
+          if (!family.quantiles.empty()) {
+            std::string quantile_name = name + "_quantile";
+            WriteHeader(&os,
+                        quantile_name,
+                        "gauge",
+                        "Estimated quantiles of " + name + ".");
+            for (auto& h : family.histograms) {
+              for (double q : family.quantiles) {
+                WriteSample(
+                    &os,
+                    quantile_name,
+                    JoinLabels(h.first,
+                               "quantile=\"" + FormatDouble(q) + "\""),
+                    FormatDouble(h.second->Quantile(q)));
+              }
+            }
+          }
+          break;
+      }
+    }
+  }
+
+  WriteHeader(&os, "paddle_stat", "gauge", "Values of the StatRegistry.");
+  ExportStatRegistry<int64_t>(&os);
+  ExportStatRegistry<float>(&os);
+
+  ExportMemoryStats(&os);
+
+  os << "# EOF\n";
+  return os.str();
+}
+
+bool MetricsRegistry::DumpToFile(const std::string& path) {
+  std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream fout(tmp_path, std::ios::out | std::ios::trunc);
+    if (!fout) {
+      LOG(WARNING) << "Cannot open " << tmp_path << " to dump metrics.";
+      return false;
+    }
+    fout << ExportText();
+    if (!fout) {
+      LOG(WARNING) << "Failed to write metrics to " << tmp_path;
+      return false;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Failed to rename " << tmp_path << " to " << path;
+    return false;
+  }
+  return true;
+}
+
+void MetricsRegistry::StartFileExport(const std::string& path,
+                                      int64_t interval_ms) {
+  PADDLE_ENFORCE_GT(
+      interval_ms,
+      0,
+      errors::InvalidArgument(
+          "The interval of dumping metrics must be greater than 0, but got %d.",
+          interval_ms));
+  static std::once_flag exit_flag;
+  std::call_once(exit_flag, [this] {
+    // The exit handlers run before the destructors of the static objects
+    // constructed before they are registered, so construct all the
+    // registries read by the dump first.
+    ExportText();
+    std::atexit([] { MetricsRegistry::Instance().StopFileExport(); });
+  });
+  StopFileExport();
+  {
+    std::lock_guard<std::mutex> guard(export_mutex_);
+    export_stop_ = false;
+  }
+  export_thread_ = std::thread([this, path, interval_ms] {
+    std::unique_lock<std::mutex> lock(export_mutex_);
+    while (!export_stop_) {
+      export_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms), [this] {
+        return export_stop_;
+      });
+      lock.unlock();
+      DumpToFile(path);
+      lock.lock();
+    }
+  });
+  VLOG(1) << "Start dumping metrics to " << path << " every " << interval_ms
+          << " ms.";
+}
+
+void MetricsRegistry::StopFileExport() {
+  {
+    std::lock_guard<std::mutex> guard(export_mutex_);
+    export_stop_ = true;
+  }
+  export_cv_.notify_all();
+  if (export_thread_.joinable()) {
+    export_thread_.join();
+  }
+}
+
+void InitMetricsExport() {
+  if (FLAGS_metrics_export_path.empty()) {
+    return;
+  }
+  static std::once_flag export_flag;
+  std::call_once(export_flag, [] {
+    MetricsRegistry::Instance().StartFileExport(
+        FLAGS_metrics_export_path, FLAGS_metrics_export_interval_ms);
+  });
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,199 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gflags/gflags.h"
+
+#include "paddle/phi/core/macros.h"
+
+DECLARE_bool(enable_metrics);
+
+namespace paddle {
+namespace platform {
+
+// Metrics exported in the OpenMetrics text format. Unlike StatRegistry in
+// monitor.h, every metric here can carry labels (e.g. op type, place), and
+// the whole registry, together with StatRegistry values and the memory
+// stats in memory/stats.h, can be rendered to text by ExportText() or dumped
+// to a file periodically, which can be scraped by the node_exporter textfile
+// collector.
+//
+// Metrics are never destroyed once created, so the pointers returned by
+// MetricsRegistry::Get* can be cached by the caller.
+
+using MetricLabels = std::map<std::string, std::string>;
+
+enum class MetricType { kCounter, kGauge, kHistogram };
+
+class MetricCounter {
+ public:
+  void Increase(int64_t inc = 1) {
+    value_.fetch_add(inc, std::memory_order_relaxed);
+  }
+  int64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+class MetricGauge {
+ public:
+  void Set(double value) { value_.store(value, std::memory_order_relaxed); }
+  void Add(double inc);
+  double Value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<double> value_{0.0};
+};
+
+class MetricHistogram {
+ public:
+  // `bounds` are the upper bounds of the buckets, in ascending order. The
+  // +Inf bucket is implicit.
+  explicit MetricHistogram(const std::vector<double>& bounds);
+
+  void Observe(double value);
+
+  const std::vector<double>& Bounds() const { return bounds_; }
+  // Cumulative count of observations that are <= Bounds()[i]; the last
+  // element is the total count.
+  std::vector<int64_t> CumulativeCounts() const;
+  int64_t Count() const { return count_.load(std::memory_order_relaxed); }
+  double Sum() const { return sum_.load(std::memory_order_relaxed); }
+  // Estimate the q-quantile (0 <= q <= 1) by linear interpolation inside
+  // the bucket which contains it, as histogram_quantile() does in Prometheus.
+  double Quantile(double q) const;
+
+ private:
+  std::vector<double> bounds_;
+  std::unique_ptr<std::atomic<int64_t>[]> buckets_;
+  std::atomic<int64_t> count_{0};
+  std::atomic<double> sum_{0.0};
+
+  DISABLE_COPY_AND_ASSIGN(MetricHistogram);
+};
+
+// Exponential buckets from 1us to ~16s, suitable for latencies in seconds.
+const std::vector<double>& DefaultLatencyBuckets();
+
+class MetricsRegistry {
+ public:
+  static MetricsRegistry& Instance();
+
+  ~MetricsRegistry();
+
+  MetricCounter* GetCounter(const std::string& name,
+                            const std::string& help,
+                            const MetricLabels& labels = {});
+  MetricGauge* GetGauge(const std::string& name,
+                        const std::string& help,
+                        const MetricLabels& labels = {});
+  // If `quantiles` is not empty, a gauge family named `<name>_quantile` with
+  // the estimated quantiles is exported along with the histogram. `bounds`
+  // and `quantiles` are taken from the first call for a given name.
+  MetricHistogram* GetHistogram(
+      const std::string& name,
+      const std::string& help,
+      const MetricLabels& labels = {},
+      const std::vector<double>& bounds = DefaultLatencyBuckets(),
+      const std::vector<double>& quantiles = {});
+
+  // Render all metrics in the OpenMetrics text format, terminated by
+  // "# EOF".
+  std::string ExportText();
+
+  // Write ExportText() to `path`. The content is written to a temporary file
+  // first and then renamed, so readers never see a partial file.
+  bool DumpToFile(const std::string& path);
+
+  // Dump to `path` every `interval_ms` milliseconds in a background thread.
+  // Calling it again restarts the thread with the new arguments. The thread
+  // dumps once more when it is stopped by StopFileExport or at exit.
+  void StartFileExport(const std::string& path, int64_t interval_ms);
+  void StopFileExport();
+
+ private:
+  struct Family {
+    MetricType type;
+    std::string help;
+    std::vector<double> bounds;
+    std::vector<double> quantiles;
+    std::map<std::string, std::unique_ptr<MetricCounter>> counters;
+    std::map<std::string, std::unique_ptr<MetricGauge>> gauges;
+    std::map<std::string, std::unique_ptr<MetricHistogram>> histograms;
+  };
+
+  MetricsRegistry();
+
+  Family* GetFamily(const std::string& name,
+                    MetricType type,
+                    const std::string& help);
+
+  std::mutex mutex_;
+  std::map<std::string, Family> families_;
+
+  std::mutex export_mutex_;
+  std::condition_variable export_cv_;
+  bool export_stop_{false};
+  std::thread export_thread_;
+
+  DISABLE_COPY_AND_ASSIGN(MetricsRegistry);
+};
+
+inline bool IsMetricsEnabled() { return FLAGS_enable_metrics; }
+
+// Start dumping to FLAGS_metrics_export_path if it is set, independent of
+// FLAGS_enable_metrics. It is called by InitGflags and InitDevices, and only
+// the first call with a non-empty path takes effect.
+void InitMetricsExport();
+
+// Observe the elapsed time in seconds of the enclosing scope into
+// `histogram`. Nothing is recorded if `histogram` is nullptr.
+class ScopedLatencyRecorder {
+ public:
+  explicit ScopedLatencyRecorder(MetricHistogram* histogram)
+      : histogram_(histogram) {
+    if (histogram_) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~ScopedLatencyRecorder() {
+    if (histogram_) {
+      std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start_;
+      histogram_->Observe(elapsed.count());
+    }
+  }
+
+ private:
+  MetricHistogram* histogram_;
+  std::chrono::steady_clock::time_point start_;
+
+  DISABLE_COPY_AND_ASSIGN(ScopedLatencyRecorder);
+};
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,105 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/metrics_exporter.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(Metrics, Counter) {
+  auto* counter = MetricsRegistry::Instance().GetCounter(
+      "test_requests", "Test counter.", {{"model", "a"}});
+  counter->Increase();
+  counter->Increase(2);
+  EXPECT_EQ(counter->Value(), 3);
+  // The same name and labels refer to the same counter.
+  EXPECT_EQ(counter,
+            MetricsRegistry::Instance().GetCounter(
+                "test_requests", "Test counter.", {{"model", "a"}}));
+
+  std::string text = MetricsRegistry::Instance().ExportText();
+  EXPECT_NE(text.find("# TYPE test_requests counter"), std::string::npos);
+  EXPECT_NE(text.find("test_requests_total{model=\"a\"} 3"),
+            std::string::npos);
+}
+
+TEST(Metrics, Gauge) {
+  auto* gauge =
+      MetricsRegistry::Instance().GetGauge("test_queue_depth", "Test gauge.");
+  gauge->Set(5);
+  gauge->Add(-2);
+  EXPECT_DOUBLE_EQ(gauge->Value(), 3);
+  std::string text = MetricsRegistry::Instance().ExportText();
+  EXPECT_NE(text.find("test_queue_depth 3\n"), std::string::npos);
+}
+
+TEST(Metrics, Histogram) {
+  auto* histogram = MetricsRegistry::Instance().GetHistogram(
+      "test_latency_seconds", "Test histogram.", {}, {1, 2, 4}, {0.5});
+  for (double v : {0.5, 1.5, 1.5, 3.0, 10.0}) {
+    histogram->Observe(v);
+  }
+  EXPECT_EQ(histogram->Count(), 5);
+  EXPECT_DOUBLE_EQ(histogram->Sum(), 16.5);
+  EXPECT_EQ(histogram->CumulativeCounts(),
+            (std::vector<int64_t>{1, 3, 4, 5}));
+  // The 0.5-quantile (rank 2.5) falls into the (1, 2] bucket.
+  EXPECT_DOUBLE_EQ(histogram->Quantile(0.5), 1.75);
+
+  std::string text = MetricsRegistry::Instance().ExportText();
+  EXPECT_NE(text.find("test_latency_seconds_bucket{le=\"2\"} 3"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_latency_seconds_bucket{le=\"+Inf\"} 5"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_latency_seconds_count 5"), std::string::npos);
+  EXPECT_NE(text.find("test_latency_seconds_quantile{quantile=\"0.5\"} 1.75"),
+            std::string::npos);
+}
+
+TEST(Metrics, LabelEscape) {
+  MetricsRegistry::Instance()
+      .GetGauge("test_escape", "", {{"path", "a\"b\\c"}})
+      ->Set(1);
+  std::string text = MetricsRegistry::Instance().ExportText();
+  EXPECT_NE(text.find("test_escape{path=\"a\\\"b\\\\c\"} 1"),
+            std::string::npos);
+}
+
+TEST(Metrics, TypeConflict) {
+  MetricsRegistry::Instance().GetCounter("test_conflict", "");
+  EXPECT_ANY_THROW(MetricsRegistry::Instance().GetGauge("test_conflict", ""));
+}
+
+TEST(Metrics, DumpToFile) {
+  std::string path = "metrics_test_dump.prom";
+  ASSERT_TRUE(MetricsRegistry::Instance().DumpToFile(path));
+  std::ifstream fin(path);
+  std::stringstream ss;
+  ss << fin.rdbuf();
+  std::string text = ss.str();
+  EXPECT_NE(text.find("paddle_memory_allocated_bytes{place=\"host\"}"),
+            std::string::npos);
+  EXPECT_EQ(text.substr(text.size() - 6), "# EOF\n");
+  std::remove(path.c_str());
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -114,6 +114,14 @@ static PyObject* tensor_method_numpy(TensorObject* self,
         nullptr);
     return array;
   }
+  if (FLAGS_use_numpy_zero_copy && self->tensor.is_cpu() &&
+      self->tensor.is_dense_tensor() && self->tensor.initialized()) {
+    // The array holds a copy of the DenseTensor, which shares the holder, so
+    // the memory outlives the tensor.
+    auto dense_tensor =
+        std::dynamic_pointer_cast<phi::DenseTensor>(self->tensor.impl());
+    return TensorToPyArray(*dense_tensor, false).release().ptr();
+  }
   auto tensor_dims = self->tensor.shape();
   auto numpy_dtype = TensorDtype2NumpyDtype(self->tensor.type());
   auto sizeof_dtype = phi::SizeOf(self->tensor.type());
@@ -177,12 +185,15 @@ static PyObject* tensor_method_numpy(TensorObject* self,
       VLOG(6) << "Getting DenseTensor's numpy value";
       auto dense_tensor =
           std::dynamic_pointer_cast<phi::DenseTensor>(self->tensor.impl());
+      // A strided view is copied in the order of its dims first.
+      phi::DenseTensor contiguous_tensor;
+      phi::ContiguousCopy(*dense_tensor, &contiguous_tensor);
       // deep copy
       paddle::memory::Copy(
           place,
           reinterpret_cast<void*>(pybind11::detail::array_proxy(array)->data),
           place,
-          dense_tensor->data(),
+          contiguous_tensor.data(),
           sizeof_dtype * numel);
     }
 
@@ -1256,6 +1267,11 @@ static PyObject* tensor_method__setitem_eager_tensor(TensorObject* self,
       }
     }
   } else {
+    // The array is written back to the tensor as a contiguous one, so a
+    // strided view stops sharing the memory of its base first.
+    if (!self_tensor->meta().is_contiguous()) {
+      phi::ContiguousCopy(*self_tensor, self_tensor);
+    }
     auto self_numpy = TensorToPyArray(*self_tensor);
     VLOG(4) << "parse_index is false";
     if (PyCheckTensor(_index)) {
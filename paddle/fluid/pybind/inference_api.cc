@@ -756,6 +756,30 @@ void BindAnalysisConfig(py::module *m) {
       .def("shape_range_info_path", &AnalysisConfig::shape_range_info_path)
       .def("shape_range_info_collected",
            &AnalysisConfig::shape_range_info_collected)
+      .def("enable_shape_bucket",
+           py::overload_cast<
+               const std::vector<std::map<std::string, std::vector<int>>> &,
+               bool>(&AnalysisConfig::EnableShapeBucket),
+           py::arg("buckets"),
+           py::arg("warmup") = true)
+      .def("enable_shape_bucket",
+           py::overload_cast<const std::string &, int, bool>(
+               &AnalysisConfig::EnableShapeBucket),
+           py::arg("shape_range_info_path"),
+           py::arg("num_buckets") = 4,
+           py::arg("warmup") = true)
+      .def("shape_bucket_enabled", &AnalysisConfig::shape_bucket_enabled)
+      .def("enable_pass_tuning",
+           &AnalysisConfig::EnablePassTuning,
+           py::arg("sample_shapes"),
+           py::arg("candidate_passes") = std::vector<std::string>({}),
+           py::arg("repeat") = 10)
+      .def("pass_tuning_enabled", &AnalysisConfig::pass_tuning_enabled)
+      .def("enable_lazy_load_params",
+           &AnalysisConfig::EnableLazyLoadParams,
+           py::arg("prefetch") = true)
+      .def("lazy_load_params_enabled",
+           &AnalysisConfig::lazy_load_params_enabled)
       .def("enable_tuned_tensorrt_dynamic_shape",
            &AnalysisConfig::EnableTunedTensorRtDynamicShape)
       .def("tuned_tensorrt_dynamic_shape",
@@ -1025,9 +1049,25 @@ void BindPaddleInferTensor(py::module *m) {
 void BindPredictorPool(py::module *m) {
   py::class_<paddle_infer::services::PredictorPool>(*m, "PredictorPool")
       .def(py::init<const paddle_infer::Config &, size_t>())
+      .def(py::init<const paddle_infer::Config &, size_t, size_t, bool>(),
+           py::arg("config"),
+           py::arg("size"),
+           py::arg("max_size"),
+           py::arg("release_idle_memory") = false)
       .def("retrive",
            &paddle_infer::services::PredictorPool::Retrive,
-           py::return_value_policy::reference);
+           py::return_value_policy::reference)
+      .def("acquire",
+           &paddle_infer::services::PredictorPool::Acquire,
+           py::keep_alive<0, 1>(),
+           py::call_guard<py::gil_scoped_release>())
+      .def("size", &paddle_infer::services::PredictorPool::Size);
+
+  py::class_<paddle_infer::services::PredictorPool::Lease>(*m,
+                                                           "PredictorLease")
+      .def("get",
+           &paddle_infer::services::PredictorPool::Lease::get,
+           py::return_value_policy::reference_internal);
 }
 
 void BindPaddlePassBuilder(py::module *m) {
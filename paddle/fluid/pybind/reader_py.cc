@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/pybind/reader_py.h"
 
+#include <algorithm>
 #include <exception>
 #include <memory>
 #include <string>
@@ -35,6 +36,7 @@
 #include "pybind11/stl.h"
 
 DECLARE_bool(reader_queue_speed_test_mode);
+DECLARE_int32(reader_num_workers);
 
 // disable auto conversion to list in Python
 PYBIND11_MAKE_OPAQUE(paddle::framework::LoDTensorArray);
@@ -164,9 +166,10 @@ class MultiDeviceFeedReader {
       auto reader = create_or_get_reader(i);
       if (use_double_buffer) {
         VLOG(10) << "Creating " << i << "-th BufferedReader";
+        size_t num_workers = std::max(FLAGS_reader_num_workers, 1);
         holder->Reset(
             framework::MakeDecoratedReader<operators::reader::BufferedReader>(
-                reader, p, 2, pin_memory_));
+                reader, p, num_workers + 1, pin_memory_, num_workers));
       } else {
         if (platform::is_gpu_place(p)) {
           PADDLE_THROW(platform::errors::PermissionDenied(
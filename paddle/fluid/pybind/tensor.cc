@@ -472,6 +472,11 @@ void BindTensor(pybind11::module &m) {  // NOLINT
            )DOC")
       .def("_to_dlpack",
            [](phi::DenseTensor &self) {
+             // DLPackTensor exports the tensor as a compact one, so a strided
+             // view stops sharing the memory of its base first.
+             if (!self.meta().is_contiguous()) {
+               phi::ContiguousCopy(self, &self);
+             }
              DLPackTensor dlpack_tensor(self, 1);
              DLManagedTensor *dmt = dlpack_tensor.ToDLManagedTensor();
              auto capsule = py::capsule(
@@ -42,10 +42,13 @@ limitations under the License. */
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 #include "paddle/phi/common/pstring.h"
 #include "paddle/phi/core/string_tensor.h"
+#include "paddle/phi/core/tensor_utils.h"
 #include "paddle/phi/kernels/strings/unicode.h"
 #include "pybind11/numpy.h"
 #include "pybind11/pybind11.h"
 
+DECLARE_bool(use_numpy_zero_copy);
+
 namespace py = pybind11;
 
 namespace pybind11 {
@@ -207,6 +210,17 @@ class PYBIND11_HIDDEN NumpyAllocation : public memory::Allocation {
   PyObject *arr_;
 };
 
+// Whether the new CPU tensor set from the array shares its memory by
+// FLAGS_use_numpy_zero_copy. The array is C-contiguous, since it is cast by
+// py::array::c_style, and the kernels may write to it and read it as T.
+template <typename T>
+bool CanShareNumpyBuffer(const phi::DenseTensor &tensor,
+                         const py::array &arr) {
+  return FLAGS_use_numpy_zero_copy && !tensor.IsInitialized() &&
+         arr.size() > 0 && arr.writeable() &&
+         reinterpret_cast<uintptr_t>(arr.data()) % alignof(T) == 0;
+}
+
 template <typename T>
 struct ValidDTypeToPyArrayChecker {
   static constexpr bool kValue = false;
@@ -375,7 +389,10 @@ void SetTensorFromPyArrayT(
   self->Resize(phi::make_ddim(dims));
 
   if (paddle::platform::is_cpu_place(place)) {
-    if (zero_copy) {
+    // An initialized tensor, such as a parameter, may share its memory with
+    // other tensors which must see the data set to it, so it only shares the
+    // memory of the array if zero_copy is set.
+    if (zero_copy || details::CanShareNumpyBuffer<T>(*self, array)) {
       auto holder = std::make_shared<details::NumpyAllocation<T>>(array);
       auto type = framework::ToDataType(std::type_index(typeid(T)));
       self->ResetHolderWithType(holder, framework::TransToPhiDataType(type));
@@ -978,6 +995,13 @@ inline py::array TensorToPyArray(const phi::DenseTensor &tensor,
   if (!tensor.IsInitialized()) {
     return py::array();
   }
+  if (!tensor.meta().is_contiguous()) {
+    // The array shares the contiguous copy of a strided view, which is not
+    // used by any tensor, so the deep copy is skipped.
+    phi::DenseTensor contiguous_tensor;
+    phi::ContiguousCopy(tensor, &contiguous_tensor);
+    return TensorToPyArray(contiguous_tensor, false);
+  }
   bool is_gpu_tensor = platform::is_gpu_place(tensor.place());
   bool is_xpu_tensor = platform::is_xpu_place(tensor.place());
   bool is_npu_tensor = platform::is_npu_place(tensor.place());
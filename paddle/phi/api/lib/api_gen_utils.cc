@@ -14,6 +14,8 @@ limitations under the License. */
 
 #include "paddle/phi/api/lib/api_gen_utils.h"
 
+#include "paddle/phi/core/tensor_utils.h"
+
 namespace paddle {
 namespace experimental {
 
@@ -189,7 +191,13 @@ phi::DenseTensor* SetKernelOutput(Tensor* out) {
     if (out->impl() == nullptr) {
       out->set_impl(std::make_shared<phi::DenseTensor>());
     }
-    return static_cast<phi::DenseTensor*>(out->impl().get());
+    auto* dense_out = static_cast<phi::DenseTensor*>(out->impl().get());
+    // The inplace kernels write the output as a contiguous tensor, so a
+    // strided view stops sharing its memory before being written.
+    if (!dense_out->meta().is_contiguous()) {
+      phi::ContiguousCopy(*dense_out, dense_out);
+    }
+    return dense_out;
   }
   return nullptr;
 }
@@ -212,6 +220,9 @@ std::vector<phi::DenseTensor*> SetInplaceVectorKernelOutput(
   std::vector<phi::DenseTensor*> results(out->size(), nullptr);
   for (size_t i = 0; i < out->size(); ++i) {
     results[i] = static_cast<phi::DenseTensor*>(out->at(i).impl().get());
+    if (!results[i]->meta().is_contiguous()) {
+      phi::ContiguousCopy(*results[i], results[i]);
+    }
   }
   return results;
 }
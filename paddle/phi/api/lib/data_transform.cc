@@ -192,6 +192,14 @@ inline phi::DenseTensor TransDataPlace(const phi::DenseTensor& tensor,
   return out;
 }
 
+// The strided views are copied to contiguous tensors before the other
+// transforms, unless the kernel accepts them.
+inline bool NeedContiguous(const phi::DenseTensor& tensor,
+                           const phi::TensorArgDef& target_args_def) {
+  return !target_args_def.allow_strided && tensor.initialized() &&
+         !tensor.meta().is_contiguous();
+}
+
 phi::DenseTensor TransformData(phi::DenseTensor* tensor,
                                const phi::TensorArgDef& target_args_def,
                                const TransformFlag& transform_flag) {
@@ -233,6 +241,12 @@ std::shared_ptr<phi::DenseTensor> PrepareData(
   if (tensor_in) {
     phi::DenseTensor& dense_tensor =
         *static_cast<phi::DenseTensor*>(tensor_in.get());
+    if (NeedContiguous(dense_tensor, target_args_def)) {
+      auto contiguous_tensor = std::make_shared<phi::DenseTensor>();
+      phi::ContiguousCopy(dense_tensor, contiguous_tensor.get());
+      return PrepareData(
+          Tensor(contiguous_tensor), target_args_def, transform_flag);
+    }
     if (!transform_flag.NeedTransform() || !dense_tensor.initialized() ||
         (!NeedTransformPlace(
              dense_tensor.place(), target_args_def.backend, transform_flag) &&
@@ -270,6 +284,12 @@ std::unique_ptr<std::vector<phi::DenseTensor>> PrepareData(
 
   for (const auto& input : inputs) {
     const auto& tensor_in = input.impl();
+    if (NeedContiguous(*static_cast<phi::DenseTensor*>(tensor_in.get()),
+                       target_args_def)) {
+      pt_tensors->emplace_back(
+          *PrepareData(input, target_args_def, transform_flag));
+      continue;
+    }
     if (!transform_flag.NeedTransform() || !tensor_in->initialized() ||
         (!NeedTransformPlace(
              tensor_in->place(), target_args_def.backend, transform_flag) &&
@@ -23,6 +23,8 @@ limitations under the License. */
 #include "paddle/phi/core/string_tensor_utils.h"
 #include "paddle/phi/core/tensor_utils.h"
 
+DECLARE_bool(use_strided_view);
+
 namespace paddle {
 namespace experimental {
 namespace detail {
@@ -145,5 +147,57 @@ DataLayout ParseLayoutWithInputOrder(DataLayout layout, const Tensor& tensor) {
   return layout != DataLayout::UNDEFINED ? layout : ParseLayout(tensor);
 }
 
+KernelDispatchCache::KernelDispatchCache(const char* kernel_name)
+    : kernel_name_(kernel_name) {
+  for (auto& slot : entries_) {
+    slot.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+KernelDispatchCache::~KernelDispatchCache() {
+  for (auto& slot : entries_) {
+    delete slot.load(std::memory_order_relaxed);
+  }
+}
+
+phi::KernelResult KernelDispatchCache::SelectAndCache(
+    const phi::KernelKey& kernel_key) {
+  auto kernel_result = phi::KernelFactory::Instance().SelectKernelOrThrowError(
+      kernel_name_, kernel_key);
+#if defined(PADDLE_WITH_XPU) && !defined(PADDLE_WITH_XPU_KP)
+  // The XPU black list may be changed at runtime.
+  if (kernel_key.backend() == Backend::XPU) {
+    return kernel_result;
+  }
+#endif
+  if (kernel_result.has_fallback_cpu) {
+    return kernel_result;
+  }
+
+  auto* entry = new Entry(kernel_key, kernel_result.kernel);
+  for (auto& slot : entries_) {
+    const Entry* expected = nullptr;
+    if (slot.compare_exchange_strong(expected,
+                                     entry,
+                                     std::memory_order_release,
+                                     std::memory_order_acquire)) {
+      return {entry->kernel, false};
+    }
+    if (expected->key == kernel_key) {
+      // Cached by another thread.
+      delete entry;
+      return {expected->kernel, false};
+    }
+  }
+  // The cache is full, the kernels of the other keys are selected from
+  // KernelFactory every time.
+  delete entry;
+  return kernel_result;
+}
+
+bool UseStridedView(Backend kernel_backend) {
+  return FLAGS_use_strided_view && kernel_backend == Backend::CPU;
+}
+
 }  // namespace experimental
 }  // namespace paddle
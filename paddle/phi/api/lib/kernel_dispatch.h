@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <atomic>
 #include <limits>
 #include <string>
 #include <utility>
@@ -201,5 +202,60 @@ DataLayout ParseLayout(DataLayout layout);
 DataLayout ParseLayout(const Tensor& tensor);
 DataLayout ParseLayoutWithInputOrder(DataLayout layout, const Tensor& tensor);
 
+/**
+ * A cache of the kernels selected for one kernel name, which every generated
+ * API holds as a static local. It saves the lookup of the kernel by its name
+ * and key in KernelFactory in the calls of the API, which dominates the
+ * latency of the ops on small tensors.
+ *
+ * The entries are immutable and never removed, so they are read without
+ * locks. Only the kernels found without the fallback to CPU are cached, as
+ * the fallback depends on the flags.
+ */
+class KernelDispatchCache {
+ public:
+  explicit KernelDispatchCache(const char* kernel_name);
+
+  ~KernelDispatchCache();
+
+  phi::KernelResult SelectKernelOrThrowError(const phi::KernelKey& kernel_key) {
+    for (auto& slot : entries_) {
+      const Entry* entry = slot.load(std::memory_order_acquire);
+      if (entry == nullptr) {
+        break;
+      }
+      if (entry->key == kernel_key) {
+        return {entry->kernel, false};
+      }
+    }
+    return SelectAndCache(kernel_key);
+  }
+
+ private:
+  struct Entry {
+    Entry(const phi::KernelKey& key, const phi::Kernel& kernel)
+        : key(key), kernel(kernel) {}
+
+    phi::KernelKey key;
+    // A copy of the kernel, as the rehash of KernelFactory may move it.
+    phi::Kernel kernel;
+  };
+
+  // An API is mostly called with a few keys.
+  enum { kNumEntries = 8 };
+
+  phi::KernelResult SelectAndCache(const phi::KernelKey& kernel_key);
+
+  const char* kernel_name_;
+  std::atomic<const Entry*> entries_[kNumEntries];
+};
+
+/**
+ * Whether the APIs with the view kernels (see strided_view_kernel.h) select
+ * them for the backend, i.e. FLAGS_use_strided_view is set and the backend is
+ * CPU.
+ */
+bool UseStridedView(Backend kernel_backend);
+
 }  // namespace experimental
 }  // namespace paddle
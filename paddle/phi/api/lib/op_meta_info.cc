@@ -22,6 +22,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/custom_operator.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/tensor_utils.h"
 
 namespace paddle {
 
@@ -46,9 +47,27 @@ PADDLE_API void AssignTensorImpl(const Tensor& src, Tensor* dst) {
 
 ////////////////////// Kernel Context //////////////////////
 
+// The custom kernels read the memory of the inputs directly, so a strided
+// view is passed as its contiguous copy, which shares the autograd meta of
+// the view.
+static Tensor ContiguousInput(const Tensor& input) {
+  if (!input.defined() || !input.is_dense_tensor() ||
+      static_cast<phi::DenseTensor*>(input.impl().get())
+          ->meta()
+          .is_contiguous()) {
+    return input;
+  }
+  auto contiguous_tensor = std::make_shared<phi::DenseTensor>();
+  phi::ContiguousCopy(*static_cast<phi::DenseTensor*>(input.impl().get()),
+                      contiguous_tensor.get());
+  Tensor contiguous_input(input);
+  contiguous_input.set_impl(contiguous_tensor);
+  return contiguous_input;
+}
+
 void CustomOpKernelContext::EmplaceBackInput(Tensor&& input) {
   size_t index = inputs_.size();
-  inputs_.emplace_back(input);
+  inputs_.emplace_back(ContiguousInput(input));
   input_range_.emplace_back(std::make_pair(index, index + 1));
 }
 
@@ -56,9 +75,9 @@ void CustomOpKernelContext::EmplaceBackInputs(
     const std::vector<Tensor>& inputs) {
   size_t index = inputs_.size();
   input_range_.emplace_back(std::make_pair(index, index + inputs.size()));
-  inputs_.insert(inputs_.end(),
-                 std::make_move_iterator(inputs.begin()),
-                 std::make_move_iterator(inputs.end()));
+  for (const auto& input : inputs) {
+    inputs_.emplace_back(ContiguousInput(input));
+  }
 }
 
 void CustomOpKernelContext::EmplaceBackOutput(Tensor&& output) {
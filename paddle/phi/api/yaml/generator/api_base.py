@@ -41,6 +41,9 @@ class BaseAPI:
         ) = self.parse_args(self.api, api_item_yaml)
 
         self.is_base_api = True
+        # the kernel returning strided views, which is selected instead of the
+        # kernel when FLAGS_use_strided_view is set (see UseStridedView)
+        self.strided_view_kernel = api_item_yaml.get('strided_view')
         if 'invoke' in api_item_yaml:
             self.is_base_api = False
             self.invoke = api_item_yaml['invoke']
@@ -1183,10 +1186,20 @@ PADDLE_API {self.get_return_type(inplace_flag=True)} {api_func_name}({self.get_d
         for kernel_out in outputs_args:
             fallback_kernel_output_trans += f"""
 {code_indent}    TransDataBackend({kernel_out}, kernel_backend, {kernel_out});"""
+        kernel_cache = "kernel_cache"
+        view_kernel_cache = ""
+        if self.strided_view_kernel is not None:
+            kernel_cache = (
+                "(UseStridedView(kernel_backend) ? view_kernel_cache : "
+                "kernel_cache)"
+            )
+            view_kernel_cache = f"""
+{code_indent}  static KernelDispatchCache view_kernel_cache("{self.strided_view_kernel}");"""
         return f"""
 {code_indent}  VLOG(6) << "{self.api} API kernel key: [" << kernel_backend << ", " << kernel_layout << ", "<< kernel_data_type << "]";
-{code_indent}  auto kernel_result = phi::KernelFactory::Instance().SelectKernelOrThrowError(
-{code_indent}      "{kernel_name}", {{kernel_backend, kernel_layout, kernel_data_type}});
+{code_indent}  static KernelDispatchCache kernel_cache("{kernel_name}");{view_kernel_cache}
+{code_indent}  auto kernel_result = {kernel_cache}.SelectKernelOrThrowError(
+{code_indent}      {{kernel_backend, kernel_layout, kernel_data_type}});
 {code_indent}  const auto& kernel = kernel_result.kernel;
 {code_indent}  VLOG(6) << "{kernel_name} kernel: " << kernel;
 {code_indent}  auto* dev_ctx = GetDeviceContextByBackend(kernel_result.has_fallback_cpu ? Backend::CPU : kernel_backend);
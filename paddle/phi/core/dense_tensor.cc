@@ -127,6 +127,7 @@ void* DenseTensor::AllocateFrom(Allocator* allocator,
   // allocator. See DeviceContext.Alloc in core/device_context.cc.
   if (!holder_ || holder_->size() < bytes + meta_.offset) {
     meta_.offset = 0;
+    meta_.strides.clear();
     VLOG(10) << "Allocate data with bytes: " << bytes;
     auto holder = allocator->Allocate(bytes);
     if (holder_) {
@@ -210,6 +211,7 @@ void DenseTensor::set_meta(const DenseTensorMeta& meta) {
   meta_.lod = meta.lod;
   meta_.offset = meta.offset;
   meta_.use_gpudnn = meta.use_gpudnn;
+  meta_.strides = meta.strides;
 }
 
 /* @jim19930609: This interface will be further modified until we finalized the
@@ -224,6 +226,7 @@ void DenseTensor::set_meta(const DenseTensorMeta& meta) {
    */
 void DenseTensor::ResizeAndAllocate(const DDim& dims) {
   meta_.dims = dims;
+  meta_.strides.clear();
   if (holder_ != nullptr && place().GetType() != AllocationType::UNDEFINED) {
     mutable_data(place());
   }
@@ -42,15 +42,16 @@ void DenseTensor::check_memory_size() const {
       holder_,
       phi::errors::PreconditionNotMet("Tensor holds no memory. "
                                       "Call Tensor::mutable_data firstly."));
+  // A strided view may span more or less memory than its numel.
   PADDLE_ENFORCE_LE(
-      numel() * SizeOf(dtype()),
+      meta_.storage_numel() * SizeOf(dtype()),
       memory_size(),
       phi::errors::PreconditionNotMet(
           "Tensor's dimension is out of bound."
           "Tensor's dimension must be equal or less than the size of its "
           "memory."
           "But received Tensor's dimension is %d, memory's size is %d.",
-          numel() * SizeOf(dtype()),
+          meta_.storage_numel() * SizeOf(dtype()),
           memory_size()));
 }
 
@@ -250,6 +251,10 @@ size_t DenseTensor::NumElements(size_t level) const {
 }
 
 DenseTensor& DenseTensor::Resize(const DDim& dims) {
+  if (dims != meta_.dims) {
+    // The strides of a view are meaningless for the other dims.
+    meta_.strides.clear();
+  }
   meta_.dims = dims;
   return *this;
 }
@@ -358,6 +363,7 @@ DenseTensor& DenseTensor::ShareDataWith(const DenseTensor& src) {
   meta_.layout = src.meta_.layout;
   meta_.offset = src.meta_.offset;
   meta_.use_gpudnn = src.meta_.use_gpudnn;
+  meta_.strides = src.meta_.strides;
   storage_properties_ =
       std::move(CopyStorageProperties(src.storage_properties_));
 #ifdef PADDLE_WITH_MKLDNN
@@ -95,6 +95,9 @@ struct TensorArgDef {
   DataLayout layout;
   DataType dtype;
   std::type_index type_index;
+  // Whether the kernel accepts the non-contiguous (strided) DenseTensor,
+  // otherwise the input is made contiguous before calling the kernel.
+  bool allow_strided{false};
 
   TensorArgDef(Backend in_backend,
                DataLayout in_layout,
@@ -119,6 +122,11 @@ struct TensorArgDef {
     dtype = in_dtype;
     return *this;
   }
+
+  TensorArgDef& SetAllowStrided(bool in_allow_strided) {
+    allow_strided = in_allow_strided;
+    return *this;
+  }
 };
 
 // Align the original fluid Attribute type with lower overhead
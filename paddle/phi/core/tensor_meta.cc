@@ -48,6 +48,35 @@ bool DenseTensorMeta::valid() const noexcept {
   return valid;
 }
 
+bool DenseTensorMeta::is_contiguous() const noexcept {
+  if (strides.empty()) {
+    return true;
+  }
+  int64_t stride = 1;
+  for (int i = dims.size() - 1; i >= 0; --i) {
+    // The stride of a dim of size 1 is never used.
+    if (dims[i] != 1 && strides[i] != stride) {
+      return false;
+    }
+    stride *= dims[i];
+  }
+  return true;
+}
+
+int64_t DenseTensorMeta::storage_numel() const noexcept {
+  if (strides.empty()) {
+    return product(dims);
+  }
+  int64_t numel = 1;
+  for (int i = 0; i < dims.size(); ++i) {
+    if (dims[i] == 0) {
+      return 0;
+    }
+    numel += (dims[i] - 1) * strides[i];
+  }
+  return numel;
+}
+
 StringTensorMeta::StringTensorMeta(const DDim& dims) : dims(dims) {}
 
 bool StringTensorMeta::valid() const noexcept {
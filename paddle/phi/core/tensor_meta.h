@@ -64,6 +64,16 @@ struct DenseTensorMeta {
   /// \return Whether the metadata is valid.
   bool valid() const noexcept;
 
+  /// \brief Test whether the elements are stored in the row-major order of
+  /// the dims without gaps. Only the strided views may be not contiguous.
+  /// \return Whether the tensor is contiguous.
+  bool is_contiguous() const noexcept;
+
+  /// \brief The number of elements from the first one to the last one in
+  /// memory, which is the numel of the contiguous tensors.
+  /// \return The number of elements spanned in memory.
+  int64_t storage_numel() const noexcept;
+
   bool is_scalar{false};
   /// \brief Determine whether using gpudnn speed-up library in the new dygraph.
   /// It maybe also support MKLDNN library in the near future.
@@ -73,13 +83,17 @@ struct DenseTensorMeta {
   DataLayout layout{DataLayout::NCHW};
   LoD lod;
   size_t offset{0};
+  /// \brief The strides of the dims in elements, which are only set for the
+  /// strided views of other tensors (see funcs/strided_view.h). It is empty
+  /// for the contiguous tensors.
+  std::vector<int64_t> strides;
 };
 
 inline bool operator==(const DenseTensorMeta& lhs, const DenseTensorMeta& rhs) {
   return (lhs.is_scalar == rhs.is_scalar) && lhs.use_gpudnn == rhs.use_gpudnn &&
          (lhs.dims == rhs.dims) && (lhs.dtype == rhs.dtype) &&
          (lhs.layout == rhs.layout) && (lhs.lod == rhs.lod) &&
-         (lhs.offset == rhs.offset);
+         (lhs.offset == rhs.offset) && (lhs.strides == rhs.strides);
 }
 
 struct StringTensorMeta {
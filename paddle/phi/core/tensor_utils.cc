@@ -14,6 +14,9 @@ limitations under the License. */
 
 #include "paddle/phi/core/tensor_utils.h"
 
+#include <cstring>
+#include <vector>
+
 #include "paddle/phi/backends/gpu/gpu_context.h"
 #include "paddle/phi/common/data_type.h"
 #include "paddle/phi/core/compat/convert_utils.h"
@@ -26,12 +29,141 @@ limitations under the License. */
 
 namespace phi {
 
+// The element of 16 bytes, e.g. complex128.
+struct alignas(8) StridedCopyElement16 {
+  uint64_t data[2];
+};
+
+template <typename T>
+static void StridedCopy(const T* src,
+                        const std::vector<int64_t>& dims,
+                        const std::vector<int64_t>& strides,
+                        T* dst) {
+  int rank = dims.size();
+  int64_t inner = dims[rank - 1];
+  int64_t inner_stride = strides[rank - 1];
+  int64_t rows = 1;
+  for (int i = 0; i < rank - 1; ++i) {
+    rows *= dims[i];
+  }
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (rows * inner > (1 << 16))
+#endif
+  for (int64_t row = 0; row < rows; ++row) {
+    int64_t offset = 0;
+    for (int64_t i = rank - 2, index = row; i >= 0; --i) {
+      offset += index % dims[i] * strides[i];
+      index /= dims[i];
+    }
+    const T* src_row = src + offset;
+    T* dst_row = dst + row * inner;
+    if (inner_stride == 1) {
+      std::memcpy(dst_row, src_row, inner * sizeof(T));
+    } else {
+      for (int64_t j = 0; j < inner; ++j) {
+        dst_row[j] = src_row[j * inner_stride];
+      }
+    }
+  }
+}
+
+void ContiguousCopy(const DenseTensor& src, DenseTensor* dst) {
+  if (src.meta().is_contiguous()) {
+    *dst = src;
+    DenseTensorUtils::GetMutableMeta(dst)->strides.clear();
+    return;
+  }
+  PADDLE_ENFORCE_EQ(paddle::platform::is_cpu_place(src.place()),
+                    true,
+                    phi::errors::Unimplemented(
+                        "Only the strided views on CPU are supported, but "
+                        "received a view on %s.",
+                        src.place()));
+  // Hold the memory of `src`, which may be `dst`.
+  const DenseTensor view(src);
+  const auto& meta = view.meta();
+  DenseTensorMeta dst_meta(meta.dtype, meta.dims, meta.layout, meta.lod);
+  dst_meta.is_scalar = meta.is_scalar;
+  dst_meta.use_gpudnn = meta.use_gpudnn;
+  *dst = DenseTensor();
+  dst->set_meta(dst_meta);
+  void* dst_ptr = dst->mutable_data(view.place(), meta.dtype);
+  if (view.numel() == 0) {
+    return;
+  }
+
+  // Merge the dims which are contiguous with each other, and drop the dims
+  // of size 1, so that the rows to copy are as long as possible.
+  std::vector<int64_t> dims, strides;
+  for (int i = 0; i < meta.dims.size(); ++i) {
+    if (meta.dims[i] == 1) {
+      continue;
+    }
+    if (!dims.empty() && strides.back() == meta.strides[i] * meta.dims[i]) {
+      dims.back() *= meta.dims[i];
+      strides.back() = meta.strides[i];
+    } else {
+      dims.push_back(meta.dims[i]);
+      strides.push_back(meta.strides[i]);
+    }
+  }
+  if (dims.empty()) {
+    dims.push_back(1);
+    strides.push_back(1);
+  }
+
+  const void* src_ptr = view.data();
+  switch (SizeOf(meta.dtype)) {
+    case 1:
+      StridedCopy(static_cast<const uint8_t*>(src_ptr),
+                  dims,
+                  strides,
+                  static_cast<uint8_t*>(dst_ptr));
+      break;
+    case 2:
+      StridedCopy(static_cast<const uint16_t*>(src_ptr),
+                  dims,
+                  strides,
+                  static_cast<uint16_t*>(dst_ptr));
+      break;
+    case 4:
+      StridedCopy(static_cast<const uint32_t*>(src_ptr),
+                  dims,
+                  strides,
+                  static_cast<uint32_t*>(dst_ptr));
+      break;
+    case 8:
+      StridedCopy(static_cast<const uint64_t*>(src_ptr),
+                  dims,
+                  strides,
+                  static_cast<uint64_t*>(dst_ptr));
+      break;
+    case 16:
+      StridedCopy(static_cast<const StridedCopyElement16*>(src_ptr),
+                  dims,
+                  strides,
+                  static_cast<StridedCopyElement16*>(dst_ptr));
+      break;
+    default:
+      PADDLE_THROW(phi::errors::Unimplemented(
+          "The strided copy of the data type %s is not supported.",
+          meta.dtype));
+  }
+}
+
 template <typename Context>
 void Copy(const Context& dev_ctx,
           const DenseTensor& src,
           Place dst_place,
           bool blocking,
           DenseTensor* dst) {
+  if (!src.meta().is_contiguous()) {
+    DenseTensor contiguous_src;
+    ContiguousCopy(src, &contiguous_src);
+    Copy(dev_ctx, contiguous_src, dst_place, blocking, dst);
+    return;
+  }
+
   auto* src_ptr = src.data();
   const auto& src_place = src.place();
 
@@ -81,6 +81,13 @@ class DenseTensorUtils {
   }
 };
 
+/**
+ * Copy the CPU tensor `src`, which may be a strided view, to `dst` as a
+ * contiguous tensor. It materializes the views for the code which needs
+ * contiguous tensors, and `dst` shares `src` if it is contiguous already.
+ */
+void ContiguousCopy(const DenseTensor& src, DenseTensor* dst);
+
 template <typename Context>
 void Copy(const Context& dev_ctx,
           const DenseTensor& src,
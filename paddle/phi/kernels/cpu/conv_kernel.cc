@@ -16,10 +16,88 @@
 
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/conv_cpu.h"
+#include "paddle/phi/kernels/funcs/packed_weight_cache.h"
 #include "paddle/phi/kernels/impl/conv_kernel_impl.h"
 
+DECLARE_bool(use_direct_conv);
+
 namespace phi {
 
+// Computes the 2-D NCHW convolution with the direct kernel and the packed
+// filter, which is cached for the constant filters, and returns false if the
+// convolution is not supported by it. The 1x1 convolutions without stride and
+// padding are a plain GEMM without im2col, so they stay on the GEMM path.
+template <typename T>
+bool DirectConv2DKernel(const CPUContext& dev_ctx,
+                        const DenseTensor& input,
+                        const DenseTensor& filter,
+                        const std::vector<int>& strides,
+                        const std::vector<int>& paddings_t,
+                        const std::string& padding_algorithm,
+                        int groups,
+                        const std::vector<int>& dilations_t,
+                        const std::string& data_format,
+                        DenseTensor* out) {
+  if (!FLAGS_use_direct_conv || input.dims().size() != 4 ||
+      data_format == "NHWC" || input.numel() == 0) {
+    return false;
+  }
+  std::vector<int> paddings = paddings_t;
+  std::vector<int> dilations = dilations_t;
+  const auto& filter_dims = filter.dims();
+  std::vector<int> ksize = {static_cast<int>(filter_dims[2]),
+                            static_cast<int>(filter_dims[3])};
+  UpdatePaddingAndDilation(&paddings,
+                           &dilations,
+                           padding_algorithm,
+                           slice_ddim(input.dims(), 2, 4),
+                           strides,
+                           ksize);
+  if (!IsExpand(vectorize(filter_dims), strides, paddings, dilations)) {
+    return false;
+  }
+
+  funcs::Conv2DParams params;
+  params.batch_size = input.dims()[0];
+  params.in_channels = input.dims()[1];
+  params.in_h = input.dims()[2];
+  params.in_w = input.dims()[3];
+  params.out_channels = out->dims()[1];
+  params.out_h = out->dims()[2];
+  params.out_w = out->dims()[3];
+  params.kernel_h = ksize[0];
+  params.kernel_w = ksize[1];
+  params.stride_h = strides[0];
+  params.stride_w = strides[1];
+  params.pad_top = paddings[0];
+  params.pad_left = paddings[2];
+  params.dilation_h = dilations[0];
+  params.dilation_w = dilations[1];
+  params.groups = groups;
+
+  // The filters which may change between the calls are packed every time.
+  std::shared_ptr<const funcs::PackedConvFilter<T>> packed;
+  auto& cache = funcs::PackedWeightCache::Instance();
+  if (cache.IsConstant(filter)) {
+    packed = cache.Get<funcs::PackedConvFilter<T>>(
+        filter,
+        "conv2d_direct_g" + std::to_string(groups),
+        [&params, &filter]() {
+          return funcs::PackConvFilter<T>(params, filter.data<T>());
+        });
+  } else {
+    packed = funcs::PackConvFilter<T>(params, filter.data<T>());
+  }
+  funcs::DirectConv2D<T>(params,
+                         input.data<T>(),
+                         *packed,
+                         nullptr,
+                         funcs::ConvActivation::kIdentity,
+                         dev_ctx.template Alloc<T>(out));
+  return true;
+}
+
 template <typename T, typename Context>
 void ConvKernel(const Context& dev_ctx,
                 const DenseTensor& input,
@@ -31,6 +109,18 @@ void ConvKernel(const Context& dev_ctx,
                 int groups,
                 const std::string& data_format,
                 DenseTensor* out) {
+  if (DirectConv2DKernel<T>(dev_ctx,
+                            input,
+                            filter,
+                            strides,
+                            paddings,
+                            padding_algorithm,
+                            groups,
+                            dilations,
+                            data_format,
+                            out)) {
+    return;
+  }
   ConvKernelImpl<T>(dev_ctx,
                     input,
                     filter,
@@ -54,6 +144,18 @@ void DepthwiseConvKernel(const Context& dev_ctx,
                          const std::vector<int>& dilations,
                          const std::string& data_format,
                          DenseTensor* out) {
+  if (DirectConv2DKernel<T>(dev_ctx,
+                            input,
+                            filter,
+                            strides,
+                            paddings,
+                            padding_algorithm,
+                            groups,
+                            dilations,
+                            data_format,
+                            out)) {
+    return;
+  }
   ConvKernelImpl<T>(dev_ctx,
                     input,
                     filter,
@@ -20,6 +20,7 @@ limitations under the License. */
 #include "paddle/phi/core/visit_type.h"
 #include "paddle/phi/kernels/funcs/axis_utils.h"
 #include "paddle/phi/kernels/funcs/eigen/common.h"
+#include "paddle/phi/kernels/funcs/softmax_cpu.h"
 
 namespace phi {
 
@@ -132,40 +133,39 @@ void CrossEntropyWithSoftmaxGradCPUKernel(const CPUContext& dev_ctx,
     // operation
 
   } else {
-    logit_grad_mat.device(place) =
-        logit_grad_mat *  // element_wise multiply
-        out_grad_mat.broadcast(Eigen::DSizes<int, 2>(1, axis_dim));
-
+    // dy/dx = (p - y) * dy, where y is 1 for the class of the label and 0
+    // for the others. Both steps run on a plane of [axis_dim, remain] while
+    // it is in the cache, and the planes run in parallel.
     const auto* label_data = label.data<LabelT>();
     T* logit_grad_data = logit_grad->data<T>();
     const T* out_grad_data = out_grad->data<T>();
     const int remain = d / axis_dim;
-    for (int i = 0; i < n; ++i) {         // for each sample_1_dim
+    bool parallel = n > 1 && static_cast<int64_t>(n) * d >=
+                                 phi::funcs::kSoftmaxMinParallelSize;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (parallel)
+#endif
+    for (int i = 0; i < n; ++i) {  // for each sample_1_dim
+      T* grad_i = logit_grad_data + i * d;
+      const T* out_grad_i = out_grad_data + i * remain;
+      for (int k = 0; k < axis_dim; ++k) {
+        for (int j = 0; j < remain; ++j) {
+          grad_i[k * remain + j] *= out_grad_i[j];
+        }
+      }
       for (int j = 0; j < remain; j++) {  // for each sample_other_dims
-        int idx = i * remain + j;  // this sample's label_idx. for 1d case,
-                                   // remain=1 and j=0, so, idx = i
-        auto lbl = static_cast<int64_t>(label_data[idx]);
+        auto lbl = static_cast<int64_t>(label_data[i * remain + j]);
         if (lbl == ignore_index) {
           for (int k = 0; k < axis_dim; ++k) {  // for each class id's label
-            logit_grad_data[i * d + k * remain + j] = 0;
+            grad_i[k * remain + j] = 0;
           }
         } else {
-          // only for this sample's label_idx, the label is 1, others is 0,
-          // so, only compute this label_idx's class
-          // for 1d case, remain=1 and j=0, so, [i * d + label_data[idx] *
-          // remain + j] = [i * d + label_data[idx]]
-          // let idx_x = i * d + label_data[idx] * remain + j,
-          //   logit_grad_data[idx_x] = logit_grad_data[idx_x] -
-          //   out_grad_data[idx]
-          // note: logit_grad_mat = logit_grad_mat * out_grad_mat
-          // so: logit_grad_data[idx_x] =  (logit_grad_data[idx_x] - 1) *
-          // out_grad_data[idx]
-          // means:           dy/dp * dy=   ( p - y ) * dy
-
-          logit_grad_data[i * d + lbl * remain + j] -= out_grad_data[idx];
+          // only for this sample's label_idx, the label is 1, others is 0
+          grad_i[lbl * remain + j] -= out_grad_i[j];
         }
       }
     }
+    (void)parallel;
   }
 }
 
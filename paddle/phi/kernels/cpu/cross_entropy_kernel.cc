@@ -20,6 +20,7 @@ limitations under the License. */
 #include "paddle/phi/kernels/funcs/axis_utils.h"
 #include "paddle/phi/kernels/funcs/cross_entropy.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/funcs/softmax_cpu.h"
 #include "paddle/phi/kernels/softmax_kernel.h"
 
 namespace phi {
@@ -68,6 +69,92 @@ void CrossEntropy(const CPUContext& dev_ctx,
       dev_ctx, &out_2d, &x_2d, &label_2d, soft_label, ignore_index, axis_dim);
 }
 
+// The softmax and the loss of every [axis_dim, remain] plane of the logits
+// are computed together, while the softmax of the plane is in the cache.
+template <typename T, typename LabelT>
+void SoftmaxWithCrossEntropy(const CPUContext& dev_ctx,
+                             const DenseTensor& logits,
+                             const DenseTensor& label,
+                             bool soft_label,
+                             int ignore_index,
+                             int axis,
+                             DenseTensor* softmax,
+                             DenseTensor* loss) {
+  const int rank = logits.dims().size();
+  const int axis_v = phi::funcs::CanonicalAxis(axis, rank);
+  const int axis_dim = logits.dims()[axis_v];
+  const int n = phi::funcs::SizeToAxis(axis_v, logits.dims());
+  const int d = phi::funcs::SizeFromAxis(axis_v, logits.dims());
+  const int remain = d / axis_dim;
+
+  const T* logits_data = logits.data<T>();
+  const LabelT* label_data = label.data<LabelT>();
+  T* softmax_data = dev_ctx.template Alloc<T>(softmax);
+  T* loss_data = dev_ctx.template Alloc<T>(loss);
+
+  if (!soft_label) {
+    for (int64_t i = 0; i < static_cast<int64_t>(n) * remain; ++i) {
+      int lbl = static_cast<int>(label_data[i]);
+      if (lbl == ignore_index) {
+        continue;
+      }
+      PADDLE_ENFORCE_GE(
+          lbl,
+          0,
+          phi::errors::OutOfRange("label value should >= 0 when label "
+                                  "value(%f) not equal to ignore_index(%f)",
+                                  lbl,
+                                  ignore_index));
+      PADDLE_ENFORCE_LT(
+          lbl,
+          axis_dim,
+          phi::errors::OutOfRange(
+              "label value should less than the shape of axis dimension "
+              "when label value(%f) not equal to ignore_index(%f), But "
+              "received label value as %ld and shape of axis dimension "
+              "is %d",
+              lbl,
+              ignore_index,
+              lbl,
+              axis_dim));
+    }
+  }
+
+  phi::funcs::SoftmaxCPU<T>(
+      logits_data,
+      n,
+      axis_dim,
+      remain,
+      /*log_softmax=*/false,
+      softmax_data,
+      [&](int64_t i) {
+        const T* prob = softmax_data + i * d;
+        T* loss_i = loss_data + i * remain;
+        if (soft_label) {
+          const LabelT* label_i = label_data + i * d;
+          for (int j = 0; j < remain; ++j) {
+            loss_i[j] = 0;
+          }
+          for (int k = 0; k < axis_dim; ++k) {
+            for (int j = 0; j < remain; ++j) {
+              loss_i[j] -= static_cast<T>(label_i[k * remain + j]) *
+                           phi::funcs::TolerableValue<T>()(
+                               std::log(prob[k * remain + j]));
+            }
+          }
+          return;
+        }
+        const LabelT* label_i = label_data + i * remain;
+        for (int j = 0; j < remain; ++j) {
+          int lbl = static_cast<int>(label_i[j]);
+          loss_i[j] = lbl == ignore_index
+                          ? 0
+                          : -phi::funcs::TolerableValue<T>()(
+                                std::log(prob[lbl * remain + j]));
+        }
+      });
+}
+
 template <typename T, typename Context>
 void CrossEntropyWithSoftmaxKernel(const Context& dev_ctx,
                                    const DenseTensor& logits,
@@ -88,6 +175,42 @@ void CrossEntropyWithSoftmaxKernel(const Context& dev_ctx,
     return;
   }
 
+  if (logits.dims().size() > 0 && logits.numel() > 0) {
+    if (soft_label) {
+      SoftmaxWithCrossEntropy<T, T>(dev_ctx,
+                                    logits,
+                                    label,
+                                    soft_label,
+                                    ignore_index,
+                                    axis,
+                                    softmax,
+                                    loss);
+      return;
+    }
+    if (label.dtype() == phi::DataType::INT64) {
+      SoftmaxWithCrossEntropy<T, int64_t>(dev_ctx,
+                                          logits,
+                                          label,
+                                          soft_label,
+                                          ignore_index,
+                                          axis,
+                                          softmax,
+                                          loss);
+      return;
+    }
+    if (label.dtype() == phi::DataType::INT32) {
+      SoftmaxWithCrossEntropy<T, int>(dev_ctx,
+                                      logits,
+                                      label,
+                                      soft_label,
+                                      ignore_index,
+                                      axis,
+                                      softmax,
+                                      loss);
+      return;
+    }
+  }
+
   phi::SoftmaxKernel<T, Context>(dev_ctx, logits, axis, softmax);
   CrossEntropy<T>(
       dev_ctx, *softmax, label, soft_label, ignore_index, axis, loss);
@@ -18,6 +18,7 @@
 #include "paddle/phi/common/data_type.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/funcs/embedding_util.h"
+#include "paddle/phi/kernels/funcs/scatter.h"
 
 namespace phi {
 
@@ -63,32 +64,41 @@ struct EmbeddingGradCPUFunctor {
         if (padding_idx_ != kNoPadding && ids_data[i] == padding_idx_) {
           // the gradient of padding_idx should be 0, already done by memset, so
           // do nothing.
-        } else {
-          PADDLE_ENFORCE_LT(
-              ids_data[i],
-              N,
-              phi::errors::InvalidArgument(
-                  "Variable value (input) of "
-                  "OP(paddle.nn.functional.embedding) "
-                  "expected >= 0 and < %ld, but got %ld. Please check input "
-                  "value.",
-                  N,
-                  ids_data[i]));
-          PADDLE_ENFORCE_GE(
-              ids_data[i],
-              0,
-              phi::errors::InvalidArgument(
-                  "Variable value (input) of "
-                  "OP(paddle.nn.functional.embedding) "
-                  "expected >= 0 and < %ld, but got %ld. Please check input "
-                  "value.",
-                  N,
-                  ids_data[i]));
-          for (int j = 0; j < D; ++j) {
-            d_table_data[ids_data[i] * D + j] += d_output_data[i * D + j];
-          }
+          continue;
         }
+        PADDLE_ENFORCE_LT(
+            ids_data[i],
+            N,
+            phi::errors::InvalidArgument(
+                "Variable value (input) of "
+                "OP(paddle.nn.functional.embedding) "
+                "expected >= 0 and < %ld, but got %ld. Please check input "
+                "value.",
+                N,
+                ids_data[i]));
+        PADDLE_ENFORCE_GE(
+            ids_data[i],
+            0,
+            phi::errors::InvalidArgument(
+                "Variable value (input) of "
+                "OP(paddle.nn.functional.embedding) "
+                "expected >= 0 and < %ld, but got %ld. Please check input "
+                "value.",
+                N,
+                ids_data[i]));
       }
+
+      // The rows of the table are accumulated in the order of the ids by the
+      // threads which own them, so the sums are the same as the serial ones.
+      funcs::CPURowPartition<int64_t> partition(ids_data, ids_num, N, D);
+      partition.ForEach([&](int64_t i, int64_t id) {
+        if (padding_idx_ != kNoPadding && id == padding_idx_) {
+          return;
+        }
+        for (int64_t j = 0; j < D; ++j) {
+          d_table_data[id * D + j] += d_output_data[i * D + j];
+        }
+      });
     }
   }
 
@@ -19,6 +19,7 @@
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 #include "paddle/phi/kernels/funcs/eigen/common.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/funcs/scatter.h"
 
 namespace phi {
 template <typename Context, typename T, typename IndexT = int>
@@ -30,9 +31,7 @@ void IndexAddInner(const Context& ctx,
                    DenseTensor* output) {
   auto input_dim = input->dims();
   auto input_dim_size = input_dim.size();
-  auto output_dim = output->dims();
   auto index_size = index.dims()[0];
-  auto add_value_dim = add_value->dims();
 
   const IndexT* index_data = index.data<IndexT>();
 
@@ -75,22 +74,24 @@ void IndexAddInner(const Context& ctx,
   VLOG(3) << "Index_Add_Debug; outer_nums: " << outer_nums
           << "; slice_size: " << slice_size << "; index_size: " << index_size;
 
-  output->Resize(phi::make_ddim({outer_nums, input_dim[axis], slice_size}));
-  add_value->Resize(phi::make_ddim({outer_nums, index_size, slice_size}));
-  VLOG(3) << "output.dims: " << output->dims()
-          << ", add_value.dims: " << add_value->dims();
-
-  auto add_value_tensor = EigenTensor<T, 3>::From(*add_value);
-  auto output_tensor = EigenTensor<T, 3>::From(*output);
-
-  auto& place = *ctx.eigen_device();
-  for (auto j = 0; j < index_size; j++) {
-    IndexT index_value = index_data[j];
-    auto output_t = output_tensor.chip(index_value, 1);
-    output_t.device(place) = output_t + add_value_tensor.chip(j, 1);
-  }
-  output->Resize(output_dim);
-  add_value->Resize(add_value_dim);
+  // The output is [outer_nums, input_dim[axis], slice_size] and add_value is
+  // [outer_nums, index_size, slice_size]. The slices of a row along the axis
+  // are added in the order of the index, by the thread which owns the row.
+  const T* add_value_data = add_value->data<T>();
+  T* output_data = output->data<T>();
+  int64_t axis_size = input_dim[axis];
+  funcs::CPURowPartition<IndexT> partition(
+      index_data, index_size, axis_size, outer_nums * slice_size);
+  partition.ForEach([&](int64_t j, IndexT index_value) {
+    for (int64_t i = 0; i < outer_nums; i++) {
+      funcs::elementwise_inner_add<T, int64_t>(ctx,
+                                               add_value_data,
+                                               output_data,
+                                               i * index_size + j,
+                                               i * axis_size + index_value,
+                                               slice_size);
+    }
+  });
 }
 
 template <typename T, typename Context>
@@ -0,0 +1,288 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/strided_view_kernel.h"
+
+#include <algorithm>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/slice_utils.h"
+#include "paddle/phi/kernels/funcs/strided_view.h"
+
+namespace phi {
+
+template <typename T, typename Context>
+void TransposeViewKernel(const Context& dev_ctx,
+                         const DenseTensor& x,
+                         const std::vector<int>& axis,
+                         DenseTensor* out) {
+  auto x_strides = funcs::GetStrides(x);
+  if (axis.size() == 0) {
+    funcs::ShareStridedView(x, x.dims(), x_strides, 0, out);
+    return;
+  }
+  int rank = x.dims().size();
+  DDim dims(x.dims());
+  std::vector<int64_t> strides(rank);
+  for (int i = 0; i < rank; ++i) {
+    int dim = axis[i] < 0 ? axis[i] + rank : axis[i];
+    dims[i] = x.dims()[dim];
+    strides[i] = x_strides[dim];
+  }
+  funcs::ShareStridedView(x, dims, strides, 0, out);
+}
+
+template <typename T, typename Context>
+void SliceViewKernel(const Context& dev_ctx,
+                     const DenseTensor& input,
+                     const std::vector<int64_t>& axes,
+                     const IntArray& starts_arr,
+                     const IntArray& ends_arr,
+                     const std::vector<int64_t>& infer_flags,
+                     const std::vector<int64_t>& decrease_axis,
+                     DenseTensor* out) {
+  std::vector<int64_t> starts = starts_arr.GetData();
+  std::vector<int64_t> ends = ends_arr.GetData();
+  PADDLE_ENFORCE_EQ(
+      starts.size(),
+      axes.size(),
+      phi::errors::InvalidArgument(
+          "The size of starts must be equal to the size of axes."));
+  PADDLE_ENFORCE_EQ(ends.size(),
+                    axes.size(),
+                    phi::errors::InvalidArgument(
+                        "The size of ends must be equal to the size of axes."));
+  // The same attrs as SliceRawKernel.
+  auto in_dims = input.dims();
+  for (size_t i = 0; i < axes.size(); ++i) {
+    if (starts[i] == -1 && ends[i] == 0 && infer_flags[i] == -1) {
+      auto ret = std::find(decrease_axis.begin(), decrease_axis.end(), axes[i]);
+      if (ret != decrease_axis.end()) {
+        ends[i] = in_dims[axes[i]];
+      }
+    }
+  }
+  funcs::CheckAndUpdateSliceAttrs<int64_t>(in_dims, axes, &starts, &ends);
+  auto slice_dims = funcs::GetSliceDims<int64_t>(
+      in_dims, axes, starts, ends, nullptr, nullptr);
+  auto out_dims = funcs::GetDecreasedDims<int64_t>(slice_dims, decrease_axis);
+
+  auto in_strides = funcs::GetStrides(input);
+  int64_t offset = 0;
+  for (size_t i = 0; i < axes.size(); ++i) {
+    offset += starts[i] * in_strides[axes[i]];
+  }
+  std::vector<int64_t> strides;
+  for (int i = 0; i < slice_dims.size(); ++i) {
+    if (std::find(decrease_axis.begin(), decrease_axis.end(), i) ==
+        decrease_axis.end()) {
+      strides.push_back(in_strides[i]);
+    }
+  }
+  // All the dims are decreased, and the result has the dims [1].
+  if (strides.size() < static_cast<size_t>(out_dims.size())) {
+    strides.push_back(1);
+  }
+  funcs::ShareStridedView(input, out_dims, strides, offset, out);
+}
+
+template <typename T, typename Context>
+void SplitViewKernel(const Context& dev_ctx,
+                     const DenseTensor& x,
+                     const IntArray& sections,
+                     const Scalar& axis_scalar,
+                     std::vector<DenseTensor*> outs) {
+  // The sizes of the outputs are inferred from the sections by InferMeta.
+  int rank = x.dims().size();
+  int axis = axis_scalar.to<int>();
+  axis = axis < 0 ? axis + rank : axis;
+  funcs::SplitStridedViews(x, axis, /*keep_axis=*/true, outs);
+}
+
+template <typename T, typename Context>
+void SplitWithNumViewKernel(const Context& dev_ctx,
+                            const DenseTensor& x,
+                            int num,
+                            const Scalar& axis_scalar,
+                            std::vector<DenseTensor*> outs) {
+  int rank = x.dims().size();
+  int axis = axis_scalar.to<int>();
+  axis = axis < 0 ? axis + rank : axis;
+  funcs::SplitStridedViews(x, axis, /*keep_axis=*/true, outs);
+}
+
+template <typename T, typename Context>
+void UnbindViewKernel(const Context& dev_ctx,
+                      const DenseTensor& x,
+                      int axis,
+                      std::vector<DenseTensor*> outs) {
+  int rank = x.dims().size();
+  axis = axis < 0 ? axis + rank : axis;
+  funcs::SplitStridedViews(x, axis, /*keep_axis=*/false, outs);
+}
+
+template <typename T, typename Context>
+void DiagonalViewKernel(const Context& dev_ctx,
+                        const DenseTensor& x,
+                        int offset,
+                        int axis1,
+                        int axis2,
+                        DenseTensor* out) {
+  int rank = x.dims().size();
+  axis1 = axis1 < 0 ? axis1 + rank : axis1;
+  axis2 = axis2 < 0 ? axis2 + rank : axis2;
+  auto x_strides = funcs::GetStrides(x);
+  std::vector<int64_t> strides;
+  for (int i = 0; i < rank; ++i) {
+    if (i != axis1 && i != axis2) {
+      strides.push_back(x_strides[i]);
+    }
+  }
+  // The diagonal is the last dim of the output, whose size is inferred by
+  // InferMeta. The element j of it is x[j][j + offset] for a positive offset,
+  // and x[j - offset][j] otherwise.
+  strides.push_back(x_strides[axis1] + x_strides[axis2]);
+  int64_t start = 0;
+  if (out->numel() > 0) {
+    start = offset >= 0 ? offset * x_strides[axis2]
+                        : -static_cast<int64_t>(offset) * x_strides[axis1];
+  }
+  funcs::ShareStridedView(x, out->dims(), strides, start, out);
+}
+
+template <typename T, typename Context>
+void ExpandViewKernel(const Context& dev_ctx,
+                      const DenseTensor& x,
+                      const IntArray& shape,
+                      DenseTensor* out) {
+  // The output dims are checked and inferred by InferMeta. The broadcast
+  // dims, which are new or of size 1 in `x`, have the stride 0.
+  auto out_dims = out->dims();
+  auto x_dims = x.dims();
+  auto x_strides = funcs::GetStrides(x);
+  int diff = out_dims.size() - x_dims.size();
+  std::vector<int64_t> strides(out_dims.size(), 0);
+  for (int i = diff; i < out_dims.size(); ++i) {
+    if (x_dims[i - diff] == out_dims[i]) {
+      strides[i] = x_strides[i - diff];
+    }
+  }
+  funcs::ShareStridedView(x, out_dims, strides, 0, out);
+}
+
+}  // namespace phi
+
+PD_REGISTER_KERNEL(transpose_view,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::TransposeViewKernel,
+                   bool,
+                   float,
+                   double,
+                   int32_t,
+                   int64_t,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16,
+                   phi::dtype::complex<float>,
+                   phi::dtype::complex<double>) {
+  kernel->InputAt(0).SetAllowStrided(true);
+}
+
+PD_REGISTER_KERNEL(slice_view,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::SliceViewKernel,
+                   bool,
+                   uint8_t,
+                   int,
+                   int64_t,
+                   float,
+                   double,
+                   phi::dtype::complex<float>,
+                   phi::dtype::complex<double>,
+                   phi::dtype::bfloat16) {
+  kernel->InputAt(0).SetAllowStrided(true);
+}
+
+PD_REGISTER_KERNEL(split_view,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::SplitViewKernel,
+                   float,
+                   double,
+                   int64_t,
+                   int,
+                   bool,
+                   uint8_t,
+                   int8_t,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {
+  kernel->InputAt(0).SetAllowStrided(true);
+}
+
+PD_REGISTER_KERNEL(split_with_num_view,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::SplitWithNumViewKernel,
+                   float,
+                   double,
+                   int64_t,
+                   int,
+                   bool,
+                   uint8_t,
+                   int8_t,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {
+  kernel->InputAt(0).SetAllowStrided(true);
+}
+
+PD_REGISTER_KERNEL(unbind_view,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::UnbindViewKernel,
+                   float,
+                   double,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16,
+                   int,
+                   int64_t) {
+  kernel->InputAt(0).SetAllowStrided(true);
+}
+
+PD_REGISTER_KERNEL(diagonal_view,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::DiagonalViewKernel,
+                   float,
+                   double,
+                   int,
+                   int64_t,
+                   phi::dtype::complex<float>,
+                   phi::dtype::complex<double>,
+                   bool) {
+  kernel->InputAt(0).SetAllowStrided(true);
+}
+
+PD_REGISTER_KERNEL(expand_view,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::ExpandViewKernel,
+                   float,
+                   double,
+                   int,
+                   int64_t,
+                   bool) {
+  kernel->InputAt(0).SetAllowStrided(true);
+}
@@ -20,6 +20,7 @@
 #include "paddle/phi/common/bfloat16.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/funcs/transpose_cpu.h"
 #include "paddle/phi/kernels/impl/transpose_grad_kernel_impl.h"
 
 namespace phi {
@@ -33,40 +34,11 @@ void TransposeKernel(const Context& ctx,
   if (out->numel() == 0) {
     return;
   }
-  int rank = axis.size();
-  switch (rank) {
-    case 0:
-      phi::Copy<Context>(ctx, x, ctx.GetPlace(), false, out);
-      break;
-    case 1:
-      funcs::Transpose<Context, T, 1> trans1;
-      trans1(ctx, x, out, axis);
-      break;
-    case 2:
-      funcs::Transpose<Context, T, 2> trans2;
-      trans2(ctx, x, out, axis);
-      break;
-    case 3:
-      funcs::Transpose<Context, T, 3> trans3;
-      trans3(ctx, x, out, axis);
-      break;
-    case 4:
-      funcs::Transpose<Context, T, 4> trans4;
-      trans4(ctx, x, out, axis);
-      break;
-    case 5:
-      funcs::Transpose<Context, T, 5> trans5;
-      trans5(ctx, x, out, axis);
-      break;
-    case 6:
-      funcs::Transpose<Context, T, 6> trans6;
-      trans6(ctx, x, out, axis);
-      break;
-    default:
-      // for rank >= 7 situation
-      funcs::TransposeNormal<Context, T> trans_normal;
-      trans_normal(ctx, x, out, axis);
+  if (axis.size() == 0) {
+    phi::Copy<Context>(ctx, x, ctx.GetPlace(), false, out);
+    return;
   }
+  funcs::TransposeCPU<T>(x, out, axis);
 }
 }  // namespace phi
 
@@ -0,0 +1,306 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
+
+namespace phi {
+namespace funcs {
+
+// The output channels of a tile of the direct convolution, which are the
+// lanes of the vectors of the inner loop.
+constexpr int kConvOCBlock = 8;
+// The output columns of a tile, which stay in registers with the channels.
+constexpr int kConvOWBlock = 8;
+// The convolutions run in parallel when they take at least so many
+// multiply-adds.
+constexpr int64_t kConvMinParallelSize = 1 << 18;
+
+// The activation which is fused with the bias into the output of the direct
+// convolution.
+enum class ConvActivation { kIdentity, kRelu, kRelu6 };
+
+struct Conv2DParams {
+  int batch_size;
+  int in_channels;
+  int in_h;
+  int in_w;
+  int out_channels;
+  int out_h;
+  int out_w;
+  int kernel_h;
+  int kernel_w;
+  int stride_h;
+  int stride_w;
+  int pad_top;
+  int pad_left;
+  int dilation_h;
+  int dilation_w;
+  int groups;
+};
+
+/**
+ * The filter of [out_channels, in_channels / groups, kernel_h, kernel_w] in
+ * the layout of the direct convolution: the output channels of every group
+ * are split into blocks of kConvOCBlock, which are the innermost dim, as
+ * [groups, blocks, in_channels / groups, kernel_h, kernel_w, kConvOCBlock].
+ * The channels after the last one of a group are zero. The depthwise filters
+ * keep their layout.
+ */
+template <typename T>
+struct PackedConvFilter {
+  int num_oc_blocks;
+  std::vector<T> data;
+};
+
+inline bool IsDepthwiseConv(const Conv2DParams& p) {
+  return p.in_channels == p.groups && p.out_channels == p.groups;
+}
+
+template <typename T>
+std::shared_ptr<PackedConvFilter<T>> PackConvFilter(const Conv2DParams& p,
+                                                    const T* filter) {
+  auto packed = std::make_shared<PackedConvFilter<T>>();
+  const int64_t kernel_size = static_cast<int64_t>(p.kernel_h) * p.kernel_w;
+  if (IsDepthwiseConv(p)) {
+    packed->num_oc_blocks = 0;
+    packed->data.assign(filter, filter + p.out_channels * kernel_size);
+    return packed;
+  }
+  const int ic_per_group = p.in_channels / p.groups;
+  const int oc_per_group = p.out_channels / p.groups;
+  const int num_oc_blocks = (oc_per_group + kConvOCBlock - 1) / kConvOCBlock;
+  const int64_t block_size = ic_per_group * kernel_size * kConvOCBlock;
+  packed->num_oc_blocks = num_oc_blocks;
+  packed->data.assign(p.groups * num_oc_blocks * block_size, 0);
+  for (int g = 0; g < p.groups; ++g) {
+    for (int oc = 0; oc < oc_per_group; ++oc) {
+      T* block = packed->data.data() +
+                 (g * num_oc_blocks + oc / kConvOCBlock) * block_size;
+      const T* src =
+          filter + (g * oc_per_group + oc) * ic_per_group * kernel_size;
+      for (int64_t k = 0; k < ic_per_group * kernel_size; ++k) {
+        block[k * kConvOCBlock + oc % kConvOCBlock] = src[k];
+      }
+    }
+  }
+  return packed;
+}
+
+template <typename T>
+inline T ApplyConvActivation(T x, ConvActivation activation) {
+  switch (activation) {
+    case ConvActivation::kRelu:
+      return x > 0 ? x : 0;
+    case ConvActivation::kRelu6:
+      return std::min<T>(x > 0 ? x : 0, 6);
+    default:
+      return x;
+  }
+}
+
+/**
+ * One output row of `num_oc` channels of a group: the tiles of
+ * kConvOWBlock columns by kConvOCBlock channels are accumulated in registers
+ * over the input channels and the taps, and the bias and the activation
+ * are applied when the tile is stored. The tiles whose taps are all inside
+ * the input skip the bounds checks.
+ */
+template <typename T>
+void DirectConv2DRow(const Conv2DParams& p,
+                     const T* input,
+                     const T* filter_block,
+                     int oh,
+                     int num_oc,
+                     const T* bias,
+                     ConvActivation activation,
+                     T* output) {
+  const int ic_per_group = p.in_channels / p.groups;
+  const int64_t out_plane = static_cast<int64_t>(p.out_h) * p.out_w;
+  for (int ow0 = 0; ow0 < p.out_w; ow0 += kConvOWBlock) {
+    const int num_ow = std::min(kConvOWBlock, p.out_w - ow0);
+    const int iw0 = ow0 * p.stride_w - p.pad_left;
+    const bool interior =
+        num_ow == kConvOWBlock && iw0 >= 0 &&
+        iw0 + (kConvOWBlock - 1) * p.stride_w +
+                (p.kernel_w - 1) * p.dilation_w <
+            p.in_w;
+    T acc[kConvOWBlock][kConvOCBlock] = {};
+    for (int ic = 0; ic < ic_per_group; ++ic) {
+      for (int kh = 0; kh < p.kernel_h; ++kh) {
+        const int ih = oh * p.stride_h - p.pad_top + kh * p.dilation_h;
+        if (ih < 0 || ih >= p.in_h) {
+          continue;
+        }
+        const T* in_row =
+            input + (static_cast<int64_t>(ic) * p.in_h + ih) * p.in_w;
+        const T* w_row =
+            filter_block + (ic * p.kernel_h + kh) * p.kernel_w * kConvOCBlock;
+        for (int kw = 0; kw < p.kernel_w; ++kw) {
+          const T* w = w_row + kw * kConvOCBlock;
+          const int iw = iw0 + kw * p.dilation_w;
+          if (interior) {
+            for (int t = 0; t < kConvOWBlock; ++t) {
+              const T x = in_row[iw + t * p.stride_w];
+              for (int c = 0; c < kConvOCBlock; ++c) {
+                acc[t][c] += x * w[c];
+              }
+            }
+          } else {
+            for (int t = 0; t < num_ow; ++t) {
+              const int x_index = iw + t * p.stride_w;
+              if (x_index < 0 || x_index >= p.in_w) {
+                continue;
+              }
+              const T x = in_row[x_index];
+              for (int c = 0; c < kConvOCBlock; ++c) {
+                acc[t][c] += x * w[c];
+              }
+            }
+          }
+        }
+      }
+    }
+    for (int c = 0; c < num_oc; ++c) {
+      const T b = bias ? bias[c] : static_cast<T>(0);
+      T* out = output + c * out_plane + ow0;
+      for (int t = 0; t < num_ow; ++t) {
+        out[t] = ApplyConvActivation<T>(acc[t][c] + b, activation);
+      }
+    }
+  }
+}
+
+// One output row of a depthwise convolution, vectorized over the columns.
+template <typename T>
+void DepthwiseConv2DRow(const Conv2DParams& p,
+                        const T* input,
+                        const T* filter,
+                        int oh,
+                        T bias,
+                        ConvActivation activation,
+                        T* output) {
+  std::fill(output, output + p.out_w, static_cast<T>(0));
+  for (int kh = 0; kh < p.kernel_h; ++kh) {
+    const int ih = oh * p.stride_h - p.pad_top + kh * p.dilation_h;
+    if (ih < 0 || ih >= p.in_h) {
+      continue;
+    }
+    const T* in_row = input + static_cast<int64_t>(ih) * p.in_w;
+    for (int kw = 0; kw < p.kernel_w; ++kw) {
+      const T w = filter[kh * p.kernel_w + kw];
+      const int iw0 = kw * p.dilation_w - p.pad_left;
+      // The columns whose input is inside the row.
+      const int begin = iw0 >= 0 ? 0 : (p.stride_w - 1 - iw0) / p.stride_w;
+      const int end =
+          iw0 >= p.in_w
+              ? 0
+              : std::min(p.out_w, (p.in_w - 1 - iw0) / p.stride_w + 1);
+      for (int ow = begin; ow < end; ++ow) {
+        output[ow] += w * in_row[iw0 + ow * p.stride_w];
+      }
+    }
+  }
+  for (int ow = 0; ow < p.out_w; ++ow) {
+    output[ow] = ApplyConvActivation<T>(output[ow] + bias, activation);
+  }
+}
+
+/**
+ * The 2-D convolution of NCHW `input` with the packed filter, which writes
+ * NCHW `output` directly instead of expanding the input with im2col. The
+ * rows of the output of every block of channels run in parallel. `bias` of
+ * out_channels may be null.
+ */
+template <typename T>
+void DirectConv2D(const Conv2DParams& p,
+                  const T* input,
+                  const PackedConvFilter<T>& filter,
+                  const T* bias,
+                  ConvActivation activation,
+                  T* output) {
+  const int ic_per_group = p.in_channels / p.groups;
+  const int oc_per_group = p.out_channels / p.groups;
+  const int64_t in_plane = static_cast<int64_t>(p.in_h) * p.in_w;
+  const int64_t out_plane = static_cast<int64_t>(p.out_h) * p.out_w;
+  const int64_t work = static_cast<int64_t>(p.batch_size) * p.out_channels *
+                       out_plane * ic_per_group * p.kernel_h * p.kernel_w;
+  bool parallel = work >= kConvMinParallelSize;
+
+  if (IsDepthwiseConv(p)) {
+    const int64_t num_rows =
+        static_cast<int64_t>(p.batch_size) * p.out_channels * p.out_h;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (parallel)
+#endif
+    for (int64_t row = 0; row < num_rows; ++row) {
+      const int oh = row % p.out_h;
+      const int64_t plane = row / p.out_h;
+      const int c = plane % p.out_channels;
+      DepthwiseConv2DRow<T>(
+          p,
+          input + plane * in_plane,
+          filter.data.data() + c * p.kernel_h * p.kernel_w,
+          oh,
+          bias ? bias[c] : static_cast<T>(0),
+          activation,
+          output + plane * out_plane + static_cast<int64_t>(oh) * p.out_w);
+    }
+    (void)parallel;
+    return;
+  }
+
+  const int64_t block_size = static_cast<int64_t>(ic_per_group) *
+                             p.kernel_h * p.kernel_w * kConvOCBlock;
+  const int64_t num_tiles = static_cast<int64_t>(p.batch_size) * p.groups *
+                            filter.num_oc_blocks * p.out_h;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (parallel)
+#endif
+  for (int64_t tile = 0; tile < num_tiles; ++tile) {
+    const int oh = tile % p.out_h;
+    const int64_t rest = tile / p.out_h;
+    const int block = rest % filter.num_oc_blocks;
+    const int g = (rest / filter.num_oc_blocks) % p.groups;
+    const int n = rest / filter.num_oc_blocks / p.groups;
+    const int oc0 = g * oc_per_group + block * kConvOCBlock;
+    const int num_oc =
+        std::min(kConvOCBlock, oc_per_group - block * kConvOCBlock);
+    DirectConv2DRow<T>(
+        p,
+        input + (static_cast<int64_t>(n) * p.in_channels + g * ic_per_group) *
+                    in_plane,
+        filter.data.data() +
+            (static_cast<int64_t>(g) * filter.num_oc_blocks + block) *
+                block_size,
+        oh,
+        num_oc,
+        bias ? bias + oc0 : nullptr,
+        activation,
+        output +
+            (static_cast<int64_t>(n) * p.out_channels + oc0) * out_plane +
+            static_cast<int64_t>(oh) * p.out_w);
+  }
+  (void)parallel;
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -34,10 +34,30 @@ struct BroadcastDimsSimplifier {
   BroadcastDimsSimplifier(const std::vector<const DenseTensor *> &ins,
                           const phi::DDim &dims,
                           int axis) {
-    if (!NeedBroadcast(ins, dims)) {
+    std::vector<phi::DDim> ins_dims;
+    ins_dims.reserve(ins.size());
+    for (auto *in : ins) {
+      ins_dims.emplace_back(in->dims());
+    }
+    Simplify(ins_dims, dims, axis);
+  }
+
+  // Simplify with the dims of the inputs, which is used by the CPU kernels
+  // that only have the broadcasted dims arrays.
+  BroadcastDimsSimplifier(const std::vector<phi::DDim> &ins_dims,
+                          const phi::DDim &dims,
+                          int axis) {
+    Simplify(ins_dims, dims, axis);
+  }
+
+ private:
+  void Simplify(const std::vector<phi::DDim> &ins_dims,
+                const phi::DDim &dims,
+                int axis) {
+    if (!NeedBroadcast(ins_dims, dims)) {
       int64_t numel = phi::product(dims);
       rank = 1;
-      N = ins.size();
+      N = ins_dims.size();
       out_dims = DimVector{numel};
       in_dims.resize(N);
       for (int64_t i = 0; i < N; ++i) {
@@ -46,18 +66,18 @@ struct BroadcastDimsSimplifier {
       return;
     }
 
-    N = std::max(static_cast<int>(ins.size()), 2);
+    N = std::max(static_cast<int>(ins_dims.size()), 2);
     in_dims.resize(N);
     rank = dims.size();
     out_dims = phi::vectorize<int64_t>(dims);
-    if (ins.size() == 1) {
+    if (ins_dims.size() == 1) {
       // When ins.size() = 1, broadcast input to output.
-      in_dims[0] = phi::vectorize<int64_t>(ins[0]->dims());
+      in_dims[0] = phi::vectorize<int64_t>(ins_dims[0]);
       // Add out_dims to in_dims to avoid errors in dims merging.
       in_dims[1] = out_dims;
     } else {
       for (int j = 0; j < N; ++j) {
-        in_dims[j] = phi::vectorize<int64_t>(ins[j]->dims());
+        in_dims[j] = phi::vectorize<int64_t>(ins_dims[j]);
       }
     }
     ExtendInputDimensions(N, axis);
@@ -111,15 +131,14 @@ struct BroadcastDimsSimplifier {
     }
   }
 
- private:
-  bool NeedBroadcast(const std::vector<const DenseTensor *> &ins,
+  bool NeedBroadcast(const std::vector<phi::DDim> &ins_dims,
                      const phi::DDim &dims) {
     bool no_broadcast_flag = true;
-    for (auto *in : ins) {
-      no_broadcast_flag &= ins[0]->dims() == in->dims();
+    for (auto &in_dim : ins_dims) {
+      no_broadcast_flag &= ins_dims[0] == in_dim;
     }
-    if (ins.size() > 0) {
-      no_broadcast_flag &= dims == ins[0]->dims();
+    if (ins_dims.size() > 0) {
+      no_broadcast_flag &= dims == ins_dims[0];
     }
     return !no_broadcast_flag;
   }
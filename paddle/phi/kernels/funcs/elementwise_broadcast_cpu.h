@@ -0,0 +1,327 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "paddle/phi/core/ddim.h"
+#include "paddle/phi/kernels/funcs/dims_simplifier.h"
+
+namespace phi {
+namespace funcs {
+
+// The layout of a binary broadcast on CPU, after the dims are collapsed by
+// BroadcastDimsSimplifier. The output is viewed as rows of `inner`
+// contiguous elements. Along a row, an input is either contiguous (stride 1)
+// or broadcasted (stride 0), and the offsets of the inputs at the beginning
+// of each row are given by the strides of the outer dims.
+//
+// Since the contiguous dims are merged, the common cases end up with a
+// single outer dim or none:
+//   same shape:       x=[N],    y=[N]
+//   row broadcast:    x=[M, N], y=[1, N]  (y repeats along the rows)
+//   column broadcast: x=[M, N], y=[M, 1]  (y is constant along a row)
+//   scalar:           x=[N],    y=[1]
+struct CPUBroadcastPlan {
+  int64_t numel{0};
+  int64_t inner{1};
+  // 1 if the input is contiguous along the rows, 0 if broadcasted.
+  int64_t x_inner_stride{0};
+  int64_t y_inner_stride{0};
+  // The outer dims and the strides of the inputs, outermost first. The
+  // stride of a broadcasted dim is 0.
+  std::vector<int64_t> outer_dims;
+  std::vector<int64_t> x_outer_strides;
+  std::vector<int64_t> y_outer_strides;
+
+  // The dims arrays are the ones given by GetBroadcastDimsArrays.
+  CPUBroadcastPlan(const int *x_dims_array,
+                   const int *y_dims_array,
+                   const int *out_dims_array,
+                   int max_dim) {
+    std::vector<phi::DDim> ins_dims = {
+        phi::make_ddim(std::vector<int>(x_dims_array, x_dims_array + max_dim)),
+        phi::make_ddim(std::vector<int>(y_dims_array, y_dims_array + max_dim))};
+    phi::DDim out_dims = phi::make_ddim(
+        std::vector<int>(out_dims_array, out_dims_array + max_dim));
+    numel = phi::product(out_dims);
+    if (numel == 0) {
+      return;
+    }
+    BroadcastDimsSimplifier simplifier(ins_dims, out_dims, /*axis=*/0);
+    // The dims of the simplifier are in the reversed order.
+    const auto &out = simplifier.out_dims;
+    const auto &x = simplifier.in_dims[0];
+    const auto &y = simplifier.in_dims[1];
+    int rank = static_cast<int>(simplifier.rank);
+
+    inner = out[0];
+    x_inner_stride = x[0] == 1 ? 0 : 1;
+    y_inner_stride = y[0] == 1 ? 0 : 1;
+    int64_t x_size = x[0];
+    int64_t y_size = y[0];
+    for (int i = 1; i < rank; ++i) {
+      outer_dims.push_back(out[i]);
+      x_outer_strides.push_back(x[i] == 1 ? 0 : x_size);
+      y_outer_strides.push_back(y[i] == 1 ? 0 : y_size);
+      x_size *= x[i];
+      y_size *= y[i];
+    }
+    std::reverse(outer_dims.begin(), outer_dims.end());
+    std::reverse(x_outer_strides.begin(), x_outer_strides.end());
+    std::reverse(y_outer_strides.begin(), y_outer_strides.end());
+  }
+
+  int64_t rows() const { return numel == 0 ? 0 : numel / inner; }
+
+  // Whether different rows never map to the same elements of the input with
+  // `outer_strides`, i.e. the gradient of the input can be accumulated in
+  // parallel over the rows.
+  bool RowsAreDisjoint(const std::vector<int64_t> &outer_strides) const {
+    for (size_t i = 0; i < outer_dims.size(); ++i) {
+      if (outer_dims[i] > 1 && outer_strides[i] == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+// Walks the rows of a CPUBroadcastPlan, keeping the offsets of the inputs
+// instead of computing them from the index of every element.
+class CPUBroadcastRowCursor {
+ public:
+  CPUBroadcastRowCursor(const CPUBroadcastPlan &plan, int64_t row)
+      : plan_(plan), index_(plan.outer_dims.size(), 0) {
+    out_offset_ = row * plan.inner;
+    for (int i = static_cast<int>(index_.size()) - 1; i >= 0; --i) {
+      index_[i] = row % plan.outer_dims[i];
+      row /= plan.outer_dims[i];
+      x_offset_ += index_[i] * plan.x_outer_strides[i];
+      y_offset_ += index_[i] * plan.y_outer_strides[i];
+    }
+  }
+
+  int64_t x_offset() const { return x_offset_; }
+  int64_t y_offset() const { return y_offset_; }
+  int64_t out_offset() const { return out_offset_; }
+
+  void Next() {
+    out_offset_ += plan_.inner;
+    for (int i = static_cast<int>(index_.size()) - 1; i >= 0; --i) {
+      x_offset_ += plan_.x_outer_strides[i];
+      y_offset_ += plan_.y_outer_strides[i];
+      if (++index_[i] < plan_.outer_dims[i]) {
+        return;
+      }
+      x_offset_ -= index_[i] * plan_.x_outer_strides[i];
+      y_offset_ -= index_[i] * plan_.y_outer_strides[i];
+      index_[i] = 0;
+    }
+  }
+
+ private:
+  const CPUBroadcastPlan &plan_;
+  std::vector<int64_t> index_;
+  int64_t x_offset_{0};
+  int64_t y_offset_{0};
+  int64_t out_offset_{0};
+};
+
+// Split the rows into chunks which are large enough to be worth a thread,
+// and call `func(row_begin, row_end)` for every chunk.
+template <typename Func>
+void ParallelForBroadcastRows(const CPUBroadcastPlan &plan,
+                              bool parallel,
+                              Func func) {
+  constexpr int64_t kMinChunkSize = 32768;
+  int64_t rows = plan.rows();
+  int64_t num_chunks = 1;
+  if (parallel) {
+    num_chunks =
+        std::min(rows, std::max<int64_t>(plan.numel / kMinChunkSize, 1));
+  }
+  if (num_chunks <= 1) {
+    func(0, rows);
+    return;
+  }
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+    func(rows * chunk / num_chunks, rows * (chunk + 1) / num_chunks);
+  }
+}
+
+// The strides of the inputs along a row are compile-time constants, so that
+// the loops are plain contiguous loops which the compiler vectorizes.
+template <int kXStride, int kYStride>
+struct BroadcastRowLoop {
+  template <typename Functor, typename InT, typename OutT>
+  static void Forward(
+      const InT *x, const InT *y, OutT *out, int64_t n, Functor func) {
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] = func(x[i * kXStride], y[i * kYStride]);
+    }
+  }
+
+  // Accumulate the gradient of the input which is contiguous along the row.
+  template <typename T, typename Tout, typename GradOp>
+  static void Gradient(const T *x,
+                       const T *y,
+                       const Tout *out,
+                       const Tout *dout,
+                       int64_t n,
+                       GradOp op,
+                       T *grad) {
+    for (int64_t i = 0; i < n; ++i) {
+      grad[i] += op(x[i * kXStride], y[i * kYStride], out[i], dout[i]);
+    }
+  }
+
+  // Accumulate the gradient of the input which is broadcasted along the row.
+  template <typename T, typename Tout, typename GradOp>
+  static void ReducedGradient(const T *x,
+                              const T *y,
+                              const Tout *out,
+                              const Tout *dout,
+                              int64_t n,
+                              GradOp op,
+                              T *grad) {
+    T sum = static_cast<T>(0);
+    for (int64_t i = 0; i < n; ++i) {
+      sum += op(x[i * kXStride], y[i * kYStride], out[i], dout[i]);
+    }
+    *grad += sum;
+  }
+};
+
+template <typename Visitor>
+void VisitBroadcastRowLoop(int64_t x_stride,
+                           int64_t y_stride,
+                           Visitor visitor) {
+  if (x_stride && y_stride) {
+    visitor(BroadcastRowLoop<1, 1>());
+  } else if (x_stride) {
+    visitor(BroadcastRowLoop<1, 0>());
+  } else if (y_stride) {
+    visitor(BroadcastRowLoop<0, 1>());
+  } else {
+    visitor(BroadcastRowLoop<0, 0>());
+  }
+}
+
+// out = func(x, y) with broadcast, parallelized over the rows.
+template <typename Functor, typename InT, typename OutT>
+void CPUBroadcastForward(const CPUBroadcastPlan &plan,
+                         const InT *x,
+                         const InT *y,
+                         OutT *out,
+                         Functor func) {
+  if (plan.numel == 0) {
+    return;
+  }
+  VisitBroadcastRowLoop(
+      plan.x_inner_stride, plan.y_inner_stride, [&](auto loop) {
+        ParallelForBroadcastRows(
+            plan, /*parallel=*/true, [&](int64_t begin, int64_t end) {
+              CPUBroadcastRowCursor cursor(plan, begin);
+              for (int64_t row = begin; row < end; ++row, cursor.Next()) {
+                loop.Forward(x + cursor.x_offset(),
+                             y + cursor.y_offset(),
+                             out + cursor.out_offset(),
+                             plan.inner,
+                             func);
+              }
+            });
+      });
+}
+
+// Accumulate the gradients of x and y, which are reduced over the
+// broadcasted dims. `dx` and `dy` must be zero-initialized, and can be
+// nullptr if not required. The rows are processed in parallel only if every
+// required gradient gets a disjoint part from each row.
+template <typename T, typename Tout, typename DX_OP, typename DY_OP>
+void CPUBroadcastBackward(const CPUBroadcastPlan &plan,
+                          const T *x,
+                          const T *y,
+                          const Tout *out,
+                          const Tout *dout,
+                          T *dx,
+                          T *dy,
+                          DX_OP dx_op,
+                          DY_OP dy_op) {
+  if (plan.numel == 0) {
+    return;
+  }
+  bool parallel =
+      (dx == nullptr || plan.RowsAreDisjoint(plan.x_outer_strides)) &&
+      (dy == nullptr || plan.RowsAreDisjoint(plan.y_outer_strides));
+  VisitBroadcastRowLoop(
+      plan.x_inner_stride, plan.y_inner_stride, [&](auto loop) {
+        ParallelForBroadcastRows(
+            plan, parallel, [&](int64_t begin, int64_t end) {
+              CPUBroadcastRowCursor cursor(plan, begin);
+              for (int64_t row = begin; row < end; ++row, cursor.Next()) {
+                const T *x_row = x + cursor.x_offset();
+                const T *y_row = y + cursor.y_offset();
+                const Tout *out_row = out + cursor.out_offset();
+                const Tout *dout_row = dout + cursor.out_offset();
+                if (dx != nullptr) {
+                  if (plan.x_inner_stride) {
+                    loop.Gradient(x_row,
+                                  y_row,
+                                  out_row,
+                                  dout_row,
+                                  plan.inner,
+                                  dx_op,
+                                  dx + cursor.x_offset());
+                  } else {
+                    loop.ReducedGradient(x_row,
+                                         y_row,
+                                         out_row,
+                                         dout_row,
+                                         plan.inner,
+                                         dx_op,
+                                         dx + cursor.x_offset());
+                  }
+                }
+                if (dy != nullptr) {
+                  if (plan.y_inner_stride) {
+                    loop.Gradient(x_row,
+                                  y_row,
+                                  out_row,
+                                  dout_row,
+                                  plan.inner,
+                                  dy_op,
+                                  dy + cursor.y_offset());
+                  } else {
+                    loop.ReducedGradient(x_row,
+                                         y_row,
+                                         out_row,
+                                         dout_row,
+                                         plan.inner,
+                                         dy_op,
+                                         dy + cursor.y_offset());
+                  }
+                }
+              }
+            });
+      });
+}
+
+}  // namespace funcs
+}  // namespace phi
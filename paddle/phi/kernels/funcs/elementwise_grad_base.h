@@ -18,6 +18,7 @@ limitations under the License. */
 #include "paddle/phi/backends/gpu/gpu_info.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/kernels/funcs/common_shape.h"
+#include "paddle/phi/kernels/funcs/elementwise_broadcast_cpu.h"
 #include "paddle/phi/kernels/funcs/elementwise_utils.h"
 #include "paddle/phi/kernels/funcs/for_range.h"
 
@@ -65,7 +66,6 @@ void CommonGradBroadcastCPU(const DenseTensor &x,
                             const CPUContext &ctx,
                             DX_OP dx_op,
                             DY_OP dy_op) {
-  std::vector<int> index_array(max_dim, 0);
   const T *x_data = x.data<T>();
   const T *y_data = y.data<T>();
   const Tout *out_data = out.data<Tout>();
@@ -78,27 +78,16 @@ void CommonGradBroadcastCPU(const DenseTensor &x,
   if (dy_data != nullptr) {
     memset(dy_data, 0, dy->numel() * sizeof(T));
   }
-  const int out_size = std::accumulate(
-      out_dims_array, out_dims_array + max_dim, 1, std::multiplies<int>());
-  int x_index, y_index;
-  for (int out_index = 0; out_index < out_size; ++out_index) {
-    x_index = GetElementwiseIndex(x_dims_array, max_dim, index_array.data());
-    y_index = GetElementwiseIndex(y_dims_array, max_dim, index_array.data());
-    if (dx_data != nullptr) {
-      dx_data[x_index] += dx_op(x_data[x_index],
-                                y_data[y_index],
-                                out_data[out_index],
-                                dout_data[out_index]);
-    }
-    if (dy_data != nullptr) {
-      dy_data[y_index] += dy_op(x_data[x_index],
-                                y_data[y_index],
-                                out_data[out_index],
-                                dout_data[out_index]);
-    }
-
-    UpdateElementwiseIndexArray(out_dims_array, max_dim, index_array.data());
-  }
+  CPUBroadcastPlan plan(x_dims_array, y_dims_array, out_dims_array, max_dim);
+  CPUBroadcastBackward(plan,
+                       x_data,
+                       y_data,
+                       out_data,
+                       dout_data,
+                       dx_data,
+                       dy_data,
+                       dx_op,
+                       dy_op);
 }
 
 template <typename T, typename DX_OP, typename DY_OP, typename Tout = T>
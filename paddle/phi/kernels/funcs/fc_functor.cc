@@ -17,6 +17,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/packed_gemm.h"
 
 namespace phi {
 namespace funcs {
@@ -31,8 +32,11 @@ void FCFunctor<DeviceContext, T>::operator()(const DeviceContext& context,
                                              T* Y,
                                              const T* B,
                                              bool relu,
-                                             bool padding_weights) {
+                                             bool padding_weights,
+                                             const DenseTensor* w_tensor) {
   auto blas = GetBlas<DeviceContext, T>(context);
+  // Reuses W packed for the GEMM if it is constant.
+  PackedGemmFunctor<DeviceContext, T> packed_gemm;
   phi::DenseTensor Y1;
   T* Y1_data = nullptr;
   if (padding_weights) {
@@ -47,20 +51,46 @@ void FCFunctor<DeviceContext, T>::operator()(const DeviceContext& context,
     for (int i = 0; i < M; i++) {
       memcpy(X1_data + i * KK, X + i * K, K * sizeof(T));
     }
-    blas.GEMM(false,
-              false,
-              M,
-              N,
-              K,
-              static_cast<T>(1.0),
-              X1_data,
-              KK,
-              W,
-              NN,
-              static_cast<T>(0.0),
-              Y1_data,
-              NN);
-  } else {
+    if (!w_tensor || !packed_gemm(context,
+                                  *w_tensor,
+                                  false,
+                                  M,
+                                  N,
+                                  K,
+                                  X1_data,
+                                  KK,
+                                  W,
+                                  NN,
+                                  static_cast<T>(0),
+                                  Y1_data,
+                                  NN)) {
+      blas.GEMM(false,
+                false,
+                M,
+                N,
+                K,
+                static_cast<T>(1.0),
+                X1_data,
+                KK,
+                W,
+                NN,
+                static_cast<T>(0.0),
+                Y1_data,
+                NN);
+    }
+  } else if (!w_tensor || !packed_gemm(context,
+                                       *w_tensor,
+                                       false,
+                                       M,
+                                       N,
+                                       K,
+                                       X,
+                                       K,
+                                       W,
+                                       N,
+                                       static_cast<T>(0),
+                                       Y,
+                                       N)) {
     blas.MatMul(M, N, K, X, W, Y);
   }
   if (B == NULL) {
@@ -286,7 +286,8 @@ void FCFunctor<DeviceContext, T>::operator()(const DeviceContext& context,
                                              T* Y,
                                              const T* B,
                                              bool relu,
-                                             bool padding_weights) {
+                                             bool padding_weights,
+                                             const DenseTensor* w_tensor) {
   PADDLE_ENFORCE_EQ(padding_weights,
                     false,
                     errors::PermissionDenied(
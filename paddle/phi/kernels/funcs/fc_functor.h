@@ -17,6 +17,7 @@ limitations under the License. */
 #include <string>
 
 #include "paddle/fluid/platform/device_context.h"
+#include "paddle/phi/core/dense_tensor.h"
 
 namespace phi {
 namespace funcs {
@@ -24,6 +25,8 @@ namespace funcs {
 template <typename DeviceContext, typename T>
 class FCFunctor {
  public:
+  // `w_tensor` is the tensor of W, if W is a whole tensor, with which the CPU
+  // functor reuses W packed for the GEMM, see PackedGemmFunctor.
   void operator()(const DeviceContext& context,
                   const int M,
                   const int N,
@@ -33,7 +36,8 @@ class FCFunctor {
                   T* Y,
                   const T* B = nullptr,
                   bool relu = false,
-                  bool weight_pass = false);
+                  bool weight_pass = false,
+                  const DenseTensor* w_tensor = nullptr);
 };
 
 }  // namespace funcs
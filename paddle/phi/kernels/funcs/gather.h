@@ -22,6 +22,7 @@ limitations under the License. */
 #include "paddle/phi/core/ddim.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/funcs/scatter.h"
 
 namespace phi {
 namespace funcs {
@@ -72,7 +73,6 @@ void CPUGather(const phi::CPUContext& ctx,
   const size_t slice_bytes = slice_size * sizeof(T);
 
   for (int64_t i = 0; i < index_size; ++i) {
-    IndexT index_ = p_index[i];
     PADDLE_ENFORCE_LT(p_index[i],
                       input_size,
                       phi::errors::OutOfRange(
@@ -90,8 +90,17 @@ void CPUGather(const phi::CPUContext& ctx,
                           "%d index.",
                           p_index[i],
                           i));
+  }
+
+  bool parallel = CPUScatterNumThreads(index_size * slice_size) > 1;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (parallel)
+#endif
+  for (int64_t i = 0; i < index_size; ++i) {
+    IndexT index_ = p_index[i];
     memcpy(p_output + i * slice_size, p_src + index_ * slice_size, slice_bytes);
   }
+  (void)parallel;
 }
 
 template <typename T, typename IndexT = int>
@@ -120,6 +129,8 @@ void CPUGatherNd(const phi::CPUContext& ctx,
   }
   const size_t slice_bytes = slice_size * sizeof(T);
 
+  // The offsets of the slices to copy, in the units of slices.
+  std::vector<int64_t> offsets(remain_numel);
   for (int64_t i = 0; i < remain_numel; ++i) {
     int64_t index_ = 0;
     int64_t temp = 1;
@@ -139,9 +150,19 @@ void CPUGatherNd(const phi::CPUContext& ctx,
       index_ += (index_value * temp);
       temp *= input_dims[j];
     }
-    memcpy(
-        p_output + i * slice_size, p_input + index_ * slice_size, slice_bytes);
+    offsets[i] = index_;
+  }
+
+  bool parallel = CPUScatterNumThreads(remain_numel * slice_size) > 1;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (parallel)
+#endif
+  for (int64_t i = 0; i < remain_numel; ++i) {
+    memcpy(p_output + i * slice_size,
+           p_input + offsets[i] * slice_size,
+           slice_bytes);
   }
+  (void)parallel;
 }
 
 template <typename T, typename U>
@@ -152,7 +173,6 @@ void GatherV2Function(const phi::CPUContext& ctx,
                       DenseTensor* out) {
   auto* index_data = index->data<U>();
   int64_t index_size = index->numel();
-  int64_t input_size = input->numel();
   auto input_dim = input->dims();
   auto* input_data = input->data<T>();
 
@@ -200,17 +220,23 @@ void GatherV2Function(const phi::CPUContext& ctx,
   out->Resize(out_dim);
   auto* out_data = ctx.Alloc<T>(out);
 
-  int out_index = 0;
-  for (int64_t i = 0; i < inner_dim_size; i++) {
-    for (int64_t j = 0; j < index_size; j++) {
-      for (int64_t k = 0; k < outer_dim_size; k++) {
-        int64_t index = k + index_data[j] * outer_dim_size +
-                        (i * input_size / inner_dim_size);
-        out_data[out_index] = input_data[index];
-        out_index++;
-      }
-    }
+  // Copy the rows of outer_dim_size elements, as many of them in parallel as
+  // there are threads.
+  const size_t row_bytes = outer_dim_size * sizeof(T);
+  int64_t num_rows = inner_dim_size * index_size;
+  bool parallel = CPUScatterNumThreads(num_rows * outer_dim_size) > 1;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (parallel)
+#endif
+  for (int64_t row = 0; row < num_rows; ++row) {
+    int64_t i = row / index_size;
+    int64_t j = row % index_size;
+    memcpy(out_data + row * outer_dim_size,
+           input_data + (i * input_index_dim_size + index_data[j]) *
+                            outer_dim_size,
+           row_bytes);
   }
+  (void)parallel;
 }
 
 template <typename T, typename U>
@@ -249,15 +275,43 @@ void GatherV2GradFunction(const phi::CPUContext& ctx,
   int64_t out_index_dim_size = out_dim[axis_index];
   phi::funcs::set_constant(ctx, out, 0.0);
 
-  for (int64_t i = 0; i < inner_dim_size; i++) {
-    for (int64_t j = 0; j < input_index_dim_size; j++) {
+  for (int64_t j = 0; j < input_index_dim_size; j++) {
+    PADDLE_ENFORCE_LT(index_data[j],
+                      out_index_dim_size,
+                      phi::errors::OutOfRange(
+                          "The element of Index must be less than the size of "
+                          "input dim size of axis which is %d, but received "
+                          "index element which is %d in the %d index.",
+                          out_index_dim_size,
+                          index_data[j],
+                          j));
+    PADDLE_ENFORCE_GE(index_data[j],
+                      0,
+                      phi::errors::OutOfRange(
+                          "The element of Index must be greater than or equal "
+                          "to 0, but received index element which is %d in the "
+                          "%d index.",
+                          index_data[j],
+                          j));
+  }
+
+  // The rows of the gradient along the axis are accumulated in the order of
+  // the index, by the threads which own them.
+  CPURowPartition<U> partition(index_data,
+                               input_index_dim_size,
+                               out_index_dim_size,
+                               inner_dim_size * outer_dim_size);
+  partition.ForEach([&](int64_t j, U index_value) {
+    for (int64_t i = 0; i < inner_dim_size; i++) {
+      T* dst = out_data + (i * out_index_dim_size + index_value) *
+                              outer_dim_size;
+      const T* src =
+          input_data + (i * input_index_dim_size + j) * outer_dim_size;
       for (int64_t k = 0; k < outer_dim_size; k++) {
-        int64_t index = k + index_data[j] * outer_dim_size +
-                        i * outer_dim_size * out_index_dim_size;
-        out_data[index] += input_data[j * outer_dim_size + k];
+        dst[k] += src[k];
       }
     }
-  }
+  });
 }
 
 }  // namespace funcs
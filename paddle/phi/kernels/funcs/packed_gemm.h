@@ -0,0 +1,158 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/packed_weight_cache.h"
+
+DECLARE_bool(use_packed_gemm);
+
+namespace phi {
+namespace funcs {
+
+/**
+ * Y = X * op(W) + beta * Y, where X is [M, K] and op(W) is the constant weight
+ * of [K, N], with W packed once for the GEMM and cached. Returns false if the
+ * packed GEMM is not used for the context and the data type, is disabled by
+ * FLAGS_use_packed_gemm, or W is not marked constant in PackedWeightCache,
+ * and then the caller runs the plain GEMM.
+ *
+ * `weight` is the tensor of W, which keys the cache, and `w` points to W in
+ * it with the leading dim `ldw`.
+ */
+template <typename Context, typename T>
+struct PackedGemmFunctor {
+  bool operator()(const Context& dev_ctx,
+                  const DenseTensor& weight,
+                  bool trans_w,
+                  int M,
+                  int N,
+                  int K,
+                  const T* x,
+                  int ldx,
+                  const T* w,
+                  int ldw,
+                  T beta,
+                  T* y,
+                  int ldy) const {
+    return false;
+  }
+};
+
+#ifdef PADDLE_WITH_MKLML
+// The B matrix packed by MKL for cblas_?gemm_compute.
+template <typename T>
+class MKLPackedGemmWeight {
+ public:
+  MKLPackedGemmWeight(const CPUContext& dev_ctx,
+                      bool trans_w,
+                      int N,
+                      int K,
+                      const T* w,
+                      int ldw) {
+    auto blas = GetBlas<CPUContext, T>(dev_ctx);
+    // The size of the packed B does not depend on M, so it is packed for a
+    // single row and used for any M.
+    data_ = blas.GEMM_ALLOC(CblasBMatrix, 1, N, K);
+    PADDLE_ENFORCE_NOT_NULL(
+        data_,
+        errors::ResourceExhausted(
+            "Failed to allocate the packed weight of [%d, %d] by GEMM_ALLOC.",
+            K,
+            N));
+    blas.GEMM_PACK(CblasBMatrix,
+                   trans_w ? CblasTrans : CblasNoTrans,
+                   1,
+                   N,
+                   K,
+                   static_cast<T>(1),
+                   w,
+                   ldw,
+                   data_);
+  }
+
+  MKLPackedGemmWeight(const MKLPackedGemmWeight&) = delete;
+  MKLPackedGemmWeight& operator=(const MKLPackedGemmWeight&) = delete;
+
+  ~MKLPackedGemmWeight() { CBlas<T>::GEMM_FREE(data_); }
+
+  const T* data() const { return data_; }
+
+ private:
+  T* data_;
+};
+
+template <typename T>
+struct MKLPackedGemmFunctor {
+  bool operator()(const CPUContext& dev_ctx,
+                  const DenseTensor& weight,
+                  bool trans_w,
+                  int M,
+                  int N,
+                  int K,
+                  const T* x,
+                  int ldx,
+                  const T* w,
+                  int ldw,
+                  T beta,
+                  T* y,
+                  int ldy) const {
+    auto& cache = PackedWeightCache::Instance();
+    if (!FLAGS_use_packed_gemm || M <= 0 || N <= 0 || K <= 0 ||
+        !cache.IsConstant(weight)) {
+      return false;
+    }
+    // The same weight may be used as W of different shapes, such as by a
+    // padded fc, so the shape is a part of the kind.
+    std::string kind = "gemm_b_" + std::to_string(K) + "x" +
+                       std::to_string(N) + "_ld" + std::to_string(ldw) +
+                       (trans_w ? "_t" : "");
+    auto packed = cache.Get<MKLPackedGemmWeight<T>>(weight, kind, [&]() {
+      return std::make_shared<MKLPackedGemmWeight<T>>(
+          dev_ctx, trans_w, N, K, w, ldw);
+    });
+    auto blas = GetBlas<CPUContext, T>(dev_ctx);
+    blas.GEMM_COMPUTE(CblasNoTrans,
+                      CblasPacked,
+                      M,
+                      N,
+                      K,
+                      x,
+                      ldx,
+                      packed->data(),
+                      ldw,
+                      beta,
+                      y,
+                      ldy);
+    return true;
+  }
+};
+
+template <>
+struct PackedGemmFunctor<CPUContext, float>
+    : public MKLPackedGemmFunctor<float> {};
+
+template <>
+struct PackedGemmFunctor<CPUContext, double>
+    : public MKLPackedGemmFunctor<double> {};
+#endif
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,107 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/packed_weight_cache.h"
+
+#include <iterator>
+
+#include "glog/logging.h"
+
+namespace phi {
+namespace funcs {
+
+PackedWeightCache& PackedWeightCache::Instance() {
+  static PackedWeightCache cache;
+  return cache;
+}
+
+size_t PackedWeightCache::KeyHash::operator()(const Key& key) const {
+  size_t seed = std::hash<const void*>()(key.holder);
+  seed ^= std::hash<size_t>()(key.offset) + 0x9e3779b9 + (seed << 6) +
+          (seed >> 2);
+  seed ^= std::hash<std::string>()(key.kind) + 0x9e3779b9 + (seed << 6) +
+          (seed >> 2);
+  return seed;
+}
+
+std::shared_ptr<const void> PackedWeightCache::GetImpl(
+    const DenseTensor& weight,
+    const std::string& kind,
+    const std::function<std::shared_ptr<const void>()>& pack) {
+  // The version counter is only read, the weight is not modified.
+  uint32_t version = const_cast<DenseTensor&>(weight)
+                         .InplaceVersionCounter()
+                         .CurrentVersion();
+  Key key{weight.Holder().get(), weight.meta().offset, kind};
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end() && !it->second.holder.expired() &&
+        it->second.dims == weight.dims() &&
+        it->second.dtype == weight.dtype() && it->second.version == version) {
+      return it->second.packed;
+    }
+  }
+
+  // Pack out of the lock, so that the weights of other kernels are not
+  // blocked. Two threads may pack the same weight, and one of them is kept.
+  auto packed = pack();
+  std::lock_guard<std::mutex> guard(mutex_);
+  // Drop the packed forms of the freed weights, which are as large as the
+  // weights, once a weight is packed.
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    it = it->second.holder.expired() ? entries_.erase(it) : std::next(it);
+  }
+  if (entries_.size() >= kMaxEntries) {
+    VLOG(3) << "The packed weight cache is full, clear its "
+            << entries_.size() << " entries.";
+    entries_.clear();
+  }
+  entries_[key] =
+      Entry{weight.Holder(), weight.dims(), weight.dtype(), version, packed};
+  return packed;
+}
+
+void PackedWeightCache::MarkConstant(const DenseTensor& weight) {
+  if (!weight.Holder()) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto it = constants_.begin(); it != constants_.end();) {
+    it = it->second.expired() ? constants_.erase(it) : std::next(it);
+  }
+  constants_[weight.Holder().get()] = weight.Holder();
+}
+
+bool PackedWeightCache::IsConstant(const DenseTensor& weight) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = constants_.find(weight.Holder().get());
+  // The memory of an expired weight may be reused by another tensor.
+  return it != constants_.end() &&
+         it->second.lock().get() == weight.Holder().get();
+}
+
+size_t PackedWeightCache::Size() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return entries_.size();
+}
+
+void PackedWeightCache::Clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_.clear();
+  constants_.clear();
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,107 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace phi {
+namespace funcs {
+
+/**
+ * The packed forms of the constant weights of the CPU kernels, such as the
+ * filters of conv in the layout of the direct convolution, so that a weight
+ * is packed once instead of on every call.
+ *
+ * An entry is keyed by the memory of the weight and the kind of packing. It
+ * is packed again if the memory was freed, or if the dims, the data type or
+ * the inplace version of the weight changed. The weights which are updated
+ * without a new inplace version, as by the optimizers and by the ops which
+ * write persistable variables, must not be cached, so the kernels only cache
+ * the weights marked by MarkConstant, as the predictors mark their
+ * parameters.
+ */
+class PackedWeightCache {
+ public:
+  // The cache drops the entries of the freed weights whenever a weight is
+  // packed or marked, and is cleared if it still grows to so many entries.
+  enum { kMaxEntries = 4096 };
+
+  static PackedWeightCache& Instance();
+
+  // The packed form of `weight` of the `kind`, made by `pack` on a miss.
+  template <typename PackedT>
+  std::shared_ptr<const PackedT> Get(
+      const DenseTensor& weight,
+      const std::string& kind,
+      const std::function<std::shared_ptr<PackedT>()>& pack) {
+    return std::static_pointer_cast<const PackedT>(
+        GetImpl(weight, kind, [&pack]() -> std::shared_ptr<const void> {
+          return pack();
+        }));
+  }
+
+  // Marks the memory of `weight` as constant while it is alive.
+  void MarkConstant(const DenseTensor& weight);
+
+  bool IsConstant(const DenseTensor& weight);
+
+  size_t Size();
+
+  void Clear();
+
+ private:
+  PackedWeightCache() = default;
+
+  struct Key {
+    const void* holder;
+    size_t offset;
+    std::string kind;
+
+    bool operator==(const Key& other) const {
+      return holder == other.holder && offset == other.offset &&
+             kind == other.kind;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    std::weak_ptr<phi::Allocation> holder;
+    DDim dims;
+    DataType dtype;
+    uint32_t version;
+    std::shared_ptr<const void> packed;
+  };
+
+  std::shared_ptr<const void> GetImpl(
+      const DenseTensor& weight,
+      const std::string& kind,
+      const std::function<std::shared_ptr<const void>()>& pack);
+
+  std::mutex mutex_;
+  std::unordered_map<Key, Entry, KeyHash> entries_;
+  std::unordered_map<const void*, std::weak_ptr<phi::Allocation>> constants_;
+};
+
+}  // namespace funcs
+}  // namespace phi
@@ -13,9 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <algorithm>
 #include <cstring>
 #include <string>
 #include <unordered_set>
+#include <vector>
+
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
 
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/ddim.h"
@@ -64,6 +70,121 @@ elementwise_inner_add(const phi::CPUContext& ctx,
   eigen_dst += eigen_src;
 }
 
+// The CPU scatters and gathers run in parallel when they move at least so
+// many elements.
+constexpr int64_t kCPUScatterMinParallelSize = 1 << 15;
+
+inline int CPUScatterNumThreads(int64_t num_elements) {
+#ifdef PADDLE_WITH_MKLML
+  if (num_elements >= kCPUScatterMinParallelSize) {
+    return omp_get_max_threads();
+  }
+#endif
+  return 1;
+}
+
+/**
+ * Run the updates of the rows `rows[i]`, which are in [0, num_rows), in
+ * parallel without races. The rows are divided into ranges, and the
+ * positions i are grouped by the range of their rows with a stable counting
+ * sort, so every range is updated by a single thread. The updates of a row
+ * keep the order of i, so the last write wins as in the serial loop, and the
+ * sums are the same bitwise.
+ */
+template <typename IndexT>
+class CPURowPartition {
+ public:
+  CPURowPartition(const IndexT* rows,
+                  int64_t size,
+                  int64_t num_rows,
+                  int64_t row_size)
+      : rows_(rows), size_(size) {
+    int num_threads = CPUScatterNumThreads(size * row_size);
+    if (num_threads <= 1 || num_rows <= 1 || size <= 1) {
+      return;
+    }
+    int64_t rows_per_bucket =
+        (num_rows + num_threads * kBucketsPerThread - 1) /
+        (num_threads * kBucketsPerThread);
+    num_buckets_ = (num_rows + rows_per_bucket - 1) / rows_per_bucket;
+    int64_t num_chunks = std::min<int64_t>(num_threads, size);
+
+    // The number of the positions of every chunk in every bucket.
+    std::vector<int64_t> offsets(num_chunks * num_buckets_, 0);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+      int64_t* count = offsets.data() + chunk * num_buckets_;
+      for (int64_t i = size * chunk / num_chunks;
+           i < size * (chunk + 1) / num_chunks;
+           ++i) {
+        ++count[rows[i] / rows_per_bucket];
+      }
+    }
+    // The offsets in the order of buckets and then chunks, which keeps the
+    // positions of a bucket in order.
+    bucket_offsets_.resize(num_buckets_ + 1);
+    int64_t total = 0;
+    for (int64_t bucket = 0; bucket < num_buckets_; ++bucket) {
+      bucket_offsets_[bucket] = total;
+      for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+        int64_t count = offsets[chunk * num_buckets_ + bucket];
+        offsets[chunk * num_buckets_ + bucket] = total;
+        total += count;
+      }
+    }
+    bucket_offsets_[num_buckets_] = total;
+
+    positions_.resize(size);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+      int64_t* offset = offsets.data() + chunk * num_buckets_;
+      for (int64_t i = size * chunk / num_chunks;
+           i < size * (chunk + 1) / num_chunks;
+           ++i) {
+        positions_[offset[rows[i] / rows_per_bucket]++] = i;
+      }
+    }
+  }
+
+  // Call `fn(i, rows[i])` for all the positions. It must not throw, as it
+  // may run in the threads of OpenMP.
+  template <typename Fn>
+  void ForEach(Fn fn) const {
+    if (num_buckets_ == 1) {
+      for (int64_t i = 0; i < size_; ++i) {
+        fn(i, rows_[i]);
+      }
+      return;
+    }
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int64_t bucket = 0; bucket < num_buckets_; ++bucket) {
+      for (int64_t pos = bucket_offsets_[bucket];
+           pos < bucket_offsets_[bucket + 1];
+           ++pos) {
+        int64_t i = positions_[pos];
+        fn(i, rows_[i]);
+      }
+    }
+  }
+
+ private:
+  // More buckets than threads balance the rows of different numbers of
+  // updates.
+  enum { kBucketsPerThread = 8 };
+
+  const IndexT* rows_;
+  int64_t size_;
+  int64_t num_buckets_{1};
+  std::vector<int64_t> bucket_offsets_;
+  std::vector<int64_t> positions_;
+};
+
 /**
  * Return an updated tensor from source tensor, scattered according to index:
  * dst[i] = src[index[i]]
@@ -128,6 +249,7 @@ void ScatterAssign(const phi::CPUContext& ctx,
 
   const size_t slice_bytes = slice_size * sizeof(T);
 
+  auto max_index = dst_dims.size() == 0 ? 1 : dst_dims[0];
   for (int64_t i = 0; i < index_size; ++i) {
     IndexT index_ = p_index[i];
 
@@ -139,9 +261,21 @@ void ScatterAssign(const phi::CPUContext& ctx,
                           "input meet the requirements. It should "
                           "be greater than or equal to 0, but received [%d]",
                           index_));
+    PADDLE_ENFORCE_LT(index_,
+                      max_index,
+                      phi::errors::OutOfRange(
+                          "The index is out of bounds, "
+                          "please check whether the dimensions of index and "
+                          "input meet the requirements. It should "
+                          "be less than %d, but received %d",
+                          max_index,
+                          index_));
+  }
 
+  CPURowPartition<IndexT> partition(p_index, index_size, max_index, slice_size);
+  partition.ForEach([&](int64_t i, IndexT index_) {
     memcpy(p_output + index_ * slice_size, p_src + i * slice_size, slice_bytes);
-  }
+  });
 }
 
 template <typename T, typename IndexT = int>
@@ -215,15 +349,16 @@ void ScatterAssignAdd(const phi::CPUContext& ctx,
                           "be less than %d, but received %d",
                           max_index,
                           index_val));
-    memset(p_output + slice_size * index_val, 0, slice_bytes);
   }
 
-  // if not in overwrite mode, need to init output data
-  for (int64_t i = 0; i < index_size; ++i) {
-    const IndexT& index_val = p_index[i];
+  CPURowPartition<IndexT> partition(p_index, index_size, max_index, slice_size);
+  partition.ForEach([&](int64_t i, IndexT index_val) {
+    memset(p_output + slice_size * index_val, 0, slice_bytes);
+  });
+  partition.ForEach([&](int64_t i, IndexT index_val) {
     elementwise_inner_add<T, IndexT>(
         ctx, p_src, p_output, i, index_val, slice_size);
-  }
+  });
 }
 
 // The function is only for scatter grad x,
@@ -239,10 +374,11 @@ void CPUScatterGradForX(const phi::CPUContext& ctx,
   size_t slice_size = 1;
   for (int i = 1; i < dst_dims.size(); ++i) slice_size *= dst_dims[i];
   const size_t slice_bytes = slice_size * sizeof(T);
-  for (int64_t i = 0; i < index_size; ++i) {
-    const IndexT& index_ = p_index[i];
+  CPURowPartition<IndexT> partition(
+      p_index, index_size, dst_dims[0], slice_size);
+  partition.ForEach([&](int64_t i, IndexT index_) {
     memset(p_output + slice_size * index_, 0, slice_bytes);
-  }
+  });
 }
 
 template <typename T, typename IndexT = int>
@@ -272,9 +408,11 @@ void ScatterNdAdd(const phi::CPUContext& ctx,
     slice_size *= output_dims[i];
   }
 
+  // The rows of the output to update, in the units of slices.
+  std::vector<int64_t> rows(remain_numel);
   for (int64_t i = 0; i < remain_numel; ++i) {
-    IndexT index_val = 0;
-    IndexT temp = 1;
+    int64_t index_val = 0;
+    int64_t temp = 1;
     for (int64_t j = end_size - 1; j >= 0; --j) {
       IndexT index_value = p_index[i * end_size + j];
       PADDLE_ENFORCE_EQ(
@@ -291,9 +429,17 @@ void ScatterNdAdd(const phi::CPUContext& ctx,
       index_val += (index_value * temp);
       temp *= output_dims[j];
     }
-    elementwise_inner_add<T, IndexT>(
-        ctx, p_update, p_output, i, index_val, slice_size);
+    rows[i] = index_val;
   }
+
+  int64_t num_rows =
+      phi::product(output_dims) / std::max<int64_t>(slice_size, 1);
+  CPURowPartition<int64_t> partition(
+      rows.data(), remain_numel, num_rows, slice_size);
+  partition.ForEach([&](int64_t i, int64_t index_val) {
+    elementwise_inner_add<T, int64_t>(
+        ctx, p_update, p_output, i, index_val, slice_size);
+  });
 }
 
 }  // namespace funcs
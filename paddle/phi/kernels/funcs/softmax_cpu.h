@@ -0,0 +1,231 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
+
+#include "paddle/phi/kernels/funcs/cpu_vec.h"
+
+namespace phi {
+namespace funcs {
+
+// The softmax of a row is computed block by block, so that the steps of a
+// block (shift, clip, exp, sum and scale) read it from the L1 cache.
+constexpr int kSoftmaxBlockSize = 256;
+// The shifted logits are clipped to this value before exp, as ValueClip does.
+constexpr double kSoftmaxClipThreshold = -64.;
+// The rows run in parallel when there are at least so many elements.
+constexpr int64_t kSoftmaxMinParallelSize = 1 << 15;
+
+/**
+ * The softmax (or log_softmax) of a contiguous row of size d, with a single
+ * pass over x to find the max and the sum online: the blocks are shifted by
+ * the running max, and the sum is rescaled when the max grows. The softmax
+ * keeps exp of every block in y and scales it by exp(block max - max) / sum
+ * in the second pass, so every element is read from memory once and written
+ * once. The log_softmax recomputes x - max - log(sum) from x instead.
+ */
+template <typename T>
+void SoftmaxContiguousRow(const T* x, int d, bool log_softmax, T* y) {
+  const T clip = static_cast<T>(kSoftmaxClipThreshold);
+  const int num_blocks = (d + kSoftmaxBlockSize - 1) / kSoftmaxBlockSize;
+  // The running max that every block is shifted by.
+  std::vector<T> block_max(num_blocks > 1 ? num_blocks : 0);
+  T buffer[kSoftmaxBlockSize];
+
+  T max = -std::numeric_limits<T>::infinity();
+  T sum = 0;
+  for (int block = 0; block < num_blocks; ++block) {
+    const int begin = block * kSoftmaxBlockSize;
+    const int len = std::min(kSoftmaxBlockSize, d - begin);
+    T local_max = *std::max_element(x + begin, x + begin + len);
+    if (local_max > max) {
+      sum *= std::exp(max - local_max);
+      max = local_max;
+    }
+    T* exp_data = log_softmax ? buffer : y + begin;
+    vec_add_bias<T, backends::cpu::avx>(len, -max, x + begin, exp_data);
+    vec_clip<T, backends::cpu::avx>(len, clip, exp_data, exp_data);
+    vec_exp<T>(len, exp_data, exp_data);
+    T local_sum = 0;
+    vec_sum<T, backends::cpu::avx>(len, exp_data, &local_sum);
+    sum += local_sum;
+    if (num_blocks > 1) {
+      block_max[block] = max;
+    }
+  }
+
+  if (log_softmax) {
+    const T log_sum = std::log(sum);
+    for (int begin = 0; begin < d; begin += kSoftmaxBlockSize) {
+      const int len = std::min(kSoftmaxBlockSize, d - begin);
+      vec_add_bias<T, backends::cpu::avx>(len, -max, x + begin, y + begin);
+      vec_clip<T, backends::cpu::avx>(len, clip, y + begin, y + begin);
+      vec_add_bias<T, backends::cpu::avx>(len, -log_sum, y + begin, y + begin);
+    }
+    return;
+  }
+  for (int block = 0; block < num_blocks; ++block) {
+    const int begin = block * kSoftmaxBlockSize;
+    const int len = std::min(kSoftmaxBlockSize, d - begin);
+    T scale = static_cast<T>(1) / sum;
+    if (num_blocks > 1) {
+      scale *= std::exp(block_max[block] - max);
+    }
+    vec_scal<T, backends::cpu::avx>(len, scale, y + begin, y + begin);
+  }
+}
+
+/**
+ * The softmax along the axis of a [axis_dim, remain] plane, where remain is
+ * greater than 1. The rows of remain elements are contiguous, so the max,
+ * the exp and the sum run over a row for all the remain columns at once.
+ */
+template <typename T>
+void SoftmaxStridedPlane(
+    const T* x, int axis_dim, int remain, bool log_softmax, T* y) {
+  const T clip = static_cast<T>(kSoftmaxClipThreshold);
+  std::vector<T> max(x, x + remain);
+  for (int k = 1; k < axis_dim; ++k) {
+    const T* row = x + k * remain;
+    for (int j = 0; j < remain; ++j) {
+      max[j] = std::max(max[j], row[j]);
+    }
+  }
+
+  std::vector<T> sum(remain, 0);
+  std::vector<T> buffer(log_softmax ? remain : 0);
+  for (int k = 0; k < axis_dim; ++k) {
+    const T* row = x + k * remain;
+    T* out = y + k * remain;
+    for (int j = 0; j < remain; ++j) {
+      out[j] = std::max(row[j] - max[j], clip);
+    }
+    T* exp_data = log_softmax ? buffer.data() : out;
+    vec_exp<T>(remain, out, exp_data);
+    for (int j = 0; j < remain; ++j) {
+      sum[j] += exp_data[j];
+    }
+  }
+
+  for (int j = 0; j < remain; ++j) {
+    sum[j] = log_softmax ? std::log(sum[j]) : static_cast<T>(1) / sum[j];
+  }
+  for (int k = 0; k < axis_dim; ++k) {
+    T* out = y + k * remain;
+    for (int j = 0; j < remain; ++j) {
+      out[j] = log_softmax ? out[j] - sum[j] : out[j] * sum[j];
+    }
+  }
+}
+
+/**
+ * The softmax (or log_softmax if `log_softmax` is true) of x, which is
+ * viewed as [n, axis_dim, remain] and normalized along axis_dim. The planes of
+ * [axis_dim, remain] run in parallel, and `fn(i)` is called after the i-th
+ * plane is written, while it is still in the cache. `fn` must not throw.
+ */
+template <typename T, typename Fn>
+void SoftmaxCPU(const T* x,
+                int64_t n,
+                int axis_dim,
+                int remain,
+                bool log_softmax,
+                T* y,
+                Fn fn) {
+  const int64_t plane_size = static_cast<int64_t>(axis_dim) * remain;
+  bool parallel = n > 1 && n * plane_size >= kSoftmaxMinParallelSize;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (parallel)
+#endif
+  for (int64_t i = 0; i < n; ++i) {
+    if (remain == 1) {
+      SoftmaxContiguousRow(
+          x + i * plane_size, axis_dim, log_softmax, y + i * plane_size);
+    } else {
+      SoftmaxStridedPlane(x + i * plane_size,
+                          axis_dim,
+                          remain,
+                          log_softmax,
+                          y + i * plane_size);
+    }
+    fn(i);
+  }
+  (void)parallel;
+}
+
+template <typename T>
+void SoftmaxCPU(
+    const T* x, int64_t n, int axis_dim, int remain, bool log_softmax, T* y) {
+  SoftmaxCPU(x, n, axis_dim, remain, log_softmax, y, [](int64_t) {});
+}
+
+/**
+ * The gradient of the softmax (or the log_softmax if `log_softmax` is true)
+ * of the same layout as SoftmaxCPU, from its output y and the gradient dy:
+ *   softmax:     dx = (dy - sum(dy * y)) * y
+ *   log_softmax: dx = dy - exp(y) * sum(dy)
+ */
+template <typename T>
+void SoftmaxGradCPU(const T* y,
+                    const T* dy,
+                    int64_t n,
+                    int axis_dim,
+                    int remain,
+                    bool log_softmax,
+                    T* dx) {
+  const int64_t plane_size = static_cast<int64_t>(axis_dim) * remain;
+  bool parallel = n > 1 && n * plane_size >= kSoftmaxMinParallelSize;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (parallel)
+#endif
+  for (int64_t i = 0; i < n; ++i) {
+    const T* y_i = y + i * plane_size;
+    const T* dy_i = dy + i * plane_size;
+    T* dx_i = dx + i * plane_size;
+    if (remain == 1 && !log_softmax) {
+      T dot = 0;
+      vec_mul_reduce<T, backends::cpu::avx>(axis_dim, dy_i, y_i, &dot);
+      vec_add_bias<T, backends::cpu::avx>(axis_dim, -dot, dy_i, dx_i);
+      vec_mul<T, backends::cpu::avx>(axis_dim, y_i, dx_i, dx_i);
+      continue;
+    }
+    std::vector<T> sum(remain, 0);
+    for (int k = 0; k < axis_dim; ++k) {
+      for (int j = 0; j < remain; ++j) {
+        sum[j] += log_softmax ? dy_i[k * remain + j]
+                      : dy_i[k * remain + j] * y_i[k * remain + j];
+      }
+    }
+    for (int k = 0; k < axis_dim; ++k) {
+      for (int j = 0; j < remain; ++j) {
+        int64_t idx = k * remain + j;
+        dx_i[idx] = log_softmax ? dy_i[idx] - std::exp(y_i[idx]) * sum[j]
+                        : (dy_i[idx] - sum[j]) * y_i[idx];
+      }
+    }
+  }
+  (void)parallel;
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,365 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
+
+#include "paddle/phi/kernels/funcs/unique_utils.h"
+
+namespace phi {
+namespace funcs {
+
+// The top-k and argsort of the rows of a contiguous CPU tensor.
+//
+// The values are compared by their sort keys, which are unsigned integers in
+// the same order as the values: NaN is greater than all the numbers, as the
+// kernels have always ordered it, and -0.0 equals 0.0. The keys of the
+// descending order are inverted, so both orders select the smallest keys,
+// and the equal keys are ordered by their indices.
+
+template <typename T>
+struct SortKey;
+
+template <>
+struct SortKey<float> {
+  using Type = uint32_t;
+};
+
+template <>
+struct SortKey<double> {
+  using Type = uint64_t;
+};
+
+template <>
+struct SortKey<int32_t> {
+  using Type = uint32_t;
+};
+
+template <>
+struct SortKey<int64_t> {
+  using Type = uint64_t;
+};
+
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value,
+                               typename SortKey<T>::Type>::type
+ToSortKey(T value, bool descending) {
+  using KeyT = typename SortKey<T>::Type;
+  constexpr KeyT kSignBit = static_cast<KeyT>(1) << (sizeof(KeyT) * 8 - 1);
+  // Adding 0 turns -0.0 into 0.0.
+  T normalized = value + static_cast<T>(0);
+  KeyT bits;
+  std::memcpy(&bits, &normalized, sizeof(bits));
+  // Flip all the bits of the negative numbers and the sign bit of the others.
+  // It is branchless, so that the keys of a block are vectorized.
+  KeyT key = bits ^ ((static_cast<KeyT>(0) - (bits >> (sizeof(KeyT) * 8 - 1))) |
+                     kSignBit);
+  key = std::isnan(value) ? std::numeric_limits<KeyT>::max() : key;
+  return descending ? ~key : key;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value,
+                               typename SortKey<T>::Type>::type
+ToSortKey(T value, bool descending) {
+  using KeyT = typename SortKey<T>::Type;
+  constexpr KeyT kSignBit = static_cast<KeyT>(1) << (sizeof(KeyT) * 8 - 1);
+  KeyT key = static_cast<KeyT>(value) ^ kSignBit;
+  return descending ? ~key : key;
+}
+
+// The rows are scanned in blocks. The keys of a block are computed and
+// reduced to their minimum in loops the compiler vectorizes, and a block is
+// skipped at once when its minimum cannot enter the top k.
+constexpr int64_t kTopKBlockSize = 256;
+// Up to this k, the top k is kept sorted and updated by insertion.
+constexpr int kTopKInsertionMaxK = 16;
+// If k is at least 1 / kTopKSelectAllRatio of the row, the keys of the whole
+// row are selected by nth_element.
+constexpr int64_t kTopKSelectAllRatio = 8;
+// Rows wider than it are split into chunks, whose top k are selected in
+// parallel and then merged.
+constexpr int64_t kTopKMinChunkSize = 1 << 15;
+// Rows shorter than it are argsorted by std::sort instead of radix sort.
+constexpr int64_t kArgsortMinRadixSize = 512;
+
+// The keys and indices of the smallest `k` keys of `row[begin, end)`, in
+// ascending order if `sorted`, where k <= end - begin.
+template <typename T>
+class TopKSelector {
+ public:
+  using KeyT = typename SortKey<T>::Type;
+  using Candidate = std::pair<KeyT, int64_t>;
+
+  TopKSelector(const T* row, int k, bool largest)
+      : row_(row), k_(k), largest_(largest) {}
+
+  void Select(int64_t begin,
+              int64_t end,
+              bool sorted,
+              std::vector<Candidate>* result) const {
+    result->clear();
+    if (k_ == 1) {
+      SelectMin(begin, end, result);
+    } else if (k_ * kTopKSelectAllRatio >= end - begin) {
+      SelectAll(begin, end, result);
+    } else if (k_ <= kTopKInsertionMaxK) {
+      // The insertion keeps the top k sorted.
+      SelectByInsertion(begin, end, result);
+      return;
+    } else {
+      SelectByThreshold(begin, end, result);
+    }
+    if (sorted) {
+      std::sort(result->begin(), result->end());
+    }
+  }
+
+ private:
+  // Compute the keys of a block, and return the minimum of them.
+  KeyT BlockKeys(int64_t begin, int64_t size, KeyT* keys) const {
+    KeyT min_key = std::numeric_limits<KeyT>::max();
+    for (int64_t j = 0; j < size; ++j) {
+      keys[j] = ToSortKey(row_[begin + j], largest_);
+      min_key = std::min(min_key, keys[j]);
+    }
+    return min_key;
+  }
+
+  void SelectMin(int64_t begin,
+                 int64_t end,
+                 std::vector<Candidate>* result) const {
+    KeyT keys[kTopKBlockSize];
+    Candidate best(ToSortKey(row_[begin], largest_), begin);
+    for (int64_t start = begin; start < end; start += kTopKBlockSize) {
+      int64_t size = std::min(kTopKBlockSize, end - start);
+      KeyT min_key = BlockKeys(start, size, keys);
+      if (min_key < best.first) {
+        best.first = min_key;
+        best.second = start + (std::find(keys, keys + size, min_key) - keys);
+      }
+    }
+    result->push_back(best);
+  }
+
+  void SelectAll(int64_t begin,
+                 int64_t end,
+                 std::vector<Candidate>* result) const {
+    result->reserve(end - begin);
+    for (int64_t j = begin; j < end; ++j) {
+      result->emplace_back(ToSortKey(row_[j], largest_), j);
+    }
+    std::nth_element(result->begin(), result->begin() + k_ - 1, result->end());
+    result->resize(k_);
+  }
+
+  // The elements are scanned by increasing index, so an element enters the
+  // top k only if its key is less than the k-th key so far.
+  void SelectByInsertion(int64_t begin,
+                         int64_t end,
+                         std::vector<Candidate>* result) const {
+    KeyT keys[kTopKBlockSize];
+    Candidate top[kTopKInsertionMaxK];
+    int size = 0;
+    for (int64_t start = begin; start < end; start += kTopKBlockSize) {
+      int64_t block_size = std::min(kTopKBlockSize, end - start);
+      KeyT min_key = BlockKeys(start, block_size, keys);
+      if (size == k_ && min_key >= top[k_ - 1].first) {
+        continue;
+      }
+      for (int64_t j = 0; j < block_size; ++j) {
+        if (size == k_ && keys[j] >= top[k_ - 1].first) {
+          continue;
+        }
+        int pos = size < k_ ? size++ : k_ - 1;
+        for (; pos > 0 && top[pos - 1].first > keys[j]; --pos) {
+          top[pos] = top[pos - 1];
+        }
+        top[pos] = Candidate(keys[j], start + j);
+      }
+    }
+    result->assign(top, top + size);
+  }
+
+  // The candidates less than the threshold are buffered, and the buffer is
+  // cut to the top k when it is full, which lowers the threshold to the k-th
+  // key so far.
+  void SelectByThreshold(int64_t begin,
+                         int64_t end,
+                         std::vector<Candidate>* result) const {
+    KeyT keys[kTopKBlockSize];
+    size_t capacity = std::max<size_t>(2 * k_, kTopKBlockSize);
+    result->reserve(capacity + kTopKBlockSize);
+    bool full = false;
+    KeyT threshold = std::numeric_limits<KeyT>::max();
+    for (int64_t start = begin; start < end; start += kTopKBlockSize) {
+      int64_t size = std::min(kTopKBlockSize, end - start);
+      KeyT min_key = BlockKeys(start, size, keys);
+      if (full && min_key >= threshold) {
+        continue;
+      }
+      for (int64_t j = 0; j < size; ++j) {
+        if (!full || keys[j] < threshold) {
+          result->emplace_back(keys[j], start + j);
+        }
+      }
+      if (result->size() >= capacity) {
+        std::nth_element(
+            result->begin(), result->begin() + k_ - 1, result->end());
+        result->resize(k_);
+        threshold = result->back().first;
+        full = true;
+      }
+    }
+    if (result->size() > static_cast<size_t>(k_)) {
+      std::nth_element(
+          result->begin(), result->begin() + k_ - 1, result->end());
+      result->resize(k_);
+    }
+  }
+
+  const T* row_;
+  int k_;
+  bool largest_;
+};
+
+// The top k of every row of `input`, which is [height, width]. The rows run
+// in parallel, and a few very wide rows are split into parallel chunks.
+template <typename T, typename IndexT>
+void TopKRows(const T* input,
+              int64_t height,
+              int64_t width,
+              int k,
+              bool largest,
+              bool sorted,
+              T* out,
+              IndexT* indices) {
+  using Candidate = typename TopKSelector<T>::Candidate;
+  if (k <= 0) {
+    return;
+  }
+  auto write_row = [&](int64_t i, const std::vector<Candidate>& top) {
+    const T* row = input + i * width;
+    for (int j = 0; j < k; ++j) {
+      out[i * k + j] = row[top[j].second];
+      indices[i * k + j] = static_cast<IndexT>(top[j].second);
+    }
+  };
+
+  int num_threads = 1;
+#ifdef PADDLE_WITH_MKLML
+  num_threads = omp_get_max_threads();
+#endif
+  int64_t num_chunks =
+      std::min<int64_t>(num_threads, width / kTopKMinChunkSize);
+  if (height >= num_threads || num_chunks < 2 ||
+      k * kTopKSelectAllRatio >= width / num_chunks) {
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (height > 1)
+#endif
+    for (int64_t i = 0; i < height; ++i) {
+      std::vector<Candidate> top;
+      TopKSelector<T>(input + i * width, k, largest)
+          .Select(0, width, sorted, &top);
+      write_row(i, top);
+    }
+    return;
+  }
+
+  std::vector<std::vector<Candidate>> chunk_tops(num_chunks);
+  for (int64_t i = 0; i < height; ++i) {
+    TopKSelector<T> selector(input + i * width, k, largest);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+      selector.Select(width * chunk / num_chunks,
+                      width * (chunk + 1) / num_chunks,
+                      /*sorted=*/false,
+                      &chunk_tops[chunk]);
+    }
+    std::vector<Candidate> top;
+    top.reserve(num_chunks * k);
+    for (auto& chunk_top : chunk_tops) {
+      top.insert(top.end(), chunk_top.begin(), chunk_top.end());
+    }
+    std::nth_element(top.begin(), top.begin() + k - 1, top.end());
+    top.resize(k);
+    if (sorted) {
+      std::sort(top.begin(), top.end());
+    }
+    write_row(i, top);
+  }
+}
+
+// Sort every row of `input`, which is [height, width], stably by the sort
+// keys. The wide rows are sorted by the radix sort of the keys, which runs
+// in parallel chunks when there are fewer rows than threads.
+template <typename T, typename IndexT>
+void ArgsortRows(const T* input,
+                 int64_t height,
+                 int64_t width,
+                 bool descending,
+                 T* out,
+                 IndexT* indices) {
+  using KeyT = typename SortKey<T>::Type;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (height > 1)
+#endif
+  for (int64_t i = 0; i < height; ++i) {
+    const T* row = input + i * width;
+    T* out_row = out + i * width;
+    IndexT* indices_row = indices + i * width;
+    if (width < kArgsortMinRadixSize) {
+      std::vector<std::pair<KeyT, IndexT>> pairs(width);
+      for (int64_t j = 0; j < width; ++j) {
+        pairs[j] = std::make_pair(ToSortKey(row[j], descending),
+                                  static_cast<IndexT>(j));
+      }
+      std::sort(pairs.begin(), pairs.end());
+      for (int64_t j = 0; j < width; ++j) {
+        indices_row[j] = pairs[j].second;
+        out_row[j] = row[pairs[j].second];
+      }
+      continue;
+    }
+
+    std::vector<KeyT> keys(width);
+    std::vector<IndexT> order(width);
+    for (int64_t j = 0; j < width; ++j) {
+      keys[j] = ToSortKey(row[j], descending);
+    }
+    std::iota(order.begin(), order.end(), 0);
+    RadixSortByKey(&keys, &order);
+    for (int64_t j = 0; j < width; ++j) {
+      indices_row[j] = order[j];
+      out_row[j] = row[order[j]];
+    }
+  }
+}
+
+}  // namespace funcs
+}  // namespace phi
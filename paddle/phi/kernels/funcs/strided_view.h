@@ -0,0 +1,89 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <vector>
+
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/tensor_utils.h"
+
+namespace phi {
+namespace funcs {
+
+// The strides of `x` in elements. They are the row-major strides of the
+// dims if `x` is contiguous.
+inline std::vector<int64_t> GetStrides(const DenseTensor& x) {
+  const auto& meta = x.meta();
+  if (!meta.strides.empty()) {
+    return meta.strides;
+  }
+  std::vector<int64_t> strides(meta.dims.size());
+  int64_t stride = 1;
+  for (int i = meta.dims.size() - 1; i >= 0; --i) {
+    strides[i] = stride;
+    stride *= meta.dims[i];
+  }
+  return strides;
+}
+
+// Make `out` a view of `x`, which has `dims` and `strides` and starts from
+// the `offset`-th element of `x`. The view shares the memory and the inplace
+// version of `x`, and it is contiguous if the strides allow.
+inline void ShareStridedView(const DenseTensor& x,
+                             const DDim& dims,
+                             const std::vector<int64_t>& strides,
+                             int64_t offset,
+                             DenseTensor* out) {
+  size_t byte_offset = x.meta().offset + offset * SizeOf(x.dtype());
+  DataLayout layout = x.layout();
+  PADDLE_ENFORCE_EQ(dims.size(),
+                    static_cast<int>(strides.size()),
+                    phi::errors::InvalidArgument(
+                        "The rank of the view (%d) must be equal to the number "
+                        "of its strides (%d).",
+                        dims.size(),
+                        strides.size()));
+  out->ShareBufferWith(x);
+  out->ShareInplaceVersionCounterWith(x);
+  auto* meta = DenseTensorUtils::GetMutableMeta(out);
+  meta->dims = dims;
+  meta->layout = layout;
+  meta->offset = byte_offset;
+  meta->strides = strides;
+  if (meta->is_contiguous()) {
+    meta->strides.clear();
+  }
+}
+
+// Split `x` into the views `outs` along `axis`, with the sizes of `outs` in
+// that axis. The axis is removed from the views if `keep_axis` is false.
+inline void SplitStridedViews(const DenseTensor& x,
+                              int axis,
+                              bool keep_axis,
+                              const std::vector<DenseTensor*>& outs) {
+  auto strides = GetStrides(x);
+  int64_t axis_stride = strides[axis];
+  if (!keep_axis) {
+    strides.erase(strides.begin() + axis);
+  }
+  int64_t offset = 0;
+  for (auto* out : outs) {
+    ShareStridedView(x, out->dims(), strides, offset, out);
+    offset += (keep_axis ? out->dims()[axis] : 1) * axis_stride;
+  }
+}
+
+}  // namespace funcs
+}  // namespace phi
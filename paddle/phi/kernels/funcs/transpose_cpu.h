@@ -0,0 +1,303 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "paddle/phi/common/data_type.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/kernels/autotune/switch_autotune.h"
+#include "paddle/phi/kernels/funcs/transpose_functor.h"
+
+namespace phi {
+namespace funcs {
+
+// The block sizes of the blocked CPU transpose, which are the candidates of
+// the autotune. The index of the chosen one is cached in
+// AutoTuneCache::GetTranspose().
+constexpr int kCPUTransposeBlockSizes[] = {16, 32, 64, 128};
+constexpr int kCPUTransposeBlockSizeNum = 4;
+// The block size used without autotune.
+constexpr int kCPUTransposeDefaultBlockIdx = 1;
+// The size of the micro tiles in a block, which are fully unrolled.
+constexpr int kCPUTransposeMicroTile = 8;
+// Transposes smaller than it run in a single thread.
+constexpr int64_t kCPUTransposeMinParallelBytes = 1 << 16;
+
+// dst[i][j] = src[j][i] for a kTile x kTile tile.
+template <typename T, int kTile>
+inline void TransposeMicroTile(const T* src,
+                               int64_t src_stride,
+                               T* dst,
+                               int64_t dst_stride) {
+  T tile[kTile][kTile];
+  for (int j = 0; j < kTile; ++j) {
+    for (int i = 0; i < kTile; ++i) {
+      tile[i][j] = src[j * src_stride + i];
+    }
+  }
+  for (int i = 0; i < kTile; ++i) {
+    for (int j = 0; j < kTile; ++j) {
+      dst[i * dst_stride + j] = tile[i][j];
+    }
+  }
+}
+
+template <typename T>
+inline void TransposeTile(const T* src,
+                          int64_t src_stride,
+                          T* dst,
+                          int64_t dst_stride,
+                          int64_t rows,
+                          int64_t cols) {
+  constexpr int kMicro = kCPUTransposeMicroTile;
+  int64_t i = 0;
+  for (; i + kMicro <= rows; i += kMicro) {
+    int64_t j = 0;
+    for (; j + kMicro <= cols; j += kMicro) {
+      TransposeMicroTile<T, kMicro>(src + j * src_stride + i,
+                                    src_stride,
+                                    dst + i * dst_stride + j,
+                                    dst_stride);
+    }
+    for (int64_t ii = i; ii < i + kMicro; ++ii) {
+      for (int64_t jj = j; jj < cols; ++jj) {
+        dst[ii * dst_stride + jj] = src[jj * src_stride + ii];
+      }
+    }
+  }
+  for (; i < rows; ++i) {
+    for (int64_t j = 0; j < cols; ++j) {
+      dst[i * dst_stride + j] = src[j * src_stride + i];
+    }
+  }
+}
+
+// The CPU transpose. The dims are simplified by TranposeTypeClassifier
+// first, so NCHW<->NHWC becomes a batched transpose of two dims and the
+// swap of the last two dims becomes a plain 2-D transpose. Then:
+//   * If the last dim is not moved, the contiguous rows are copied.
+//   * Otherwise, the dims which are innermost in the src and in the dst are
+//     transposed in cache blocks of micro tiles, and the blocks of all the
+//     batches are distributed over the threads.
+template <typename T>
+class CPUTransposer {
+ public:
+  CPUTransposer(const std::vector<int64_t>& dims,
+                const std::vector<int32_t>& perm,
+                const T* src,
+                T* dst)
+      : src_(src), dst_(dst) {
+    numel_ = 1;
+    for (auto dim : dims) {
+      numel_ *= dim;
+    }
+    TranposeTypeClassifier<T> classifier(
+        /*sm_count=*/0, perm.size(), numel_, perm, dims, src, dst);
+    rank_ = classifier.GetRank();
+    perm_ = classifier.GetPerm();
+    src_dims_ = classifier.GetSrcDims();
+    dst_dims_ = classifier.GetDstDims();
+
+    src_strides_.resize(rank_);
+    dst_strides_.resize(rank_);
+    int64_t src_stride = 1;
+    int64_t dst_stride = 1;
+    for (int i = rank_ - 1; i >= 0; --i) {
+      src_strides_[i] = src_stride;
+      dst_strides_[i] = dst_stride;
+      src_stride *= src_dims_[i];
+      dst_stride *= dst_dims_[i];
+    }
+  }
+
+  // Whether the transpose runs in blocks, i.e. the block size matters.
+  bool IsBlocked() const { return rank_ > 1 && perm_[rank_ - 1] != rank_ - 1; }
+
+  const std::vector<int64_t>& SrcDims() const { return src_dims_; }
+  const std::vector<int>& Perm() const { return perm_; }
+
+  void Run(int block_size) const {
+    if (rank_ == 1) {
+      std::memcpy(dst_, src_, numel_ * sizeof(T));
+    } else if (!IsBlocked()) {
+      CopyRows();
+    } else {
+      RunBlocked(block_size);
+    }
+  }
+
+ private:
+  bool Parallel() const {
+    return numel_ * static_cast<int64_t>(sizeof(T)) >=
+           kCPUTransposeMinParallelBytes;
+  }
+
+  // The offset of the `index`-th element of the dims `sizes`, which have
+  // the `strides` in memory.
+  static int64_t Offset(int64_t index,
+                        const std::vector<int64_t>& sizes,
+                        const std::vector<int64_t>& strides) {
+    int64_t offset = 0;
+    for (int i = static_cast<int>(sizes.size()) - 1; i >= 0; --i) {
+      offset += index % sizes[i] * strides[i];
+      index /= sizes[i];
+    }
+    return offset;
+  }
+
+  void CopyRows() const {
+    int64_t inner = dst_dims_[rank_ - 1];
+    int64_t rows = numel_ / inner;
+    std::vector<int64_t> outer_dims(dst_dims_.begin(), dst_dims_.end() - 1);
+    std::vector<int64_t> outer_strides;
+    for (int i = 0; i < rank_ - 1; ++i) {
+      outer_strides.push_back(src_strides_[perm_[i]]);
+    }
+    bool parallel = Parallel();
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (parallel)
+#endif
+    for (int64_t row = 0; row < rows; ++row) {
+      std::memcpy(dst_ + row * inner,
+                  src_ + Offset(row, outer_dims, outer_strides),
+                  inner * sizeof(T));
+    }
+    (void)parallel;
+  }
+
+  void RunBlocked(int block_size) const {
+    // The src innermost dim `a` is at position `dst_a` in the dst, and the
+    // dst innermost dim is the src dim `b`.
+    int a = rank_ - 1;
+    int b = perm_[rank_ - 1];
+    int dst_a = static_cast<int>(
+        std::find(perm_.begin(), perm_.end(), a) - perm_.begin());
+    int64_t size_a = src_dims_[a];
+    int64_t size_b = src_dims_[b];
+    int64_t src_stride_b = src_strides_[b];
+    int64_t dst_stride_a = dst_strides_[dst_a];
+
+    // The other dims in the order of the dst.
+    std::vector<int64_t> batch_dims, batch_src_strides, batch_dst_strides;
+    for (int i = 0; i < rank_; ++i) {
+      if (perm_[i] != a && perm_[i] != b) {
+        batch_dims.push_back(dst_dims_[i]);
+        batch_src_strides.push_back(src_strides_[perm_[i]]);
+        batch_dst_strides.push_back(dst_strides_[i]);
+      }
+    }
+    int64_t batch = numel_ / size_a / size_b;
+    int64_t blocks_a = (size_a + block_size - 1) / block_size;
+    int64_t blocks_b = (size_b + block_size - 1) / block_size;
+    int64_t num_blocks = batch * blocks_a * blocks_b;
+    bool parallel = Parallel();
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (parallel)
+#endif
+    for (int64_t block = 0; block < num_blocks; ++block) {
+      int64_t batch_idx = block / (blocks_a * blocks_b);
+      int64_t block_a = block / blocks_b % blocks_a;
+      int64_t block_b = block % blocks_b;
+      int64_t src_offset = Offset(batch_idx, batch_dims, batch_src_strides);
+      int64_t dst_offset = Offset(batch_idx, batch_dims, batch_dst_strides);
+      int64_t begin_a = block_a * block_size;
+      int64_t begin_b = block_b * block_size;
+      TransposeTile(src_ + src_offset + begin_b * src_stride_b + begin_a,
+                    src_stride_b,
+                    dst_ + dst_offset + begin_a * dst_stride_a + begin_b,
+                    dst_stride_a,
+                    std::min<int64_t>(block_size, size_a - begin_a),
+                    std::min<int64_t>(block_size, size_b - begin_b));
+    }
+    (void)parallel;
+  }
+
+  const T* src_;
+  T* dst_;
+  int64_t numel_;
+  int rank_;
+  std::vector<int> perm_;
+  std::vector<int64_t> src_dims_;
+  std::vector<int64_t> dst_dims_;
+  std::vector<int64_t> src_strides_;
+  std::vector<int64_t> dst_strides_;
+};
+
+// Transpose `in` to `out` on CPU, where `out` is allocated. The block size
+// is tuned for the simplified dims and perm when autotune is enabled.
+template <typename T>
+void TransposeCPU(const DenseTensor& in,
+                  DenseTensor* out,
+                  const std::vector<int>& axis) {
+  std::vector<int32_t> perm(axis.begin(), axis.end());
+  CPUTransposer<T> transposer(
+      phi::vectorize<int64_t>(in.dims()), perm, in.data<T>(), out->data<T>());
+  if (!transposer.IsBlocked()) {
+    transposer.Run(kCPUTransposeBlockSizes[kCPUTransposeDefaultBlockIdx]);
+    return;
+  }
+
+  std::vector<int32_t> simplified_perm(transposer.Perm().begin(),
+                                       transposer.Perm().end());
+  // The GPU transpose caches the kernel with the same key, so the place is
+  // hashed in to tell them apart.
+  auto dtype = paddle::experimental::CppTypeToDataType<T>::Type();
+  size_t key = autotune::GetKey(
+      autotune::TransposeKey(transposer.SrcDims(), simplified_perm, dtype),
+      static_cast<int64_t>(AllocationType::CPU));
+  auto& cache = autotune::AutoTuneCache::Instance().GetTranspose();
+  if (cache.Find(key)) {
+    transposer.Run(kCPUTransposeBlockSizes[cache.Get(key)]);
+    return;
+  }
+  if (!autotune::AutoTuneStatus::Instance().UseAutoTune()) {
+    transposer.Run(kCPUTransposeBlockSizes[kCPUTransposeDefaultBlockIdx]);
+    return;
+  }
+
+  // Regard the first run as warmup, as the GPU autotune does.
+  constexpr int kRepeats = 3;
+  int64_t best_idx = kCPUTransposeDefaultBlockIdx;
+  double min_time = std::numeric_limits<double>::max();
+  for (int idx = 0; idx < kCPUTransposeBlockSizeNum; ++idx) {
+    int block_size = kCPUTransposeBlockSizes[idx];
+    transposer.Run(block_size);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRepeats; ++i) {
+      transposer.Run(block_size);
+    }
+    double time = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    VLOG(3) << "CPU transpose with block size " << block_size << " costs "
+            << time / kRepeats << " s";
+    if (time < min_time) {
+      min_time = time;
+      best_idx = idx;
+    }
+  }
+  VLOG(3) << "Best block size of CPU transpose is "
+          << kCPUTransposeBlockSizes[best_idx];
+  cache.Set(key, best_idx);
+}
+
+}  // namespace funcs
+}  // namespace phi
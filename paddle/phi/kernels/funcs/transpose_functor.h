@@ -109,7 +109,7 @@ class TranposeTypeClassifier {
     int valid_dim_idx = 0;
     bool sequential_flag = false;
     for (auto i = 0; i < rank; ++i) {
-      const int src_dim = combined_dims[i];
+      const int64_t src_dim = combined_dims[i];
       if (src_dim == 1) {
         valid_map[i] = -1;
       } else {
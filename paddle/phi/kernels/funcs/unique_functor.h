@@ -17,6 +17,7 @@
 #include "paddle/phi/core/utils/data_type.h"
 #include "paddle/phi/kernels/funcs/concat_and_split_functor.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/funcs/unique_utils.h"
 
 namespace phi {
 namespace funcs {
@@ -41,12 +42,6 @@ struct UniqueOpFunctor {
     auto* in_data = in_->data<InT>();
     auto* index_data = context_.template Alloc<IndexT>(index_);
 
-    int64_t j = 0;
-
-    // TODO(fangzeyang): Should optimize performance here.
-    std::unordered_map<InT, int64_t> dict;
-    std::vector<InT> uniq;
-
     PADDLE_ENFORCE_LT(
         in_->numel(),
         pow(2, 31),
@@ -55,25 +50,23 @@ struct UniqueOpFunctor {
             "but received num is %d.",
             in_->numel()));
 
-    for (auto i = 0; i < in_->numel(); i++) {
-      auto it = dict.find(in_data[i]);
-      if (it == dict.end()) {
-        dict.emplace(std::make_pair(in_data[i], j));
-        uniq.emplace_back(in_data[i]);
-        index_data[i] = static_cast<IndexT>(j);
-        j++;
-      } else {
-        index_data[i] = static_cast<IndexT>(it->second);
+    // The ids and the counts of the keys are computed in one pass.
+    FlatKeyIndexer<InT> indexer;
+    std::vector<IndexT> counts;
+    for (int64_t i = 0; i < in_->numel(); i++) {
+      bool inserted;
+      int64_t id = indexer.Insert(in_data[i], &inserted);
+      index_data[i] = static_cast<IndexT>(id);
+      if (count_ != nullptr) {
+        if (inserted) {
+          counts.emplace_back(0);
+        }
+        counts[id] += static_cast<IndexT>(1);
       }
     }
+    const std::vector<InT>& uniq = indexer.Keys();
 
     if (count_ != nullptr) {
-      // Resize the count tensor dims to allocate the memory
-      count_->Resize(phi::make_ddim({static_cast<int64_t>(uniq.size())}));
-      IndexT* count_data = context_.template Alloc<IndexT>(count_);
-      // init count_data to 0
-      memset(count_data, 0, uniq.size() * sizeof(IndexT));
-
       const auto& index_type = index_->dtype();
       bool index_type_match =
           index_type == DataType::INT32 || index_type == DataType::INT64;
@@ -86,22 +79,15 @@ struct UniqueOpFunctor {
                             phi::DataTypeToString(DataType::INT32),
                             phi::DataTypeToString(DataType::INT64)));
 
-      if (index_type == DataType::INT32) {
-        for (auto i = 0; i < in_->numel(); ++i) {
-          const IndexT& index = index_data[i];
-          count_data[static_cast<int32_t>(index)] += static_cast<IndexT>(1);
-        }
-      } else {
-        for (auto i = 0; i < in_->numel(); ++i) {
-          const IndexT& index = index_data[i];
-          count_data[static_cast<int64_t>(index)] += static_cast<IndexT>(1);
-        }
-      }
+      // Resize the count tensor dims to allocate the memory
+      count_->Resize(phi::make_ddim({static_cast<int64_t>(uniq.size())}));
+      IndexT* count_data = context_.template Alloc<IndexT>(count_);
+      std::copy(counts.begin(), counts.end(), count_data);
     }
 
     out_->Resize(phi::make_ddim({static_cast<int64_t>(uniq.size())}));
     auto* out_data = context_.template Alloc<InT>(out_);
-    std::memcpy(out_data, uniq.data(), uniq.size() * sizeof(InT));
+    std::copy(uniq.begin(), uniq.end(), out_data);
   }
 };
 
@@ -138,7 +124,39 @@ static void UniqueFlattendTensor(const Context& context,
                                  bool return_inverse,
                                  bool return_counts) {
   const InT* in_data = in.data<InT>();
-  std::set<InT> unique(in_data, in_data + in.numel());
+  int64_t numel = in.numel();
+
+  // Sort the keys stably with their positions, then the outputs are all
+  // computed in one pass over the sorted keys.
+  std::vector<InT> sorted_keys;
+  std::vector<IndexT> sorted_indices;
+  SortWithIndices(in_data, numel, &sorted_keys, &sorted_indices);
+
+  std::vector<InT> unique;
+  std::vector<IndexT> indices_vec;
+  std::vector<IndexT> inverse_vec(return_inverse ? numel : 0);
+  std::vector<IndexT> counts_vec;
+  for (int64_t i = 0; i < numel; ++i) {
+    if (i == 0 || sorted_keys[i - 1] < sorted_keys[i]) {
+      unique.emplace_back(sorted_keys[i]);
+      // The first of the equal keys has the smallest position, since the
+      // sort is stable.
+      if (return_index) {
+        indices_vec.emplace_back(sorted_indices[i]);
+      }
+      if (return_counts) {
+        counts_vec.emplace_back(0);
+      }
+    }
+    IndexT id = static_cast<IndexT>(unique.size() - 1);
+    if (return_inverse) {
+      inverse_vec[sorted_indices[i]] = id;
+    }
+    if (return_counts) {
+      counts_vec[id] += 1;
+    }
+  }
+
   out->Resize(phi::make_ddim({static_cast<int64_t>(unique.size())}));
   auto* out_data = context.template Alloc<InT>(out);
   std::copy(unique.begin(), unique.end(), out_data);
@@ -146,44 +164,19 @@ static void UniqueFlattendTensor(const Context& context,
   if (return_index) {
     indices->Resize(phi::make_ddim({out->numel()}));
     auto indices_data = context.template Alloc<IndexT>(indices);
-    std::unordered_map<InT, IndexT> indices_map;
-    indices_map.reserve(out->numel());
-    for (int64_t i = 0; i < in.numel(); ++i) {
-      if (indices_map.find(in_data[i]) != indices_map.end()) continue;
-      indices_map[in_data[i]] = i;
-    }
-    for (int64_t i = 0; i < out->numel(); ++i) {
-      indices_data[i] = indices_map[out_data[i]];
-    }
+    std::copy(indices_vec.begin(), indices_vec.end(), indices_data);
   }
 
   if (return_inverse) {
-    index->Resize(phi::make_ddim({in.numel()}));
+    index->Resize(phi::make_ddim({numel}));
     auto inverse_data = context.template Alloc<IndexT>(index);
-    std::unordered_map<InT, IndexT> inverse_map;
-    inverse_map.reserve(out->numel());
-    for (int64_t i = 0; i < out->numel(); ++i) {
-      inverse_map[out_data[i]] = i;
-    }
-    for (int64_t i = 0; i < in.numel(); ++i) {
-      inverse_data[i] = inverse_map[in_data[i]];
-    }
+    std::copy(inverse_vec.begin(), inverse_vec.end(), inverse_data);
   }
 
   if (return_counts) {
     count->Resize(phi::make_ddim({out->numel()}));
     auto count_data = context.template Alloc<IndexT>(count);
-    std::unordered_map<InT, IndexT> counts_map;
-    counts_map.reserve(out->numel());
-    for (int64_t i = 0; i < out->numel(); ++i) {
-      counts_map[out_data[i]] = 0;
-    }
-    for (int64_t i = 0; i < in.numel(); i++) {
-      counts_map[in_data[i]] += 1;
-    }
-    for (int64_t i = 0; i < out->numel(); i++) {
-      count_data[i] = counts_map[out_data[i]];
-    }
+    std::copy(counts_vec.begin(), counts_vec.end(), count_data);
   }
 }
 
@@ -0,0 +1,286 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace phi {
+namespace funcs {
+
+// Maps keys to dense ids in the order of their first occurrence, e.g. the
+// inputs [5, 3, 5, 7] get the ids [0, 1, 0, 2]. The keys are kept in one
+// vector and the table only holds the ids, so there is no allocation per key.
+//
+// The table is probed in groups of 8 slots. Every slot has a one byte tag
+// with 7 bits of the hash, and the tags of a group are compared at once as a
+// 64-bit word, so most probes touch only the tags and the key of the match.
+template <typename KeyT>
+class FlatKeyIndexer {
+ public:
+  explicit FlatKeyIndexer(int64_t expected_size = 0) {
+    Rehash(CapacityFor(expected_size));
+    keys_.reserve(expected_size);
+  }
+
+  // Return the id of `key`, which is the number of keys before it if the key
+  // is inserted.
+  int64_t Insert(const KeyT& key, bool* inserted) {
+    if ((keys_.size() + 1) * 2 > tags_.size()) {
+      Rehash(tags_.size() * 2);
+    }
+    uint64_t hash = Hash(key);
+    uint8_t tag = Tag(hash);
+    size_t group_mask = tags_.size() / kGroupSize - 1;
+    for (size_t group = hash & group_mask;; group = (group + 1) & group_mask) {
+      size_t base = group * kGroupSize;
+      uint64_t word;
+      std::memcpy(&word, tags_.data() + base, kGroupSize);
+      for (uint64_t match = MatchByte(word, tag); match; match &= match - 1) {
+        int64_t id = ids_[base + LowestByte(match)];
+        if (keys_[id] == key) {
+          *inserted = false;
+          return id;
+        }
+      }
+      uint64_t empty = ~word & kHighBits;
+      if (empty) {
+        // Keys are never erased, so the key is absent once a group has an
+        // empty slot.
+        size_t pos = base + LowestByte(empty);
+        int64_t id = static_cast<int64_t>(keys_.size());
+        tags_[pos] = tag;
+        ids_[pos] = id;
+        keys_.push_back(key);
+        *inserted = true;
+        return id;
+      }
+    }
+  }
+
+  int64_t Size() const { return static_cast<int64_t>(keys_.size()); }
+
+  // The keys in the order of their ids.
+  const std::vector<KeyT>& Keys() const { return keys_; }
+
+ private:
+  enum : size_t { kGroupSize = 8, kMinCapacity = 16 };
+  enum : uint64_t {
+    kLowBits = 0x0101010101010101ULL,
+    kHighBits = 0x8080808080808080ULL
+  };
+
+  static size_t CapacityFor(int64_t size) {
+    size_t capacity = kMinCapacity;
+    while (capacity < static_cast<size_t>(size) * 2) {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  static uint64_t Hash(const KeyT& key) {
+    // std::hash of integers is the identity, so the bits are mixed with the
+    // finalizer of MurmurHash3.
+    uint64_t h = static_cast<uint64_t>(std::hash<KeyT>()(key));
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  // The tag of an occupied slot always has the high bit, and 0 is empty.
+  static uint8_t Tag(uint64_t hash) {
+    return static_cast<uint8_t>((hash >> 57) | 0x80);
+  }
+
+  // The bytes of `word` which may equal `tag`, as a mask of their high bits.
+  // It may have false positives (which are filtered by comparing the keys),
+  // but never false negatives.
+  static uint64_t MatchByte(uint64_t word, uint8_t tag) {
+    uint64_t x = word ^ (kLowBits * tag);
+    return (x - kLowBits) & ~x & kHighBits;
+  }
+
+  // The index of the lowest byte with the high bit set in the mask. The tags
+  // are loaded in little endian.
+  static size_t LowestByte(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctzll(mask)) / 8;
+#else
+    size_t pos = 0;
+    while (!(mask & 0x80)) {
+      mask >>= 8;
+      ++pos;
+    }
+    return pos;
+#endif
+  }
+
+  void Rehash(size_t capacity) {
+    tags_.assign(capacity, 0);
+    ids_.assign(capacity, -1);
+    size_t group_mask = capacity / kGroupSize - 1;
+    for (int64_t id = 0; id < static_cast<int64_t>(keys_.size()); ++id) {
+      uint64_t hash = Hash(keys_[id]);
+      for (size_t group = hash & group_mask;;
+           group = (group + 1) & group_mask) {
+        size_t base = group * kGroupSize;
+        uint64_t word;
+        std::memcpy(&word, tags_.data() + base, kGroupSize);
+        uint64_t empty = ~word & kHighBits;
+        if (empty) {
+          size_t pos = base + LowestByte(empty);
+          tags_[pos] = Tag(hash);
+          ids_[pos] = id;
+          break;
+        }
+      }
+    }
+  }
+
+  std::vector<uint8_t> tags_;
+  std::vector<int64_t> ids_;
+  std::vector<KeyT> keys_;
+};
+
+// Sort `keys` stably, and reorder `indices` in the same way. The integers
+// are sorted by LSD radix sort on 8-bit digits. The digits above
+// the highest bit where the keys differ (e.g. the high bytes of small ids)
+// are skipped, and so is any pass where all the keys have the same digit.
+// Each pass counts and scatters the chunks of the keys in parallel.
+template <typename KeyT, typename IndexT>
+void RadixSortByKey(std::vector<KeyT>* keys, std::vector<IndexT>* indices) {
+  static_assert(std::is_integral<KeyT>::value,
+                "RadixSortByKey only supports integers.");
+  using UKeyT = typename std::make_unsigned<KeyT>::type;
+  constexpr int kRadixBits = 8;
+  constexpr int kRadix = 1 << kRadixBits;
+  constexpr int64_t kMinChunkSize = 1 << 16;
+  constexpr int64_t kMaxChunks = 64;
+  constexpr UKeyT kSignBit =
+      std::is_signed<KeyT>::value
+          ? static_cast<UKeyT>(static_cast<UKeyT>(1) << (sizeof(KeyT) * 8 - 1))
+          : 0;
+
+  int64_t n = static_cast<int64_t>(keys->size());
+  std::vector<UKeyT> src(n), dst(n);
+  // The bits where the keys differ, only the digits of them are sorted.
+  UKeyT diff_bits = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    // Flip the sign bit so that the negative keys come first.
+    src[i] = static_cast<UKeyT>((*keys)[i]) ^ kSignBit;
+    diff_bits |= src[i] ^ src[0];
+  }
+  std::vector<IndexT> src_indices(std::move(*indices));
+  std::vector<IndexT> dst_indices(n);
+
+  int64_t num_chunks =
+      std::max<int64_t>(1, std::min(n / kMinChunkSize, kMaxChunks));
+  std::vector<int64_t> offsets(num_chunks * kRadix);
+  for (size_t shift = 0; shift < sizeof(KeyT) * 8 && (diff_bits >> shift);
+       shift += kRadixBits) {
+    std::fill(offsets.begin(), offsets.end(), 0);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+      int64_t* count = offsets.data() + chunk * kRadix;
+      for (int64_t i = n * chunk / num_chunks;
+           i < n * (chunk + 1) / num_chunks;
+           ++i) {
+        ++count[(src[i] >> shift) & (kRadix - 1)];
+      }
+    }
+
+    // The offsets of every chunk in every bucket, in the order of buckets
+    // and then chunks, which keeps the sort stable.
+    int64_t total = 0;
+    bool single_bucket = false;
+    for (int digit = 0; digit < kRadix; ++digit) {
+      int64_t bucket_size = 0;
+      for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+        int64_t count = offsets[chunk * kRadix + digit];
+        offsets[chunk * kRadix + digit] = total;
+        total += count;
+        bucket_size += count;
+      }
+      single_bucket |= bucket_size == n;
+    }
+    if (single_bucket) {
+      continue;
+    }
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+      int64_t* offset = offsets.data() + chunk * kRadix;
+      for (int64_t i = n * chunk / num_chunks;
+           i < n * (chunk + 1) / num_chunks;
+           ++i) {
+        int64_t pos = offset[(src[i] >> shift) & (kRadix - 1)]++;
+        dst[pos] = src[i];
+        dst_indices[pos] = src_indices[i];
+      }
+    }
+    src.swap(dst);
+    src_indices.swap(dst_indices);
+  }
+
+  for (int64_t i = 0; i < n; ++i) {
+    (*keys)[i] = static_cast<KeyT>(src[i] ^ kSignBit);
+  }
+  *indices = std::move(src_indices);
+}
+
+// Sort the keys with their positions, by radix sort for integers and by
+// comparison otherwise.
+template <typename KeyT, typename IndexT>
+typename std::enable_if<std::is_integral<KeyT>::value>::type SortWithIndices(
+    const KeyT* data,
+    int64_t n,
+    std::vector<KeyT>* keys,
+    std::vector<IndexT>* indices) {
+  keys->assign(data, data + n);
+  indices->resize(n);
+  std::iota(indices->begin(), indices->end(), 0);
+  RadixSortByKey(keys, indices);
+}
+
+template <typename KeyT, typename IndexT>
+typename std::enable_if<!std::is_integral<KeyT>::value>::type SortWithIndices(
+    const KeyT* data,
+    int64_t n,
+    std::vector<KeyT>* keys,
+    std::vector<IndexT>* indices) {
+  indices->resize(n);
+  std::iota(indices->begin(), indices->end(), 0);
+  std::stable_sort(indices->begin(),
+                   indices->end(),
+                   [data](IndexT a, IndexT b) { return data[a] < data[b]; });
+  keys->resize(n);
+  for (int64_t i = 0; i < n; ++i) {
+    (*keys)[i] = data[(*indices)[i]];
+  }
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -17,6 +17,7 @@ limitations under the License. */
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 #include "paddle/phi/kernels/funcs/complex_functors.h"
+#include "paddle/phi/kernels/funcs/packed_gemm.h"
 
 namespace phi {
 
@@ -355,6 +356,23 @@ void MatMulFunction(const Context& dev_ctx,
                       1LL,
                       std::multiplies<std::int64_t>());
   if (out_batch_size == 0) return;
+  if (y_batch_size == 1 && !trans_x &&
+      funcs::PackedGemmFunctor<Context, T>()(dev_ctx,
+                                             Y,
+                                             trans_y,
+                                             x_batch_size * M,
+                                             N,
+                                             K,
+                                             x_data,
+                                             K,
+                                             y_data,
+                                             trans_y ? K : N,
+                                             static_cast<T>(flag),
+                                             Out->data<T>(),
+                                             N)) {
+    VLOG(3) << "MatMul's case packed";
+    return;
+  }
   if (x_batch_size == 1 && y_batch_size == 1) {
     VLOG(3) << "MatMul's case 8";
     blas.GEMM(trans_x ? CblasTrans : CblasNoTrans,
@@ -0,0 +1,82 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+
+#include "paddle/phi/common/int_array.h"
+#include "paddle/phi/common/scalar.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace phi {
+
+/*
+ * The view kernels have the same arguments and results as the kernels
+ * without the suffix, but the outputs are strided views which share the
+ * memory of the input instead of copies. They accept the strided inputs, so
+ * a view of a view is not copied either. They are only selected by the
+ * dygraph api when FLAGS_use_strided_view is set.
+ */
+template <typename T, typename Context>
+void TransposeViewKernel(const Context& dev_ctx,
+                         const DenseTensor& x,
+                         const std::vector<int>& axis,
+                         DenseTensor* out);
+
+template <typename T, typename Context>
+void SliceViewKernel(const Context& dev_ctx,
+                     const DenseTensor& input,
+                     const std::vector<int64_t>& axes,
+                     const IntArray& starts,
+                     const IntArray& ends,
+                     const std::vector<int64_t>& infer_flags,
+                     const std::vector<int64_t>& decrease_axis,
+                     DenseTensor* out);
+
+template <typename T, typename Context>
+void SplitViewKernel(const Context& dev_ctx,
+                     const DenseTensor& x,
+                     const IntArray& sections,
+                     const Scalar& axis,
+                     std::vector<DenseTensor*> out);
+
+template <typename T, typename Context>
+void SplitWithNumViewKernel(const Context& dev_ctx,
+                            const DenseTensor& x,
+                            int num,
+                            const Scalar& axis,
+                            std::vector<DenseTensor*> out);
+
+template <typename T, typename Context>
+void UnbindViewKernel(const Context& dev_ctx,
+                      const DenseTensor& x,
+                      int axis,
+                      std::vector<DenseTensor*> outs);
+
+template <typename T, typename Context>
+void DiagonalViewKernel(const Context& dev_ctx,
+                        const DenseTensor& x,
+                        int offset,
+                        int axis1,
+                        int axis2,
+                        DenseTensor* out);
+
+template <typename T, typename Context>
+void ExpandViewKernel(const Context& dev_ctx,
+                      const DenseTensor& x,
+                      const IntArray& shape,
+                      DenseTensor* out);
+
+}  // namespace phi
@@ -17,6 +17,7 @@ limitations under the License. */
 #include <memory>
 
 #include "paddle/phi/api/include/api.h"
+#include "paddle/phi/api/lib/kernel_dispatch.h"
 #include "paddle/phi/api/lib/utils/allocator.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/kernel_registry.h"
@@ -61,5 +62,51 @@ TEST(API, scale) {
   LOG(INFO) << "The cost of switch_case is " << t3 << "ms.";
 }
 
+TEST(API, kernel_dispatch_cache) {
+  phi::KernelKey kernel_key(
+      phi::Backend::CPU, phi::DataLayout::ALL_LAYOUT, phi::DataType::FLOAT32);
+  experimental::KernelDispatchCache kernel_cache("scale");
+  auto factory_result =
+      phi::KernelFactory::Instance().SelectKernelOrThrowError("scale",
+                                                              kernel_key);
+  auto cache_result = kernel_cache.SelectKernelOrThrowError(kernel_key);
+  ASSERT_FALSE(cache_result.has_fallback_cpu);
+  ASSERT_EQ(cache_result.kernel.GetVariadicKernelFn<void*>(),
+            factory_result.kernel.GetVariadicKernelFn<void*>());
+
+  const size_t cycles = 100000;
+  phi::tests::Timer timer;
+  timer.tic();
+  for (size_t i = 0; i < cycles; ++i) {
+    auto result = phi::KernelFactory::Instance().SelectKernelOrThrowError(
+        "scale", kernel_key);
+    ASSERT_TRUE(result.kernel.IsValid());
+  }
+  double factory_cost = timer.toc();
+  timer.tic();
+  for (size_t i = 0; i < cycles; ++i) {
+    auto result = kernel_cache.SelectKernelOrThrowError(kernel_key);
+    ASSERT_TRUE(result.kernel.IsValid());
+  }
+  double cache_cost = timer.toc();
+
+  // The latency of an op on a small tensor, which is dominated by the
+  // dispatch.
+  auto x = experimental::full(
+      {3, 4}, 1.0, experimental::DataType::FLOAT32, CPUPlace());
+  timer.tic();
+  for (size_t i = 0; i < cycles; ++i) {
+    auto out = experimental::scale(x, 2.0, 1.0, true);
+  }
+  double op_cost = timer.toc();
+
+  LOG(INFO) << "The cost of selecting kernel from KernelFactory is "
+            << factory_cost * 1000 / cycles << "us.";
+  LOG(INFO) << "The cost of selecting kernel from KernelDispatchCache is "
+            << cache_cost * 1000 / cycles << "us.";
+  LOG(INFO) << "The latency of scale on a [3, 4] tensor is "
+            << op_cost * 1000 / cycles << "us.";
+}
+
 }  // namespace tests
 }  // namespace paddle
@@ -0,0 +1,76 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "gflags/gflags.h"
+#include "paddle/phi/api/include/api.h"
+#include "paddle/phi/api/include/tensor.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+
+PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(scale, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(transpose_view, CPU, ALL_LAYOUT);
+
+DECLARE_bool(use_strided_view);
+
+namespace paddle {
+namespace tests {
+
+static phi::DenseTensor* GetDense(const experimental::Tensor& t) {
+  return static_cast<phi::DenseTensor*>(t.impl().get());
+}
+
+TEST(API, strided_view) {
+  FLAGS_use_strided_view = true;
+  auto x = experimental::full({2, 3}, 0, phi::DataType::FLOAT32);
+  float* x_data = GetDense(x)->data<float>();
+  for (int i = 0; i < 6; ++i) {
+    x_data[i] = static_cast<float>(i);
+  }
+
+  auto y = experimental::transpose(x, {1, 0});
+  ASSERT_FALSE(GetDense(y)->meta().is_contiguous());
+  ASSERT_EQ(GetDense(y)->Holder(), GetDense(x)->Holder());
+
+  // PrepareData copies the view in the order of its dims for scale.
+  auto z = experimental::scale(y, 2.0, 0.0, true);
+  ASSERT_TRUE(GetDense(z)->meta().is_contiguous());
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      ASSERT_EQ(z.data<float>()[i * 2 + j], 2.0f * x_data[j * 3 + i]);
+    }
+  }
+
+  // SetKernelOutput makes the view contiguous before the inplace scale
+  // writes it, so the base is not changed.
+  experimental::scale_(y, 3.0, 0.0, true);
+  ASSERT_TRUE(GetDense(y)->meta().is_contiguous());
+  ASSERT_NE(GetDense(y)->Holder(), GetDense(x)->Holder());
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      ASSERT_EQ(y.data<float>()[i * 2 + j], 3.0f * x_data[j * 3 + i]);
+    }
+  }
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_EQ(x_data[i], static_cast<float>(i));
+  }
+  FLAGS_use_strided_view = false;
+}
+
+}  // namespace tests
+}  // namespace paddle
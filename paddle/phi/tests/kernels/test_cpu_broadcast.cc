@@ -0,0 +1,150 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/kernels/funcs/elementwise_broadcast_cpu.h"
+
+namespace phi {
+namespace tests {
+
+using phi::funcs::CPUBroadcastPlan;
+
+static int64_t BroadcastIndex(const std::vector<int>& dims,
+                              const std::vector<int>& index) {
+  int64_t offset = 0;
+  for (size_t i = 0; i < dims.size(); ++i) {
+    if (dims[i] > 1) {
+      offset = offset * dims[i] + index[i];
+    }
+  }
+  return offset;
+}
+
+// Compare the engine with the computation of the indices of every element,
+// on random shapes. The values are small integers so that the results do not
+// depend on the order of the summation.
+static void CheckBroadcast(const std::vector<int>& x_dims,
+                           const std::vector<int>& y_dims,
+                           std::mt19937* engine) {
+  int rank = x_dims.size();
+  std::vector<int> out_dims(rank);
+  int64_t numel = 1, x_numel = 1, y_numel = 1;
+  for (int i = 0; i < rank; ++i) {
+    out_dims[i] = std::max(x_dims[i], y_dims[i]);
+    numel *= out_dims[i];
+    x_numel *= x_dims[i];
+    y_numel *= y_dims[i];
+  }
+  std::uniform_int_distribution<int> dist(0, 9);
+  std::vector<double> x(x_numel), y(y_numel), dout(numel);
+  for (auto& v : x) v = dist(*engine);
+  for (auto& v : y) v = dist(*engine);
+  for (auto& v : dout) v = dist(*engine);
+
+  std::vector<double> expected_out(numel);
+  std::vector<double> expected_dx(x_numel, 0), expected_dy(y_numel, 0);
+  std::vector<int> index(rank, 0);
+  for (int64_t i = 0; i < numel; ++i) {
+    int64_t x_idx = BroadcastIndex(x_dims, index);
+    int64_t y_idx = BroadcastIndex(y_dims, index);
+    expected_out[i] = x[x_idx] * 2 - y[y_idx];
+    expected_dx[x_idx] += dout[i] * y[y_idx];
+    expected_dy[y_idx] += dout[i] * x[x_idx];
+    for (int d = rank - 1; d >= 0; --d) {
+      if (++index[d] < out_dims[d]) break;
+      index[d] = 0;
+    }
+  }
+
+  CPUBroadcastPlan plan(x_dims.data(), y_dims.data(), out_dims.data(), rank);
+  std::vector<double> out(numel);
+  std::vector<double> dx(x_numel, 0), dy(y_numel, 0);
+  phi::funcs::CPUBroadcastForward(
+      plan, x.data(), y.data(), out.data(), [](double a, double b) {
+        return a * 2 - b;
+      });
+  phi::funcs::CPUBroadcastBackward(
+      plan,
+      x.data(),
+      y.data(),
+      out.data(),
+      dout.data(),
+      dx.data(),
+      dy.data(),
+      [](double a, double b, double out, double dout) { return dout * b; },
+      [](double a, double b, double out, double dout) { return dout * a; });
+  EXPECT_EQ(out, expected_out);
+  EXPECT_EQ(dx, expected_dx);
+  EXPECT_EQ(dy, expected_dy);
+}
+
+TEST(CPUBroadcast, collapse_dims) {
+  const int x_dims[] = {3, 4, 5};
+  // Row broadcast, [3, 4, 5] + [1, 4, 5] -> [3, 20] + [1, 20].
+  const int row_dims[] = {1, 4, 5};
+  CPUBroadcastPlan row(x_dims, row_dims, x_dims, 3);
+  EXPECT_EQ(row.inner, 20);
+  EXPECT_EQ(row.y_inner_stride, 1);
+  EXPECT_EQ(row.outer_dims, std::vector<int64_t>({3}));
+  EXPECT_EQ(row.y_outer_strides, std::vector<int64_t>({0}));
+  EXPECT_FALSE(row.RowsAreDisjoint(row.y_outer_strides));
+
+  // Column broadcast, [3, 4, 5] + [3, 4, 1] -> [12, 5] + [12, 1].
+  const int column_dims[] = {3, 4, 1};
+  CPUBroadcastPlan column(x_dims, column_dims, x_dims, 3);
+  EXPECT_EQ(column.inner, 5);
+  EXPECT_EQ(column.y_inner_stride, 0);
+  EXPECT_EQ(column.outer_dims, std::vector<int64_t>({12}));
+  EXPECT_EQ(column.y_outer_strides, std::vector<int64_t>({1}));
+  EXPECT_TRUE(column.RowsAreDisjoint(column.y_outer_strides));
+
+  // Scalar, [3, 4, 5] + [1, 1, 1] -> [60] + [1].
+  const int scalar_dims[] = {1, 1, 1};
+  CPUBroadcastPlan scalar(x_dims, scalar_dims, x_dims, 3);
+  EXPECT_EQ(scalar.inner, 60);
+  EXPECT_EQ(scalar.y_inner_stride, 0);
+  EXPECT_TRUE(scalar.outer_dims.empty());
+}
+
+TEST(CPUBroadcast, random_shapes) {
+  std::mt19937 engine(2022);
+  std::uniform_int_distribution<int> rank_dist(1, 5);
+  std::uniform_int_distribution<int> dim_dist(1, 6);
+  std::uniform_int_distribution<int> broadcast_dist(0, 2);
+  for (int iter = 0; iter < 500; ++iter) {
+    int rank = rank_dist(engine);
+    std::vector<int> x_dims(rank), y_dims(rank);
+    for (int i = 0; i < rank; ++i) {
+      int dim = dim_dist(engine);
+      x_dims[i] = broadcast_dist(engine) == 0 ? 1 : dim;
+      y_dims[i] = broadcast_dist(engine) == 0 ? 1 : dim;
+    }
+    CheckBroadcast(x_dims, y_dims, &engine);
+  }
+}
+
+TEST(CPUBroadcast, parallel_rows) {
+  std::mt19937 engine(2022);
+  // Large enough to be split into chunks.
+  CheckBroadcast({256, 3, 100}, {256, 1, 100}, &engine);
+  CheckBroadcast({256, 3, 100}, {1, 3, 1}, &engine);
+  CheckBroadcast({256, 300}, {256, 1}, &engine);
+  CheckBroadcast({1, 300}, {256, 1}, &engine);
+}
+
+}  // namespace tests
+}  // namespace phi
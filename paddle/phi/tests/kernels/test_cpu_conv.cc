@@ -0,0 +1,218 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "paddle/phi/backends/all_context.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/kernels/conv_kernel.h"
+#include "paddle/phi/kernels/funcs/conv_cpu.h"
+#include "paddle/phi/kernels/funcs/packed_weight_cache.h"
+
+DECLARE_bool(use_direct_conv);
+
+namespace phi {
+namespace tests {
+
+static const CPUContext& GetCPUContext() {
+  auto& pool = DeviceContextPool::Instance();
+  return *static_cast<const CPUContext*>(pool.GetByPlace(CPUPlace()));
+}
+
+static std::vector<float> RandomValues(int64_t size) {
+  std::mt19937 engine(2022);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> values(size);
+  for (auto& value : values) {
+    value = dist(engine);
+  }
+  return values;
+}
+
+static DenseTensor MakeTensor(const std::vector<int64_t>& dims,
+                              const std::vector<float>& values) {
+  DenseTensor x;
+  const DenseTensorMeta meta(DataType::FLOAT32, make_ddim(dims));
+  x.set_meta(meta);
+  float* data = GetCPUContext().Alloc<float>(&x);
+  std::copy(values.begin(), values.end(), data);
+  return x;
+}
+
+static funcs::Conv2DParams MakeParams(int batch_size,
+                                      int in_channels,
+                                      int in_size,
+                                      int out_channels,
+                                      int kernel_size,
+                                      int stride,
+                                      int padding,
+                                      int dilation,
+                                      int groups) {
+  funcs::Conv2DParams p;
+  p.batch_size = batch_size;
+  p.in_channels = in_channels;
+  p.in_h = in_size;
+  p.in_w = in_size + 3;
+  p.out_channels = out_channels;
+  p.kernel_h = kernel_size;
+  p.kernel_w = kernel_size;
+  p.stride_h = stride;
+  p.stride_w = stride;
+  p.pad_top = padding;
+  p.pad_left = padding;
+  p.dilation_h = dilation;
+  p.dilation_w = dilation;
+  p.groups = groups;
+  p.out_h = (p.in_h + 2 * padding - dilation * (kernel_size - 1) - 1) / stride +
+            1;
+  p.out_w = (p.in_w + 2 * padding - dilation * (kernel_size - 1) - 1) / stride +
+            1;
+  return p;
+}
+
+static std::vector<float> ReferenceConv2D(const funcs::Conv2DParams& p,
+                                          const std::vector<float>& input,
+                                          const std::vector<float>& filter,
+                                          const std::vector<float>& bias) {
+  const int ic_per_group = p.in_channels / p.groups;
+  const int oc_per_group = p.out_channels / p.groups;
+  std::vector<float> output(p.batch_size * p.out_channels * p.out_h * p.out_w);
+  for (int n = 0; n < p.batch_size; ++n) {
+    for (int oc = 0; oc < p.out_channels; ++oc) {
+      const int g = oc / oc_per_group;
+      for (int oh = 0; oh < p.out_h; ++oh) {
+        for (int ow = 0; ow < p.out_w; ++ow) {
+          double sum = bias.empty() ? 0 : bias[oc];
+          for (int ic = 0; ic < ic_per_group; ++ic) {
+            for (int kh = 0; kh < p.kernel_h; ++kh) {
+              for (int kw = 0; kw < p.kernel_w; ++kw) {
+                int ih = oh * p.stride_h - p.pad_top + kh * p.dilation_h;
+                int iw = ow * p.stride_w - p.pad_left + kw * p.dilation_w;
+                if (ih < 0 || ih >= p.in_h || iw < 0 || iw >= p.in_w) {
+                  continue;
+                }
+                int c = g * ic_per_group + ic;
+                sum += input[((n * p.in_channels + c) * p.in_h + ih) * p.in_w +
+                             iw] *
+                       filter[((oc * ic_per_group + ic) * p.kernel_h + kh) *
+                                  p.kernel_w +
+                              kw];
+              }
+            }
+          }
+          output[((n * p.out_channels + oc) * p.out_h + oh) * p.out_w + ow] =
+              sum;
+        }
+      }
+    }
+  }
+  return output;
+}
+
+static void CheckDirectConv2D(const funcs::Conv2DParams& p, bool with_bias) {
+  auto input = RandomValues(p.batch_size * p.in_channels * p.in_h * p.in_w);
+  auto filter = RandomValues(p.out_channels * p.in_channels / p.groups *
+                             p.kernel_h * p.kernel_w);
+  std::vector<float> bias;
+  if (with_bias) {
+    bias = RandomValues(p.out_channels);
+  }
+  auto expected = ReferenceConv2D(p, input, filter, bias);
+
+  auto packed = funcs::PackConvFilter<float>(p, filter.data());
+  for (auto activation : {funcs::ConvActivation::kIdentity,
+                          funcs::ConvActivation::kRelu,
+                          funcs::ConvActivation::kRelu6}) {
+    std::vector<float> output(expected.size());
+    funcs::DirectConv2D<float>(p,
+                               input.data(),
+                               *packed,
+                               with_bias ? bias.data() : nullptr,
+                               activation,
+                               output.data());
+    for (size_t i = 0; i < output.size(); ++i) {
+      float value = funcs::ApplyConvActivation(expected[i], activation);
+      ASSERT_NEAR(output[i], value, 1e-4 + 1e-4 * std::abs(value))
+          << "in_channels " << p.in_channels << ", out_channels "
+          << p.out_channels << ", groups " << p.groups << ", index " << i;
+    }
+  }
+}
+
+TEST(CPUDirectConv, same_as_reference) {
+  // batch, in_channels, in_size, out_channels, kernel, stride, padding,
+  // dilation, groups
+  CheckDirectConv2D(MakeParams(2, 3, 17, 5, 3, 1, 1, 1, 1), true);
+  CheckDirectConv2D(MakeParams(1, 16, 20, 24, 3, 2, 1, 1, 1), false);
+  CheckDirectConv2D(MakeParams(1, 8, 19, 13, 5, 1, 2, 2, 1), true);
+  CheckDirectConv2D(MakeParams(2, 12, 9, 18, 3, 1, 0, 1, 3), true);
+  CheckDirectConv2D(MakeParams(1, 4, 30, 4, 1, 2, 0, 1, 1), false);
+  CheckDirectConv2D(MakeParams(1, 3, 6, 8, 7, 1, 3, 1, 1), true);
+  // Depthwise.
+  CheckDirectConv2D(MakeParams(2, 16, 23, 16, 3, 1, 1, 1, 16), true);
+  CheckDirectConv2D(MakeParams(1, 8, 24, 8, 3, 2, 1, 1, 8), false);
+  CheckDirectConv2D(MakeParams(1, 8, 21, 8, 5, 1, 4, 2, 8), true);
+  // Large enough to run in parallel.
+  CheckDirectConv2D(MakeParams(4, 32, 28, 40, 3, 1, 1, 1, 1), true);
+}
+
+TEST(CPUDirectConv, packed_weight_cache) {
+  auto& cache = funcs::PackedWeightCache::Instance();
+  cache.Clear();
+  auto weight = MakeTensor({8, 4, 3, 3}, RandomValues(8 * 4 * 3 * 3));
+  int num_packs = 0;
+  auto pack = [&num_packs]() {
+    ++num_packs;
+    return std::make_shared<funcs::PackedConvFilter<float>>();
+  };
+  auto first = cache.Get<funcs::PackedConvFilter<float>>(weight, "a", pack);
+  auto second = cache.Get<funcs::PackedConvFilter<float>>(weight, "a", pack);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(num_packs, 1);
+
+  cache.Get<funcs::PackedConvFilter<float>>(weight, "b", pack);
+  EXPECT_EQ(num_packs, 2);
+  EXPECT_EQ(cache.Size(), 2UL);
+
+  weight.InplaceVersionCounter().Bump();
+  auto third = cache.Get<funcs::PackedConvFilter<float>>(weight, "a", pack);
+  EXPECT_NE(first, third);
+  EXPECT_EQ(num_packs, 3);
+
+  {
+    auto freed = MakeTensor({8, 4, 3, 3}, RandomValues(8 * 4 * 3 * 3));
+    cache.Get<funcs::PackedConvFilter<float>>(freed, "a", pack);
+    EXPECT_EQ(cache.Size(), 3UL);
+  }
+  // The entry of the freed weight is dropped when the next one is packed.
+  cache.Get<funcs::PackedConvFilter<float>>(weight, "c", pack);
+  EXPECT_EQ(cache.Size(), 3UL);
+  EXPECT_EQ(num_packs, 5);
+
+  auto other = MakeTensor({8, 4, 3, 3}, RandomValues(8 * 4 * 3 * 3));
+  EXPECT_FALSE(cache.IsConstant(weight));
+  cache.MarkConstant(weight);
+  EXPECT_TRUE(cache.IsConstant(weight));
+  EXPECT_FALSE(cache.IsConstant(other));
+  cache.Clear();
+  EXPECT_EQ(cache.Size(), 0UL);
+  EXPECT_FALSE(cache.IsConstant(weight));
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,132 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/phi/backends/all_context.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/kernels/conv_kernel.h"
+#include "paddle/phi/kernels/funcs/packed_weight_cache.h"
+#include "paddle/phi/tests/core/timer.h"
+
+DECLARE_bool(use_direct_conv);
+
+namespace phi {
+namespace tests {
+
+static const CPUContext& GetCPUContext() {
+  auto& pool = DeviceContextPool::Instance();
+  return *static_cast<const CPUContext*>(pool.GetByPlace(CPUPlace()));
+}
+
+static std::vector<float> RandomValues(int64_t size) {
+  std::mt19937 engine(2022);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> values(size);
+  for (auto& value : values) {
+    value = dist(engine);
+  }
+  return values;
+}
+
+static DenseTensor MakeTensor(const std::vector<int64_t>& dims,
+                              const std::vector<float>& values) {
+  DenseTensor x;
+  const DenseTensorMeta meta(DataType::FLOAT32, make_ddim(dims));
+  x.set_meta(meta);
+  float* data = GetCPUContext().Alloc<float>(&x);
+  std::copy(values.begin(), values.end(), data);
+  return x;
+}
+
+// Compare the direct convolution with im2col and GEMM through conv2d, on the
+// shapes of ResNet and MobileNet.
+TEST(CPUDirectConv, benchmark) {
+  const auto& dev_ctx = GetCPUContext();
+  Timer timer;
+  struct Shape {
+    int channels, size, out_channels, kernel_size, stride, groups;
+  };
+  for (auto shape : {Shape{64, 56, 64, 3, 1, 1},
+                     Shape{128, 28, 128, 3, 1, 1},
+                     Shape{256, 14, 256, 3, 1, 1},
+                     Shape{3, 224, 64, 7, 2, 1},
+                     Shape{128, 56, 128, 3, 1, 128}}) {
+    const int padding = shape.kernel_size / 2;
+    auto input = MakeTensor(
+        {1, shape.channels, shape.size, shape.size},
+        RandomValues(shape.channels * shape.size * shape.size));
+    auto filter = MakeTensor(
+        {shape.out_channels,
+         shape.channels / shape.groups,
+         shape.kernel_size,
+         shape.kernel_size},
+        RandomValues(shape.out_channels * shape.channels / shape.groups *
+                     shape.kernel_size * shape.kernel_size));
+    // As a parameter of a predictor.
+    funcs::PackedWeightCache::Instance().MarkConstant(filter);
+    const int out_size =
+        (shape.size + 2 * padding - shape.kernel_size) / shape.stride + 1;
+    std::vector<float> outputs[2];
+    double times[2];
+    for (bool direct : {false, true}) {
+      FLAGS_use_direct_conv = direct;
+      DenseTensor out;
+      const DenseTensorMeta meta(
+          DataType::FLOAT32,
+          make_ddim({1, shape.out_channels, out_size, out_size}));
+      out.set_meta(meta);
+      auto conv = [&]() {
+        ConvKernel<float, CPUContext>(dev_ctx,
+                                      input,
+                                      filter,
+                                      {shape.stride, shape.stride},
+                                      {padding, padding},
+                                      "EXPLICIT",
+                                      {1, 1},
+                                      shape.groups,
+                                      "NCHW",
+                                      &out);
+      };
+      // The first call packs the filter.
+      conv();
+      const int kRepeats = 5;
+      timer.tic();
+      for (int i = 0; i < kRepeats; ++i) {
+        conv();
+      }
+      times[direct] = timer.toc() / kRepeats;
+      const float* data = out.data<float>();
+      outputs[direct].assign(data, data + out.numel());
+    }
+    FLAGS_use_direct_conv = false;
+    for (size_t i = 0; i < outputs[0].size(); ++i) {
+      ASSERT_NEAR(outputs[1][i], outputs[0][i], 1e-3);
+    }
+    LOG(INFO) << "conv " << shape.channels << "x" << shape.size << "x"
+              << shape.size << " -> " << shape.out_channels << ", kernel "
+              << shape.kernel_size << ", stride " << shape.stride
+              << ", groups " << shape.groups << ": im2col " << times[0]
+              << "ms, direct " << times[1] << "ms.";
+  }
+  funcs::PackedWeightCache::Instance().Clear();
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,117 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "paddle/phi/backends/all_context.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/kernels/funcs/packed_gemm.h"
+#include "paddle/phi/kernels/funcs/packed_weight_cache.h"
+
+namespace phi {
+namespace tests {
+
+static const CPUContext& GetCPUContext() {
+  auto& pool = DeviceContextPool::Instance();
+  return *static_cast<const CPUContext*>(pool.GetByPlace(CPUPlace()));
+}
+
+static std::vector<float> RandomValues(int64_t size) {
+  std::mt19937 engine(2022);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> values(size);
+  for (auto& value : values) {
+    value = dist(engine);
+  }
+  return values;
+}
+
+static DenseTensor MakeTensor(const std::vector<int64_t>& dims,
+                              const std::vector<float>& values) {
+  DenseTensor x;
+  const DenseTensorMeta meta(DataType::FLOAT32, make_ddim(dims));
+  x.set_meta(meta);
+  float* data = GetCPUContext().Alloc<float>(&x);
+  std::copy(values.begin(), values.end(), data);
+  return x;
+}
+
+TEST(CPUPackedGemm, same_as_gemm) {
+  const auto& dev_ctx = GetCPUContext();
+  auto& cache = funcs::PackedWeightCache::Instance();
+  cache.Clear();
+  FLAGS_use_packed_gemm = true;
+  const int M = 3, N = 40, K = 24;
+  auto x = RandomValues(M * K);
+  for (bool trans_w : {false, true}) {
+    auto weight = MakeTensor(trans_w ? std::vector<int64_t>{N, K}
+                                     : std::vector<int64_t>{K, N},
+                             RandomValues(K * N));
+    const float* w = weight.data<float>();
+    std::vector<float> expected(M * N);
+    for (int i = 0; i < M; ++i) {
+      for (int j = 0; j < N; ++j) {
+        for (int k = 0; k < K; ++k) {
+          expected[i * N + j] +=
+              x[i * K + k] * (trans_w ? w[j * K + k] : w[k * N + j]);
+        }
+      }
+    }
+
+    std::vector<float> y(M * N);
+    auto packed_gemm = [&](float beta) {
+      return funcs::PackedGemmFunctor<CPUContext, float>()(dev_ctx,
+                                                           weight,
+                                                           trans_w,
+                                                           M,
+                                                           N,
+                                                           K,
+                                                           x.data(),
+                                                           K,
+                                                           w,
+                                                           trans_w ? K : N,
+                                                           beta,
+                                                           y.data(),
+                                                           N);
+    };
+    // The weights which are not marked constant are not packed.
+    EXPECT_FALSE(packed_gemm(0.f));
+    cache.MarkConstant(weight);
+    bool packed = packed_gemm(0.f);
+#ifdef PADDLE_WITH_MKLML
+    ASSERT_TRUE(packed);
+    // Accumulate into y with the cached weight.
+    ASSERT_TRUE(packed_gemm(1.f));
+    for (int i = 0; i < M * N; ++i) {
+      ASSERT_NEAR(y[i], 2 * expected[i], 1e-4);
+    }
+#else
+    EXPECT_FALSE(packed);
+#endif
+  }
+#ifdef PADDLE_WITH_MKLML
+  // The entry of the first weight is dropped once it is freed and the second
+  // one is packed.
+  EXPECT_EQ(cache.Size(), 1UL);
+#endif
+  FLAGS_use_packed_gemm = false;
+  cache.Clear();
+}
+
+}  // namespace tests
+}  // namespace phi
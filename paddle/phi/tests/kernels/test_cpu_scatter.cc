@@ -0,0 +1,164 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "paddle/phi/backends/all_context.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/kernels/funcs/gather.h"
+#include "paddle/phi/kernels/funcs/scatter.h"
+
+namespace phi {
+namespace tests {
+
+static const CPUContext& GetCPUContext() {
+  auto& pool = DeviceContextPool::Instance();
+  return *static_cast<const CPUContext*>(pool.GetByPlace(CPUPlace()));
+}
+
+template <typename T>
+static DenseTensor MakeTensor(const std::vector<int64_t>& dims,
+                              const std::vector<T>& values) {
+  DenseTensor x;
+  const DenseTensorMeta meta(
+      paddle::experimental::CppTypeToDataType<T>::Type(), make_ddim(dims));
+  x.set_meta(meta);
+  T* data = GetCPUContext().Alloc<T>(&x);
+  std::copy(values.begin(), values.end(), data);
+  return x;
+}
+
+template <typename T>
+static std::vector<T> Values(const DenseTensor& x) {
+  const T* data = x.data<T>();
+  return std::vector<T>(data, data + x.numel());
+}
+
+// Skewed indices in [0, num_rows), so that some rows are updated many times.
+static std::vector<int64_t> RandomIndex(int64_t size, int64_t num_rows) {
+  std::mt19937 engine(2022);
+  std::geometric_distribution<int64_t> skewed(0.05);
+  std::uniform_int_distribution<int64_t> uniform(0, num_rows - 1);
+  std::vector<int64_t> index(size);
+  for (int64_t i = 0; i < size; ++i) {
+    index[i] = i % 2 ? uniform(engine) : skewed(engine) % num_rows;
+  }
+  return index;
+}
+
+static std::vector<float> RandomValues(int64_t size) {
+  std::mt19937 engine(2022);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> values(size);
+  for (auto& value : values) {
+    value = dist(engine);
+  }
+  return values;
+}
+
+// The sizes are large enough for the kernels to run in parallel.
+TEST(CPUScatter, same_as_serial) {
+  const auto& dev_ctx = GetCPUContext();
+  const int64_t num_rows = 1000, size = 20000, width = 16;
+  auto index = RandomIndex(size, num_rows);
+  auto updates = RandomValues(size * width);
+  auto x = RandomValues(num_rows * width);
+
+  auto index_t = MakeTensor<int64_t>({size}, index);
+  auto updates_t = MakeTensor<float>({size, width}, updates);
+
+  // overwrite: the last update of a row wins.
+  auto assigned = x;
+  for (int64_t i = 0; i < size; ++i) {
+    std::copy(updates.begin() + i * width,
+              updates.begin() + (i + 1) * width,
+              assigned.begin() + index[i] * width);
+  }
+  auto out = MakeTensor<float>({num_rows, width}, x);
+  funcs::ScatterAssign<float, int64_t>(dev_ctx, updates_t, index_t, &out);
+  EXPECT_EQ(Values<float>(out), assigned);
+
+  // accumulate: the sums are added in the order of the index.
+  auto added = x;
+  for (int64_t i = 0; i < size; ++i) {
+    for (int64_t j = 0; j < width; ++j) {
+      added[index[i] * width + j] = 0;
+    }
+  }
+  for (int64_t i = 0; i < size; ++i) {
+    for (int64_t j = 0; j < width; ++j) {
+      added[index[i] * width + j] += updates[i * width + j];
+    }
+  }
+  out = MakeTensor<float>({num_rows, width}, x);
+  funcs::ScatterAssignAdd<float, int64_t>(dev_ctx, updates_t, index_t, &out);
+  EXPECT_EQ(Values<float>(out), added);
+
+  // scatter_nd_add with the index of the rows as [size, 1].
+  auto nd_index_t = MakeTensor<int64_t>({size, 1}, index);
+  out = MakeTensor<float>({num_rows, width}, x);
+  funcs::ScatterNdAdd<float, int64_t>(dev_ctx, updates_t, nd_index_t, &out);
+  auto nd_added = x;
+  for (int64_t i = 0; i < size; ++i) {
+    for (int64_t j = 0; j < width; ++j) {
+      nd_added[index[i] * width + j] += updates[i * width + j];
+    }
+  }
+  EXPECT_EQ(Values<float>(out), nd_added);
+}
+
+TEST(CPUGather, same_as_serial) {
+  const auto& dev_ctx = GetCPUContext();
+  const int64_t outer = 3, num_rows = 500, size = 4000, width = 8;
+  auto index = RandomIndex(size, num_rows);
+  auto x = RandomValues(outer * num_rows * width);
+  auto index_t = MakeTensor<int64_t>({size}, index);
+
+  // gather along the axis 1 of [outer, num_rows, width].
+  auto x_t = MakeTensor<float>({outer, num_rows, width}, x);
+  DenseTensor out;
+  funcs::GatherV2Function<float, int64_t>(dev_ctx, &x_t, &index_t, 1, &out);
+  EXPECT_EQ(out.dims(), make_ddim({outer, size, width}));
+  std::vector<float> gathered;
+  for (int64_t i = 0; i < outer; ++i) {
+    for (int64_t j = 0; j < size; ++j) {
+      auto begin = x.begin() + (i * num_rows + index[j]) * width;
+      gathered.insert(gathered.end(), begin, begin + width);
+    }
+  }
+  EXPECT_EQ(Values<float>(out), gathered);
+
+  // The gradient of the gather adds the rows back in the order of the index.
+  DenseTensor grad;
+  grad.Resize(make_ddim({outer, num_rows, width}));
+  funcs::GatherV2GradFunction<float, int64_t>(
+      dev_ctx, &out, &index_t, 1, &grad);
+  std::vector<float> expected(outer * num_rows * width, 0.f);
+  for (int64_t i = 0; i < outer; ++i) {
+    for (int64_t j = 0; j < size; ++j) {
+      for (int64_t k = 0; k < width; ++k) {
+        expected[(i * num_rows + index[j]) * width + k] +=
+            gathered[(i * size + j) * width + k];
+      }
+    }
+  }
+  EXPECT_EQ(Values<float>(grad), expected);
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,136 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/kernels/funcs/softmax_cpu.h"
+
+namespace phi {
+namespace tests {
+
+// The softmax of x as [n, axis_dim, remain] along axis_dim, in double.
+static std::vector<double> ReferenceSoftmax(const std::vector<float>& x,
+                                            int n,
+                                            int axis_dim,
+                                            int remain,
+                                            bool log_softmax) {
+  std::vector<double> y(x.size());
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < remain; ++j) {
+      auto at = [&](int k) { return i * axis_dim * remain + k * remain + j; };
+      double max = x[at(0)];
+      for (int k = 1; k < axis_dim; ++k) {
+        max = std::max<double>(max, x[at(k)]);
+      }
+      double sum = 0;
+      for (int k = 0; k < axis_dim; ++k) {
+        sum += std::exp(std::max(x[at(k)] - max, -64.));
+      }
+      for (int k = 0; k < axis_dim; ++k) {
+        double shifted = std::max(x[at(k)] - max, -64.);
+        y[at(k)] = log_softmax ? shifted - std::log(sum)
+                               : std::exp(shifted) / sum;
+      }
+    }
+  }
+  return y;
+}
+
+static void CheckSoftmax(const std::vector<float>& x,
+                         int n,
+                         int axis_dim,
+                         int remain) {
+  std::mt19937 engine(2022);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> dy(x.size());
+  for (auto& v : dy) {
+    v = dist(engine);
+  }
+
+  for (bool log_softmax : {false, true}) {
+    std::vector<float> y(x.size());
+    funcs::SoftmaxCPU(x.data(), n, axis_dim, remain, log_softmax, y.data());
+    auto expected = ReferenceSoftmax(x, n, axis_dim, remain, log_softmax);
+    for (size_t i = 0; i < x.size(); ++i) {
+      ASSERT_NEAR(y[i], expected[i], 1e-5 + 1e-5 * std::abs(expected[i]))
+          << "axis_dim " << axis_dim << ", remain " << remain << ", log "
+          << log_softmax << ", index " << i;
+    }
+
+    std::vector<float> dx(x.size());
+    funcs::SoftmaxGradCPU(
+        y.data(), dy.data(), n, axis_dim, remain, log_softmax, dx.data());
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < remain; ++j) {
+        auto at = [&](int k) { return i * axis_dim * remain + k * remain + j; };
+        double sum = 0;
+        for (int k = 0; k < axis_dim; ++k) {
+          sum += log_softmax ? dy[at(k)] : dy[at(k)] * expected[at(k)];
+        }
+        for (int k = 0; k < axis_dim; ++k) {
+          double p = log_softmax ? std::exp(expected[at(k)]) : expected[at(k)];
+          double grad =
+              log_softmax ? dy[at(k)] - p * sum : (dy[at(k)] - sum) * p;
+          ASSERT_NEAR(dx[at(k)], grad, 1e-4 + 1e-4 * std::abs(grad));
+        }
+      }
+    }
+  }
+}
+
+TEST(CPUSoftmax, same_as_reference) {
+  std::mt19937 engine(2022);
+  std::normal_distribution<float> dist(0.f, 4.f);
+  for (int axis_dim : {1, 7, 256, 257, 1000, 5000}) {
+    for (int remain : {1, 3}) {
+      const int n = 5;
+      std::vector<float> x(n * axis_dim * remain);
+      for (auto& v : x) {
+        v = dist(engine);
+      }
+      CheckSoftmax(x, n, axis_dim, remain);
+    }
+  }
+}
+
+// The max grows from block to block, so the sum is rescaled many times, and
+// the shifted logits of the first blocks are clipped.
+TEST(CPUSoftmax, growing_max) {
+  const int axis_dim = 3000;
+  std::vector<float> x(2 * axis_dim);
+  for (int k = 0; k < axis_dim; ++k) {
+    x[k] = 0.05f * k;
+    x[axis_dim + k] = 100.f - 0.05f * k;
+  }
+  CheckSoftmax(x, 2, axis_dim, 1);
+}
+
+// Enough rows to run in parallel.
+TEST(CPUSoftmax, many_rows) {
+  std::mt19937 engine(2022);
+  std::uniform_real_distribution<float> dist(-10.f, 10.f);
+  const int n = 512, axis_dim = 300;
+  std::vector<float> x(n * axis_dim);
+  for (auto& v : x) {
+    v = dist(engine);
+  }
+  CheckSoftmax(x, n, axis_dim, 1);
+}
+
+}  // namespace tests
+}  // namespace phi
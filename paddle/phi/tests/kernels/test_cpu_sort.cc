@@ -0,0 +1,158 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/kernels/funcs/sort_cpu.h"
+
+namespace phi {
+namespace tests {
+
+// The order of the kernels: NaN is the largest, and the equal values are
+// ordered by their indices.
+template <typename T>
+static bool Before(T a, int64_t ia, T b, int64_t ib, bool descending) {
+  bool a_nan = std::isnan(static_cast<double>(a));
+  bool b_nan = std::isnan(static_cast<double>(b));
+  if (a_nan != b_nan) {
+    return descending ? a_nan : b_nan;
+  }
+  if (!a_nan && a != b) {
+    return descending ? a > b : a < b;
+  }
+  return ia < ib;
+}
+
+template <typename T>
+static std::vector<int64_t> ExpectedOrder(const T* row,
+                                          int64_t width,
+                                          bool descending) {
+  std::vector<int64_t> order(width);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return Before(row[a], a, row[b], b, descending);
+  });
+  return order;
+}
+
+template <typename T>
+static std::vector<T> RandomValues(int64_t n, int range, std::mt19937* engine) {
+  std::uniform_int_distribution<int> dist(-range, range);
+  std::vector<T> values(n);
+  for (auto& v : values) {
+    v = static_cast<T>(dist(*engine));
+  }
+  return values;
+}
+
+template <typename T>
+static void CheckTopK(const std::vector<T>& input,
+                      int64_t height,
+                      int64_t width,
+                      int k,
+                      bool largest) {
+  std::vector<T> out(height * k);
+  std::vector<int64_t> indices(height * k);
+  funcs::TopKRows(input.data(),
+                  height,
+                  width,
+                  k,
+                  largest,
+                  /*sorted=*/true,
+                  out.data(),
+                  indices.data());
+  for (int64_t i = 0; i < height; ++i) {
+    auto order = ExpectedOrder(input.data() + i * width, width, largest);
+    for (int j = 0; j < k; ++j) {
+      ASSERT_EQ(indices[i * k + j], order[j])
+          << "width " << width << ", k " << k << ", row " << i;
+      ASSERT_EQ(std::memcmp(&out[i * k + j],
+                            &input[i * width + order[j]],
+                            sizeof(T)),
+                0);
+    }
+  }
+}
+
+TEST(CPUTopK, same_as_sort) {
+  std::mt19937 engine(2022);
+  for (int64_t width : {1, 7, 100, 1000, 5000}) {
+    for (int k : {1, 2, 5, 16, 17, 100}) {
+      if (k > width) continue;
+      for (bool largest : {true, false}) {
+        // Few distinct values, so that there are many ties.
+        CheckTopK(RandomValues<float>(3 * width, 10, &engine),
+                  3,
+                  width,
+                  k,
+                  largest);
+        CheckTopK(RandomValues<int64_t>(2 * width, 1000000, &engine),
+                  2,
+                  width,
+                  k,
+                  largest);
+      }
+    }
+  }
+}
+
+TEST(CPUTopK, nan_and_signed_zero) {
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float inf = std::numeric_limits<float>::infinity();
+  std::vector<float> input = {0.f, nan, -0.f, -inf, 1.f, -nan, inf, -1.f};
+  for (int k = 1; k <= 8; ++k) {
+    CheckTopK(input, 1, 8, k, true);
+    CheckTopK(input, 1, 8, k, false);
+  }
+}
+
+TEST(CPUTopK, wide_rows) {
+  std::mt19937 engine(2022);
+  constexpr int64_t kWidth = 1 << 20;
+  auto input = RandomValues<double>(2 * kWidth, 1 << 30, &engine);
+  for (int k : {1, 10, 100, 1000}) {
+    CheckTopK(input, 2, kWidth, k, true);
+  }
+}
+
+TEST(CPUArgsort, same_as_sort) {
+  std::mt19937 engine(2022);
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  for (int64_t width : {1, 10, 511, 512, 3000}) {
+    for (bool descending : {true, false}) {
+      auto input = RandomValues<float>(2 * width, 100, &engine);
+      input[0] = nan;
+      input[input.size() / 2] = -0.f;
+      std::vector<float> out(input.size());
+      std::vector<int64_t> indices(input.size());
+      funcs::ArgsortRows(
+          input.data(), 2, width, descending, out.data(), indices.data());
+      for (int64_t i = 0; i < 2; ++i) {
+        auto order = ExpectedOrder(input.data() + i * width, width, descending);
+        for (int64_t j = 0; j < width; ++j) {
+          ASSERT_EQ(indices[i * width + j], order[j]);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,92 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/phi/kernels/funcs/sort_cpu.h"
+#include "paddle/phi/tests/core/timer.h"
+
+namespace phi {
+namespace tests {
+
+// Compare with the std::partial_sort of (value, index) pairs which the
+// kernel used before, on the 1M-wide score vectors of retrieval.
+TEST(CPUTopK, benchmark) {
+  std::mt19937 engine(2022);
+  constexpr int64_t kWidth = 1 << 20;
+  std::normal_distribution<float> dist;
+  std::vector<float> scores(kWidth);
+  for (auto& score : scores) {
+    score = dist(engine);
+  }
+  Timer timer;
+  for (int k : {1, 10, 100, 1000}) {
+    timer.tic();
+    std::vector<std::pair<float, int64_t>> pairs;
+    pairs.reserve(kWidth);
+    for (int64_t j = 0; j < kWidth; ++j) {
+      pairs.emplace_back(scores[j], j);
+    }
+    std::partial_sort(pairs.begin(),
+                      pairs.begin() + k,
+                      pairs.end(),
+                      [](const std::pair<float, int64_t>& l,
+                         const std::pair<float, int64_t>& r) {
+                        return l.first > r.first;
+                      });
+    double partial_sort_cost = timer.toc();
+
+    std::vector<float> out(k);
+    std::vector<int64_t> indices(k);
+    timer.tic();
+    funcs::TopKRows(
+        scores.data(), 1, kWidth, k, true, true, out.data(), indices.data());
+    double top_k_cost = timer.toc();
+    EXPECT_EQ(out[0], pairs[0].first);
+    EXPECT_EQ(out[k - 1], pairs[k - 1].first);
+    LOG(INFO) << "top " << k << " of " << kWidth << ": partial_sort "
+              << partial_sort_cost << "ms, TopKRows " << top_k_cost << "ms.";
+  }
+
+  timer.tic();
+  std::vector<std::pair<float, int64_t>> pairs;
+  pairs.reserve(kWidth);
+  for (int64_t j = 0; j < kWidth; ++j) {
+    pairs.emplace_back(scores[j], j);
+  }
+  std::sort(pairs.begin(),
+            pairs.end(),
+            [](const std::pair<float, int64_t>& l,
+               const std::pair<float, int64_t>& r) {
+              return l.first < r.first;
+            });
+  double sort_cost = timer.toc();
+  std::vector<float> out(kWidth);
+  std::vector<int64_t> indices(kWidth);
+  timer.tic();
+  funcs::ArgsortRows(
+      scores.data(), 1, kWidth, false, out.data(), indices.data());
+  double argsort_cost = timer.toc();
+  EXPECT_TRUE(std::is_sorted(out.begin(), out.end()));
+  LOG(INFO) << "argsort of " << kWidth << ": sort " << sort_cost
+            << "ms, ArgsortRows " << argsort_cost << "ms.";
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,122 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/kernels/funcs/transpose_cpu.h"
+
+namespace phi {
+namespace tests {
+
+template <typename T>
+static std::vector<T> NaiveTranspose(const std::vector<int64_t>& dims,
+                                     const std::vector<int>& perm,
+                                     const std::vector<T>& src) {
+  int rank = dims.size();
+  std::vector<int64_t> strides(rank), dst_dims(rank);
+  int64_t numel = 1;
+  for (int i = rank - 1; i >= 0; --i) {
+    strides[i] = numel;
+    numel *= dims[i];
+  }
+  for (int i = 0; i < rank; ++i) {
+    dst_dims[i] = dims[perm[i]];
+  }
+  std::vector<T> dst(numel);
+  std::vector<int64_t> index(rank, 0);
+  for (int64_t i = 0; i < numel; ++i) {
+    int64_t offset = 0;
+    for (int d = 0; d < rank; ++d) {
+      offset += index[d] * strides[perm[d]];
+    }
+    dst[i] = src[offset];
+    for (int d = rank - 1; d >= 0; --d) {
+      if (++index[d] < dst_dims[d]) break;
+      index[d] = 0;
+    }
+  }
+  return dst;
+}
+
+TEST(CPUTranspose, random_perms) {
+  std::mt19937 engine(2022);
+  for (int iter = 0; iter < 1000; ++iter) {
+    int rank = 1 + iter % 7;
+    std::vector<int64_t> dims(rank);
+    std::vector<int> perm(rank);
+    int64_t numel = 1;
+    for (int i = 0; i < rank; ++i) {
+      dims[i] = 1 + engine() % (i % 2 ? 37 : 5);
+      numel *= dims[i];
+    }
+    std::iota(perm.begin(), perm.end(), 0);
+    std::shuffle(perm.begin(), perm.end(), engine);
+
+    std::vector<float> src(numel), dst(numel);
+    std::iota(src.begin(), src.end(), 0.f);
+    std::vector<int32_t> perm32(perm.begin(), perm.end());
+    funcs::CPUTransposer<float> transposer(
+        dims, perm32, src.data(), dst.data());
+    int block_idx = iter % funcs::kCPUTransposeBlockSizeNum;
+    transposer.Run(funcs::kCPUTransposeBlockSizes[block_idx]);
+    EXPECT_EQ(dst, NaiveTranspose(dims, perm, src));
+  }
+}
+
+TEST(CPUTranspose, large_merged_dim) {
+  // The merged dim 50000 * 50000 does not fit in int32. The data is never
+  // touched, since only the simplified dims are checked.
+  std::vector<int64_t> dims = {2, 50000, 50000};
+  std::vector<int32_t> perm = {1, 2, 0};
+  funcs::CPUTransposer<float> transposer(dims, perm, nullptr, nullptr);
+  EXPECT_EQ(transposer.SrcDims(), std::vector<int64_t>({2, 2500000000}));
+  EXPECT_EQ(transposer.Perm(), std::vector<int>({1, 0}));
+  EXPECT_TRUE(transposer.IsBlocked());
+}
+
+TEST(CPUTranspose, autotune_block_size) {
+  phi::DenseTensor x, out;
+  float* x_data = x.mutable_data<float>({8, 96, 40}, phi::CPUPlace());
+  float* out_data = out.mutable_data<float>({8, 40, 96}, phi::CPUPlace());
+  std::iota(x_data, x_data + x.numel(), 0.f);
+
+  auto& status = autotune::AutoTuneStatus::Instance();
+  auto& cache = autotune::AutoTuneCache::Instance().GetTranspose();
+  status.EnableAutoTune();
+  // Autotune starts from the first step.
+  status.Update();
+  funcs::TransposeCPU<float>(x, &out, {0, 2, 1});
+  EXPECT_EQ(cache.Size(), 1);
+  EXPECT_EQ(cache.CacheMisses(), 1);
+
+  std::vector<float> src(x_data, x_data + x.numel());
+  std::vector<float> expected =
+      NaiveTranspose<float>({8, 96, 40}, {0, 2, 1}, src);
+  EXPECT_EQ(std::vector<float>(out_data, out_data + out.numel()), expected);
+
+  // The tuned block size is used.
+  std::fill(out_data, out_data + out.numel(), 0.f);
+  funcs::TransposeCPU<float>(x, &out, {0, 2, 1});
+  EXPECT_EQ(cache.Size(), 1);
+  EXPECT_EQ(cache.CacheHits(), 1);
+  EXPECT_EQ(std::vector<float>(out_data, out_data + out.numel()), expected);
+  status.DisableAutoTune();
+}
+
+}  // namespace tests
+}  // namespace phi
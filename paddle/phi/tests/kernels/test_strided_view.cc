@@ -0,0 +1,177 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <vector>
+
+#include "paddle/phi/backends/all_context.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/meta_tensor.h"
+#include "paddle/phi/core/tensor_utils.h"
+#include "paddle/phi/infermeta/unary.h"
+#include "paddle/phi/kernels/strided_view_kernel.h"
+
+namespace phi {
+namespace tests {
+
+static const CPUContext& GetCPUContext() {
+  auto& pool = DeviceContextPool::Instance();
+  return *static_cast<const CPUContext*>(pool.GetByPlace(CPUPlace()));
+}
+
+// A float tensor of `dims` with the values 0, 1, 2, ...
+static DenseTensor Iota(const std::vector<int64_t>& dims) {
+  DenseTensor x;
+  const DenseTensorMeta meta(DataType::FLOAT32, make_ddim(dims));
+  x.set_meta(meta);
+  float* data = GetCPUContext().Alloc<float>(&x);
+  std::iota(data, data + x.numel(), 0.f);
+  return x;
+}
+
+static std::vector<float> Values(const DenseTensor& x) {
+  DenseTensor contiguous;
+  ContiguousCopy(x, &contiguous);
+  EXPECT_TRUE(contiguous.meta().is_contiguous());
+  EXPECT_EQ(contiguous.dims(), x.dims());
+  const float* data = contiguous.data<float>();
+  return std::vector<float>(data, data + contiguous.numel());
+}
+
+TEST(StridedView, meta) {
+  DenseTensorMeta meta(DataType::FLOAT32, make_ddim({2, 1, 3}));
+  EXPECT_TRUE(meta.is_contiguous());
+  EXPECT_EQ(meta.storage_numel(), 6);
+  // The stride of the dim of size 1 is ignored.
+  meta.strides = {3, 100, 1};
+  EXPECT_TRUE(meta.is_contiguous());
+  meta.strides = {1, 1, 2};
+  EXPECT_FALSE(meta.is_contiguous());
+  EXPECT_EQ(meta.storage_numel(), 6);
+  // The broadcast dims have the stride 0.
+  meta.strides = {0, 0, 1};
+  EXPECT_FALSE(meta.is_contiguous());
+  EXPECT_EQ(meta.storage_numel(), 3);
+}
+
+TEST(StridedView, transpose_and_slice) {
+  const auto& dev_ctx = GetCPUContext();
+  auto x = Iota({2, 3, 4});
+
+  DenseTensor transposed;
+  MetaTensor meta_transposed(&transposed);
+  TransposeInferMeta(x, {2, 0, 1}, &meta_transposed);
+  TransposeViewKernel<float>(dev_ctx, x, {2, 0, 1}, &transposed);
+  EXPECT_FALSE(transposed.meta().is_contiguous());
+  EXPECT_EQ(transposed.data<float>(), x.data<float>());
+  EXPECT_EQ(Values(transposed),
+            std::vector<float>({0, 4,  8,  12, 16, 20, 1, 5,  9,  13, 17, 21,
+                                2, 6,  10, 14, 18, 22, 3, 7,  11, 15, 19, 23}));
+
+  // A slice of the transposed view: [1:3, :, 2] of the dims [4, 2, 3].
+  DenseTensor sliced;
+  MetaTensor meta_sliced(&sliced);
+  SliceRawInferMeta(transposed,
+                    {0, 2},
+                    IntArray(std::vector<int64_t>{1, 2}),
+                    IntArray(std::vector<int64_t>{3, 3}),
+                    {1, 1},
+                    {2},
+                    &meta_sliced);
+  SliceViewKernel<float>(dev_ctx,
+                         transposed,
+                         {0, 2},
+                         IntArray(std::vector<int64_t>{1, 2}),
+                         IntArray(std::vector<int64_t>{3, 3}),
+                         {1, 1},
+                         {2},
+                         &sliced);
+  EXPECT_EQ(sliced.dims(), make_ddim({2, 2}));
+  EXPECT_EQ(Values(sliced), std::vector<float>({9, 21, 10, 22}));
+
+  // The copy of a view is contiguous.
+  DenseTensor copied;
+  Copy(dev_ctx, sliced, CPUPlace(), true, &copied);
+  EXPECT_TRUE(copied.meta().is_contiguous());
+  EXPECT_EQ(Values(copied), Values(sliced));
+}
+
+TEST(StridedView, split_and_unbind) {
+  const auto& dev_ctx = GetCPUContext();
+  auto x = Iota({3, 4});
+
+  std::vector<DenseTensor> splits(2);
+  std::vector<MetaTensor> meta_splits = {MetaTensor(&splits[0]),
+                                         MetaTensor(&splits[1])};
+  std::vector<MetaTensor*> meta_split_ptrs = {&meta_splits[0],
+                                              &meta_splits[1]};
+  SplitInferMeta(
+      x, IntArray(std::vector<int64_t>{1, -1}), Scalar(1), meta_split_ptrs);
+  SplitViewKernel<float>(dev_ctx,
+                         x,
+                         IntArray(std::vector<int64_t>{1, -1}),
+                         Scalar(1),
+                         {&splits[0], &splits[1]});
+  EXPECT_EQ(Values(splits[0]), std::vector<float>({0, 4, 8}));
+  EXPECT_EQ(Values(splits[1]),
+            std::vector<float>({1, 2, 3, 5, 6, 7, 9, 10, 11}));
+
+  std::vector<DenseTensor> rows(3);
+  std::vector<MetaTensor> meta_rows = {
+      MetaTensor(&rows[0]), MetaTensor(&rows[1]), MetaTensor(&rows[2])};
+  std::vector<MetaTensor*> meta_row_ptrs = {
+      &meta_rows[0], &meta_rows[1], &meta_rows[2]};
+  UnbindInferMeta(x, 0, meta_row_ptrs);
+  UnbindViewKernel<float>(dev_ctx, x, 0, {&rows[0], &rows[1], &rows[2]});
+  // The rows are contiguous views.
+  EXPECT_TRUE(rows[2].meta().is_contiguous());
+  EXPECT_EQ(rows[2].data<float>(), x.data<float>() + 8);
+  EXPECT_EQ(Values(rows[2]), std::vector<float>({8, 9, 10, 11}));
+}
+
+TEST(StridedView, diagonal_and_expand) {
+  const auto& dev_ctx = GetCPUContext();
+  auto x = Iota({3, 4});
+
+  for (int offset : {-1, 0, 1}) {
+    DenseTensor diagonal;
+    MetaTensor meta_diagonal(&diagonal);
+    DiagonalInferMeta(x, offset, 0, 1, &meta_diagonal);
+    DiagonalViewKernel<float>(dev_ctx, x, offset, 0, 1, &diagonal);
+    std::vector<float> expected;
+    for (int i = 0; i < 3; ++i) {
+      int j = i + offset;
+      if (j >= 0 && j < 4) {
+        expected.push_back(i * 4 + j);
+      }
+    }
+    EXPECT_EQ(Values(diagonal), expected);
+  }
+
+  auto y = Iota({3, 1});
+  DenseTensor expanded;
+  MetaTensor meta_expanded(&expanded);
+  ExpandInferMeta(y, IntArray(std::vector<int64_t>{2, 3, 2}), &meta_expanded);
+  ExpandViewKernel<float>(
+      dev_ctx, y, IntArray(std::vector<int64_t>{2, 3, 2}), &expanded);
+  EXPECT_EQ(expanded.meta().storage_numel(), 3);
+  EXPECT_EQ(Values(expanded),
+            std::vector<float>({0, 0, 1, 1, 2, 2, 0, 0, 1, 1, 2, 2}));
+}
+
+}  // namespace tests
+}  // namespace phi
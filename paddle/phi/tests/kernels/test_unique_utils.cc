@@ -0,0 +1,106 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/kernels/funcs/unique_utils.h"
+
+namespace phi {
+namespace tests {
+
+// The distributions of the ids in feature deduplication.
+static std::vector<int64_t> GenerateIds(const std::string& distribution,
+                                        int64_t n) {
+  std::mt19937_64 engine(2022);
+  std::vector<int64_t> ids(n);
+  if (distribution == "uniform") {
+    // Hashed feature signs, nearly all distinct.
+    for (auto& id : ids) id = static_cast<int64_t>(engine());
+  } else if (distribution == "zipf") {
+    // A few hot ids and a long tail.
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    for (auto& id : ids) {
+      id = static_cast<int64_t>(std::pow(n, dist(engine))) - n / 2;
+    }
+  } else if (distribution == "dense") {
+    // Small ids of a vocabulary.
+    std::uniform_int_distribution<int64_t> dist(0, 10000);
+    for (auto& id : ids) id = dist(engine);
+  }
+  return ids;
+}
+
+TEST(FlatKeyIndexer, same_as_unordered_map) {
+  for (auto distribution : {"uniform", "zipf", "dense"}) {
+    auto ids = GenerateIds(distribution, 100000);
+    funcs::FlatKeyIndexer<int64_t> indexer;
+    std::unordered_map<int64_t, int64_t> expected;
+    for (auto id : ids) {
+      bool inserted;
+      int64_t index = indexer.Insert(id, &inserted);
+      auto it = expected.find(id);
+      EXPECT_EQ(inserted, it == expected.end());
+      if (it == expected.end()) {
+        EXPECT_EQ(index, static_cast<int64_t>(expected.size()));
+        expected.emplace(id, index);
+      } else {
+        EXPECT_EQ(index, it->second);
+      }
+    }
+    EXPECT_EQ(indexer.Size(), static_cast<int64_t>(expected.size()));
+  }
+
+  funcs::FlatKeyIndexer<float> float_indexer;
+  bool inserted;
+  EXPECT_EQ(float_indexer.Insert(1.5f, &inserted), 0);
+  EXPECT_EQ(float_indexer.Insert(-0.0f, &inserted), 1);
+  EXPECT_EQ(float_indexer.Insert(0.0f, &inserted), 1);
+  EXPECT_FALSE(inserted);
+}
+
+TEST(RadixSortByKey, stable) {
+  for (auto distribution : {"uniform", "zipf", "dense"}) {
+    auto ids = GenerateIds(distribution, 300000);
+    std::vector<int64_t> keys = ids;
+    std::vector<int32_t> indices(ids.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    funcs::RadixSortByKey(&keys, &indices);
+
+    std::vector<int32_t> expected(ids.size());
+    std::iota(expected.begin(), expected.end(), 0);
+    std::stable_sort(expected.begin(),
+                     expected.end(),
+                     [&ids](int32_t a, int32_t b) { return ids[a] < ids[b]; });
+    EXPECT_EQ(indices, expected);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      ASSERT_EQ(keys[i], ids[indices[i]]);
+    }
+  }
+
+  std::vector<int32_t> keys = {3, -1, 2, -1, 0, 2147483647, -2147483647 - 1};
+  std::vector<int64_t> indices = {0, 1, 2, 3, 4, 5, 6};
+  funcs::RadixSortByKey(&keys, &indices);
+  EXPECT_EQ(keys,
+            std::vector<int32_t>(
+                {-2147483647 - 1, -1, -1, 0, 2, 3, 2147483647}));
+  EXPECT_EQ(indices, std::vector<int64_t>({6, 1, 3, 4, 2, 0, 5}));
+}
+
+}  // namespace tests
+}  // namespace phi
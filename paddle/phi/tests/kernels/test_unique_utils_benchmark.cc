@@ -0,0 +1,99 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/phi/kernels/funcs/unique_utils.h"
+#include "paddle/phi/tests/core/timer.h"
+
+namespace phi {
+namespace tests {
+
+// The distributions of the ids in feature deduplication.
+static std::vector<int64_t> GenerateIds(const std::string& distribution,
+                                        int64_t n) {
+  std::mt19937_64 engine(2022);
+  std::vector<int64_t> ids(n);
+  if (distribution == "uniform") {
+    // Hashed feature signs, nearly all distinct.
+    for (auto& id : ids) id = static_cast<int64_t>(engine());
+  } else if (distribution == "zipf") {
+    // A few hot ids and a long tail.
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    for (auto& id : ids) {
+      id = static_cast<int64_t>(std::pow(n, dist(engine))) - n / 2;
+    }
+  } else if (distribution == "dense") {
+    // Small ids of a vocabulary.
+    std::uniform_int_distribution<int64_t> dist(0, 10000);
+    for (auto& id : ids) id = dist(engine);
+  }
+  return ids;
+}
+
+// Compare the dedup of the unique kernels with the std containers they used
+// before, on 10M ids.
+TEST(UniqueUtils, benchmark) {
+  constexpr int64_t kNumIds = 10000000;
+  for (auto distribution : {"uniform", "zipf", "dense"}) {
+    auto ids = GenerateIds(distribution, kNumIds);
+    std::vector<int64_t> index(kNumIds);
+
+    Timer timer;
+    timer.tic();
+    std::unordered_map<int64_t, int64_t> dict;
+    for (int64_t i = 0; i < kNumIds; ++i) {
+      index[i] = dict.emplace(ids[i], dict.size()).first->second;
+    }
+    double map_cost = timer.toc();
+    timer.tic();
+    funcs::FlatKeyIndexer<int64_t> indexer;
+    for (int64_t i = 0; i < kNumIds; ++i) {
+      bool inserted;
+      index[i] = indexer.Insert(ids[i], &inserted);
+    }
+    double indexer_cost = timer.toc();
+    EXPECT_EQ(indexer.Size(), static_cast<int64_t>(dict.size()));
+
+    std::vector<int64_t> sorted = ids;
+    std::vector<int64_t> order(kNumIds);
+    std::iota(order.begin(), order.end(), 0);
+    timer.tic();
+    std::stable_sort(order.begin(), order.end(), [&ids](int64_t a, int64_t b) {
+      return ids[a] < ids[b];
+    });
+    double sort_cost = timer.toc();
+    std::iota(order.begin(), order.end(), 0);
+    timer.tic();
+    funcs::RadixSortByKey(&sorted, &order);
+    double radix_cost = timer.toc();
+
+    LOG(INFO) << distribution << " ids (" << dict.size() << " unique): "
+              << "unordered_map " << map_cost << "ms, "
+              << "FlatKeyIndexer " << indexer_cost << "ms, "
+              << "stable_sort " << sort_cost << "ms, "
+              << "RadixSortByKey " << radix_cost << "ms.";
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
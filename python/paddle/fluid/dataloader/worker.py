@@ -374,9 +374,13 @@ def _worker_loop(
                 batch, structure = _flatten_batch(batch)
                 if use_shared_memory:
 
+                    # NOTE: The tensor shares the memory of the array, which
+                    # is copied into shared memory only once when the tensor
+                    # is put into the queue. With FLAGS_use_shm_cache, the
+                    # shared memory files are reused for the later batches.
                     def numpy2lodtensor(arr):
                         lodtensor = core.Tensor()
-                        lodtensor.set(arr, core.CPUPlace())
+                        lodtensor.set(arr, core.CPUPlace(), True)
                         return lodtensor
 
                     tensor_list = [
@@ -0,0 +1,88 @@
+# Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+import paddle.fluid as fluid
+
+
+class TestNumpyZeroCopy(unittest.TestCase):
+    def setUp(self):
+        paddle.set_flags({'FLAGS_use_numpy_zero_copy': True})
+        self.place = fluid.CPUPlace()
+
+    def tearDown(self):
+        paddle.set_flags({'FLAGS_use_numpy_zero_copy': False})
+
+    def test_lod_tensor_shares_array(self):
+        for dtype in ['float32', 'float64', 'int32', 'int64', 'uint8']:
+            data = np.arange(24).reshape([2, 3, 4]).astype(dtype)
+            t = fluid.LoDTensor()
+            t.set(data, self.place)
+            self.assertEqual(t._ptr(), data.ctypes.data)
+            data[0, 0, 0] = 7
+            self.assertEqual(np.array(t)[0, 0, 0], 7)
+
+    def test_lod_tensor_copies_array(self):
+        data = np.arange(24).reshape([4, 6]).astype('float32')
+        # Not C-contiguous.
+        t = fluid.LoDTensor()
+        t.set(data.T, self.place)
+        self.assertNotEqual(t._ptr(), data.ctypes.data)
+        np.testing.assert_array_equal(np.array(t), data.T)
+        # Not writeable.
+        readonly = data.copy()
+        readonly.flags.writeable = False
+        t = fluid.LoDTensor()
+        t.set(readonly, self.place)
+        self.assertNotEqual(t._ptr(), readonly.ctypes.data)
+        # Set to an initialized tensor.
+        t.set(data, self.place)
+        self.assertNotEqual(t._ptr(), data.ctypes.data)
+        np.testing.assert_array_equal(np.array(t), data)
+
+    def test_eager_tensor(self):
+        paddle.disable_static(self.place)
+        data = np.random.random([3, 5]).astype('float32')
+        x = paddle.to_tensor(data, place=self.place)
+        data[1, 2] = -1.0
+        self.assertEqual(x.numpy()[1, 2], -1.0)
+
+        y = x * 2
+        out = y.numpy()
+        np.testing.assert_allclose(out, data * 2, rtol=1e-6)
+        # The array keeps the memory after the tensor is released.
+        del y
+        np.testing.assert_allclose(out, data * 2, rtol=1e-6)
+        paddle.enable_static()
+
+    def test_feed(self):
+        paddle.enable_static()
+        main = fluid.Program()
+        startup = fluid.Program()
+        with fluid.program_guard(main, startup):
+            x = paddle.static.data(name='x', shape=[4, 8], dtype='float32')
+            y = paddle.scale(x, scale=3.0)
+        exe = fluid.Executor(self.place)
+        exe.run(startup)
+        data = np.random.random([4, 8]).astype('float32')
+        (out,) = exe.run(main, feed={'x': data}, fetch_list=[y])
+        np.testing.assert_allclose(out, data * 3.0, rtol=1e-6)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,60 @@
+#   Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle import _legacy_C_ops
+
+
+# With FLAGS_use_strided_view, transpose returns a strided view of its input
+# on CPU, which the paths reading or writing the memory directly copy to a
+# contiguous tensor first.
+class TestStridedView(unittest.TestCase):
+    def setUp(self):
+        paddle.set_flags({'FLAGS_use_strided_view': True})
+        self.x_np = np.arange(6, dtype='float32').reshape([2, 3])
+        self.x = paddle.to_tensor(self.x_np, place=paddle.CPUPlace())
+        self.y = paddle.transpose(self.x, [1, 0])
+
+    def tearDown(self):
+        paddle.set_flags({'FLAGS_use_strided_view': False})
+
+    def test_numpy(self):
+        np.testing.assert_array_equal(self.y.numpy(), self.x_np.T)
+
+    def test_setitem(self):
+        self.y[0] = 10
+        self.y[paddle.to_tensor([2])] = 20
+        expected = self.x_np.T.copy()
+        expected[0] = 10
+        expected[2] = 20
+        np.testing.assert_array_equal(self.y.numpy(), expected)
+        # The view stops sharing the memory of its base when written.
+        np.testing.assert_array_equal(self.x.numpy(), self.x_np)
+
+    def test_legacy_op(self):
+        out = _legacy_C_ops.scale(self.y, 'scale', 2.0)
+        np.testing.assert_array_equal(out.numpy(), 2 * self.x_np.T)
+
+    def test_dlpack(self):
+        dlpack = paddle.utils.dlpack.to_dlpack(self.y)
+        out = paddle.utils.dlpack.from_dlpack(dlpack)
+        np.testing.assert_array_equal(out.numpy(), self.x_np.T)
+
+
+if __name__ == '__main__':
+    unittest.main()